@@ -1,12 +1,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
-#include <sys/time.h>
 
 #include "bilateral_grid.h"
 
 #include <static_image.h>
 #include <image_io.h>
+#include <benchmark.h>
 
 int main(int argc, char **argv) {
 
@@ -16,31 +16,21 @@ int main(int argc, char **argv) {
         return 0;
     }
 
-    Image<float> input = load<float>(argv[1]);
+    // I/O is timed separately from compute.
+    Image<float> input;
+    benchmark_io("bilateral_grid/load", [&]() {
+        input = load<float>(argv[1]);
+    });
     Image<float> output(input.width(), input.height(), 1);
 
-    bilateral_grid(atof(argv[3]), input, output);
-
-#if 1
-    // Timing code
-    timeval t1, t2;
-    double min_t = 1e10f;
-    for (int j = 0; j < 10; j++) {
-        gettimeofday(&t1, NULL);
-        for (int i = 0; i < 10; i++) {
-            bilateral_grid(atof(argv[3]), input, output);
-        }
-        gettimeofday(&t2, NULL);
-        double t = (t2.tv_sec - t1.tv_sec)*1000.0 + (t2.tv_usec - t1.tv_usec)/1000.0;
-        if (t < min_t) {
-            min_t = t;
-        }
-    }
-
-    printf("Time: %fms\n", min_t/10);
-#endif
+    float r_sigma = atof(argv[3]);
+    benchmark_thread_sweep("bilateral_grid", halide_set_num_threads, [&]() {
+        bilateral_grid(r_sigma, input, output);
+    });
 
-    save(output, argv[2]);
+    benchmark_io("bilateral_grid/save", [&]() {
+        save(output, argv[2]);
+    });
 
     return 0;
 }
@@ -1,18 +1,19 @@
 #include <emmintrin.h>
 #include <math.h>
-#include <sys/time.h>
 #include <stdint.h>
 #include <stdio.h>
 
 #include "static_image.h"
+#include "benchmark.h"
 
 //#define cimg_display 0
 //#include "CImg.h"
 //using namespace cimg_library;
 
-timeval t1, t2;
-#define begin_timing gettimeofday(&t1, NULL); for (int i = 0; i < 10; i++) {
-#define end_timing } gettimeofday(&t2, NULL);
+// The median time of the last thing timed, in seconds.
+double t;
+#define begin_timing(name) t = benchmark(name, [&]() {
+#define end_timing }).p50
 
 // typedef CImg<uint16_t> Image;
 
@@ -20,7 +21,7 @@ Image<uint16_t> blur(Image<uint16_t> in) {
     Image<uint16_t> tmp(in.width()-8, in.height());
     Image<uint16_t> out(in.width()-8, in.height()-2);
 
-    begin_timing;
+    begin_timing("blur/naive");
 
     for (int y = 0; y < tmp.height(); y++)
         for (int x = 0; x < tmp.width(); x++)
@@ -38,7 +39,7 @@ Image<uint16_t> blur(Image<uint16_t> in) {
 
 Image<uint16_t> blur_fast(Image<uint16_t> in) {
     Image<uint16_t> out(in.width()-8, in.height()-2);
-    begin_timing;
+    begin_timing("blur/sse_openmp");
     __m128i one_third = _mm_set1_epi16(21846);
 #pragma omp parallel for
     for (int yTile = 0; yTile < out.height(); yTile += 32) {
@@ -120,18 +121,18 @@ Image<uint16_t> blur_fast(Image<uint16_t> in) {
 Image<uint16_t> blur_fast2(const Image<uint16_t> &in) {
     Image<uint16_t> out(in.width()-8, in.height()-2);
 
-    begin_timing;
-
-    // multiplying by 21846 then taking the top 16 bits is equivalent to
-    // dividing by three
-    __m128i one_third = _mm_set1_epi16(21846);
-
     int vw = in.width()/8;
     if (vw > 1024) {
         printf("Image too large for constant-sized stack allocation\n");
         return out;
     }
 
+    begin_timing("blur/sse_openmp_sliding_window");
+
+    // multiplying by 21846 then taking the top 16 bits is equivalent to
+    // dividing by three
+    __m128i one_third = _mm_set1_epi16(21846);
+
 #pragma omp parallel for
     for (int yTile = 0; yTile < in.height(); yTile += 128) {
 
@@ -180,16 +181,13 @@ extern "C" {
 Image<uint16_t> blur_halide(Image<uint16_t> in) {
     Image<uint16_t> out(in.width()-8, in.height()-2);
 
-    // Call it once to initialize the halide runtime stuff
-    halide_blur(in, out);
-
-    begin_timing;
-
     // Compute the same region of the output as blur_fast (i.e., we're
     // still being sloppy with boundary conditions)
-    halide_blur(in, out);
-
-    end_timing;
+    std::vector<BenchmarkResult> results =
+        benchmark_thread_sweep("blur/halide", halide_set_num_threads, [&]() {
+            halide_blur(in, out);
+        });
+    t = results.back().p50;
 
     return out;
 }
@@ -205,16 +203,16 @@ int main(int argc, char **argv) {
     }
 
     Image<uint16_t> blurry = blur(input);
-    float slow_time = (t2.tv_sec - t1.tv_sec) + (t2.tv_usec - t1.tv_usec) / 1000000.0f;
+    double slow_time = t;
 
     Image<uint16_t> speedy = blur_fast(input);
-    float fast_time = (t2.tv_sec - t1.tv_sec) + (t2.tv_usec - t1.tv_usec) / 1000000.0f;
+    double fast_time = t;
 
     //Image<uint16_t> speedy2 = blur_fast2(input);
-    //float fast_time2 = (t2.tv_sec - t1.tv_sec) + (t2.tv_usec - t1.tv_usec) / 1000000.0f;
+    //double fast_time2 = t;
 
     Image<uint16_t> halide = blur_halide(input);
-    float halide_time = (t2.tv_sec - t1.tv_sec) + (t2.tv_usec - t1.tv_usec) / 1000000.0f;
+    double halide_time = t;
 
     // fast_time2 is always slower than fast_time, so skip printing it
     printf("times: %f %f %f\n", slow_time, fast_time, halide_time);
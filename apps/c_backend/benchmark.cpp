@@ -0,0 +1,51 @@
+#include "blur_native.h"
+#include "blur_c.h"
+#include "blur_c_scalar.h"
+#include "../support/static_image.h"
+#include "../support/benchmark.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Compares the speed of the same vectorized pipeline compiled by LLVM,
+// by the C backend using vector extensions, and by the C backend
+// without them.
+
+int main(int argc, char **argv) {
+    Image<uint16_t> in(2048 + 8, 2048 + 2);
+
+    for (int y = 0; y < in.height(); y++) {
+        for (int x = 0; x < in.width(); x++) {
+            in(x, y) = (uint16_t)(rand() & 0xfff);
+        }
+    }
+
+    Image<uint16_t> out_native(2048, 2048);
+    Image<uint16_t> out_c(2048, 2048);
+    Image<uint16_t> out_c_scalar(2048, 2048);
+
+    benchmark("c_backend/llvm", [&]() {
+        blur_native(in, out_native);
+    });
+    benchmark("c_backend/c_vector", [&]() {
+        blur_c(in, out_c);
+    });
+    benchmark("c_backend/c_scalar", [&]() {
+        blur_c_scalar(in, out_c_scalar);
+    });
+
+    for (int y = 0; y < out_native.height(); y++) {
+        for (int x = 0; x < out_native.width(); x++) {
+            if (out_native(x, y) != out_c(x, y) ||
+                out_native(x, y) != out_c_scalar(x, y)) {
+                printf("out_native(%d, %d) = %d, but out_c(%d, %d) = %d and out_c_scalar(%d, %d) = %d\n",
+                       x, y, out_native(x, y),
+                       x, y, out_c(x, y),
+                       x, y, out_c_scalar(x, y));
+                return -1;
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -29,5 +29,26 @@ int main(int argc, char **argv) {
     g.compile_to_header("pipeline_c.h", args, "pipeline_c");
     g.compile_to_object("pipeline_native.o", args, "pipeline_native");
     g.compile_to_c("pipeline_c.c", args, "pipeline_c");
+
+    // A vectorized blur, to compare the performance of the C backend
+    // against LLVM.
+    {
+        Func blur_x("blur_x"), blur_y("blur_y");
+        Var xi, yi;
+        blur_x(x, y) = (input(x, y) + input(x+1, y) + input(x+2, y))/3;
+        blur_y(x, y) = (blur_x(x, y) + blur_x(x, y+1) + blur_x(x, y+2))/3;
+
+        blur_y.tile(x, y, xi, yi, 128, 32).vectorize(xi, 8);
+        blur_x.compute_at(blur_y, x).vectorize(x, 8);
+
+        Target target = get_target_from_environment();
+        blur_y.compile_to_header("blur_native.h", args, "blur_native");
+        blur_y.compile_to_object("blur_native.o", args, "blur_native", target);
+        blur_y.compile_to_header("blur_c.h", args, "blur_c");
+        blur_y.compile_to_c("blur_c.c", args, "blur_c", target);
+        blur_y.compile_to_header("blur_c_scalar.h", args, "blur_c_scalar");
+        blur_y.compile_to_c("blur_c_scalar.c", args, "blur_c_scalar",
+                            target.with_feature(Target::NoVectorExtensions));
+    }
     return 0;
 }
@@ -3,14 +3,13 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
-#include <sys/time.h>
-#include <unistd.h>
 
 extern "C" {
   #include "curved.h"
 }
 #include <static_image.h>
 #include <image_io.h>
+#include <benchmark.h>
 
 #include "fcam/Demosaic.h"
 #include "fcam/Demosaic_ARM.h"
@@ -22,7 +21,11 @@ int main(int argc, char **argv) {
         return 0;
     }
 
-    Image<uint16_t> input = load<uint16_t>(argv[1]);
+    // I/O is timed separately from compute.
+    Image<uint16_t> input;
+    benchmark_io("camera_pipe/load", [&]() {
+        input = load<uint16_t>(argv[1]);
+    });
     Image<uint8_t> output(2560-32, 1920, 3); // image size is hard-coded for the N900 raw pipeline
 
     // These color matrices are for the sensor in the Nokia N900 and are
@@ -46,42 +49,22 @@ int main(int argc, char **argv) {
     float gamma = atof(argv[3]);
     float contrast = atof(argv[4]);
 
-    timeval t1, t2;
-    unsigned int bestT = 0xffffffff;
-    for (int i = 0; i < 5; i++) {
-        gettimeofday(&t1, NULL);
+    benchmark_thread_sweep("camera_pipe/halide", halide_set_num_threads, [&]() {
         curved(color_temp, gamma, contrast,
                input, matrix_3200, matrix_7000, output);
-        gettimeofday(&t2, NULL);
-        unsigned int t = (t2.tv_sec - t1.tv_sec) * 1000000 + (t2.tv_usec - t1.tv_usec);
-        if (t < bestT) bestT = t;
-        if (i % 5 == 0) sleep(1);
-    }
-    printf("Halide:\t%u\n", bestT);
-    save(output, argv[5]);
+    });
+    benchmark_io("camera_pipe/save", [&]() {
+        save(output, argv[5]);
+    });
 
-    bestT = 0xffffffff;
-    for (int i = 0; i < 5; i++) {
-        gettimeofday(&t1, NULL);
+    benchmark("camera_pipe/fcam_c", [&]() {
         FCam::demosaic(input, output, color_temp, contrast, true, 25, gamma);
-        gettimeofday(&t2, NULL);
-        unsigned int t = (t2.tv_sec - t1.tv_sec) * 1000000 + (t2.tv_usec - t1.tv_usec);
-        if (t < bestT) bestT = t;
-        if (i % 5 == 0) sleep(1);
-    }
-    printf("C++:\t%u\n", bestT);
+    });
     save(output, "fcam_c.png");
 
-    bestT = 0xffffffff;
-    for (int i = 0; i < 5; i++) {
-        gettimeofday(&t1, NULL);
+    benchmark("camera_pipe/fcam_arm", [&]() {
         FCam::demosaic_ARM(input, output, color_temp, contrast, true, 25, gamma);
-        gettimeofday(&t2, NULL);
-        unsigned int t = (t2.tv_sec - t1.tv_sec) * 1000000 + (t2.tv_usec - t1.tv_usec);
-        if (t < bestT) bestT = t;
-        if (i % 5 == 0) sleep(1);
-    }
-    printf("ASM:\t%u\n", bestT);
+    });
     save(output, "fcam_arm.png");
 
     // Timings on N900 as of SIGGRAPH 2012 camera ready are (best of 10)
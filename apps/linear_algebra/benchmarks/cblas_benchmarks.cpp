@@ -15,7 +15,7 @@
 #include <random>
 #include <string>
 #include "Halide.h"
-#include "clock.h"
+#include "benchmark.h"
 
 #if defined(USE_ATLAS)
 # define BLAS_NAME "Atlas"
@@ -14,7 +14,7 @@
 #include <iostream>
 #include <string>
 #include <Eigen/Eigen>
-#include "clock.h"
+#include "benchmark.h"
 #include "macros.h"
 
 template<class T>
@@ -16,7 +16,7 @@
 #include <string>
 #include "Halide.h"
 #include "halide_blas.h"
-#include "clock.h"
+#include "benchmark.h"
 #include "macros.h"
 
 template<class T>
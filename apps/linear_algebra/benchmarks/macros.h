@@ -1,17 +1,13 @@
-#define time_it(code)                               \
-    double elapsed = 0;                             \
-    for (int iters = 20; ; iters *= 2) {            \
-        double start = current_time();              \
-        for (int i = 0; i < iters; i++) {           \
-            code;                                   \
-        }                                           \
-        double end = current_time();                \
-        elapsed = 1000 * (end - start);             \
-        if (elapsed > 100000) {                     \
-            elapsed /= iters;                       \
-            break;                                  \
-        }                                           \
-    }
+// Times code with benchmark() from apps/support/benchmark.h, naming
+// the result "<package>/<subroutine>/<size>", and sets elapsed to the
+// median time per call in microseconds. The table the benchmarks print
+// is parsed to make benchmarks.csv, so benchmark() only prints its own
+// line (and records the result) when HL_BENCHMARK_JSON is set.
+#define time_it(label, code)                                            \
+    BenchmarkConfig config;                                             \
+    const char *json = getenv("HL_BENCHMARK_JSON");                     \
+    config.report = json && json[0];                                    \
+    double elapsed = 1e6 * benchmark(label, [&]() {code;}, config).p50;
 
 #define L1GFLOPS(N) 2 * N * 1e-3 / elapsed
 #define L1Benchmark(benchmark, type, code)                              \
@@ -20,7 +16,8 @@
         Vector x(random_vector(N));                                     \
         Vector y(random_vector(N));                                     \
                                                                         \
-        time_it(code)                                                   \
+        time_it(name + "/" + type + #benchmark "/" + std::to_string(N), \
+                code)                                                   \
                                                                         \
         std::cout << std::setw(8) << name                               \
                   << std::setw(15) << type << #benchmark                \
@@ -39,7 +36,8 @@
         Vector y(random_vector(N));                                     \
         Matrix A(random_matrix(N));                                     \
                                                                         \
-        time_it(code)                                                   \
+        time_it(name + "/" + type + #benchmark "/" + std::to_string(N), \
+                code)                                                   \
                                                                         \
         std::cout << std::setw(8) << name                               \
         << std::setw(15) << type << #benchmark                          \
@@ -58,7 +56,8 @@
         Matrix B(random_matrix(N));                                     \
         Matrix C(random_matrix(N));                                     \
                                                                         \
-        time_it(code)                                                   \
+        time_it(name + "/" + type + #benchmark "/" + std::to_string(N), \
+                code)                                                   \
                                                                         \
         std::cout << std::setw(8) << name                               \
                   << std::setw(15) << type << #benchmark                \
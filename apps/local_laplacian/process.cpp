@@ -2,7 +2,7 @@
 #include "local_laplacian.h"
 #include "static_image.h"
 #include "image_io.h"
-#include <sys/time.h>
+#include "benchmark.h"
 
 int main(int argc, char **argv) {
     if (argc < 7) {
@@ -11,28 +11,33 @@ int main(int argc, char **argv) {
         return 0;
     }
 
-    Image<uint16_t> input = load<uint16_t>(argv[1]);
+    // I/O is timed separately from compute.
+    Image<uint16_t> input;
+    benchmark_io("local_laplacian/load", [&]() {
+        input = load<uint16_t>(argv[1]);
+    });
+
     int levels = atoi(argv[2]);
     float alpha = atof(argv[3]), beta = atof(argv[4]);
     Image<uint16_t> output(input.width(), input.height(), 3);
     int timing = atoi(argv[5]);
 
-    // Timing code
-    timeval t1, t2;
-    unsigned int bestT = 0xffffffff;
-    for (int i = 0; i < timing; i++) {
-      gettimeofday(&t1, NULL);
-      local_laplacian(levels, alpha/(levels-1), beta, input, output);
-      gettimeofday(&t2, NULL);
-      unsigned int t = (t2.tv_sec - t1.tv_sec) * 1000000 + (t2.tv_usec - t1.tv_usec);
-      if (t < bestT) bestT = t;
+    // Timing code. The number of timing iterations is the minimum
+    // number of samples to take, and zero skips timing altogether.
+    if (timing > 0) {
+        BenchmarkConfig config;
+        config.min_samples = timing;
+        config.max_samples = std::max(config.max_samples, timing);
+        benchmark_thread_sweep("local_laplacian", halide_set_num_threads, [&]() {
+            local_laplacian(levels, alpha/(levels-1), beta, input, output);
+        }, config);
     }
-    printf("%u\n", bestT);
-
 
     local_laplacian(levels, alpha/(levels-1), beta, input, output);
 
-    save(output, argv[6]);
+    benchmark_io("local_laplacian/save", [&]() {
+        save(output, argv[6]);
+    });
 
     return 0;
 }
@@ -3,24 +3,9 @@
 using namespace Halide;
 
 #include <image_io.h>
+#include <benchmark.h>
 
 #include <iostream>
-#include <limits>
-
-#include <sys/time.h>
-
-double now() {
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    static bool first_call = true;
-    static time_t first_sec = 0;
-    if (first_call) {
-        first_call = false;
-        first_sec = tv.tv_sec;
-    }
-    assert(tv.tv_sec >= first_sec);
-    return (tv.tv_sec - first_sec) + (tv.tv_usec / 1000000.0);
-}
 
 enum InterpolationType {
     BOX, LINEAR, CUBIC, LANCZOS
@@ -191,7 +176,10 @@ int main(int argc, char **argv) {
     final.compile_jit(target);
 
     printf("Loading '%s'\n", infile.c_str());
-    Image<float> in_png = load<float>(infile);
+    Image<float> in_png;
+    benchmark_io("resize/load", [&]() {
+        in_png = load<float>(infile);
+    });
     int out_width = in_png.width() * scaleFactor;
     int out_height = in_png.height() * scaleFactor;
     Image<float> out(out_width, out_height, 3);
@@ -202,21 +190,12 @@ int main(int argc, char **argv) {
            out_width, out_height,
            kernelInfo[interpolationType].name);
 
-    double min = std::numeric_limits<double>::infinity();
-    double avg = 0.0;
-    const unsigned int iters = 10;
-
-    for (unsigned int i = 0; i < iters; ++i) {
-        double before = now();
+    benchmark(std::string("resize/") + kernelInfo[interpolationType].name +
+              "/schedule_" + std::to_string(schedule), [&]() {
         final.realize(out);
-        double after = now();
-        double timediff = after - before;
-
-        min = (timediff < min) ? timediff : min;
-        avg = avg + (timediff - avg) / (i + 1);
-        std::cout << "   " << timediff * 1000 << " (avg=" << avg * 1000 << ")\n";
-    }
-    std::cout << " took min=" << min * 1000 << ", avg=" << avg * 1000 << " msec." << std::endl;
+    });
 
-    save(out, outfile);
+    benchmark_io("resize/save", [&]() {
+        save(out, outfile);
+    });
 }
@@ -0,0 +1,377 @@
+// This header defines the benchmarking helpers shared by the apps and
+// the performance tests, so that they all time things the same way and
+// report results in a form that can be tracked across commits and
+// machines. E.g.:
+//
+//     BenchmarkResult r = benchmark("blur/halide", [&]() {
+//         halide_blur(input, output);
+//     });
+//     printf("%f ms\n", r.p50 * 1000);
+//
+// benchmark() runs the operation until it's warm, picks a number of
+// iterations per sample so that each sample is long enough to time
+// accurately, and then takes samples until it has spent
+// HL_BENCHMARK_MIN_TIME seconds (default 0.5) and has at least
+// HL_BENCHMARK_MIN_SAMPLES samples (default 10). Every result is
+// printed to stdout and, if HL_BENCHMARK_JSON names a file, appended
+// to it as one JSON object per line. If HL_BENCHMARK_PERF_COUNTERS is
+// set to 1 on Linux, the cycles and instructions per iteration are
+// recorded too. tools/compare_benchmarks.cpp compares two such files,
+// and 'make benchmark' at the top level runs everything that uses this
+// header and compares the results against a stored baseline.
+
+#ifndef HALIDE_BENCHMARK_H
+#define HALIDE_BENCHMARK_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// The time in seconds since an arbitrary point, from a monotonic clock.
+inline double benchmark_now() {
+    using namespace std::chrono;
+    return duration_cast<duration<double>>(steady_clock::now().time_since_epoch()).count();
+}
+
+struct BenchmarkConfig {
+    // Time spent running the operation before any samples are taken.
+    double warmup_time;
+    // The minimum time spent taking samples, and the time after which
+    // no more samples are taken once there are min_samples of them.
+    double min_time, max_time;
+    // The target duration of each sample. Operations faster than this
+    // are run several times per sample.
+    double min_sample_time;
+    int min_samples, max_samples;
+    // Read the cycle and instruction counters (Linux only).
+    bool perf_counters;
+    // Print the result and append it to HL_BENCHMARK_JSON.
+    bool report;
+
+    // The defaults can be overridden by the environment variables
+    // HL_BENCHMARK_<FIELD> (e.g. HL_BENCHMARK_MIN_TIME=2).
+    BenchmarkConfig()
+        : warmup_time(0.1), min_time(0.5), max_time(10), min_sample_time(0.01),
+          min_samples(10), max_samples(1000), perf_counters(false), report(true) {
+        read_env("HL_BENCHMARK_WARMUP_TIME", &warmup_time);
+        read_env("HL_BENCHMARK_MIN_TIME", &min_time);
+        read_env("HL_BENCHMARK_MAX_TIME", &max_time);
+        read_env("HL_BENCHMARK_MIN_SAMPLE_TIME", &min_sample_time);
+        double d = min_samples;
+        read_env("HL_BENCHMARK_MIN_SAMPLES", &d);
+        min_samples = std::max(1, (int)d);
+        d = max_samples;
+        read_env("HL_BENCHMARK_MAX_SAMPLES", &d);
+        max_samples = std::max(min_samples, (int)d);
+        d = 0;
+        read_env("HL_BENCHMARK_PERF_COUNTERS", &d);
+        perf_counters = d != 0;
+    }
+
+private:
+    static void read_env(const char *name, double *value) {
+        const char *s = getenv(name);
+        if (s && s[0]) {
+            *value = atof(s);
+        }
+    }
+};
+
+struct BenchmarkResult {
+    std::string name;
+    // The number of threads, for results of benchmark_thread_sweep,
+    // and zero otherwise.
+    int threads;
+    int samples, iterations_per_sample;
+    // Statistics of the time per iteration over the samples, in seconds.
+    double min, p50, p90, p99, mean, stddev;
+    // Per-iteration counts, or negative if they weren't measured.
+    double cycles, instructions;
+
+    BenchmarkResult()
+        : threads(0), samples(0), iterations_per_sample(0),
+          min(0), p50(0), p90(0), p99(0), mean(0), stddev(0),
+          cycles(-1), instructions(-1) {}
+};
+
+namespace BenchmarkInternal {
+
+// Reads the cycle and instruction counters of this process, including
+// threads it creates while the counters are open.
+class PerfCounters {
+#ifdef __linux__
+    int fds[2];
+
+    static int open_counter(uint64_t config) {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+
+public:
+    PerfCounters() {
+        fds[0] = open_counter(PERF_COUNT_HW_CPU_CYCLES);
+        fds[1] = open_counter(PERF_COUNT_HW_INSTRUCTIONS);
+    }
+    ~PerfCounters() {
+        for (int i = 0; i < 2; i++) {
+            if (fds[i] >= 0) close(fds[i]);
+        }
+    }
+    bool ok() const { return fds[0] >= 0 && fds[1] >= 0; }
+    void start() {
+        for (int i = 0; i < 2; i++) {
+            ioctl(fds[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(fds[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+    void stop(double *cycles, double *instructions) {
+        uint64_t counts[2] = {0, 0};
+        for (int i = 0; i < 2; i++) {
+            ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+            if (read(fds[i], &counts[i], sizeof(counts[i])) != sizeof(counts[i])) {
+                counts[i] = 0;
+            }
+        }
+        *cycles = (double)counts[0];
+        *instructions = (double)counts[1];
+    }
+#else
+public:
+    bool ok() const { return false; }
+    void start() {}
+    void stop(double *, double *) {}
+#endif
+};
+
+// The value below which the given fraction of the sorted values lie,
+// using the nearest rank.
+inline double percentile(const std::vector<double> &sorted, double p) {
+    size_t rank = (size_t)std::ceil(p * sorted.size());
+    return sorted[std::min(sorted.size(), std::max((size_t)1, rank)) - 1];
+}
+
+inline std::string json_escape(const std::string &s) {
+    std::string result;
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            result += '\\';
+            result += c;
+        } else if ((unsigned char)c < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", c);
+            result += buf;
+        } else {
+            result += c;
+        }
+    }
+    return result;
+}
+
+}  // namespace BenchmarkInternal
+
+// Print a result, and append it to the file named by HL_BENCHMARK_JSON
+// if it's set. Called by benchmark() unless config.report is false.
+inline void benchmark_report(const BenchmarkResult &r) {
+    printf("%s", r.name.c_str());
+    if (r.threads > 0) {
+        printf(" (%d threads)", r.threads);
+    }
+    printf(": %.4f ms (min %.4f, p90 %.4f, p99 %.4f, %d x %d iterations)",
+           r.p50 * 1000, r.min * 1000, r.p90 * 1000, r.p99 * 1000,
+           r.samples, r.iterations_per_sample);
+    if (r.cycles >= 0) {
+        printf(", %.0f cycles, %.0f instructions", r.cycles, r.instructions);
+    }
+    printf("\n");
+
+    const char *filename = getenv("HL_BENCHMARK_JSON");
+    if (!filename || !filename[0]) {
+        return;
+    }
+    FILE *f = fopen(filename, "a");
+    if (!f) {
+        fprintf(stderr, "Could not open %s to record benchmark results\n", filename);
+        return;
+    }
+    fprintf(f, "{\"name\": \"%s\", \"threads\": %d, \"samples\": %d, \"iterations_per_sample\": %d, "
+            "\"min_ms\": %.6f, \"p50_ms\": %.6f, \"p90_ms\": %.6f, \"p99_ms\": %.6f, "
+            "\"mean_ms\": %.6f, \"stddev_ms\": %.6f",
+            BenchmarkInternal::json_escape(r.name).c_str(), r.threads, r.samples, r.iterations_per_sample,
+            r.min * 1000, r.p50 * 1000, r.p90 * 1000, r.p99 * 1000, r.mean * 1000, r.stddev * 1000);
+    if (r.cycles >= 0) {
+        fprintf(f, ", \"cycles\": %.0f, \"instructions\": %.0f", r.cycles, r.instructions);
+    }
+    fprintf(f, "}\n");
+    fclose(f);
+}
+
+// Time an operation. See the top of this file.
+inline BenchmarkResult benchmark(const std::string &name, std::function<void()> op,
+                                 const BenchmarkConfig &config = BenchmarkConfig()) {
+    BenchmarkResult r;
+    r.name = name;
+
+    // Warm up, and estimate the time per iteration while we're at it.
+    int warmup_iterations = 0;
+    double start = benchmark_now(), elapsed = 0;
+    do {
+        op();
+        warmup_iterations++;
+        elapsed = benchmark_now() - start;
+    } while (elapsed < config.warmup_time);
+    // Don't count the first iteration, which may be much slower than
+    // the rest (e.g. because it JIT-compiles something).
+    if (warmup_iterations == 1) {
+        start = benchmark_now();
+        op();
+        elapsed = benchmark_now() - start;
+    } else {
+        elapsed *= (warmup_iterations - 1.0) / warmup_iterations;
+        warmup_iterations--;
+    }
+    double estimate = std::max(elapsed / warmup_iterations, 1e-9);
+    r.iterations_per_sample = std::max(1, (int)std::ceil(config.min_sample_time / estimate));
+
+    BenchmarkInternal::PerfCounters counters;
+    bool use_counters = config.perf_counters && counters.ok();
+    if (use_counters) {
+        counters.start();
+    }
+
+    std::vector<double> times;
+    start = benchmark_now();
+    do {
+        double t1 = benchmark_now();
+        for (int i = 0; i < r.iterations_per_sample; i++) {
+            op();
+        }
+        double t2 = benchmark_now();
+        times.push_back((t2 - t1) / r.iterations_per_sample);
+        elapsed = t2 - start;
+    } while ((int)times.size() < config.max_samples &&
+             ((int)times.size() < config.min_samples || elapsed < config.min_time) &&
+             elapsed < config.max_time);
+
+    if (use_counters) {
+        double iterations = (double)times.size() * r.iterations_per_sample;
+        counters.stop(&r.cycles, &r.instructions);
+        r.cycles /= iterations;
+        r.instructions /= iterations;
+    }
+
+    std::sort(times.begin(), times.end());
+    r.samples = (int)times.size();
+    r.min = times[0];
+    r.p50 = BenchmarkInternal::percentile(times, 0.5);
+    r.p90 = BenchmarkInternal::percentile(times, 0.9);
+    r.p99 = BenchmarkInternal::percentile(times, 0.99);
+    double sum = 0, sum_sq = 0;
+    for (double t : times) {
+        sum += t;
+        sum_sq += t * t;
+    }
+    r.mean = sum / r.samples;
+    r.stddev = std::sqrt(std::max(0.0, sum_sq / r.samples - r.mean * r.mean));
+
+    if (config.report) {
+        benchmark_report(r);
+    }
+    return r;
+}
+
+// Time a step of an app that isn't part of the computation being
+// benchmarked, such as loading its input or saving its output, and
+// report it like any other result (by convention, as "<app>/load" and
+// "<app>/save"). These steps are slow and don't need many samples, so
+// after the two untimed runs benchmark() always does, this takes at
+// most three samples of one iteration each. E.g.:
+//
+//     Image<float> input;
+//     benchmark_io("blur/load", [&]() {
+//         input = load<float>(argv[1]);
+//     });
+inline BenchmarkResult benchmark_io(const std::string &name, std::function<void()> op,
+                                    const BenchmarkConfig &config = BenchmarkConfig()) {
+    BenchmarkConfig c = config;
+    c.warmup_time = 0;
+    c.min_time = 0;
+    c.min_sample_time = 0;
+    c.min_samples = std::min(c.min_samples, 3);
+    c.max_samples = c.min_samples;
+    return benchmark(name, op, c);
+}
+
+// The thread counts to sweep over: the comma-separated list in
+// HL_BENCHMARK_THREADS if it's set, and otherwise 1 and the number of
+// hardware threads.
+inline std::vector<int> benchmark_thread_counts() {
+    std::vector<int> counts;
+    const char *s = getenv("HL_BENCHMARK_THREADS");
+    if (s && s[0]) {
+        while (*s) {
+            int n = atoi(s);
+            if (n > 0) {
+                counts.push_back(n);
+            }
+            const char *comma = strchr(s, ',');
+            if (!comma) break;
+            s = comma + 1;
+        }
+    }
+    if (counts.empty()) {
+        counts.push_back(1);
+        int n = (int)std::thread::hardware_concurrency();
+        if (n > 1) {
+            counts.push_back(n);
+        }
+    }
+    return counts;
+}
+
+// Time an operation once per thread count, calling set_num_threads
+// (e.g. halide_set_num_threads) before each, and with zero afterwards,
+// which makes the Halide thread pool go back to its default size.
+inline std::vector<BenchmarkResult> benchmark_thread_sweep(const std::string &name,
+                                                           std::function<void(int)> set_num_threads,
+                                                           std::function<void()> op,
+                                                           const BenchmarkConfig &config = BenchmarkConfig()) {
+    std::vector<BenchmarkResult> results;
+    for (int threads : benchmark_thread_counts()) {
+        set_num_threads(threads);
+        BenchmarkConfig c = config;
+        c.report = false;
+        BenchmarkResult r = benchmark(name, op, c);
+        r.threads = threads;
+        if (config.report) {
+            benchmark_report(r);
+        }
+        results.push_back(r);
+    }
+    set_num_threads(0);
+    return results;
+}
+
+#endif  // HALIDE_BENCHMARK_H
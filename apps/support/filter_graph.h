@@ -0,0 +1,358 @@
+// This header defines an executor for a DAG of AOT-compiled filters that
+// were compiled with Target::RegisterMetadata, and are found at runtime by
+// name through halide_enumerate_registered_filters. The graph is run one
+// tile of the final output at a time: bounds queries walk the graph from
+// the output back to its inputs to find the region of each intermediate
+// a tile needs, so intermediates are only ever tile-sized and stay in
+// cache, and filters that don't depend on each other run concurrently
+// on the Halide thread pool. E.g.:
+//
+//     FilterGraph g;
+//     int a = g.add("blur_x"), b = g.add("blur_y");
+//     g.bind_input(a, "input", input);
+//     g.connect(a, b, "input");
+//     g.run(output);
+
+#ifndef HALIDE_FILTER_GRAPH_H
+#define HALIDE_FILTER_GRAPH_H
+
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "HalideRuntime.h"
+
+class FilterGraph {
+    // What an argument of a filter is bound to: the output of another
+    // node, an external buffer, or a scalar value.
+    struct Binding {
+        int producer;
+        buffer_t *buffer;
+        void *scalar;
+        Binding() : producer(-1), buffer(NULL), scalar(NULL) {}
+    };
+
+    struct Node {
+        const halide_filter_metadata_t *metadata;
+        int (*argv_func)(void **args);
+        std::vector<Binding> bindings;
+        int output;  // The index of the output argument
+        int level;   // The longest path from a node with no producers
+
+        // Per-tile state
+        std::vector<buffer_t> buffers;
+        std::vector<void *> args;
+        buffer_t region;
+        std::vector<uint8_t> storage;
+    };
+
+    std::vector<Node> nodes;
+    void *user_context;
+    int tile_extent[2];
+
+    struct Lookup {
+        const char *name;
+        const halide_filter_metadata_t *metadata;
+        int (*argv_func)(void **args);
+    };
+
+    static int find_filter(void *context, const halide_filter_metadata_t *metadata,
+                           int (*argv_func)(void **args)) {
+        Lookup *lookup = (Lookup *)context;
+        if (strcmp(metadata->name, lookup->name) == 0) {
+            lookup->metadata = metadata;
+            lookup->argv_func = argv_func;
+            return 1;
+        }
+        return 0;
+    }
+
+    int argument(int node, const std::string &name) const {
+        const halide_filter_metadata_t *md = nodes[node].metadata;
+        for (int i = 0; i < md->num_arguments; i++) {
+            if (name == md->arguments[i].name) return i;
+        }
+        return -1;
+    }
+
+    int fail(const std::string &msg) const {
+        halide_error(user_context, msg.c_str());
+        return halide_error_code_generic_error;
+    }
+
+    static void union_region(buffer_t *a, const buffer_t *b, int dimensions) {
+        for (int d = 0; d < dimensions; d++) {
+            if (a->extent[d] == 0) {
+                a->min[d] = b->min[d];
+                a->extent[d] = b->extent[d];
+            } else if (b->extent[d] != 0) {
+                int max = std::max(a->min[d] + a->extent[d], b->min[d] + b->extent[d]);
+                a->min[d] = std::min(a->min[d], b->min[d]);
+                a->extent[d] = max - a->min[d];
+            }
+        }
+    }
+
+    // Ask a node which regions of its inputs it needs to compute
+    // node.region, and grow the regions of its producers to match.
+    int query(Node &node) {
+        const halide_filter_metadata_t *md = node.metadata;
+        node.buffers.assign(md->num_arguments, buffer_t());
+        node.args.assign(md->num_arguments, (void *)NULL);
+        for (int i = 0; i < md->num_arguments; i++) {
+            const Binding &b = node.bindings[i];
+            if (md->arguments[i].kind == halide_argument_kind_input_scalar) {
+                node.args[i] = b.scalar;
+                continue;
+            }
+            buffer_t &buf = node.buffers[i];
+            memset(&buf, 0, sizeof(buf));
+            buf.elem_size = (md->arguments[i].type_bits + 7) / 8;
+            if (i == node.output) {
+                buf = node.region;
+                buf.host = NULL;
+            }
+            node.args[i] = &buf;
+        }
+
+        int result = node.argv_func(&node.args[0]);
+        if (result != 0) return result;
+
+        for (int i = 0; i < md->num_arguments; i++) {
+            int p = node.bindings[i].producer;
+            if (p >= 0) {
+                union_region(&nodes[p].region, &node.buffers[i], md->arguments[i].dimensions);
+            }
+        }
+        return 0;
+    }
+
+    struct LevelClosure {
+        FilterGraph *graph;
+        std::vector<int> *nodes;
+    };
+
+    static int run_node(void *user_context, int idx, uint8_t *closure) {
+        LevelClosure *c = (LevelClosure *)closure;
+        Node &node = c->graph->nodes[(*c->nodes)[idx]];
+        return node.argv_func(&node.args[0]);
+    }
+
+public:
+    FilterGraph(void *user_context = NULL) : user_context(user_context) {
+        tile_extent[0] = 256;
+        tile_extent[1] = 32;
+    }
+
+    // Add a node that runs the registered filter with the given name,
+    // and return its index, or -1 if there is no such filter.
+    int add(const std::string &filter_name) {
+        Lookup lookup = {filter_name.c_str(), NULL, NULL};
+        halide_enumerate_registered_filters(user_context, &lookup, find_filter);
+        if (!lookup.metadata) {
+            fail("No registered filter named " + filter_name + "\n");
+            return -1;
+        }
+        Node node;
+        node.metadata = lookup.metadata;
+        node.argv_func = lookup.argv_func;
+        node.bindings.resize(lookup.metadata->num_arguments);
+        node.output = -1;
+        node.level = 0;
+        for (int i = 0; i < lookup.metadata->num_arguments; i++) {
+            if (lookup.metadata->arguments[i].kind == halide_argument_kind_output_buffer) {
+                if (node.output >= 0) {
+                    fail("Filter " + filter_name + " has more than one output\n");
+                    return -1;
+                }
+                node.output = i;
+            }
+        }
+        nodes.push_back(node);
+        return (int)nodes.size() - 1;
+    }
+
+    // Feed the output of one node to an input buffer of another.
+    int connect(int producer, int consumer, const std::string &input_name) {
+        int i = argument(consumer, input_name);
+        if (i < 0 || nodes[consumer].metadata->arguments[i].kind != halide_argument_kind_input_buffer) {
+            return fail("No input buffer named " + input_name + "\n");
+        }
+        const halide_filter_argument_t &in = nodes[consumer].metadata->arguments[i];
+        const halide_filter_argument_t &out = nodes[producer].metadata->arguments[nodes[producer].output];
+        if (in.type_code != out.type_code || in.type_bits != out.type_bits ||
+            in.dimensions != out.dimensions) {
+            return fail("The output of " + std::string(nodes[producer].metadata->name) +
+                        " does not match the input " + input_name + "\n");
+        }
+        nodes[consumer].bindings[i].producer = producer;
+        return 0;
+    }
+
+    // Bind an input buffer of a node to an external buffer, which must
+    // contain the whole region that the graph reads from it.
+    int bind_input(int node, const std::string &input_name, buffer_t *buf) {
+        int i = argument(node, input_name);
+        if (i < 0 || nodes[node].metadata->arguments[i].kind != halide_argument_kind_input_buffer) {
+            return fail("No input buffer named " + input_name + "\n");
+        }
+        nodes[node].bindings[i].buffer = buf;
+        return 0;
+    }
+
+    // Bind a scalar argument of a node to a pointer to its value.
+    int bind_scalar(int node, const std::string &name, void *value) {
+        int i = argument(node, name);
+        if (i < 0 || nodes[node].metadata->arguments[i].kind != halide_argument_kind_input_scalar) {
+            return fail("No scalar argument named " + name + "\n");
+        }
+        nodes[node].bindings[i].scalar = value;
+        return 0;
+    }
+
+    // Set the size of the tiles of the output computed at a time, in
+    // its first two dimensions. Zero means the full extent.
+    void set_tile_extent(int x, int y) {
+        tile_extent[0] = x;
+        tile_extent[1] = y;
+    }
+
+    // Run the graph, writing the output of the one node whose output
+    // is not consumed by any other node into output. Returns zero on
+    // success.
+    int run(buffer_t *output) {
+        const int n = (int)nodes.size();
+        if (n == 0) return fail("The filter graph is empty\n");
+
+        // Check that everything is bound, and find the sink and a
+        // topological order.
+        std::vector<int> consumers(n, 0), pending(n, 0), order;
+        for (int i = 0; i < n; i++) {
+            const halide_filter_metadata_t *md = nodes[i].metadata;
+            for (int j = 0; j < md->num_arguments; j++) {
+                const Binding &b = nodes[i].bindings[j];
+                int kind = md->arguments[j].kind;
+                if ((kind == halide_argument_kind_input_buffer && b.producer < 0 && !b.buffer) ||
+                    (kind == halide_argument_kind_input_scalar && !b.scalar)) {
+                    return fail(std::string("Argument ") + md->arguments[j].name + " of " +
+                                md->name + " is not bound\n");
+                }
+                if (b.producer >= 0) {
+                    consumers[b.producer]++;
+                    pending[i]++;
+                }
+            }
+        }
+        int sink = -1;
+        for (int i = 0; i < n; i++) {
+            if (consumers[i] == 0) {
+                if (sink >= 0) return fail("The filter graph has more than one output\n");
+                sink = i;
+            }
+            if (pending[i] == 0) {
+                order.push_back(i);
+                nodes[i].level = 0;
+            }
+        }
+        for (size_t k = 0; k < order.size(); k++) {
+            for (int i = 0; i < n; i++) {
+                for (size_t j = 0; j < nodes[i].bindings.size(); j++) {
+                    if (nodes[i].bindings[j].producer == order[k]) {
+                        nodes[i].level = std::max(nodes[i].level, nodes[order[k]].level + 1);
+                        if (--pending[i] == 0) order.push_back(i);
+                    }
+                }
+            }
+        }
+        if ((int)order.size() != n || sink < 0) return fail("The filter graph has a cycle\n");
+
+        std::vector<std::vector<int> > levels(nodes[sink].level + 1);
+        for (int i = 0; i < n; i++) {
+            levels[nodes[i].level].push_back(i);
+        }
+
+        const int sink_dims = nodes[sink].metadata->arguments[nodes[sink].output].dimensions;
+        int num_tiles[2] = {1, 1}, extent[2] = {1, 1};
+        for (int d = 0; d < 2 && d < sink_dims; d++) {
+            extent[d] = tile_extent[d] > 0 ? tile_extent[d] : output->extent[d];
+            num_tiles[d] = (output->extent[d] + extent[d] - 1) / extent[d];
+        }
+
+        for (int t = 0; t < num_tiles[0] * num_tiles[1]; t++) {
+            // The sink computes its tile straight into the output.
+            buffer_t &tile = nodes[sink].region;
+            tile = *output;
+            ptrdiff_t offset = 0;
+            for (int d = 0; d < 2 && d < sink_dims; d++) {
+                int i = d == 0 ? t % num_tiles[0] : t / num_tiles[0];
+                tile.min[d] = output->min[d] + i * extent[d];
+                tile.extent[d] = std::min(extent[d], output->min[d] + output->extent[d] - tile.min[d]);
+                offset += (ptrdiff_t)(tile.min[d] - output->min[d]) * output->stride[d];
+            }
+            tile.host = output->host + offset * output->elem_size;
+
+            // Walk from the output back to the inputs, working out the
+            // region of each intermediate needed.
+            for (int i = 0; i < n; i++) {
+                if (i != sink) {
+                    memset(&nodes[i].region, 0, sizeof(buffer_t));
+                    nodes[i].region.elem_size = (nodes[i].metadata->arguments[nodes[i].output].type_bits + 7) / 8;
+                }
+            }
+            for (int k = n - 1; k >= 0; k--) {
+                int result = query(nodes[order[k]]);
+                if (result != 0) return result;
+            }
+
+            // Allocate the intermediates, and point each node at its
+            // inputs and output.
+            for (int i = 0; i < n; i++) {
+                Node &node = nodes[i];
+                if (i != sink) {
+                    buffer_t &r = node.region;
+                    int dims = node.metadata->arguments[node.output].dimensions;
+                    size_t size = 1;
+                    for (int d = 0; d < dims; d++) {
+                        r.stride[d] = (int32_t)size;
+                        size *= r.extent[d];
+                    }
+                    node.storage.resize(size * r.elem_size + 32);
+                    r.host = &node.storage[0];
+                    while ((size_t)r.host & 0x1f) r.host++;
+                }
+            }
+            for (int i = 0; i < n; i++) {
+                Node &node = nodes[i];
+                for (size_t j = 0; j < node.bindings.size(); j++) {
+                    const Binding &b = node.bindings[j];
+                    if ((int)j == node.output) {
+                        node.buffers[j] = node.region;
+                    } else if (b.producer >= 0) {
+                        node.buffers[j] = nodes[b.producer].region;
+                    } else if (b.buffer) {
+                        node.args[j] = b.buffer;
+                    }
+                }
+            }
+
+            // Run each level of the graph, with the nodes in a level in
+            // parallel.
+            for (size_t l = 0; l < levels.size(); l++) {
+                LevelClosure closure = {this, &levels[l]};
+                int result;
+                if (levels[l].size() == 1) {
+                    result = run_node(user_context, 0, (uint8_t *)&closure);
+                } else {
+                    result = halide_do_par_for(user_context, run_node, 0, (int)levels[l].size(),
+                                               (uint8_t *)&closure);
+                }
+                if (result != 0) return result;
+            }
+        }
+        return 0;
+    }
+};
+
+#endif
@@ -12,6 +12,16 @@
 #include <stdio.h>
 #include <algorithm>
 #include <string.h>
+#include <ctype.h>
+#include <limits>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 //#include <sys/time.h>
 
@@ -403,5 +413,384 @@ void save(Image<T> im, std::string filename) {
 }
 
 
+#ifndef _WIN32
+
+// An image file whose pixels are mapped into memory instead of being
+// read, so only the pages a pipeline touches are loaded from disk, and
+// a pipeline can write its output straight into a file. Binary PPM and
+// PGM, uncompressed TIFF with contiguous strips, and headerless raw
+// files are supported. When the samples in the file have type T, are
+// in native byte order, and are suitably aligned, the buffer_t points
+// directly into the mapping; otherwise 8- and 16-bit samples are
+// converted into a private copy. Either way the image is interleaved:
+// stride[0] is the number of channels and stride[2] is 1.
+template<typename T>
+class MappedImage {
+    int fd;
+    uint8_t *map;
+    size_t map_size;
+    bool mapped;
+    std::vector<T> copy;
+    buffer_t buf;
+
+    MappedImage(const MappedImage &);
+    MappedImage &operator=(const MappedImage &);
+
+    enum SampleFormat {Unsigned = 1, Signed = 2, Float = 3};
+
+    static int native_format() {
+        if (!std::numeric_limits<T>::is_integer) return Float;
+        return std::numeric_limits<T>::is_signed ? Signed : Unsigned;
+    }
+
+    static const int tiff_entries = 11;
+
+    // Where the samples go in the TIFF files we write: after the
+    // header, the directory, and per-channel arrays of bits and sample
+    // formats if they don't fit in their directory entries (two SHORT
+    // values fit in an entry).
+    static size_t tiff_data_offset(int channels) {
+        size_t size = 8 + 2 + tiff_entries * 12 + 4;
+        if (channels > 2) size += channels * 4;
+        return (size + 63) & ~(size_t)63;
+    }
+
+    void map_file(const std::string &filename, bool writable, size_t size) {
+        fd = ::open(filename.c_str(), writable ? (O_RDWR | O_CREAT | O_TRUNC) : O_RDONLY, 0644);
+        _assert(fd >= 0, "File %s could not be opened\n", filename.c_str());
+        if (writable) {
+            _assert(ftruncate(fd, size) == 0, "File %s could not be resized\n", filename.c_str());
+        } else {
+            struct stat st;
+            _assert(fstat(fd, &st) == 0, "Could not stat %s\n", filename.c_str());
+            size = st.st_size;
+        }
+        map_size = size;
+        void *p = mmap(NULL, size, writable ? (PROT_READ | PROT_WRITE) : PROT_READ,
+                       MAP_SHARED, fd, 0);
+        _assert(p != MAP_FAILED, "File %s could not be mapped\n", filename.c_str());
+        map = (uint8_t *)p;
+    }
+
+    // Point the buffer at samples starting at the given offset into the
+    // file, converting them if necessary.
+    void wrap(size_t offset, int width, int height, int channels,
+              int bits, int format, bool big_endian) {
+        size_t count = (size_t)width * height * channels;
+        _assert(offset + count * (bits / 8) <= map_size, "Image file is truncated\n");
+        memset(&buf, 0, sizeof(buf));
+        buf.extent[0] = width;
+        buf.extent[1] = height;
+        buf.stride[0] = channels;
+        buf.stride[1] = width * channels;
+        if (channels > 1) {
+            buf.extent[2] = channels;
+            buf.stride[2] = 1;
+        }
+        buf.elem_size = sizeof(T);
+
+        uint8_t *src = map + offset;
+        if (bits == (int)sizeof(T) * 8 && format == native_format() &&
+            (bits == 8 || big_endian == !is_little_endian()) &&
+            ((size_t)src % sizeof(T)) == 0) {
+            buf.host = src;
+            mapped = true;
+            return;
+        }
+
+        _assert(format == Unsigned && (bits == 8 || bits == 16),
+                "Can only convert 8- and 16-bit unsigned samples\n");
+        copy.resize(count);
+        if (bits == 8) {
+            for (size_t i = 0; i < count; i++) {
+                convert(src[i], copy[i]);
+            }
+        } else {
+            for (size_t i = 0; i < count; i++) {
+                uint16_t value = big_endian ? ((src[2*i] << 8) | src[2*i+1]) : ((src[2*i+1] << 8) | src[2*i]);
+                convert(value, copy[i]);
+            }
+        }
+        buf.host = (uint8_t *)&copy[0];
+        buf.host_dirty = true;
+    }
+
+    // Read an ASCII integer from a PPM/PGM header, skipping whitespace
+    // and comments.
+    int header_int(size_t &pos) {
+        while (pos < map_size) {
+            if (map[pos] == '#') {
+                while (pos < map_size && map[pos] != '\n') pos++;
+            } else if (isspace(map[pos])) {
+                pos++;
+            } else {
+                break;
+            }
+        }
+        _assert(pos < map_size && isdigit(map[pos]), "Malformed PPM/PGM header\n");
+        int value = 0;
+        while (pos < map_size && isdigit(map[pos])) {
+            value = value * 10 + (map[pos++] - '0');
+        }
+        return value;
+    }
+
+    uint32_t tiff_read(size_t pos, int bytes, bool big_endian) {
+        _assert(pos + bytes <= map_size, "TIFF file is truncated\n");
+        uint32_t value = 0;
+        for (int i = 0; i < bytes; i++) {
+            int shift = big_endian ? (bytes - 1 - i) * 8 : i * 8;
+            value |= (uint32_t)map[pos + i] << shift;
+        }
+        return value;
+    }
+
+    // The i'th value of a TIFF directory entry, which may be stored in
+    // the entry itself or elsewhere in the file.
+    uint32_t tiff_value(size_t entry, uint32_t i, bool big_endian) {
+        int type = tiff_read(entry + 2, 2, big_endian);
+        uint32_t count = tiff_read(entry + 4, 4, big_endian);
+        int bytes = (type == 3) ? 2 : 4;
+        _assert(type == 3 || type == 4, "Unsupported TIFF field type %d\n", type);
+        size_t pos = entry + 8;
+        if (count * bytes > 4) {
+            pos = tiff_read(entry + 8, 4, big_endian);
+        }
+        return tiff_read(pos + i * bytes, bytes, big_endian);
+    }
+
+    void open_ppm(const std::string &filename) {
+        _assert(map_size >= 2 && map[0] == 'P' && (map[1] == '5' || map[1] == '6'),
+                "File %s is not a binary PPM or PGM file\n", filename.c_str());
+        int channels = map[1] == '6' ? 3 : 1;
+        size_t pos = 2;
+        int width = header_int(pos);
+        int height = header_int(pos);
+        int maxval = header_int(pos);
+        _assert(maxval == 255 || maxval == 65535, "Invalid bit depth in PPM/PGM\n");
+        // Exactly one whitespace character precedes the samples.
+        pos++;
+        wrap(pos, width, height, channels, maxval == 255 ? 8 : 16, Unsigned, true);
+    }
+
+    void open_tiff(const std::string &filename) {
+        _assert(map_size >= 8 && map[0] == map[1] && (map[0] == 'I' || map[0] == 'M'),
+                "File %s is not a TIFF file\n", filename.c_str());
+        bool big_endian = map[0] == 'M';
+        _assert(tiff_read(2, 2, big_endian) == 42, "File %s is not a TIFF file\n", filename.c_str());
+
+        size_t ifd = tiff_read(4, 4, big_endian);
+        int entries = tiff_read(ifd, 2, big_endian);
+        int width = 0, height = 0, channels = 1, bits = 1, format = Unsigned;
+        int rows_per_strip = 0, num_strips = 0;
+        size_t strip_offsets = 0;
+        for (int i = 0; i < entries; i++) {
+            size_t entry = ifd + 2 + i * 12;
+            switch (tiff_read(entry, 2, big_endian)) {
+            case 256: width = tiff_value(entry, 0, big_endian); break;
+            case 257: height = tiff_value(entry, 0, big_endian); break;
+            case 258: bits = tiff_value(entry, 0, big_endian); break;
+            case 259:
+                _assert(tiff_value(entry, 0, big_endian) == 1,
+                        "Can only map uncompressed TIFF files\n");
+                break;
+            case 273:
+                strip_offsets = entry;
+                num_strips = tiff_read(entry + 4, 4, big_endian);
+                break;
+            case 277: channels = tiff_value(entry, 0, big_endian); break;
+            case 278: rows_per_strip = tiff_value(entry, 0, big_endian); break;
+            case 284:
+                _assert(tiff_value(entry, 0, big_endian) == 1,
+                        "Can only map TIFF files with interleaved channels\n");
+                break;
+            case 339: format = tiff_value(entry, 0, big_endian); break;
+            }
+        }
+        _assert(strip_offsets && width > 0 && height > 0 && bits % 8 == 0,
+                "Unsupported TIFF file %s\n", filename.c_str());
+        if (rows_per_strip <= 0 || rows_per_strip > height) rows_per_strip = height;
+
+        // The strips must be laid out one after another to be treated
+        // as a single image.
+        size_t offset = tiff_value(strip_offsets, 0, big_endian);
+        size_t strip_size = (size_t)rows_per_strip * width * channels * (bits / 8);
+        for (int i = 1; i < num_strips; i++) {
+            _assert(tiff_value(strip_offsets, i, big_endian) == offset + i * strip_size,
+                    "Can only map TIFF files with contiguous strips\n");
+        }
+        wrap(offset, width, height, channels, bits, format, big_endian);
+    }
+
+    void tiff_write(size_t pos, uint32_t value, int bytes, bool big_endian) {
+        for (int i = 0; i < bytes; i++) {
+            int shift = big_endian ? (bytes - 1 - i) * 8 : i * 8;
+            map[pos + i] = (value >> shift) & 0xff;
+        }
+    }
+
+    void tiff_entry(size_t &pos, int tag, int type, uint32_t count, uint32_t value, bool big_endian) {
+        tiff_write(pos, tag, 2, big_endian);
+        tiff_write(pos + 2, type, 2, big_endian);
+        tiff_write(pos + 4, count, 4, big_endian);
+        tiff_write(pos + 8, value, (type == 3 && count == 1) ? 2 : 4, big_endian);
+        pos += 12;
+    }
+
+    // An entry with the same SHORT value for each channel. Up to two
+    // values are stored in the entry itself, and more in an array at
+    // array_pos.
+    void tiff_per_channel_entry(size_t &pos, int tag, int channels, int value,
+                                size_t array_pos, bool big_endian) {
+        if (channels > 2) {
+            for (int c = 0; c < channels; c++) {
+                tiff_write(array_pos + c * 2, value, 2, big_endian);
+            }
+            tiff_entry(pos, tag, 3, channels, array_pos, big_endian);
+        } else {
+            tiff_write(pos, tag, 2, big_endian);
+            tiff_write(pos + 2, 3, 2, big_endian);
+            tiff_write(pos + 4, channels, 4, big_endian);
+            for (int c = 0; c < channels; c++) {
+                tiff_write(pos + 8 + c * 2, value, 2, big_endian);
+            }
+            pos += 12;
+        }
+    }
+
+    // Write a single-strip TIFF header for native-endian samples of
+    // type T.
+    void write_tiff_header(int width, int height, int channels) {
+        bool big_endian = !is_little_endian();
+        int bits = sizeof(T) * 8;
+        size_t bits_pos = 8 + 2 + tiff_entries * 12 + 4;
+        size_t format_pos = bits_pos + channels * 2;
+
+        map[0] = map[1] = big_endian ? 'M' : 'I';
+        tiff_write(2, 42, 2, big_endian);
+        tiff_write(4, 8, 4, big_endian);
+        tiff_write(8, tiff_entries, 2, big_endian);
+        size_t pos = 10;
+        tiff_entry(pos, 256, 4, 1, width, big_endian);
+        tiff_entry(pos, 257, 4, 1, height, big_endian);
+        tiff_per_channel_entry(pos, 258, channels, bits, bits_pos, big_endian);
+        tiff_entry(pos, 259, 3, 1, 1, big_endian);                       // No compression
+        tiff_entry(pos, 262, 3, 1, channels >= 3 ? 2 : 1, big_endian);   // RGB or grayscale
+        tiff_entry(pos, 273, 4, 1, tiff_data_offset(channels), big_endian);
+        tiff_entry(pos, 277, 3, 1, channels, big_endian);
+        tiff_entry(pos, 278, 4, 1, height, big_endian);
+        tiff_entry(pos, 279, 4, 1, (uint32_t)((size_t)width * height * channels * sizeof(T)), big_endian);
+        tiff_entry(pos, 284, 3, 1, 1, big_endian);                       // Interleaved
+        tiff_per_channel_entry(pos, 339, channels, native_format(), format_pos, big_endian);
+        tiff_write(pos, 0, 4, big_endian);                               // No more directories
+    }
+
+    // A PPM or PGM header for samples of type T, padded so that the
+    // samples after it are aligned.
+    static std::string ppm_header(int width, int height, int channels) {
+        char dims[64];
+        snprintf(dims, sizeof(dims), "P%c\n%d %d\n", channels == 3 ? '6' : '5', width, height);
+        std::string header = dims;
+        std::string maxval = sizeof(T) == 1 ? "255\n" : "65535\n";
+        while ((header.size() + maxval.size()) % sizeof(T)) {
+            header += ' ';
+        }
+        return header + maxval;
+    }
+
+public:
+    MappedImage() : fd(-1), map(NULL), map_size(0), mapped(false) {
+        memset(&buf, 0, sizeof(buf));
+    }
+
+    ~MappedImage() {
+        close();
+    }
+
+    // Map an existing .ppm, .pgm, .tif or .tiff file.
+    void open(const std::string &filename) {
+        close();
+        map_file(filename, false, 0);
+        if (ends_with_ignore_case(filename, ".tif") || ends_with_ignore_case(filename, ".tiff")) {
+            open_tiff(filename);
+        } else {
+            open_ppm(filename);
+        }
+    }
+
+    // Map a headerless file of interleaved samples of type T.
+    void open_raw(const std::string &filename, int width, int height, int channels, size_t offset = 0) {
+        close();
+        map_file(filename, false, 0);
+        wrap(offset, width, height, channels, sizeof(T) * 8, native_format(), !is_little_endian());
+    }
+
+    // Create a .ppm, .pgm, .tif, .tiff or raw file of the given size,
+    // and map it writably, so that whatever is written to the image
+    // (e.g. by realizing a pipeline into it) goes straight to the
+    // file. Raw files are written in native byte order. PPM and PGM
+    // files are big-endian, so they can only be created for uint8_t
+    // samples, or for uint16_t samples on big-endian hosts.
+    void create(const std::string &filename, int width, int height, int channels) {
+        close();
+        bool tiff = ends_with_ignore_case(filename, ".tif") || ends_with_ignore_case(filename, ".tiff");
+        bool ppm = ends_with_ignore_case(filename, ".ppm") || ends_with_ignore_case(filename, ".pgm");
+        size_t bytes = (size_t)width * height * channels * sizeof(T);
+        _assert(!tiff || bytes <= 0xffffffffu, "Image is too large for a TIFF file\n");
+        std::string header;
+        if (ppm) {
+            _assert(native_format() == Unsigned &&
+                    (sizeof(T) == 1 || (sizeof(T) == 2 && !is_little_endian())),
+                    "Can't create a PPM/PGM file with samples of this type\n");
+            _assert(channels == (ends_with_ignore_case(filename, ".ppm") ? 3 : 1),
+                    "PPM files must have three channels, and PGM files one\n");
+            header = ppm_header(width, height, channels);
+        }
+        size_t offset = tiff ? tiff_data_offset(channels) : header.size();
+        map_file(filename, true, offset + bytes);
+        if (tiff) {
+            write_tiff_header(width, height, channels);
+        } else {
+            memcpy(map, header.data(), header.size());
+        }
+        wrap(offset, width, height, channels, sizeof(T) * 8, native_format(), ppm || !is_little_endian());
+        _assert(mapped, "File %s could not be mapped without conversion\n", filename.c_str());
+    }
+
+    // Unmap the file, writing back any changes.
+    void close() {
+        if (map) {
+            munmap(map, map_size);
+            map = NULL;
+        }
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+        copy.clear();
+        mapped = false;
+        memset(&buf, 0, sizeof(buf));
+    }
+
+    // Whether the pixels point directly into the file, rather than to
+    // a converted copy.
+    bool is_mapped() const {
+        return mapped;
+    }
+
+    operator buffer_t *() {
+        return &buf;
+    }
+
+    T &operator()(int x, int y = 0, int c = 0) {
+        return ((T *)buf.host)[(size_t)x * buf.stride[0] + (size_t)y * buf.stride[1] + c];
+    }
+
+    int width() const {return buf.extent[0];}
+    int height() const {return buf.extent[1];}
+    int channels() const {return buf.extent[2] ? buf.extent[2] : 1;}
+};
+
+#endif  // _WIN32
 
 #endif
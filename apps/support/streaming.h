@@ -0,0 +1,352 @@
+// This header defines a driver for running a statically-compiled Halide
+// pipeline over images too large to hold in memory. The output is split
+// into tiles (or strips), the pipeline's bounds query mode is used to
+// find the region of each input a tile requires, and only that region is
+// read, through a StreamReader. Reading the next tile's inputs and
+// writing the previous tile's outputs overlap with computing the current
+// tile.
+//
+// The pipeline must not have been compiled with Target::NoBoundsQuery,
+// and the driver is called with the pipeline's _argv entry point and
+// _metadata, e.g.:
+//
+//     StreamReader *in = ...;
+//     StreamWriter *out = ...;
+//     void *args[] = {in, &some_scalar, out};
+//     int output_extent[] = {width, height, 3};
+//     halide_stream(my_pipeline_argv, &my_pipeline_metadata, args, output_extent);
+
+#ifndef HALIDE_STREAMING_H
+#define HALIDE_STREAMING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <future>
+#include <vector>
+
+#include "HalideRuntime.h"
+
+#ifndef BUFFER_T_DEFINED
+#define BUFFER_T_DEFINED
+#include <stdint.h>
+typedef struct buffer_t {
+    uint64_t dev;
+    uint8_t* host;
+    int32_t extent[4];
+    int32_t stride[4];
+    int32_t min[4];
+    int32_t elem_size;
+    bool host_dirty;
+    bool dev_dirty;
+} buffer_t;
+#endif
+
+// A source of input pixels. Calls to read are made from a thread other
+// than the one that called halide_stream, but never concurrently with
+// other calls to read on any reader.
+class StreamReader {
+public:
+    virtual ~StreamReader() {}
+
+    // Fill in the region of the input described by the min and extent
+    // of buf, storing it at buf->host according to buf's strides. The
+    // region may extend beyond the edges of the input if the pipeline
+    // reads out of bounds there. Returns zero on success.
+    virtual int read(const buffer_t *buf) = 0;
+};
+
+// A sink for output pixels. Tiles are written in order, from a thread
+// other than the one that called halide_stream, and never concurrently
+// with other calls to write on any writer.
+class StreamWriter {
+public:
+    virtual ~StreamWriter() {}
+
+    // Store the computed region of the output described by buf.
+    // Returns zero on success.
+    virtual int write(const buffer_t *buf) = 0;
+};
+
+namespace Halide { namespace Streaming { namespace Internal {
+
+// Copy the region of dst from src, clamping coordinates to the bounds of
+// src if clamp is true. The buffers must have the same elem_size.
+inline void copy_region(const buffer_t *src, const buffer_t *dst, bool clamp) {
+    int extent[4];
+    for (int d = 0; d < 4; d++) {
+        extent[d] = dst->extent[d] ? dst->extent[d] : 1;
+    }
+    const int elem_size = dst->elem_size;
+
+    // Rows that are dense in both buffers and don't need clamping in x
+    // can be copied in one go.
+    const bool dense = src->stride[0] == 1 && dst->stride[0] == 1;
+    const bool row_inside = !clamp ||
+        (dst->min[0] >= src->min[0] &&
+         dst->min[0] + extent[0] <= src->min[0] + src->extent[0]);
+
+    for (int w = 0; w < extent[3]; w++) {
+        for (int z = 0; z < extent[2]; z++) {
+            for (int y = 0; y < extent[1]; y++) {
+                int coord[4] = {0, y, z, w};
+                ptrdiff_t src_row = 0, dst_row = 0;
+                for (int d = 1; d < 4; d++) {
+                    if (!dst->extent[d]) continue;
+                    int c = coord[d] + dst->min[d];
+                    if (clamp) {
+                        c = std::max(src->min[d], std::min(c, src->min[d] + src->extent[d] - 1));
+                    }
+                    src_row += (ptrdiff_t)(c - src->min[d]) * src->stride[d];
+                    dst_row += (ptrdiff_t)coord[d] * dst->stride[d];
+                }
+                if (dense && row_inside) {
+                    memcpy(dst->host + dst_row * elem_size,
+                           src->host + (src_row + dst->min[0] - src->min[0]) * elem_size,
+                           (size_t)extent[0] * elem_size);
+                    continue;
+                }
+                for (int x = 0; x < extent[0]; x++) {
+                    int c = x + dst->min[0];
+                    if (clamp) {
+                        c = std::max(src->min[0], std::min(c, src->min[0] + src->extent[0] - 1));
+                    }
+                    ptrdiff_t src_offset = src_row + (ptrdiff_t)(c - src->min[0]) * src->stride[0];
+                    ptrdiff_t dst_offset = dst_row + (ptrdiff_t)x * dst->stride[0];
+                    memcpy(dst->host + dst_offset * elem_size,
+                           src->host + src_offset * elem_size, elem_size);
+                }
+            }
+        }
+    }
+}
+
+}}}  // namespace Halide::Streaming::Internal
+
+// A StreamReader for an image that is already addressable, e.g. a
+// MappedImage from image_io.h, so that only the pages each tile needs
+// are touched. Reads beyond the edges of the image repeat the edge.
+class BufferReader : public StreamReader {
+    const buffer_t *source;
+public:
+    BufferReader(const buffer_t *source) : source(source) {}
+
+    int read(const buffer_t *buf) override {
+        Halide::Streaming::Internal::copy_region(source, buf, true);
+        return 0;
+    }
+};
+
+// A StreamWriter that stores each tile into an addressable image,
+// e.g. a MappedImage created with image_io.h, so that the output is
+// streamed to the file strip by strip.
+class BufferWriter : public StreamWriter {
+    buffer_t *dest;
+public:
+    BufferWriter(buffer_t *dest) : dest(dest) {}
+
+    int write(const buffer_t *buf) override {
+        // Copy from the tile into the matching region of dest.
+        buffer_t region = *dest;
+        for (int d = 0; d < 4; d++) {
+            region.min[d] = buf->min[d];
+            region.extent[d] = buf->extent[d];
+        }
+        ptrdiff_t offset = 0;
+        for (int d = 0; d < 4; d++) {
+            offset += (ptrdiff_t)(buf->min[d] - dest->min[d]) * dest->stride[d];
+        }
+        region.host = dest->host + offset * dest->elem_size;
+        Halide::Streaming::Internal::copy_region(buf, &region, false);
+        return 0;
+    }
+};
+
+struct StreamOptions {
+    // The size of each tile in the first two dimensions of the
+    // output. Zero means the entire extent, so the default streams
+    // strips of 64 rows. Tiles at the edges of the output are
+    // smaller, so any constraints the pipeline places on the output
+    // size must hold for them too.
+    int tile_extent[2];
+
+    StreamOptions() {
+        tile_extent[0] = 0;
+        tile_extent[1] = 64;
+    }
+};
+
+namespace Halide { namespace Streaming { namespace Internal {
+
+// The buffers and storage for one tile in flight.
+struct Slot {
+    std::vector<buffer_t> buffers;
+    std::vector<std::vector<uint8_t> > storage;
+    std::vector<void *> args;
+    std::future<int> pending;
+
+    int wait() {
+        return pending.valid() ? pending.get() : 0;
+    }
+};
+
+inline bool is_buffer(const halide_filter_argument_t &arg) {
+    return arg.kind != halide_argument_kind_input_scalar;
+}
+
+// Give the buffer a dense, 32-byte aligned allocation for the region
+// it describes.
+inline void allocate(buffer_t *buf, int dimensions, std::vector<uint8_t> &storage) {
+    size_t size = 1;
+    for (int i = 0; i < dimensions; i++) {
+        buf->stride[i] = (int32_t)size;
+        size *= buf->extent[i];
+    }
+    storage.resize(size * buf->elem_size + 32);
+    buf->host = &storage[0];
+    while ((size_t)buf->host & 0x1f) buf->host++;
+}
+
+}}}  // namespace Halide::Streaming::Internal
+
+// Run the pipeline over an output of the given extent (with mins of
+// zero), one tile at a time. args has one entry per argument of the
+// pipeline, in the same order as the metadata: a StreamReader * for
+// each input buffer, a StreamWriter * for each output buffer, and a
+// pointer to the value for each scalar. Returns zero on success, or
+// the first nonzero result of the pipeline, a reader, or a writer.
+inline int halide_stream(int (*argv_func)(void **args),
+                         const halide_filter_metadata_t *metadata,
+                         void **args,
+                         const int *output_extent,
+                         const StreamOptions &options = StreamOptions()) {
+    using namespace Halide::Streaming::Internal;
+
+    const int num_args = metadata->num_arguments;
+    const halide_filter_argument_t *arguments = metadata->arguments;
+
+    int output_dimensions = 0;
+    for (int i = 0; i < num_args; i++) {
+        if (arguments[i].kind == halide_argument_kind_output_buffer) {
+            output_dimensions = arguments[i].dimensions;
+        }
+    }
+
+    // Carve the output into tiles.
+    int tile_extent[2], num_tiles[2] = {1, 1};
+    for (int d = 0; d < 2; d++) {
+        tile_extent[d] = d < output_dimensions ? output_extent[d] : 1;
+        if (d < output_dimensions && options.tile_extent[d] > 0) {
+            tile_extent[d] = options.tile_extent[d];
+            num_tiles[d] = (output_extent[d] + tile_extent[d] - 1) / tile_extent[d];
+        }
+    }
+    const int total_tiles = num_tiles[0] * num_tiles[1];
+
+    // Set up the buffers for a tile, query the pipeline for the regions
+    // of the inputs it needs, and start reading them.
+    auto start_tile = [&](Slot &slot, int tile) -> int {
+        int tile_min[2] = {(tile % num_tiles[0]) * tile_extent[0],
+                           (tile / num_tiles[0]) * tile_extent[1]};
+        slot.buffers.assign(num_args, buffer_t());
+        slot.storage.resize(num_args);
+        slot.args.resize(num_args);
+        for (int i = 0; i < num_args; i++) {
+            if (!is_buffer(arguments[i])) {
+                slot.args[i] = args[i];
+                continue;
+            }
+            buffer_t &buf = slot.buffers[i];
+            memset(&buf, 0, sizeof(buf));
+            buf.elem_size = (arguments[i].type_bits + 7) / 8;
+            if (arguments[i].kind == halide_argument_kind_output_buffer) {
+                for (int d = 0; d < arguments[i].dimensions; d++) {
+                    buf.extent[d] = output_extent[d];
+                }
+                for (int d = 0; d < 2 && d < arguments[i].dimensions; d++) {
+                    buf.min[d] = tile_min[d];
+                    buf.extent[d] = std::min(tile_extent[d], output_extent[d] - tile_min[d]);
+                }
+            }
+            slot.args[i] = &buf;
+        }
+
+        // Every buffer has a NULL host pointer, so this is a bounds query.
+        int result = argv_func(&slot.args[0]);
+        if (result != 0) return result;
+
+        for (int i = 0; i < num_args; i++) {
+            if (!is_buffer(arguments[i])) continue;
+            buffer_t &buf = slot.buffers[i];
+            if (arguments[i].kind == halide_argument_kind_output_buffer) {
+                // The output region is the tile, whatever the query said.
+                for (int d = 0; d < 2 && d < arguments[i].dimensions; d++) {
+                    buf.min[d] = tile_min[d];
+                    buf.extent[d] = std::min(tile_extent[d], output_extent[d] - tile_min[d]);
+                }
+            }
+            allocate(&buf, arguments[i].dimensions, slot.storage[i]);
+        }
+
+        slot.pending = std::async(std::launch::async, [&slot, arguments, num_args, args]() {
+            for (int i = 0; i < num_args; i++) {
+                if (arguments[i].kind != halide_argument_kind_input_buffer) continue;
+                int result = ((StreamReader *)args[i])->read(&slot.buffers[i]);
+                if (result != 0) return result;
+            }
+            return 0;
+        });
+        return 0;
+    };
+
+    auto start_write = [&](Slot &slot) {
+        slot.pending = std::async(std::launch::async, [&slot, arguments, num_args, args]() {
+            for (int i = 0; i < num_args; i++) {
+                if (arguments[i].kind != halide_argument_kind_output_buffer) continue;
+                int result = ((StreamWriter *)args[i])->write(&slot.buffers[i]);
+                if (result != 0) return result;
+            }
+            return 0;
+        });
+    };
+
+    // Three tiles are in flight: the one being computed, the next one
+    // being read, and the previous one being written.
+    Slot slots[3];
+    int result = total_tiles > 0 ? start_tile(slots[0], 0) : 0;
+    for (int tile = 0; tile < total_tiles && result == 0; tile++) {
+        Slot &current = slots[tile % 3];
+        Slot &next = slots[(tile + 1) % 3];
+        Slot &previous = slots[(tile + 2) % 3];
+
+        result = current.wait();
+        if (result != 0) break;
+
+        if (tile + 1 < total_tiles) {
+            // The next slot was last used to write the tile before
+            // the previous one.
+            result = next.wait();
+            if (result != 0) break;
+            result = start_tile(next, tile + 1);
+            if (result != 0) break;
+        }
+
+        result = argv_func(&current.args[0]);
+        if (result != 0) break;
+
+        // Writes happen in order.
+        result = previous.wait();
+        if (result != 0) break;
+        start_write(current);
+    }
+
+    // Wait for any reads and writes still in flight.
+    for (int i = 0; i < 3; i++) {
+        int r = slots[i].wait();
+        if (result == 0) result = r;
+    }
+    return result;
+}
+
+#endif
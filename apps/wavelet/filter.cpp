@@ -1,7 +1,6 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
-#include <sys/time.h>
 
 extern "C" {
   #include "haar_x.h"
@@ -12,6 +11,7 @@ extern "C" {
 
 #include <static_image.h>
 #include <image_io.h>
+#include <benchmark.h>
 
 float clamp(float x, float min, float max) {
     if (x < min) return min;
@@ -32,27 +32,31 @@ void save_transformed(Image<float> t, const char *filename) {
 
 int main(int argc, char **argv) {
 
-    Image<float> input = load<float>(argv[1]);
+    // I/O is timed separately from compute.
+    Image<float> input;
+    benchmark_io("wavelet/load", [&]() {
+        input = load<float>(argv[1]);
+    });
     Image<float> transformed(input.width()/2, input.height(), 2);
     Image<float> inverse_transformed(input.width(), input.height(), 1);
 
     printf("haar_x\n");
-    haar_x(input, transformed);    
+    benchmark("wavelet/haar_x", [&]() { haar_x(input, transformed); });
     printf("saving result...\n");
     save_transformed(transformed, "haar_x.png");
 
     printf("inverse_haar_x\n");
-    inverse_haar_x(transformed, inverse_transformed);
+    benchmark("wavelet/inverse_haar_x", [&]() { inverse_haar_x(transformed, inverse_transformed); });
     printf("saving result...\n");
     save(inverse_transformed, "inverse_haar_x.png");
 
     printf("daubechies_x\n");
-    daubechies_x(input, transformed);    
+    benchmark("wavelet/daubechies_x", [&]() { daubechies_x(input, transformed); });
     printf("saving result...\n");
     save_transformed(transformed, "daubechies_x.png");
 
     printf("inverse_daubechies_x\n");
-    inverse_daubechies_x(transformed, inverse_transformed);
+    benchmark("wavelet/inverse_daubechies_x", [&]() { inverse_daubechies_x(transformed, inverse_transformed); });
     printf("saving result...\n");
     save(inverse_transformed, "inverse_daubechies_x.png");
 
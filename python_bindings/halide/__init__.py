@@ -241,8 +241,17 @@ _bound0 = FuncType.bound
 _parallel0 = FuncType.parallel
 _vectorize0 = FuncType.vectorize
 _unroll0 = FuncType.unroll
+_realize0 = FuncType.realize
 
 #Func.realize = lambda x, *a: _realize(x,*a) if not (len(a)==1 and isinstance(a[0], ImageTypes)) else _realize(x,to_dynimage(a[0]))
+
+def _func_realize(self, *a):
+    if len(a) >= 1 and isinstance(a[0], numpy.ndarray):
+        # Realize directly into the array's storage.
+        return _realize0(self, _wrap_buffer(a[0], writable=True), *a[1:])
+    return _realize0(self, *a)
+
+Func.realize = _func_realize
 Func.allow_race_conditions = lambda self: _allow_race_conditions0(self)
 
 Func.gpu_blocks = lambda self, *a: _gpu_blocks0(self, *wrap_gpu_args_int(a))
@@ -306,7 +315,10 @@ class Func(object):
         the resulting buffer. The buffer should probably be instantly
         wrapped in an Image class.
 
-        One can use f.realize(Buffer) to realize into an existing buffer.
+        One can use f.realize(Buffer) to realize into an existing buffer,
+        or f.realize(array) to realize directly into a writable numpy array
+        (indexed as A[y,x] unless flip_xy(False) was called) without a copy.
+        The GIL is released while the pipeline runs.
         """
 
     def compile_to_bitcode(self, filename, list_of_Argument, fn_name=""):
@@ -1005,26 +1017,20 @@ def _image_getattr(self, name):
         else:
             raise ValueError('Unknown type %r'%t)
         shape = tuple([D.extent(i) for i in range(D.dimensions())])
-        strides = tuple([D.stride(i)*(t.bits/8) for i in range(D.dimensions())])
+        strides = tuple([D.stride(i)*(t.bits//8) for i in range(D.dimensions())])
         if _flip_xy and len(strides) >= 2:
             strides = (strides[1], strides[0]) + strides[2:]
             shape = (shape[1], shape[0]) + shape[2:]
 
-        #print("About to call image_to_string on", type(self))
-        data = image_to_string(self)
-        #print(type(data))
-        #data = image_to_uint8(self)
-        #data_p = get_image_bytes(self)
-        #print(type(data))
-        #data = ctypes.c_uint8_p(int(data_p))
-        #void_data_p = ctypes.c_void_p(int(data_p))
-        #uint8_data = ctypes.cast(void_data_p, ctypes.POINTER(ctypes.c_uint8))
+        # Expose the image's storage directly rather than copying it.
+        # numpy keeps a reference to self as the base of the array.
+        data = (buffer_host_address(to_buffer(self)), False)
 
         return {'shape': shape,
                 'typestr': typestr,
-                #'data': uint8_data,
                 'data': data,
-                'strides': strides}
+                'strides': strides,
+                'version': 3}
     raise AttributeError(name)
 
 for _ImageT in ImageTypes:
@@ -1074,28 +1080,35 @@ for _ImageT in ImageTypes:
     _ImageT.show = lambda *args, **kw: _show_image(*args, **kw)
     _ImageT.tostring = lambda self: image_to_string(self)
 
+def _wrap_buffer(a, typeval=None, writable=False):
+    """
+    Wrap a numpy array, or any object supporting the buffer protocol, as a Buffer
+    without copying it. The Buffer keeps the wrapped array alive.
+    """
+    if not isinstance(a, numpy.ndarray):
+        a = numpy.asarray(memoryview(a))
+    if typeval is None:
+        typeval = _numpy_to_type(a)
+    return buffer_from_python(a, typeval, _flip_xy, writable)
+
 def _numpy_to_image(a, dtype, C):
     a = numpy.asarray(a, dtype)
-    shape = a.shape
-    strides = a.strides
-    if _flip_xy and len(shape) >= 2:
-        shape = (shape[1], shape[0]) + shape[2:]
-        strides = (strides[1], strides[0]) + strides[2:]
-
-    ans = C(*shape)
-    assign_array(ans, a.__array_interface__['data'][0], *strides)
-    return ans
+    # Images are writable, and can only alias whole elements.
+    if not a.flags.writeable or any(s % a.itemsize for s in a.strides):
+        a = numpy.array(a)
+    return C(_wrap_buffer(a, writable=True))
+
+_numpy_types = {numpy.dtype('int8'): Int(8),
+                numpy.dtype('int16'): Int(16),
+                numpy.dtype('int32'): Int(32),
+                numpy.dtype('uint8'): UInt(8),
+                numpy.dtype('uint16'): UInt(16),
+                numpy.dtype('uint32'): UInt(32),
+                numpy.dtype('float32'): Float(32),
+                numpy.dtype('float64'): Float(64)}
 
 def _numpy_to_type(a):
-    d = {numpy.dtype('int8'): Int(8),
-         numpy.dtype('int16'): Int(16),
-         numpy.dtype('int32'): Int(32),
-         numpy.dtype('uint8'): UInt(8),
-         numpy.dtype('uint16'): UInt(16),
-         numpy.dtype('uint32'): UInt(32),
-         numpy.dtype('float32'): Float(32),
-         numpy.dtype('float64'): Float(64)}
-    return d[a.dtype]
+    return _numpy_types[a.dtype]
 
 class Image(object):
     """
@@ -1370,9 +1383,19 @@ for ParamT in ParamTypes: # + (DynUniform,):
 
 #UniformImage.__setitem__ = lambda x, key, value: assign(call(x, *[wrap(y) for y in key]), wrap(value)) if isinstance(key,tuple) else assign(call(x, key), wrap(value))
 
+def _image_param_set(self, y):
+    if (isinstance(y, numpy.ndarray) and y.dtype in _numpy_types and
+        not any(s % y.itemsize for s in y.strides)):
+        # Pipelines don't write to their inputs, so read-only arrays
+        # can be bound without a copy.
+        y = _wrap_buffer(y)
+    elif hasattr(y, 'putpixel') or isinstance(y, numpy.ndarray):
+        y = Image(y)
+    set(self, y)
+
 for _ImageT in [ImageParamType]:
     _ImageT.__getitem__ = _generic_getitem_expr
-    _ImageT.set = lambda x, y: set(x, Image(y) if (isinstance(y,numpy.ndarray) or hasattr(y, 'putpixel')) else y)
+    _ImageT.set = lambda x, y: _image_param_set(x, y)
     #_ImageT.save = lambda x, y: save_png(x, y)
 
 # ----------------------------------------------------
@@ -1975,6 +1998,48 @@ def test_numpy():
 
     print('halide.test_numpy:                   OK')
 
+def test_numpy_zero_copy():
+    x = Var('x')
+    y = Var('y')
+    f = Func('f')
+
+    # A strided view of an input, bound without a copy.
+    a = numpy.arange(16*12, dtype='float32').reshape(16, 12)
+    view = a[::2, 1::3]
+    input = ImageParam(Float(32), 2)
+    input.set(view)
+    f[x,y] = input[x,y]*2.0
+
+    # Neither buffer is dense in x.
+    input.set_stride(0, Expr())
+    f.output_buffer().set_stride(0, Expr())
+
+    # Realize into a preallocated array, also strided.
+    out = numpy.zeros((view.shape[0], view.shape[1]*2), 'float32')
+    out_view = out[:, ::2]
+    f.realize(out_view)
+    assert numpy.all(out_view == view*2)
+    assert numpy.all(out[:, 1::2] == 0)
+
+    # The bound Buffer keeps the array alive, even once nothing in
+    # Python refers to it, and lets go of it when it's replaced.
+    b = numpy.full(view.shape, 3.0, 'float32')
+    refs = sys.getrefcount(b)
+    input.set(b)
+    assert sys.getrefcount(b) > refs
+    input.set(b.copy())
+    assert sys.getrefcount(b) == refs
+    del b
+    f.realize(out_view)
+    assert numpy.all(out_view == 6.0)
+
+    # Images made from arrays alias them, and vice versa.
+    I = Image(a)
+    assert numpy.asarray(I).__array_interface__['data'][0] == a.__array_interface__['data'][0]
+    a[0, 0] = 42.0
+    assert numpy.asarray(I)[0, 0] == 42.0
+    print('halide.test_numpy_zero_copy:         OK')
+
 def test_minimal():
     f1 = Func()
     f2 = Func()
@@ -2075,6 +2140,7 @@ def test():
     test_blur()
     test_core()
     test_numpy()
+    test_numpy_zero_copy()
     test_image_constructors()
 
 
@@ -61,8 +61,32 @@
 #include "Halide.h"
 #include "py_util.h"
 using namespace Halide;
+
+// Releases the GIL for as long as it lives, and takes it back even if
+// the code it guards throws.
+class ReleaseGIL {
+    PyThreadState *state;
+public:
+    ReleaseGIL() : state(PyEval_SaveThread()) {}
+    ~ReleaseGIL() { PyEval_RestoreThread(state); }
+};
 %}
 
+// buffer_from_python reports failures by setting a Python exception.
+%exception buffer_from_python {
+  $action
+  if (PyErr_Occurred()) SWIG_fail;
+}
+
+// Release the GIL while compiling and running a pipeline, so other
+// Python threads can make progress.
+%exception Halide::Func::realize {
+  {
+    ReleaseGIL release_gil;
+    $action
+  }
+}
+
 // ~=~=~=~=~=~=~=~=~=~=~=~=~=~=~=~=~=~=~
 %typemap(out) std::string {
 %#if PY_VERSION_HEX >= 0x03000000
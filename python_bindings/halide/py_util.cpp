@@ -5,7 +5,9 @@
 #include "py_util.h"
 #include "../../apps/support/image_io.h"
 #include <signal.h>
+#include <algorithm>
 #include <string>
+#include <utility>
 #include "Python.h"
 #include "frameobject.h"
 
@@ -247,3 +249,67 @@ DEFINE_TYPE(float)
 DEFINE_TYPE(double)
 #undef DEFINE_TYPE
 
+namespace {
+
+// Release a Py_buffer acquired by buffer_from_python, once the Buffer
+// wrapping it dies. That may happen on a thread that doesn't hold the
+// GIL, e.g. while a pipeline runs.
+void release_py_buffer(void *arg) {
+    Py_buffer *view = (Py_buffer *)arg;
+    PyGILState_STATE gil = PyGILState_Ensure();
+    PyBuffer_Release(view);
+    PyGILState_Release(gil);
+    delete view;
+}
+
+}
+
+Buffer buffer_from_python(PyObject *obj, Type t, bool flip_xy, bool writable) {
+    Py_buffer *view = new Py_buffer;
+    int flags = PyBUF_STRIDES | (writable ? PyBUF_WRITABLE : 0);
+    if (PyObject_GetBuffer(obj, view, flags) != 0) {
+        delete view;
+        return Buffer();
+    }
+
+    const char *error = NULL;
+    if (view->ndim > 4) {
+        error = "Halide buffers may have at most four dimensions";
+    } else if (view->itemsize != t.bytes()) {
+        error = "The element size of the array does not match the type of the Buffer";
+    }
+
+    buffer_t buf;
+    memset(&buf, 0, sizeof(buf));
+    buf.host = (uint8_t *)view->buf;
+    buf.elem_size = (int32_t)view->itemsize;
+    for (int i = 0; i < view->ndim && !error; i++) {
+        Py_ssize_t stride = view->strides[i] / view->itemsize;
+        if (stride * view->itemsize != view->strides[i]) {
+            error = "The array strides must be a multiple of the element size";
+        } else if (view->shape[i] > INT32_MAX || stride > INT32_MAX || stride < INT32_MIN) {
+            error = "The array is too large to be wrapped as a Halide Buffer";
+        }
+        buf.extent[i] = (int32_t)view->shape[i];
+        buf.stride[i] = (int32_t)stride;
+    }
+    if (flip_xy && view->ndim >= 2) {
+        std::swap(buf.extent[0], buf.extent[1]);
+        std::swap(buf.stride[0], buf.stride[1]);
+    }
+
+    if (error) {
+        PyBuffer_Release(view);
+        delete view;
+        PyErr_SetString(PyExc_ValueError, error);
+        return Buffer();
+    }
+
+    // The Buffer holds on to the view, and hence to obj, until it dies.
+    return Buffer(t, &buf, release_py_buffer, view);
+}
+
+size_t buffer_host_address(Buffer b) {
+    b.copy_to_host();
+    return (size_t)b.host_ptr();
+}
@@ -5,6 +5,7 @@
 #ifndef _py_util_h
 #define _py_util_h
 
+#include "Python.h"
 #include "Halide.h"
 #include <vector>
 
@@ -200,5 +201,18 @@ DEFINE_TYPE(float)
 DEFINE_TYPE(double)
 #undef DEFINE_TYPE
 
+// Wrap any object supporting the buffer protocol (e.g. a numpy array)
+// as a Buffer of the given type, without copying. The strides may be
+// arbitrary multiples of the element size. If flip_xy is true, the
+// first two dimensions are swapped, so that a[y, x] maps to I(x, y).
+// The Buffer keeps obj alive, and its storage acquired, until the
+// last reference to it dies. On failure, sets a Python exception and
+// returns an undefined Buffer.
+Buffer buffer_from_python(PyObject *obj, Type t, bool flip_xy, bool writable);
+
+// The address of the host allocation of a Buffer, copying it back
+// from the device first if necessary.
+size_t buffer_host_address(Buffer b);
+
 #endif
 
@@ -138,6 +138,13 @@ Stmt add_image_checks(Stmt s, Function f, const Target &t,
         Type type = buf.second.type;
         int dimensions = buf.second.dimensions;
 
+        // Buffer arguments are passed as buffer_t, which only has
+        // room for four dimensions.
+        user_assert(dimensions <= 4)
+            << "Buffer " << name << " has " << dimensions << " dimensions. "
+            << "Halide currently has a limit of four dimensions on "
+            << "input and output buffers of a pipeline.\n";
+
         // Detect if this is one of the outputs of a multi-output pipeline.
         bool is_output_buffer = false;
         bool is_secondary_output_buffer = false;
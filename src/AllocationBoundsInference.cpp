@@ -24,6 +24,7 @@ class AllocationInference : public IRMutator {
     const map<string, Function> &env;
     const FuncValueBounds &func_bounds;
     set<string> touched_by_extern;
+    bool precise;
 
     void visit(const Realize *op) {
         map<string, Function>::const_iterator iter = env.find(op->name);
@@ -31,7 +32,7 @@ class AllocationInference : public IRMutator {
         Function f = iter->second;
 
         Scope<Interval> empty_scope;
-        Box b = box_touched(op->body, op->name, empty_scope, func_bounds);
+        Box b = box_touched(op->body, op->name, empty_scope, func_bounds, precise);
         if (touched_by_extern.count(f.name())) {
             // The region touched is at least the region required at this
             // loop level of the first stage (this is important for inputs
@@ -71,8 +72,8 @@ class AllocationInference : public IRMutator {
     }
 
 public:
-    AllocationInference(const map<string, Function> &e, const FuncValueBounds &fb) :
-        env(e), func_bounds(fb) {
+    AllocationInference(const map<string, Function> &e, const FuncValueBounds &fb, bool p) :
+        env(e), func_bounds(fb), precise(p) {
         // Figure out which buffers are touched by extern stages
         for (map<string, Function>::const_iterator iter = e.begin();
              iter != e.end(); ++iter) {
@@ -92,8 +93,9 @@ public:
 
 Stmt allocation_bounds_inference(Stmt s,
                                  const map<string, Function> &env,
-                                 const FuncValueBounds &fb) {
-    AllocationInference inf(env, fb);
+                                 const FuncValueBounds &fb,
+                                 bool precise) {
+    AllocationInference inf(env, fb, precise);
     s = inf.mutate(s);
     return s;
 }
@@ -12,10 +12,13 @@ namespace Halide {
 namespace Internal {
 
 /** Take a partially statement with Realize nodes in terms of
- * variables, and define values for those variables. */
+ * variables, and define values for those variables. If precise is
+ * true, the regions touched are computed with the precise mode of
+ * box_touched. */
 Stmt allocation_bounds_inference(Stmt s,
                                  const std::map<std::string, Function> &env,
-                                 const std::map<std::pair<std::string, int>, Interval> &func_bounds);
+                                 const std::map<std::pair<std::string, int>, Interval> &func_bounds,
+                                 bool precise = false);
 }
 }
 
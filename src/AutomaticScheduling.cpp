@@ -111,14 +111,14 @@ private:
         s.bounds().insert(s.bounds().begin(), oldbounds.begin(), oldbounds.end());
 
         for (size_t i = 0; i < f.args().size(); i++) {
-            Dim d = {f.args()[i], ForType::Serial, DeviceAPI::Parent, true};
+            Dim d = {f.args()[i], ForType::Serial, DeviceAPI::Parent, true, false};
             f.schedule().dims().push_back(d);
             f.schedule().storage_dims().push_back(f.args()[i]);
         }
 
         // Add the dummy outermost dim
         {
-            Dim d = {Var::outermost().name(), ForType::Serial, DeviceAPI::Parent, true};
+            Dim d = {Var::outermost().name(), ForType::Serial, DeviceAPI::Parent, true, false};
             f.schedule().dims().push_back(d);
         }
     }
@@ -222,6 +222,10 @@ void VectorizeInner::apply(Func root, const Target &target) {
     vector<Function> all_functions = cg.transitive_calls(root.function());
     all_functions.push_back(root.function());
     for (Function f : all_functions) {
+        // Extern stages traverse their innermost dimension themselves.
+        if (f.has_extern_definition()) {
+            continue;
+        }
         if (!f.schedule().compute_level().is_inline() || f.same_as(root.function())) {
             Func wrapper(f);
             Dim inner = f.schedule().dims()[0];
@@ -11,6 +11,7 @@
 #include "Var.h"
 #include "Debug.h"
 #include "ExprUsesVar.h"
+#include "FixedPoint.h"
 
 namespace Halide {
 namespace Internal {
@@ -37,6 +38,65 @@ int static_sign(Expr x) {
     }
     return 0;
 }
+
+// A sum of constant multiples of variables in some scope, plus a
+// term that doesn't depend on any of them.
+struct LinearForm {
+    map<string, int> coeffs;
+    Expr rest;
+    // Does some variable appear in more than one term?
+    bool repeated;
+    LinearForm() : repeated(false) {}
+};
+
+// Add scale * e to a linear form. Returns false if e isn't linear in
+// the variables in scope.
+bool linearize(Expr e, int scale, const Scope<Interval> &scope, LinearForm &form) {
+    if (e.type() != Int(32)) {
+        return false;
+    }
+
+    if (!expr_uses_vars(e, scope)) {
+        Expr term = (scale == 1) ? e : e * scale;
+        form.rest = form.rest.defined() ? form.rest + term : term;
+        return true;
+    }
+
+    const int64_t max_coeff = 1 << 16;
+    if (const Variable *v = e.as<Variable>()) {
+        map<string, int>::iterator iter = form.coeffs.find(v->name);
+        if (iter != form.coeffs.end()) {
+            form.repeated = true;
+            iter->second += scale;
+        } else {
+            form.coeffs[v->name] = scale;
+        }
+        return true;
+    } else if (const Add *add = e.as<Add>()) {
+        return (linearize(add->a, scale, scope, form) &&
+                linearize(add->b, scale, scope, form));
+    } else if (const Sub *sub = e.as<Sub>()) {
+        return (linearize(sub->a, scale, scope, form) &&
+                linearize(sub->b, -scale, scope, form));
+    } else if (const Mul *mul = e.as<Mul>()) {
+        const IntImm *ca = mul->a.as<IntImm>();
+        const IntImm *cb = mul->b.as<IntImm>();
+        int64_t c = ca ? ca->value : (cb ? cb->value : 0);
+        Expr other = ca ? mul->b : mul->a;
+        if ((ca || cb) && std::abs(c * scale) < max_coeff) {
+            return linearize(other, (int)(c * scale), scope, form);
+        }
+    }
+    return false;
+}
+
+// Narrow the bounds of the variables in scope given that a condition
+// has the given truth value, e.g. x is at most 9 on the true side of
+// x < 10. The names of the new entries in scope are added to pushed
+// so that the caller can pop them again.
+void push_condition(Expr cond, bool value, Scope<Interval> &scope,
+                    const FuncValueBounds &fb, vector<string> &pushed);
+
 }
 
 class Bounds : public IRVisitor {
@@ -44,13 +104,60 @@ public:
     Expr min, max;
     Scope<Interval> scope;
     const FuncValueBounds &func_bounds;
+    bool precise;
 
-    Bounds(const Scope<Interval> *s, const FuncValueBounds &fb) :
-        func_bounds(fb) {
+    Bounds(const Scope<Interval> *s, const FuncValueBounds &fb, bool p = false) :
+        func_bounds(fb), precise(p) {
         scope.set_containing_scope(s);
     }
 private:
 
+    // Compute exact bounds for a sum of constant multiples of
+    // variables in which some variable appears more than once, which
+    // interval arithmetic would overestimate. Returns false if e isn't
+    // of that form.
+    bool bounds_of_linear_form(Expr e) {
+        LinearForm form;
+        if (!linearize(e, 1, scope, form) || !form.repeated) {
+            return false;
+        }
+
+        Expr lo = form.rest.defined() ? form.rest : make_zero(e.type());
+        Expr hi = lo;
+        for (map<string, int>::iterator iter = form.coeffs.begin();
+             iter != form.coeffs.end(); ++iter) {
+            int c = iter->second;
+            if (c == 0) continue;
+            Interval in = scope.get(iter->first);
+            if (!in.min.defined() || !in.max.defined()) {
+                return false;
+            }
+            if (c > 0) {
+                lo += in.min * c;
+                hi += in.max * c;
+            } else {
+                lo += in.max * c;
+                hi += in.min * c;
+            }
+        }
+        min = lo;
+        max = hi;
+        return true;
+    }
+
+    // Compute the bounds of one side of a select, knowing which way
+    // the condition went.
+    void bounds_of_branch(Expr value, Expr cond, bool cond_value) {
+        vector<string> pushed;
+        if (precise) {
+            push_condition(cond, cond_value, scope, func_bounds, pushed);
+        }
+        value.accept(this);
+        for (size_t i = 0; i < pushed.size(); i++) {
+            scope.pop(pushed[i]);
+        }
+    }
+
     // Compute the intrinsic bounds of a function.
     void bounds_of_func(Function f, int value_index) {
         // if we can't get a good bound from the function, fall back to the bounds of the type.
@@ -196,6 +303,10 @@ private:
     }
 
     void visit(const Add *op) {
+        if (precise && bounds_of_linear_form(op)) {
+            return;
+        }
+
         op->a.accept(this);
         Expr min_a = min, max_a = max;
         op->b.accept(this);
@@ -238,6 +349,10 @@ private:
     }
 
     void visit(const Sub *op) {
+        if (precise && bounds_of_linear_form(op)) {
+            return;
+        }
+
         op->a.accept(this);
         Expr min_a = min, max_a = max;
         op->b.accept(this);
@@ -592,13 +707,13 @@ private:
     }
 
     void visit(const Select *op) {
-        op->true_value.accept(this);
+        bounds_of_branch(op->true_value, op->condition, true);
         Expr min_a = min, max_a = max;
         if (!min_a.defined() || !max_a.defined()) {
             min = Expr(); max = Expr(); return;
         }
 
-        op->false_value.accept(this);
+        bounds_of_branch(op->false_value, op->condition, false);
         Expr min_b = min, max_b = max;
         if (!min_b.defined() || !max_b.defined()) {
             min = Expr(); max = Expr(); return;
@@ -636,6 +751,11 @@ private:
         internal_error << "Bounds of vector";
     }
 
+    void visit(const VectorReduce *op) {
+        internal_assert(op->type.is_scalar()) << "Bounds of vector";
+        bounds_of_type(op->type);
+    }
+
     void visit(const Call *op) {
         // If the args are const we can return the call of those args
         // for pure functions (extern and image). For other types of
@@ -681,6 +801,9 @@ private:
                 // If the argument is unbounded on one side, then the max is unbounded.
                 max = Expr();
             }
+        } else if (is_fixed_point_intrinsic(op)) {
+            // Use the bounds of the equivalent widened arithmetic.
+            lower_fixed_point_intrinsic(op).accept(this);
         } else if (op->call_type == Call::Intrinsic && op->name == Call::likely) {
             assert(op->args.size() == 1);
             op->args[0].accept(this);
@@ -789,14 +912,101 @@ private:
     }
 };
 
-Interval bounds_of_expr_in_scope(Expr expr, const Scope<Interval> &scope, const FuncValueBounds &fb) {
+Interval bounds_of_expr_in_scope(Expr expr, const Scope<Interval> &scope, const FuncValueBounds &fb, bool precise) {
     //debug(3) << "computing bounds_of_expr_in_scope " << expr << "\n";
-    Bounds b(&scope, fb);
+    Bounds b(&scope, fb, precise);
     expr.accept(&b);
     //debug(3) << "bounds_of_expr_in_scope " << expr << " = " << simplify(b.min) << ", " << simplify(b.max) << "\n";
     return Interval(b.min, b.max);
 }
 
+namespace {
+
+void push_condition(Expr cond, bool value, Scope<Interval> &scope,
+                    const FuncValueBounds &fb, vector<string> &pushed) {
+    if (const Call *call = cond.as<Call>()) {
+        if (call->call_type == Call::Intrinsic && call->name == Call::likely) {
+            push_condition(call->args[0], value, scope, fb, pushed);
+        }
+        return;
+    } else if (const Not *n = cond.as<Not>()) {
+        push_condition(n->a, !value, scope, fb, pushed);
+        return;
+    } else if (const And *a = cond.as<And>()) {
+        // We only learn something about each side if the whole thing is true.
+        if (value) {
+            push_condition(a->a, true, scope, fb, pushed);
+            push_condition(a->b, true, scope, fb, pushed);
+        }
+        return;
+    } else if (const Or *o = cond.as<Or>()) {
+        if (!value) {
+            push_condition(o->a, false, scope, fb, pushed);
+            push_condition(o->b, false, scope, fb, pushed);
+        }
+        return;
+    }
+
+    // Rewrite the condition as a <= b or a < b.
+    Expr a, b;
+    bool strict = false, equality = false;
+    if (const LT *lt = cond.as<LT>()) {
+        a = lt->a; b = lt->b; strict = true;
+    } else if (const LE *le = cond.as<LE>()) {
+        a = le->a; b = le->b;
+    } else if (const GT *gt = cond.as<GT>()) {
+        a = gt->b; b = gt->a; strict = true;
+    } else if (const GE *ge = cond.as<GE>()) {
+        a = ge->b; b = ge->a;
+    } else if (const EQ *eq = cond.as<EQ>()) {
+        if (!value) return;
+        a = eq->a; b = eq->b; equality = true;
+    } else {
+        return;
+    }
+
+    if (a.type() != Int(32)) {
+        return;
+    }
+
+    if (!value) {
+        // !(a < b) is b <= a, and !(a <= b) is b < a
+        std::swap(a, b);
+        strict = !strict;
+    }
+    // Now we know a <= b, or a < b if strict (and also b <= a, if
+    // it's an equality).
+    for (int i = 0; i < (equality ? 2 : 1); i++) {
+        if (const Variable *v = a.as<Variable>()) {
+            if (scope.contains(v->name) && !expr_uses_var(b, v->name)) {
+                Interval in = scope.get(v->name);
+                Expr max_b = bounds_of_expr_in_scope(b, scope, fb, true).max;
+                if (max_b.defined()) {
+                    if (strict) max_b = max_b - 1;
+                    in.max = in.max.defined() ? Min::make(in.max, max_b) : max_b;
+                    scope.push(v->name, in);
+                    pushed.push_back(v->name);
+                }
+            }
+        }
+        if (const Variable *v = b.as<Variable>()) {
+            if (scope.contains(v->name) && !expr_uses_var(a, v->name)) {
+                Interval in = scope.get(v->name);
+                Expr min_a = bounds_of_expr_in_scope(a, scope, fb, true).min;
+                if (min_a.defined()) {
+                    if (strict) min_a = min_a + 1;
+                    in.min = in.min.defined() ? Max::make(in.min, min_a) : min_a;
+                    scope.push(v->name, in);
+                    pushed.push_back(v->name);
+                }
+            }
+        }
+        std::swap(a, b);
+    }
+}
+
+}
+
 Interval interval_union(const Interval &a, const Interval &b) {
     Expr max, min;
     debug(3) << "Interval union of " << a.min << ", " << a.max << ",  " << b.min << ", " << b.max << "\n";
@@ -995,8 +1205,9 @@ bool boxes_overlap(const Box &a, const Box &b) {
 class BoxesTouched : public IRGraphVisitor {
 
 public:
-    BoxesTouched(bool calls, bool provides, string fn, const Scope<Interval> *s, const FuncValueBounds &fb) :
-        func(fn), consider_calls(calls), consider_provides(provides), func_bounds(fb) {
+    BoxesTouched(bool calls, bool provides, string fn, const Scope<Interval> *s,
+                 const FuncValueBounds &fb, bool p) :
+        func(fn), consider_calls(calls), consider_provides(provides), func_bounds(fb), precise(p) {
         scope.set_containing_scope(s);
     }
 
@@ -1008,14 +1219,66 @@ private:
     bool consider_calls, consider_provides;
     Scope<Interval> scope;
     const FuncValueBounds &func_bounds;
+    bool precise;
 
     using IRGraphVisitor::visit;
 
+    // The branch conditions narrowing the scope, outermost first, and
+    // the nodes visited under each combination of them. A node
+    // reached again under the same conditions can't touch anything
+    // new, so this memoizes across branches (and across selects that
+    // share subexpressions) rather than starting afresh in each one.
+    typedef vector<std::pair<const IRNode *, bool> > BranchPath;
+    BranchPath branch_path;
+    map<BranchPath, std::set<const IRNode *> > visited_on_path;
+
+    // Beyond this many nested narrowing conditions, branches are
+    // visited without narrowing, so that the number of distinct paths
+    // (and hence of visits to each node) stays bounded.
+    static const size_t max_branch_depth = 8;
+
+    // Visit one side of a select or if statement, knowing which way
+    // the condition went.
+    template<typename ExprOrStmt>
+    void visit_branch(ExprOrStmt branch, Expr cond, bool cond_value) {
+        if (branch_path.size() >= max_branch_depth) {
+            branch.accept(this);
+            return;
+        }
+        vector<string> pushed;
+        push_condition(cond, cond_value, scope, func_bounds, pushed);
+        if (pushed.empty()) {
+            // The condition tells us nothing, so this is the same
+            // context as the enclosing one.
+            branch.accept(this);
+            return;
+        }
+        branch_path.push_back(std::make_pair((const IRNode *)cond.ptr, cond_value));
+        std::set<const IRNode *> &path_visited = visited_on_path[branch_path];
+        visited.swap(path_visited);
+        branch.accept(this);
+        visited.swap(path_visited);
+        branch_path.pop_back();
+        for (size_t i = 0; i < pushed.size(); i++) {
+            scope.pop(pushed[i]);
+        }
+    }
+
+    void visit(const Select *op) {
+        if (!precise || !consider_calls) {
+            IRGraphVisitor::visit(op);
+            return;
+        }
+        op->condition.accept(this);
+        visit_branch(op->true_value, op->condition, true);
+        visit_branch(op->false_value, op->condition, false);
+    }
+
     void visit(const Let *op) {
         if (!consider_calls) return;
 
         op->value.accept(this);
-        Interval value_bounds = bounds_of_expr_in_scope(op->value, scope, func_bounds);
+        Interval value_bounds = bounds_of_expr_in_scope(op->value, scope, func_bounds, precise);
         scope.push(op->name, value_bounds);
         op->body.accept(this);
         scope.pop(op->name);
@@ -1056,7 +1319,7 @@ private:
         b.used = const_true();
         for (size_t i = 0; i < op->args.size(); i++) {
             op->args[i].accept(this);
-            b[i] = bounds_of_expr_in_scope(op->args[i], scope, func_bounds);
+            b[i] = bounds_of_expr_in_scope(op->args[i], scope, func_bounds, precise);
         }
         merge_boxes(boxes[op->name], b);
     }
@@ -1090,7 +1353,7 @@ private:
         if (consider_calls) {
             op->value.accept(this);
         }
-        Interval value_bounds = bounds_of_expr_in_scope(op->value, scope, func_bounds);
+        Interval value_bounds = bounds_of_expr_in_scope(op->value, scope, func_bounds, precise);
         value_bounds.min = simplify(value_bounds.min);
         value_bounds.max = simplify(value_bounds.max);
 
@@ -1128,9 +1391,16 @@ private:
         op->condition.accept(this);
 
         if (expr_uses_vars(op->condition, scope)) {
-            op->then_case.accept(this);
-            if (op->else_case.defined()) {
-                op->else_case.accept(this);
+            if (precise) {
+                visit_branch(op->then_case, op->condition, true);
+                if (op->else_case.defined()) {
+                    visit_branch(op->else_case, op->condition, false);
+                }
+            } else {
+                op->then_case.accept(this);
+                if (op->else_case.defined()) {
+                    op->else_case.accept(this);
+                }
             }
         } else {
             // If the condition is based purely on params, then we'll only
@@ -1194,14 +1464,14 @@ private:
         if (scope.contains(op->name + ".loop_min")) {
             min_val = scope.get(op->name + ".loop_min").min;
         } else {
-            min_val = bounds_of_expr_in_scope(op->min, scope, func_bounds).min;
+            min_val = bounds_of_expr_in_scope(op->min, scope, func_bounds, precise).min;
         }
 
         if (scope.contains(op->name + ".loop_max")) {
             max_val = scope.get(op->name + ".loop_max").max;
         } else {
-            max_val = bounds_of_expr_in_scope(op->extent, scope, func_bounds).max;
-            max_val += bounds_of_expr_in_scope(op->min, scope, func_bounds).max;
+            max_val = bounds_of_expr_in_scope(op->extent, scope, func_bounds, precise).max;
+            max_val += bounds_of_expr_in_scope(op->min, scope, func_bounds, precise).max;
             max_val -= 1;
         }
 
@@ -1215,7 +1485,7 @@ private:
             if (op->name == func || func.empty()) {
                 Box b(op->args.size());
                 for (size_t i = 0; i < op->args.size(); i++) {
-                    b[i] = bounds_of_expr_in_scope(op->args[i], scope, func_bounds);
+                    b[i] = bounds_of_expr_in_scope(op->args[i], scope, func_bounds, precise);
                 }
                 merge_boxes(boxes[op->name], b);
             }
@@ -1233,8 +1503,9 @@ private:
 };
 
 map<string, Box> boxes_touched(Expr e, Stmt s, bool consider_calls, bool consider_provides,
-                               string fn, const Scope<Interval> &scope, const FuncValueBounds &fb) {
-    BoxesTouched b(consider_calls, consider_provides, fn, &scope, fb);
+                               string fn, const Scope<Interval> &scope, const FuncValueBounds &fb,
+                               bool precise) {
+    BoxesTouched b(consider_calls, consider_provides, fn, &scope, fb, precise);
     if (e.defined()) {
         e.accept(&b);
     }
@@ -1245,61 +1516,62 @@ map<string, Box> boxes_touched(Expr e, Stmt s, bool consider_calls, bool conside
 }
 
 Box box_touched(Expr e, Stmt s, bool consider_calls, bool consider_provides,
-                string fn, const Scope<Interval> &scope, const FuncValueBounds &fb) {
-    return boxes_touched(e, s, consider_calls, consider_provides, fn, scope, fb)[fn];
+                string fn, const Scope<Interval> &scope, const FuncValueBounds &fb,
+                bool precise) {
+    return boxes_touched(e, s, consider_calls, consider_provides, fn, scope, fb, precise)[fn];
 }
 
-map<string, Box> boxes_required(Expr e, const Scope<Interval> &scope, const FuncValueBounds &fb) {
-    return boxes_touched(e, Stmt(), true, false, "", scope, fb);
+map<string, Box> boxes_required(Expr e, const Scope<Interval> &scope, const FuncValueBounds &fb, bool precise) {
+    return boxes_touched(e, Stmt(), true, false, "", scope, fb, precise);
 }
 
-Box box_required(Expr e, string fn, const Scope<Interval> &scope, const FuncValueBounds &fb) {
-    return box_touched(e, Stmt(), true, false, fn, scope, fb);
+Box box_required(Expr e, string fn, const Scope<Interval> &scope, const FuncValueBounds &fb, bool precise) {
+    return box_touched(e, Stmt(), true, false, fn, scope, fb, precise);
 }
 
-map<string, Box> boxes_required(Stmt s, const Scope<Interval> &scope, const FuncValueBounds &fb) {
-    return boxes_touched(Expr(), s, true, false, "", scope, fb);
+map<string, Box> boxes_required(Stmt s, const Scope<Interval> &scope, const FuncValueBounds &fb, bool precise) {
+    return boxes_touched(Expr(), s, true, false, "", scope, fb, precise);
 }
 
-Box box_required(Stmt s, string fn, const Scope<Interval> &scope, const FuncValueBounds &fb) {
-    return box_touched(Expr(), s, true, false, fn, scope, fb);
+Box box_required(Stmt s, string fn, const Scope<Interval> &scope, const FuncValueBounds &fb, bool precise) {
+    return box_touched(Expr(), s, true, false, fn, scope, fb, precise);
 }
 
-map<string, Box> boxes_provided(Expr e, const Scope<Interval> &scope, const FuncValueBounds &fb) {
-    return boxes_touched(e, Stmt(), false, true, "", scope, fb);
+map<string, Box> boxes_provided(Expr e, const Scope<Interval> &scope, const FuncValueBounds &fb, bool precise) {
+    return boxes_touched(e, Stmt(), false, true, "", scope, fb, precise);
 }
 
-Box box_provided(Expr e, string fn, const Scope<Interval> &scope, const FuncValueBounds &fb) {
-    return box_touched(e, Stmt(), false, true, fn, scope, fb);
+Box box_provided(Expr e, string fn, const Scope<Interval> &scope, const FuncValueBounds &fb, bool precise) {
+    return box_touched(e, Stmt(), false, true, fn, scope, fb, precise);
 }
 
-map<string, Box> boxes_provided(Stmt s, const Scope<Interval> &scope, const FuncValueBounds &fb) {
-    return boxes_touched(Expr(), s, false, true, "", scope, fb);
+map<string, Box> boxes_provided(Stmt s, const Scope<Interval> &scope, const FuncValueBounds &fb, bool precise) {
+    return boxes_touched(Expr(), s, false, true, "", scope, fb, precise);
 }
 
-Box box_provided(Stmt s, string fn, const Scope<Interval> &scope, const FuncValueBounds &fb) {
-    return box_touched(Expr(), s, false, true, fn, scope, fb);
+Box box_provided(Stmt s, string fn, const Scope<Interval> &scope, const FuncValueBounds &fb, bool precise) {
+    return box_touched(Expr(), s, false, true, fn, scope, fb, precise);
 }
 
-map<string, Box> boxes_touched(Expr e, const Scope<Interval> &scope, const FuncValueBounds &fb) {
-    return boxes_touched(e, Stmt(), true, true, "", scope, fb);
+map<string, Box> boxes_touched(Expr e, const Scope<Interval> &scope, const FuncValueBounds &fb, bool precise) {
+    return boxes_touched(e, Stmt(), true, true, "", scope, fb, precise);
 }
 
-Box box_touched(Expr e, string fn, const Scope<Interval> &scope, const FuncValueBounds &fb) {
-    return box_touched(e, Stmt(), true, true, fn, scope, fb);
+Box box_touched(Expr e, string fn, const Scope<Interval> &scope, const FuncValueBounds &fb, bool precise) {
+    return box_touched(e, Stmt(), true, true, fn, scope, fb, precise);
 }
 
-map<string, Box> boxes_touched(Stmt s, const Scope<Interval> &scope, const FuncValueBounds &fb) {
-    return boxes_touched(Expr(), s, true, true, "", scope, fb);
+map<string, Box> boxes_touched(Stmt s, const Scope<Interval> &scope, const FuncValueBounds &fb, bool precise) {
+    return boxes_touched(Expr(), s, true, true, "", scope, fb, precise);
 }
 
-Box box_touched(Stmt s, string fn, const Scope<Interval> &scope, const FuncValueBounds &fb) {
-    return box_touched(Expr(), s, true, true, fn, scope, fb);
+Box box_touched(Stmt s, string fn, const Scope<Interval> &scope, const FuncValueBounds &fb, bool precise) {
+    return box_touched(Expr(), s, true, true, fn, scope, fb, precise);
 }
 
-void check(const Scope<Interval> &scope, Expr e, Expr correct_min, Expr correct_max) {
+void check(const Scope<Interval> &scope, Expr e, Expr correct_min, Expr correct_max, bool precise = false) {
     FuncValueBounds fb;
-    Interval result = bounds_of_expr_in_scope(e, scope, fb);
+    Interval result = bounds_of_expr_in_scope(e, scope, fb, precise);
     if (result.min.defined()) result.min = simplify(result.min);
     if (result.max.defined()) result.max = simplify(result.max);
     if (!equal(result.min, correct_min)) {
@@ -1378,6 +1650,13 @@ void bounds_test() {
     check(scope, y + (Let::make("y", x+3, y - x + 10)), y + 3, y + 23); // Once again, we don't know that y is correlated with x
     check(scope, clamp(1/(x-2), x-10, x+10), -10, 20);
 
+    // Precise bounds do understand correlated terms, and refine each
+    // side of a select using its condition.
+    check(scope, x*2 - x, 0, 10, true);
+    check(scope, x*3 + y - x*2, y, y + 10, true);
+    check(scope, Select::make(x < 5, x + 6, x - 5), 0, 10, true);
+    check(scope, Select::make(x < 5, x + 6, x - 5), -5, 16);
+
     check(scope, print(x, y), 0, 10);
     check(scope, print_when(x > y, x, y), 0, 10);
 
@@ -1427,6 +1706,28 @@ void bounds_test() {
     internal_assert(equal(simplify(r2[0].min), 4));
     internal_assert(equal(simplify(r2[0].max), 19));
 
+    // A wrap-around access that only precise bounds gets exactly.
+    Expr xv = Variable::make(Int(32), "x");
+    loop = For::make("x", 0, 10, ForType::Serial, DeviceAPI::Host,
+                     Provide::make("output",
+                                   vec<Expr>(Call::make(in, vec(Select::make(xv < 5, xv + 5, xv - 5)))),
+                                   vec(xv)));
+    r = boxes_required(loop, Scope<Interval>::empty_scope(), FuncValueBounds(), true);
+    internal_assert(equal(simplify(r["input"][0].min), 0));
+    internal_assert(equal(simplify(r["input"][0].max), 9));
+
+    // A long chain of selects whose branches share a subexpression
+    // shouldn't take time exponential in its length.
+    Expr chain = Call::make(in, vec(xv));
+    for (int i = 0; i < 40; i++) {
+        chain = Select::make(xv < i, chain + 1, chain * 2);
+    }
+    loop = For::make("x", 0, 10, ForType::Serial, DeviceAPI::Host,
+                     Provide::make("output", vec(chain), vec(xv)));
+    r = boxes_required(loop, Scope<Interval>::empty_scope(), FuncValueBounds(), true);
+    internal_assert(equal(simplify(r["input"][0].min), 0));
+    internal_assert(equal(simplify(r["input"][0].max), 9));
+
     std::cout << "Bounds test passed" << std::endl;
 }
 
@@ -29,10 +29,20 @@ typedef std::map<std::pair<std::string, int>, Interval> FuncValueBounds;
  *
  * This is for tasks such as deducing the region of a buffer
  * loaded by a chunk of code.
+ *
+ * If precise is true, the bounds of sums of constant multiples of
+ * variables are computed exactly, even when a variable appears more
+ * than once (e.g. x*2 - x), and each branch of a select is bounded
+ * using the ranges of the variables for which its condition holds
+ * (e.g. x in select(x < 0, x + w, x) is at least zero in the false
+ * branch). Anything else falls back to interval arithmetic. This is
+ * slower, so it's only used when the target has the PreciseBounds
+ * feature.
  */
 Interval bounds_of_expr_in_scope(Expr expr,
                                  const Scope<Interval> &scope,
-                                 const FuncValueBounds &func_bounds = FuncValueBounds());
+                                 const FuncValueBounds &func_bounds = FuncValueBounds(),
+                                 bool precise = false);
 
 /** Represents the bounds of a region of arbitrary dimension. Zero
  * dimensions corresponds to a scalar region. */
@@ -66,14 +76,21 @@ bool boxes_overlap(const Box &a, const Box &b);
 /** Compute rectangular domains large enough to cover all the 'Call's
  * to each function that occurs within a given statement or
  * expression. This is useful for figuring out what regions of things
- * to evaluate. */
+ * to evaluate. If precise is true, the bounds of the args of each
+ * call are computed as in bounds_of_expr_in_scope, and calls in a
+ * branch of a select or if statement only touch the region for which
+ * the condition holds. The result is still one box per function, so
+ * a footprint that couples dimensions (e.g. a shear like f(x + y, y),
+ * or a diagonal) is covered by its bounding box either way. */
 // @{
 std::map<std::string, Box> boxes_required(Expr e,
                                           const Scope<Interval> &scope = Scope<Interval>::empty_scope(),
-                                          const FuncValueBounds &func_bounds = FuncValueBounds());
+                                          const FuncValueBounds &func_bounds = FuncValueBounds(),
+                                          bool precise = false);
 std::map<std::string, Box> boxes_required(Stmt s,
                                           const Scope<Interval> &scope = Scope<Interval>::empty_scope(),
-                                          const FuncValueBounds &func_bounds = FuncValueBounds());
+                                          const FuncValueBounds &func_bounds = FuncValueBounds(),
+                                          bool precise = false);
 // @}
 
 /** Compute rectangular domains large enough to cover all the
@@ -82,10 +99,12 @@ std::map<std::string, Box> boxes_required(Stmt s,
 // @{
 std::map<std::string, Box> boxes_provided(Expr e,
                                           const Scope<Interval> &scope = Scope<Interval>::empty_scope(),
-                                          const FuncValueBounds &func_bounds = FuncValueBounds());
+                                          const FuncValueBounds &func_bounds = FuncValueBounds(),
+                                          bool precise = false);
 std::map<std::string, Box> boxes_provided(Stmt s,
                                           const Scope<Interval> &scope = Scope<Interval>::empty_scope(),
-                                          const FuncValueBounds &func_bounds = FuncValueBounds());
+                                          const FuncValueBounds &func_bounds = FuncValueBounds(),
+                                          bool precise = false);
 // @}
 
 /** Compute rectangular domains large enough to cover all the 'Call's
@@ -94,34 +113,42 @@ std::map<std::string, Box> boxes_provided(Stmt s,
 // @{
 std::map<std::string, Box> boxes_touched(Expr e,
                                          const Scope<Interval> &scope = Scope<Interval>::empty_scope(),
-                                         const FuncValueBounds &func_bounds = FuncValueBounds());
+                                         const FuncValueBounds &func_bounds = FuncValueBounds(),
+                                         bool precise = false);
 std::map<std::string, Box> boxes_touched(Stmt s,
                                          const Scope<Interval> &scope = Scope<Interval>::empty_scope(),
-                                         const FuncValueBounds &func_bounds = FuncValueBounds());
+                                         const FuncValueBounds &func_bounds = FuncValueBounds(),
+                                         bool precise = false);
 // @}
 
 /** Variants of the above that are only concerned with a single function. */
 // @{
 Box box_required(Expr e, std::string fn,
                  const Scope<Interval> &scope = Scope<Interval>::empty_scope(),
-                 const FuncValueBounds &func_bounds = FuncValueBounds());
+                 const FuncValueBounds &func_bounds = FuncValueBounds(),
+                 bool precise = false);
 Box box_required(Stmt s, std::string fn,
                  const Scope<Interval> &scope = Scope<Interval>::empty_scope(),
-                 const FuncValueBounds &func_bounds = FuncValueBounds());
+                 const FuncValueBounds &func_bounds = FuncValueBounds(),
+                 bool precise = false);
 
 Box box_provided(Expr e, std::string fn,
                  const Scope<Interval> &scope = Scope<Interval>::empty_scope(),
-                 const FuncValueBounds &func_bounds = FuncValueBounds());
+                 const FuncValueBounds &func_bounds = FuncValueBounds(),
+                 bool precise = false);
 Box box_provided(Stmt s, std::string fn,
                  const Scope<Interval> &scope = Scope<Interval>::empty_scope(),
-                 const FuncValueBounds &func_bounds = FuncValueBounds());
+                 const FuncValueBounds &func_bounds = FuncValueBounds(),
+                 bool precise = false);
 
 Box box_touched(Expr e, std::string fn,
                 const Scope<Interval> &scope = Scope<Interval>::empty_scope(),
-                const FuncValueBounds &func_bounds = FuncValueBounds());
+                const FuncValueBounds &func_bounds = FuncValueBounds(),
+                bool precise = false);
 Box box_touched(Stmt s, std::string fn,
                 const Scope<Interval> &scope = Scope<Interval>::empty_scope(),
-                const FuncValueBounds &func_bounds = FuncValueBounds());
+                const FuncValueBounds &func_bounds = FuncValueBounds(),
+                bool precise = false);
 // @}
 
 /** Compute the maximum and minimum possible value for each function
@@ -4,6 +4,7 @@
 #include "Bounds.h"
 #include "IROperator.h"
 #include "Inline.h"
+#include "Simplify.h"
 
 namespace Halide {
 namespace Internal {
@@ -101,12 +102,52 @@ Interval bounds_of_inner_var(string var, Stmt s) {
     return b.result;
 }
 
+/** An extern stage split into tiles has no Provide. Instead, it
+ * makes a buffer_t describing each tile, and passes it to the extern
+ * function. Replace each of those with Provides to the first and
+ * last sites of the tile, so that box_provided can find it. */
+class ExternTileRegions : public IRMutator {
+    Function func;
+
+    using IRMutator::visit;
+
+    void visit(const LetStmt *op) {
+        const Call *buf = op->value.as<Call>();
+        const Call *addr = buf ? buf->args[0].as<Call>() : NULL;
+        const Call *site = addr ? addr->args[0].as<Call>() : NULL;
+        if (!buf || buf->name != Call::create_buffer_t ||
+            addr->name != Call::address_of ||
+            !site || site->name != func.name()) {
+            IRMutator::visit(op);
+            return;
+        }
+
+        // The args after the host pointer and element size are the
+        // min, extent, and stride of each dimension.
+        vector<Expr> first, last, values(func.outputs());
+        for (int k = 0; k < func.dimensions(); k++) {
+            Expr min = buf->args[2 + 3*k], extent = buf->args[3 + 3*k];
+            first.push_back(min);
+            last.push_back(simplify(min + extent - 1));
+        }
+        for (int j = 0; j < func.outputs(); j++) {
+            values[j] = make_zero(func.output_types()[j]);
+        }
+        stmt = Block::make(Provide::make(func.name(), values, first),
+                           Provide::make(func.name(), values, last));
+    }
+
+public:
+    ExternTileRegions(Function f) : func(f) {}
+};
+
 }
 
 class BoundsInference : public IRMutator {
 public:
     const vector<Function> &funcs;
     const FuncValueBounds &func_bounds;
+    bool precise;
     set<string> in_pipeline, inner_productions;
     Scope<int> in_stages;
 
@@ -417,8 +458,9 @@ public:
     vector<Stage> stages;
 
     BoundsInference(const vector<Function> &f,
-                    const FuncValueBounds &fb) :
-        funcs(f), func_bounds(fb) {
+                    const FuncValueBounds &fb,
+                    bool p) :
+        funcs(f), func_bounds(fb), precise(p) {
         internal_assert(!f.empty());
         Function output_function = f[f.size()-1];
 
@@ -533,7 +575,7 @@ public:
             } else {
                 const vector<Expr> &exprs = consumer.exprs;
                 for (size_t j = 0; j < exprs.size(); j++) {
-                    map<string, Box> new_boxes = boxes_required(exprs[j], scope, func_bounds);
+                    map<string, Box> new_boxes = boxes_required(exprs[j], scope, func_bounds, precise);
                     for (const pair<string, Box> &i : new_boxes) {
                         merge_boxes(boxes[i.first], i.second);
                     }
@@ -660,7 +702,13 @@ public:
         Box box;
         if (!no_pipelines && producing >= 0) {
             Scope<Interval> empty_scope;
-            box = box_provided(body, stages[producing].name, empty_scope, func_bounds);
+            Stmt provides = body;
+            if (f.has_extern_definition()) {
+                // The buffer_t for the tile may be in one of the lets
+                // we walked inside of.
+                provides = ExternTileRegions(f).mutate(op->body);
+            }
+            box = box_provided(provides, stages[producing].name, empty_scope, func_bounds, precise);
             internal_assert((int)box.size() == f.dimensions());
         }
 
@@ -694,6 +742,14 @@ public:
             // Finally, define the production bounds for the thing
             // we're producing.
             if (producing >= 0 && !inner_productions.empty()) {
+                // If this is a loop over the tiles of an extern
+                // stage, ask the extern function what it needs of
+                // its inputs for just the tiles inside this loop, so
+                // that the producers computed here only cover those.
+                if (f.has_extern_definition()) {
+                    body = stages[producing].do_bounds_query(body, in_pipeline);
+                }
+
                 for (size_t i = 0; i < box.size(); i++) {
                     internal_assert(box[i].min.defined() && box[i].max.defined());
                     string var = stage_name + "." + f.args()[i];
@@ -774,7 +830,8 @@ public:
 
 Stmt bounds_inference(Stmt s, const vector<string> &order,
                       const map<string, Function> &env,
-                      const FuncValueBounds &func_bounds) {
+                      const FuncValueBounds &func_bounds,
+                      bool precise) {
 
     vector<Function> funcs(order.size());
     for (size_t i = 0; i < order.size(); i++) {
@@ -783,7 +840,7 @@ Stmt bounds_inference(Stmt s, const vector<string> &order,
 
     // Add an outermost bounds inference marker
     s = For::make("<outermost>", 0, 1, ForType::Serial, DeviceAPI::Parent, s);
-    s = BoundsInference(funcs, func_bounds).mutate(s);
+    s = BoundsInference(funcs, func_bounds, precise).mutate(s);
     return s.as<For>()->body;
 }
 
@@ -27,6 +27,12 @@ struct BufferContents {
      * NULL. */
     uint8_t *allocation;
 
+    /** If the memory belongs to someone else who wants to know when
+     * this buffer dies, this is called with release_arg at that
+     * point. Otherwise it's NULL. */
+    void (*release)(void *);
+    void *release_arg;
+
     /** How many Buffer objects point to this BufferContents */
     mutable RefCount ref_count;
 
@@ -35,7 +41,8 @@ struct BufferContents {
 
     BufferContents(Type t, int x_size, int y_size, int z_size, int w_size,
                    uint8_t* data, const std::string &n) :
-        type(t), allocation(NULL), name(n.empty() ? unique_name('b') : n) {
+        type(t), allocation(NULL), release(NULL), release_arg(NULL),
+        name(n.empty() ? unique_name('b') : n) {
         user_assert(t.width == 1) << "Can't create of a buffer of a vector type";
         buf.elem_size = t.bytes();
         uint64_t size = 1;
@@ -86,7 +93,8 @@ struct BufferContents {
     }
 
     BufferContents(Type t, const buffer_t *b, const std::string &n) :
-        type(t), allocation(NULL), name(n.empty() ? unique_name('b') : n) {
+        type(t), allocation(NULL), release(NULL), release_arg(NULL),
+        name(n.empty() ? unique_name('b') : n) {
         buf = *b;
         user_assert(t.width == 1) << "Can't create of a buffer of a vector type";
     }
@@ -102,6 +110,9 @@ EXPORT void destroy<BufferContents>(const BufferContents *p) {
     int error = halide_device_free(NULL, const_cast<buffer_t *>(&p->buf));
     user_assert(!error) << "Failed to free device buffer\n";
     free(p->allocation);
+    if (p->release) {
+        p->release(p->release_arg);
+    }
 
     delete p;
 }
@@ -145,6 +156,15 @@ Buffer::Buffer(Type t, const buffer_t *buf, const std::string &name) :
                                           make_buffer_name(name, this))) {
 }
 
+Buffer::Buffer(Type t, const buffer_t *buf,
+               void (*release)(void *), void *release_arg,
+               const std::string &name) :
+    contents(new Internal::BufferContents(t, buf,
+                                          make_buffer_name(name, this))) {
+    contents.ptr->release = release;
+    contents.ptr->release_arg = release_arg;
+}
+
 void *Buffer::host_ptr() const {
     user_assert(defined()) << "Buffer is undefined\n";
     return (void *)contents.ptr->buf.host;
@@ -42,6 +42,14 @@ public:
 
     EXPORT Buffer(Type t, const buffer_t *buf, const std::string &name = "");
 
+    /** Make a Buffer that aliases memory owned by someone else, as
+     * described by buf. When the last reference to the Buffer dies,
+     * release(release_arg) is called, so the owner can keep the
+     * memory alive until then. */
+    EXPORT Buffer(Type t, const buffer_t *buf,
+                  void (*release)(void *), void *release_arg,
+                  const std::string &name = "");
+
     /** Get a pointer to the host-side memory. */
     EXPORT void *host_ptr() const;
 
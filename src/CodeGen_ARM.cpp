@@ -9,6 +9,7 @@
 #include "Util.h"
 #include "Simplify.h"
 #include "IntegerDivisionTable.h"
+#include "FixedPoint.h"
 #include "IRPrinter.h"
 #include "LLVM_Headers.h"
 
@@ -368,6 +369,120 @@ CodeGen_ARM::CodeGen_ARM(Target t) : CodeGen_Posix(t) {
         negations.push_back(Pattern("vqneg.v16i8", 16, -max(wild_i8x_, -127)));
         negations.push_back(Pattern("vqneg.v8i16", 8,  -max(wild_i16x_, -32767)));
         negations.push_back(Pattern("vqneg.v4i32", 4,  -max(wild_i32x_, -(0x7fffffff))));
+    } else {
+        // AArch64. The instructions are mostly the same as on 32-bit
+        // ARM, but the intrinsics are named after the new
+        // mnemonics, with the signedness as a prefix instead of a
+        // suffix. We only use the 128-bit versions; call_intrin pads
+        // narrower vectors.
+        Type types[] = {Int(8, 16), UInt(8, 16), Int(16, 8), UInt(16, 8), Int(32, 4), UInt(32, 4)};
+        for (size_t i = 0; i < sizeof(types)/sizeof(types[0]); i++) {
+            Type t = types[i];
+
+            int intrin_width = t.width;
+            std::ostringstream oss;
+            oss << ".v" << intrin_width << "i" << t.bits;
+            string t_str = oss.str();
+            string sign = t.is_int() ? "s" : "u";
+
+            // Match any vector width.
+            t.width = -1;
+
+            Type w = t;
+            w.bits *= 2;
+            Type ws = Int(t.bits*2, t.width);
+
+            Expr w_vector = Variable::make(w, "*");
+            Expr ws_vector = Variable::make(ws, "*");
+
+            Expr tmin = simplify(cast(w, t.imin()));
+            Expr tmax = simplify(cast(w, t.imax()));
+            Expr tsmin = simplify(cast(ws, t.imin()));
+            Expr tsmax = simplify(cast(ws, t.imax()));
+            if (t.element_of() == UInt(32)) {
+                tmax = simplify(cast(w, t.max()));
+                tsmax = simplify(cast(ws, t.max()));
+            }
+
+            Pattern p = aarch64_pattern("", intrin_width, Expr(), Pattern::NarrowArgs);
+
+            p.intrin = "llvm.aarch64.neon." + sign + "rhadd" + t_str;
+            p.pattern = cast(t, (w_vector + w_vector + 1)/2);
+            casts.push_back(p);
+            p.pattern = cast(t, (w_vector + (w_vector + 1))/2);
+            casts.push_back(p);
+            p.pattern = cast(t, ((w_vector + 1) + w_vector)/2);
+            casts.push_back(p);
+
+            p.intrin = "llvm.aarch64.neon." + sign + "hadd" + t_str;
+            p.pattern = cast(t, (w_vector + w_vector)/2);
+            casts.push_back(p);
+
+            p.intrin = "llvm.aarch64.neon." + sign + "hsub" + t_str;
+            p.pattern = cast(t, (w_vector - w_vector)/2);
+            casts.push_back(p);
+
+            p.intrin = "llvm.aarch64.neon." + sign + "qadd" + t_str;
+            p.pattern = cast(t, clamp(w_vector + w_vector, tmin, tmax));
+            casts.push_back(p);
+            if (t.is_uint()) {
+                p.pattern = cast(t, min(w_vector + w_vector, tmax));
+                casts.push_back(p);
+            }
+
+            p.intrin = "llvm.aarch64.neon." + sign + "qsub" + t_str;
+            p.pattern = cast(t, clamp(ws_vector - ws_vector, tsmin, tsmax));
+            casts.push_back(p);
+            if (t.is_uint()) {
+                p.pattern = cast(t, max(ws_vector - ws_vector, 0));
+                casts.push_back(p);
+            }
+
+            // Halving adds and subtracts of values already of this type.
+            Expr vector = Variable::make(t, "*");
+            averagings.push_back(aarch64_pattern(sign + "hadd" + t_str, intrin_width, vector + vector));
+            averagings.push_back(aarch64_pattern(sign + "hsub" + t_str, intrin_width, vector - vector));
+
+            if (t.is_int()) {
+                // Saturating negation
+                negations.push_back(aarch64_pattern("sqneg" + t_str, intrin_width, -max(vector, t.imin() + 1)));
+            }
+        }
+
+        // Saturating narrowing right shifts. The shift amount is an
+        // immediate. These must come before the saturating
+        // narrowing casts below, which would otherwise match them.
+        casts.push_back(aarch64_pattern("sqshrn.v8i8",  8,  _i8q(wild_i16x_/wild_i16x_), Pattern::RightShift));
+        casts.push_back(aarch64_pattern("sqshrn.v4i16", 4, _i16q(wild_i32x_/wild_i32x_), Pattern::RightShift));
+        casts.push_back(aarch64_pattern("sqshrn.v2i32", 2, _i32q(wild_i64x_/wild_i64x_), Pattern::RightShift));
+        casts.push_back(aarch64_pattern("uqshrn.v8i8",  8,  _u8q(wild_u16x_/wild_u16x_), Pattern::RightShift));
+        casts.push_back(aarch64_pattern("uqshrn.v4i16", 4, _u16q(wild_u32x_/wild_u32x_), Pattern::RightShift));
+        casts.push_back(aarch64_pattern("uqshrn.v2i32", 2, _u32q(wild_u64x_/wild_u64x_), Pattern::RightShift));
+        casts.push_back(aarch64_pattern("sqshrun.v8i8",  8,  _u8q(wild_i16x_/wild_i16x_), Pattern::RightShift));
+        casts.push_back(aarch64_pattern("sqshrun.v4i16", 4, _u16q(wild_i32x_/wild_i32x_), Pattern::RightShift));
+        casts.push_back(aarch64_pattern("sqshrun.v2i32", 2, _u32q(wild_i64x_/wild_i64x_), Pattern::RightShift));
+
+        // Saturating left shifts
+        casts.push_back(aarch64_pattern("sqshl.v16i8", 16, _i8q(_i16(wild_i8x_)*wild_i16x_), Pattern::LeftShift));
+        casts.push_back(aarch64_pattern("sqshl.v8i16",  8, _i16q(_i32(wild_i16x_)*wild_i32x_), Pattern::LeftShift));
+        casts.push_back(aarch64_pattern("sqshl.v4i32",  4, _i32q(_i64(wild_i32x_)*wild_i64x_), Pattern::LeftShift));
+        casts.push_back(aarch64_pattern("uqshl.v16i8", 16, _u8q(_u16(wild_u8x_)*wild_u16x_), Pattern::LeftShift));
+        casts.push_back(aarch64_pattern("uqshl.v8i16",  8, _u16q(_u32(wild_u16x_)*wild_u32x_), Pattern::LeftShift));
+        casts.push_back(aarch64_pattern("uqshl.v4i32",  4, _u32q(_u64(wild_u32x_)*wild_u64x_), Pattern::LeftShift));
+        casts.push_back(aarch64_pattern("sqshlu.v16i8", 16, _u8q(_i16(wild_i8x_)*wild_i16x_), Pattern::LeftShift));
+        casts.push_back(aarch64_pattern("sqshlu.v8i16",  8, _u16q(_i32(wild_i16x_)*wild_i32x_), Pattern::LeftShift));
+        casts.push_back(aarch64_pattern("sqshlu.v4i32",  4, _u32q(_i64(wild_i32x_)*wild_i64x_), Pattern::LeftShift));
+
+        // Saturating narrowing
+        casts.push_back(aarch64_pattern("sqxtn.v8i8",   8,  _i8q(wild_i16x_)));
+        casts.push_back(aarch64_pattern("sqxtn.v4i16",  4, _i16q(wild_i32x_)));
+        casts.push_back(aarch64_pattern("sqxtn.v2i32",  2, _i32q(wild_i64x_)));
+        casts.push_back(aarch64_pattern("uqxtn.v8i8",   8,  _u8q(wild_u16x_)));
+        casts.push_back(aarch64_pattern("uqxtn.v4i16",  4, _u16q(wild_u32x_)));
+        casts.push_back(aarch64_pattern("uqxtn.v2i32",  2, _u32q(wild_u64x_)));
+        casts.push_back(aarch64_pattern("sqxtun.v8i8",  8,  _u8q(wild_i16x_)));
+        casts.push_back(aarch64_pattern("sqxtun.v4i16", 4, _u16q(wild_i32x_)));
+        casts.push_back(aarch64_pattern("sqxtun.v2i32", 2, _u32q(wild_i64x_)));
     }
 }
 
@@ -528,13 +643,16 @@ void CodeGen_ARM::visit(const Cast *op) {
                 int shift_amount;
                 bool power_of_two = is_const_power_of_two(constant, &shift_amount);
                 if (power_of_two && shift_amount < matches[0].type().bits) {
-                    if (pattern.type == Pattern::RightShift) {
-                        shift_amount = -shift_amount;
+                    Value *shift = NULL;
+                    if (pattern.type == Pattern::RightShift && target.bits == 64) {
+                        // AArch64 narrowing shifts take an immediate.
+                        shift = ConstantInt::get(i32, shift_amount);
+                    } else if (pattern.type == Pattern::RightShift) {
+                        shift = ConstantInt::get(llvm_type_of(matches[0].type()), -shift_amount);
                     } else {
                         internal_assert(pattern.type == Pattern::LeftShift);
+                        shift = ConstantInt::get(llvm_type_of(matches[0].type()), shift_amount);
                     }
-                    Value *shift = ConstantInt::get(llvm_type_of(matches[0].type()),
-                                                    shift_amount);
                     value = call_intrin(llvm_type_of(t),
                                         pattern.intrin_width,
                                         pattern.intrin,
@@ -546,6 +664,55 @@ void CodeGen_ARM::visit(const Cast *op) {
     }
 
 
+    // AArch64 has rounding narrowing shifts, with and without
+    // saturation.
+    if (target.bits == 64 && t.is_vector() && (t.is_int() || t.is_uint()) &&
+        op->value.type().bits == t.bits * 2) {
+        Type wide = op->value.type();
+        Expr narrowed = op->value;
+        string intrin = "rshrn";
+        const Min *mn = narrowed.as<Min>();
+        const Max *mx = narrowed.as<Max>();
+        if (t.bits == 32) {
+            // The clamp bounds for 32-bit results don't fit in an int,
+            // so we only match the plain narrowing form.
+        } else if (mn) {
+            // Saturating unsigned narrowing of an unsigned value.
+            if (t.is_uint() && wide.is_uint() && is_const(mn->b, t.imax())) {
+                narrowed = mn->a;
+                intrin = "uqrshrn";
+            }
+        } else if (mx) {
+            // Saturating narrowing of a signed value.
+            mn = mx->a.as<Min>();
+            if (mn && wide.is_int() && t.is_int() &&
+                is_const(mx->b, t.imin()) && is_const(mn->b, t.imax())) {
+                narrowed = mn->a;
+                intrin = "sqrshrn";
+            } else if (mn && wide.is_int() && t.is_uint() &&
+                       is_const(mx->b, 0) && is_const(mn->b, t.imax())) {
+                narrowed = mn->a;
+                intrin = "sqrshrun";
+            }
+        }
+
+        const Call *c = narrowed.as<Call>();
+        int shift = 0;
+        if (c && c->name == Call::rounding_shift_right && c->call_type == Call::Intrinsic) {
+            const int *s = as_const_int(c->args[1]);
+            const Broadcast *b = c->args[1].as<Broadcast>();
+            if (!s && b) s = as_const_int(b->value);
+            if (s) shift = *s;
+        }
+        if (shift >= 1 && shift <= t.bits) {
+            ostringstream ss;
+            ss << "llvm.aarch64.neon." << intrin << ".v" << (64 / t.bits) << "i" << t.bits;
+            value = call_intrin(llvm_type_of(t), 64 / t.bits, ss.str(),
+                                vec(codegen(c->args[0]), (Value *)ConstantInt::get(i32, shift)));
+            return;
+        }
+    }
+
     // Catch extract-high-half-of-signed integer pattern and convert
     // it to extract-high-half-of-unsigned-integer. llvm peephole
     // optimization recognizes logical shift right but not arithemtic
@@ -634,6 +801,30 @@ void CodeGen_ARM::visit(const Mul *op) {
         }
     }
 
+    // AArch64 widening multiplies. llvm folds an add of the result
+    // into smlal/umlal.
+    Type t = op->type;
+    if (target.bits == 64 && (t.bits == 16 || t.bits == 32 || t.bits == 64)) {
+        Type narrow = t.is_int() ? Int(t.bits / 2, t.width) : UInt(t.bits / 2, t.width);
+        Expr a = try_narrow(op->a, narrow);
+        Expr b = try_narrow(op->b, narrow);
+        if (!a.defined() || !b.defined()) {
+            // A signed multiply of unsigned values may still be done
+            // with an unsigned widening multiply.
+            narrow = UInt(t.bits / 2, t.width);
+            a = try_narrow(op->a, narrow);
+            b = try_narrow(op->b, narrow);
+        }
+        if (a.defined() && b.defined()) {
+            ostringstream ss;
+            int intrin_width = 128 / t.bits;
+            ss << "llvm.aarch64.neon." << (narrow.is_int() ? "smull" : "umull")
+               << ".v" << intrin_width << "i" << t.bits;
+            value = call_intrin(t, intrin_width, ss.str(), vec(a, b));
+            return;
+        }
+    }
+
     CodeGen_Posix::visit(op);
 }
 
@@ -792,11 +983,11 @@ void CodeGen_ARM::visit(const Div *op) {
         // Average with original numerator
         if (method == 2) {
             if (op->type.bits == 32) {
-                val = call_intrin(narrower, 2, "llvm.arm.neon.vhaddu.v2i32", vec(val, num));
+                val = call_intrin(narrower, 2, neon_intrinsic("vhaddu.v2i32", "uhadd.v2i32"), vec(val, num));
             } else if (op->type.bits == 16) {
-                val = call_intrin(narrower, 4, "llvm.arm.neon.vhaddu.v4i16", vec(val, num));
+                val = call_intrin(narrower, 4, neon_intrinsic("vhaddu.v4i16", "uhadd.v4i16"), vec(val, num));
             } else if (op->type.bits == 8) {
-                val = call_intrin(narrower, 8, "llvm.arm.neon.vhaddu.v8i8", vec(val, num));
+                val = call_intrin(narrower, 8, neon_intrinsic("vhaddu.v8i8", "uhadd.v8i8"), vec(val, num));
             } else {
                 // num > val, so the following works without widening:
                 // val += (num - val)/2
@@ -819,9 +1010,90 @@ void CodeGen_ARM::visit(const Div *op) {
 }
 
 void CodeGen_ARM::visit(const Add *op) {
+    if (target.bits == 64 && !neon_intrinsics_disabled() &&
+        visit_pairwise_add(op)) {
+        return;
+    }
+
     CodeGen_Posix::visit(op);
 }
 
+bool CodeGen_ARM::visit_pairwise_add(const Add *op) {
+    // Look for the sum of the even and odd lanes of a dense vector,
+    // optionally widened, which is addp, saddlp, or uaddlp.
+    Type t = op->type;
+    if (!t.is_vector() || !(t.is_int() || t.is_uint())) {
+        return false;
+    }
+
+    Expr a = op->a, b = op->b;
+    bool widening = false;
+    const Cast *cast_a = a.as<Cast>(), *cast_b = b.as<Cast>();
+    if (cast_a && cast_b &&
+        cast_a->value.type() == cast_b->value.type() &&
+        cast_a->value.type().bits * 2 == t.bits) {
+        a = cast_a->value;
+        b = cast_b->value;
+        widening = true;
+    }
+
+    const Load *load_a = a.as<Load>(), *load_b = b.as<Load>();
+    if (!load_a || !load_b || load_a->name != load_b->name) {
+        return false;
+    }
+    const Ramp *ramp_a = load_a->index.as<Ramp>(), *ramp_b = load_b->index.as<Ramp>();
+    if (!ramp_a || !ramp_b || !is_two(ramp_a->stride) || !is_two(ramp_b->stride)) {
+        return false;
+    }
+    Expr delta = simplify(ramp_b->base - ramp_a->base);
+    if (is_const(delta, -1)) {
+        std::swap(load_a, load_b);
+        std::swap(ramp_a, ramp_b);
+    } else if (!is_one(delta)) {
+        return false;
+    }
+
+    Type src = load_a->type;
+    if (!(src.is_int() || src.is_uint()) ||
+        !(src.bits == 8 || src.bits == 16 || src.bits == 32)) {
+        return false;
+    }
+
+    // The number of output lanes per instruction.
+    int n = 128 / t.bits;
+    if (t.width % n != 0) {
+        return false;
+    }
+
+    // The even and odd lanes together are a dense load.
+    Type dense_t = src;
+    dense_t.width = t.width * 2;
+    Expr dense = Load::make(dense_t, load_a->name,
+                            Ramp::make(ramp_a->base, 1, dense_t.width),
+                            load_a->image, load_a->param);
+    Value *v = codegen(dense);
+
+    llvm::Type *result_t = VectorType::get(llvm_type_of(t.element_of()), n);
+    vector<Value *> results;
+    for (int i = 0; i < t.width; i += n) {
+        ostringstream ss;
+        if (widening) {
+            ss << "llvm.aarch64.neon." << (src.is_int() ? "saddlp" : "uaddlp")
+               << ".v" << n << "i" << t.bits
+               << ".v" << n * 2 << "i" << src.bits;
+            results.push_back(call_intrin(result_t, n, ss.str(),
+                                          vec(slice_vector(v, i * 2, n * 2))));
+        } else {
+            ss << "llvm.aarch64.neon.addp.v" << n << "i" << t.bits;
+            results.push_back(call_intrin(result_t, n, ss.str(),
+                                          vec(slice_vector(v, i * 2, n),
+                                              slice_vector(v, i * 2 + n, n))));
+        }
+    }
+    value = concat_vectors(results);
+    return true;
+}
+
 void CodeGen_ARM::visit(const Sub *op) {
     // AArch64 SIMD not yet supported
     if (neon_intrinsics_disabled()) {
@@ -870,7 +1142,7 @@ void CodeGen_ARM::visit(const Min *op) {
         return;
     }
 
-    if (op->type == Float(32)) {
+    if (op->type == Float(32) && target.bits == 32) {
         // Use a 2-wide vector instead
         Value *undef = UndefValue::get(f32x2);
         Constant *zero = ConstantInt::get(i32, 0);
@@ -881,24 +1153,27 @@ void CodeGen_ARM::visit(const Min *op) {
         return;
     }
 
+    // The names of the intrinsics on 32-bit ARM and on AArch64, minus
+    // the prefix. NULL means there is no 32-bit version.
     struct {
         Type t;
-        const char *op;
+        const char *arm32, *arm64;
     } patterns[] = {
-        {UInt(8, 8), "llvm.arm.neon.vminu.v8i8"},
-        {UInt(16, 4), "llvm.arm.neon.vminu.v4i16"},
-        {UInt(32, 2), "llvm.arm.neon.vminu.v2i32"},
-        {Int(8, 8), "llvm.arm.neon.vmins.v8i8"},
-        {Int(16, 4), "llvm.arm.neon.vmins.v4i16"},
-        {Int(32, 2), "llvm.arm.neon.vmins.v2i32"},
-        {Float(32, 2), "llvm.arm.neon.vmins.v2f32"},
-        {UInt(8, 16), "llvm.arm.neon.vminu.v16i8"},
-        {UInt(16, 8), "llvm.arm.neon.vminu.v8i16"},
-        {UInt(32, 4), "llvm.arm.neon.vminu.v4i32"},
-        {Int(8, 16), "llvm.arm.neon.vmins.v16i8"},
-        {Int(16, 8), "llvm.arm.neon.vmins.v8i16"},
-        {Int(32, 4), "llvm.arm.neon.vmins.v4i32"},
-        {Float(32, 4), "llvm.arm.neon.vmins.v4f32"}
+        {UInt(8, 8), "vminu.v8i8", "umin.v8i8"},
+        {UInt(16, 4), "vminu.v4i16", "umin.v4i16"},
+        {UInt(32, 2), "vminu.v2i32", "umin.v2i32"},
+        {Int(8, 8), "vmins.v8i8", "smin.v8i8"},
+        {Int(16, 4), "vmins.v4i16", "smin.v4i16"},
+        {Int(32, 2), "vmins.v2i32", "smin.v2i32"},
+        {Float(32, 2), "vmins.v2f32", "fmin.v2f32"},
+        {UInt(8, 16), "vminu.v16i8", "umin.v16i8"},
+        {UInt(16, 8), "vminu.v8i16", "umin.v8i16"},
+        {UInt(32, 4), "vminu.v4i32", "umin.v4i32"},
+        {Int(8, 16), "vmins.v16i8", "smin.v16i8"},
+        {Int(16, 8), "vmins.v8i16", "smin.v8i16"},
+        {Int(32, 4), "vmins.v4i32", "smin.v4i32"},
+        {Float(32, 4), "vmins.v4f32", "fmin.v4f32"},
+        {Float(64, 2), NULL, "fmin.v2f64"}
     };
 
     for (size_t i = 0; i < sizeof(patterns)/sizeof(patterns[0]); i++) {
@@ -909,8 +1184,15 @@ void CodeGen_ARM::visit(const Min *op) {
             match = match || (op->type.element_of() == patterns[i].t.element_of());
         }
 
+        if (target.bits == 32 && !patterns[i].arm32) {
+            match = false;
+        }
+
         if (match) {
-            value = call_intrin(op->type, patterns[i].t.width, patterns[i].op, vec(op->a, op->b));
+            string intrin = (target.bits == 32 ?
+                             string("llvm.arm.neon.") + patterns[i].arm32 :
+                             string("llvm.aarch64.neon.") + patterns[i].arm64);
+            value = call_intrin(op->type, patterns[i].t.width, intrin, vec(op->a, op->b));
             return;
         }
     }
@@ -925,7 +1207,7 @@ void CodeGen_ARM::visit(const Max *op) {
         return;
     }
 
-    if (op->type == Float(32)) {
+    if (op->type == Float(32) && target.bits == 32) {
         // Use a 2-wide vector instead
         Value *undef = UndefValue::get(f32x2);
         Constant *zero = ConstantInt::get(i32, 0);
@@ -936,24 +1218,27 @@ void CodeGen_ARM::visit(const Max *op) {
         return;
     }
 
+    // The names of the intrinsics on 32-bit ARM and on AArch64, minus
+    // the prefix. NULL means there is no 32-bit version.
     struct {
         Type t;
-        const char *op;
+        const char *arm32, *arm64;
     } patterns[] = {
-        {UInt(8, 8), "llvm.arm.neon.vmaxu.v8i8"},
-        {UInt(16, 4), "llvm.arm.neon.vmaxu.v4i16"},
-        {UInt(32, 2), "llvm.arm.neon.vmaxu.v2i32"},
-        {Int(8, 8), "llvm.arm.neon.vmaxs.v8i8"},
-        {Int(16, 4), "llvm.arm.neon.vmaxs.v4i16"},
-        {Int(32, 2), "llvm.arm.neon.vmaxs.v2i32"},
-        {Float(32, 2), "llvm.arm.neon.vmaxs.v2f32"},
-        {UInt(8, 16), "llvm.arm.neon.vmaxu.v16i8"},
-        {UInt(16, 8), "llvm.arm.neon.vmaxu.v8i16"},
-        {UInt(32, 4), "llvm.arm.neon.vmaxu.v4i32"},
-        {Int(8, 16), "llvm.arm.neon.vmaxs.v16i8"},
-        {Int(16, 8), "llvm.arm.neon.vmaxs.v8i16"},
-        {Int(32, 4), "llvm.arm.neon.vmaxs.v4i32"},
-        {Float(32, 4), "llvm.arm.neon.vmaxs.v4f32"}
+        {UInt(8, 8), "vmaxu.v8i8", "umax.v8i8"},
+        {UInt(16, 4), "vmaxu.v4i16", "umax.v4i16"},
+        {UInt(32, 2), "vmaxu.v2i32", "umax.v2i32"},
+        {Int(8, 8), "vmaxs.v8i8", "smax.v8i8"},
+        {Int(16, 4), "vmaxs.v4i16", "smax.v4i16"},
+        {Int(32, 2), "vmaxs.v2i32", "smax.v2i32"},
+        {Float(32, 2), "vmaxs.v2f32", "fmax.v2f32"},
+        {UInt(8, 16), "vmaxu.v16i8", "umax.v16i8"},
+        {UInt(16, 8), "vmaxu.v8i16", "umax.v8i16"},
+        {UInt(32, 4), "vmaxu.v4i32", "umax.v4i32"},
+        {Int(8, 16), "vmaxs.v16i8", "smax.v16i8"},
+        {Int(16, 8), "vmaxs.v8i16", "smax.v8i16"},
+        {Int(32, 4), "vmaxs.v4i32", "smax.v4i32"},
+        {Float(32, 4), "vmaxs.v4f32", "fmax.v4f32"},
+        {Float(64, 2), NULL, "fmax.v2f64"}
     };
 
     for (size_t i = 0; i < sizeof(patterns)/sizeof(patterns[0]); i++) {
@@ -964,8 +1249,15 @@ void CodeGen_ARM::visit(const Max *op) {
             match = match || (op->type.element_of() == patterns[i].t.element_of());
         }
 
+        if (target.bits == 32 && !patterns[i].arm32) {
+            match = false;
+        }
+
         if (match) {
-            value = call_intrin(op->type, patterns[i].t.width, patterns[i].op, vec(op->a, op->b));
+            string intrin = (target.bits == 32 ?
+                             string("llvm.arm.neon.") + patterns[i].arm32 :
+                             string("llvm.aarch64.neon.") + patterns[i].arm64);
+            value = call_intrin(op->type, patterns[i].t.width, intrin, vec(op->a, op->b));
             return;
         }
     }
@@ -1047,13 +1339,23 @@ void CodeGen_ARM::visit(const Store *op) {
 
         // Grab the function
         std::ostringstream instr;
-        instr << "llvm.arm.neon.vst" << num_vecs << ".v" << intrin_type.width;
-        if (t.is_float()) {
-            instr << "f" << t.bits;
+        char elt_code = t.is_float() ? 'f' : 'i';
+        llvm::Function *fn = NULL;
+        if (target.bits == 32) {
+            instr << "llvm.arm.neon.vst" << num_vecs << ".v" << intrin_type.width
+                  << elt_code << t.bits;
+            fn = module->getFunction(instr.str());
         } else {
-            instr << "i" << t.bits;
+            // The AArch64 versions take the vectors first, then a
+            // pointer to the element type, and no alignment.
+            instr << "llvm.aarch64.neon.st" << num_vecs << ".v" << intrin_type.width
+                  << elt_code << t.bits << ".p0" << elt_code << t.bits;
+            llvm::Type *vec_t = llvm_type_of(intrin_type);
+            vector<llvm::Type *> arg_types(num_vecs, vec_t);
+            arg_types.push_back(llvm_type_of(t.element_of())->getPointerTo());
+            FunctionType *fn_t = FunctionType::get(void_t, arg_types, false);
+            fn = dyn_cast<llvm::Function>(module->getOrInsertFunction(instr.str(), fn_t));
         }
-        llvm::Function *fn = module->getFunction(instr.str());
         internal_assert(fn);
 
         // How many vst instructions do we need to generate?
@@ -1064,16 +1366,22 @@ void CodeGen_ARM::visit(const Store *op) {
             Expr slice_base = simplify(ramp->base + i * num_vecs);
             Expr slice_ramp = Ramp::make(slice_base, ramp->stride, intrin_type.width);
             Value *ptr = codegen_buffer_pointer(op->name, call->args[0].type().element_of(), slice_base);
-            ptr = builder->CreatePointerCast(ptr, i8->getPointerTo());
 
             vector<Value *> slice_args = args;
-            slice_args[0] = ptr; // Set the pointer argument
-
             // Take a slice of each arg
             for (int j = 1; j < num_vecs + 1; j++) {
                 slice_args[j] = slice_vector(slice_args[j], i, intrin_type.width);
             }
 
+            if (target.bits == 32) {
+                // Set the pointer argument
+                slice_args[0] = builder->CreatePointerCast(ptr, i8->getPointerTo());
+            } else {
+                // The pointer goes last, and there's no alignment.
+                slice_args.erase(slice_args.begin());
+                slice_args.back() = ptr;
+            }
+
             CallInst *store = builder->CreateCall(fn, slice_args);
             add_tbaa_metadata(store, op->name, slice_ramp);
         }
@@ -1118,6 +1426,55 @@ void CodeGen_ARM::visit(const Store *op) {
 
 }
 
+bool CodeGen_ARM::visit_table_lookup(const Load *op) {
+    // Gathers of bytes from a small constant-sized allocation can be
+    // done with tbl, which looks up 16 to 64 bytes held in registers.
+    Type t = op->type;
+    if (!t.is_vector() || t.bits != 8 || t.is_float() || t.width % 8 != 0 ||
+        op->index.as<Ramp>() || op->index.as<Broadcast>() ||
+        !allocations.contains(op->name)) {
+        return false;
+    }
+
+    int bytes = allocations.get(op->name).constant_bytes;
+    if (bytes != 16 && bytes != 32 && bytes != 48 && bytes != 64) {
+        return false;
+    }
+    int tables = bytes / 16;
+
+    // Load the whole table.
+    Value *base = codegen_buffer_pointer(op->name, t.element_of(), make_zero(Int(32)));
+    base = builder->CreatePointerCast(base, i8x16->getPointerTo());
+    vector<Value *> table;
+    for (int i = 0; i < tables; i++) {
+        Value *ptr = builder->CreateConstInBoundsGEP1_32(
+#if LLVM_VERSION >= 37
+            i8x16,
+#endif
+            base, i);
+        LoadInst *load = builder->CreateLoad(ptr);
+        load->setAlignment(1);
+        add_tbaa_metadata(load, op->name, Expr());
+        table.push_back(load);
+    }
+
+    // The index is known to be in range, so it fits in a byte.
+    Value *index = codegen(op->index);
+    index = builder->CreateIntCast(index, VectorType::get(i8, t.width), false);
+
+    int n = (t.width % 16 == 0) ? 16 : 8;
+    ostringstream ss;
+    ss << "llvm.aarch64.neon.tbl" << tables << ".v" << n << "i8";
+    vector<Value *> results;
+    for (int i = 0; i < t.width; i += n) {
+        vector<Value *> args = table;
+        args.push_back(slice_vector(index, i, n));
+        results.push_back(call_intrin(VectorType::get(i8, n), n, ss.str(), args));
+    }
+    value = concat_vectors(results);
+    return true;
+}
+
 void CodeGen_ARM::visit(const Load *op) {
     // AArch64 SIMD not yet supported
     if (neon_intrinsics_disabled()) {
@@ -1125,6 +1482,10 @@ void CodeGen_ARM::visit(const Load *op) {
         return;
     }
 
+    if (target.bits == 64 && visit_table_lookup(op)) {
+        return;
+    }
+
     const Ramp *ramp = op->index.as<Ramp>();
 
     // We only deal with ramps here
@@ -1194,14 +1555,32 @@ void CodeGen_ARM::visit(const Load *op) {
         }
 
         ostringstream intrin;
-        intrin << "llvm.arm.neon.vld"
-               << stride->value
-               << ".v" << intrin_width
-               << (op->type.is_float() ? 'f' : 'i')
-               << op->type.bits;
-
-        // Get the intrinsic
-        llvm::Function *fn = module->getFunction(intrin.str());
+        char elt_code = op->type.is_float() ? 'f' : 'i';
+        llvm::Function *fn = NULL;
+        if (target.bits == 32) {
+            intrin << "llvm.arm.neon.vld"
+                   << stride->value
+                   << ".v" << intrin_width
+                   << elt_code
+                   << op->type.bits;
+
+            // Get the intrinsic
+            fn = module->getFunction(intrin.str());
+        } else {
+            // The AArch64 versions take a pointer to the element type
+            // and no alignment, and aren't declared in the runtime.
+            intrin << "llvm.aarch64.neon.ld"
+                   << stride->value
+                   << ".v" << intrin_width
+                   << elt_code << op->type.bits
+                   << ".p0" << elt_code << op->type.bits;
+            llvm::Type *vec_t = VectorType::get(llvm_type_of(op->type.element_of()), intrin_width);
+            vector<llvm::Type *> result_types(stride->value, vec_t);
+            llvm::Type *result_t = StructType::get(*context, result_types);
+            llvm::Type *ptr_t = llvm_type_of(op->type.element_of())->getPointerTo();
+            FunctionType *fn_t = FunctionType::get(result_t, vec(ptr_t), false);
+            fn = dyn_cast<llvm::Function>(module->getOrInsertFunction(intrin.str(), fn_t));
+        }
         internal_assert(fn);
 
         // Load each slice.
@@ -1210,8 +1589,13 @@ void CodeGen_ARM::visit(const Load *op) {
             Expr slice_base = simplify(base + i*ramp->stride);
             Expr slice_ramp = Ramp::make(slice_base, ramp->stride, intrin_width);
             Value *ptr = codegen_buffer_pointer(op->name, op->type.element_of(), slice_base);
-            ptr = builder->CreatePointerCast(ptr, i8->getPointerTo());
-            CallInst *call = builder->CreateCall(fn, vec(ptr, align));
+            CallInst *call = NULL;
+            if (target.bits == 32) {
+                ptr = builder->CreatePointerCast(ptr, i8->getPointerTo());
+                call = builder->CreateCall(fn, vec(ptr, align));
+            } else {
+                call = builder->CreateCall(fn, vec(ptr));
+            }
             add_tbaa_metadata(call, op->name, slice_ramp);
 
             Value *elt = builder->CreateExtractValue(call, vec((unsigned int)offset));
@@ -1247,6 +1631,52 @@ void CodeGen_ARM::visit(const Load *op) {
 }
 
 void CodeGen_ARM::visit(const Call *op) {
+    if (op->type.is_vector() && is_fixed_point_intrinsic(op) &&
+        !neon_intrinsics_disabled()) {
+        Type t = op->type;
+        // Use the 64-bit version of the intrinsic for 64-bit vectors,
+        // and the 128-bit version otherwise.
+        int intrin_width = (t.bits * t.width == 64) ? t.width : 128 / t.bits;
+        ostringstream ss;
+        ss << ".v" << intrin_width << "i" << t.bits;
+        string t_str = ss.str();
+        string sign = t.is_int() ? "s" : "u";
+
+        string intrin;
+        if (op->name == Call::saturating_add) {
+            intrin = neon_intrinsic("vqadd" + sign + t_str, sign + "qadd" + t_str);
+        } else if (op->name == Call::saturating_sub) {
+            intrin = neon_intrinsic("vqsub" + sign + t_str, sign + "qsub" + t_str);
+        } else if (op->name == Call::halving_add) {
+            intrin = neon_intrinsic("vhadd" + sign + t_str, sign + "hadd" + t_str);
+        } else if (op->name == Call::halving_sub) {
+            intrin = neon_intrinsic("vhsub" + sign + t_str, sign + "hsub" + t_str);
+        } else if (op->name == Call::rounding_halving_add) {
+            intrin = neon_intrinsic("vrhadd" + sign + t_str, sign + "rhadd" + t_str);
+        } else if (op->args.size() == 3 && t.is_int() &&
+                   (t.bits == 16 || t.bits == 32) &&
+                   is_const(op->args[2], t.bits - 1)) {
+            // Doubling multiplies returning the high half.
+            if (op->name == Call::mul_shift_right) {
+                intrin = neon_intrinsic("vqdmulh" + t_str, "sqdmulh" + t_str);
+            } else if (op->name == Call::rounding_mul_shift_right) {
+                intrin = neon_intrinsic("vqrdmulh" + t_str, "sqrdmulh" + t_str);
+            }
+        }
+
+        if (!intrin.empty()) {
+            value = call_intrin(t, intrin_width, intrin, vec(op->args[0], op->args[1]));
+            return;
+        } else if (op->name == Call::rounding_shift_right) {
+            // vrshl/srshl/urshl shift right for negative shift amounts.
+            Expr shift = -cast(Int(t.bits, t.width), op->args[1]);
+            value = call_intrin(t, intrin_width,
+                                neon_intrinsic("vrshift" + sign + t_str, sign + "rshl" + t_str),
+                                vec(op->args[0], shift));
+            return;
+        }
+    }
+
     if (op->call_type == Call::Intrinsic) {
         if (op->name == Call::profiling_timer) {
             // Android devices generally have read-cycle-counter
@@ -1288,6 +1718,121 @@ void CodeGen_ARM::visit(const Call *op) {
     CodeGen_Posix::visit(op);
 }
 
+void CodeGen_ARM::visit(const VectorReduce *op) {
+    Type t = op->type;
+    Type vt = op->value.type();
+    const int factor = vt.width / t.width;
+    const bool is_integer = t.is_int() || t.is_uint();
+    if (neon_intrinsics_disabled() || t.is_bool()) {
+        CodeGen_Posix::visit(op);
+        return;
+    }
+
+    // Adds can widen for free by looking through a cast.
+    const Cast *cast = op->value.as<Cast>();
+    Type src;
+    if (op->op == VectorReduce::Add && cast && is_integer) {
+        src = cast->value.type();
+        if (!(src.is_int() || src.is_uint()) ||
+            !(src.bits == 8 || src.bits == 16 || src.bits == 32) ||
+            src.bits >= t.bits) {
+            cast = NULL;
+        }
+    } else {
+        cast = NULL;
+    }
+
+    if (target.bits == 64 && t.is_scalar()) {
+        // Reductions across a whole 64 or 128-bit register: addv,
+        // saddlv, uaddlv, sminv, umaxv, fmaxv, etc.
+        Expr arg = cast ? cast->value : op->value;
+        Type at = arg.type();
+        int reg_bits = at.bits * at.width;
+        string name;
+        if (op->op == VectorReduce::Add && cast) {
+            name = src.is_int() ? "saddlv" : "uaddlv";
+        } else if (op->op == VectorReduce::Add && is_integer) {
+            name = t.is_int() ? "saddv" : "uaddv";
+        } else if ((op->op == VectorReduce::Min || op->op == VectorReduce::Max) &&
+                   is_integer && t.bits < 64) {
+            name = string(t.is_int() ? "s" : "u") + (op->op == VectorReduce::Min ? "minv" : "maxv");
+        } else if ((op->op == VectorReduce::Min || op->op == VectorReduce::Max) &&
+                   t == Float(32)) {
+            name = op->op == VectorReduce::Min ? "fminv" : "fmaxv";
+        }
+
+        if (!name.empty() && (reg_bits == 64 || reg_bits == 128)) {
+            // The integer versions return at least 32 bits.
+            Type ret = t.is_float() ? t : Int(std::max(32, cast ? src.bits * 2 : at.bits));
+            ostringstream ss;
+            ss << "llvm.aarch64.neon." << name
+               << "." << (ret.is_float() ? "f" : "i") << ret.bits
+               << ".v" << at.width << (at.is_float() ? "f" : "i") << at.bits;
+            FunctionType *fn_t = FunctionType::get(llvm_type_of(ret), vec(llvm_type_of(at)), false);
+            llvm::Function *fn = dyn_cast<llvm::Function>(module->getOrInsertFunction(ss.str(), fn_t));
+            internal_assert(fn);
+            CallInst *call = builder->CreateCall(fn, codegen(arg));
+            call->setDoesNotAccessMemory();
+            call->setDoesNotThrow();
+            value = call;
+            if (is_integer) {
+                bool sign = cast ? src.is_int() : t.is_int();
+                value = builder->CreateIntCast(value, llvm_type_of(t), sign);
+            }
+            return;
+        }
+    }
+
+    if (op->op == VectorReduce::Add && factor % 2 == 0 && is_integer) {
+        // Pairwise adds: vpadd/vpaddl on 32-bit ARM and
+        // addp/saddlp/uaddlp on AArch64. These halve the number of
+        // lanes, and then we reduce the rest of the way.
+        Type half_t = t;
+        half_t.width = vt.width / 2;
+        vector<Value *> results;
+        if (cast && src.bits * 2 == t.bits && half_t.width % (128 / t.bits) == 0) {
+            int n = 128 / t.bits;
+            string sign = src.is_int() ? "s" : "u";
+            ostringstream ss;
+            ss << ".v" << n << "i" << t.bits << ".v" << n * 2 << "i" << src.bits;
+            string intrin = neon_intrinsic("vpaddl" + sign + ss.str(), sign + "addlp" + ss.str());
+            llvm::Type *result_t = VectorType::get(llvm_type_of(t.element_of()), n);
+            Value *v = codegen(cast->value);
+            for (int i = 0; i < half_t.width; i += n) {
+                results.push_back(call_intrin(result_t, n, intrin, vec(slice_vector(v, i * 2, n * 2))));
+            }
+        } else if ((t.bits <= 32 || target.bits == 64) &&
+                   half_t.width % ((target.bits == 32 ? 64 : 128) / t.bits) == 0) {
+            // 32-bit ARM only has pairwise adds of 64-bit vectors.
+            int n = (target.bits == 32 ? 64 : 128) / t.bits;
+            ostringstream ss;
+            ss << ".v" << n << "i" << t.bits;
+            string intrin = neon_intrinsic("vpadd" + ss.str(), "addp" + ss.str());
+            llvm::Type *result_t = VectorType::get(llvm_type_of(t.element_of()), n);
+            Value *v = codegen(op->value);
+            for (int i = 0; i < half_t.width; i += n) {
+                results.push_back(call_intrin(result_t, n, intrin,
+                                              vec(slice_vector(v, i * 2, n),
+                                                  slice_vector(v, i * 2 + n, n))));
+            }
+        }
+
+        if (!results.empty()) {
+            value = concat_vectors(results);
+            if (factor > 2) {
+                string name = unique_name('r');
+                sym_push(name, value);
+                Expr sums = Variable::make(half_t, name);
+                value = codegen(VectorReduce::make(VectorReduce::Add, sums, t.width));
+                sym_pop(name);
+            }
+            return;
+        }
+    }
+
+    CodeGen_Posix::visit(op);
+}
+
 string CodeGen_ARM::mcpu() const {
     if (target.bits == 32) {
         if (target.has_feature(Target::ARMv7s)) {
@@ -35,6 +35,14 @@ protected:
     void visit(const Store *);
     void visit(const Load *);
     void visit(const Call *);
+    void visit(const VectorReduce *);
+    // @}
+
+    /** AArch64 peephole optimizations that have no 32-bit
+     * equivalent. Return true if they set value. */
+    // @{
+    bool visit_pairwise_add(const Add *);
+    bool visit_table_lookup(const Load *);
     // @}
 
     /** Various patterns to peephole match against */
@@ -52,6 +60,26 @@ protected:
         Pattern(const std::string &i, int w, Expr p, PatternType t = Simple) :
             intrin("llvm.arm.neon." + i), intrin_width(w), pattern(p), type(t) {}
     };
+
+    /** Make a pattern for an AArch64 intrinsic. The name excludes the
+     * "llvm.aarch64.neon." prefix. */
+    static Pattern aarch64_pattern(const std::string &i, int w, Expr p,
+                                   Pattern::PatternType t = Pattern::Simple) {
+        Pattern result("", w, p, t);
+        result.intrin = "llvm.aarch64.neon." + i;
+        return result;
+    }
+
+    /** The full name of a NEON intrinsic for the current target,
+     * given its 32-bit ARM and AArch64 names without the
+     * "llvm.arm.neon." or "llvm.aarch64.neon." prefix. */
+    std::string neon_intrinsic(const std::string &arm32, const std::string &arm64) const {
+        if (target.bits == 32) {
+            return "llvm.arm.neon." + arm32;
+        } else {
+            return "llvm.aarch64.neon." + arm64;
+        }
+    }
     std::vector<Pattern> casts, left_shifts, averagings, negations;
 
     std::string mcpu() const;
@@ -59,11 +87,15 @@ protected:
     bool use_soft_float_abi() const;
     int native_vector_bits() const;
 
-    // On 64-bit ARM, the NEON instrinsics do not work as the syntax
-    // changed from 32-bit and this has not been updated.
+    // On 64-bit ARM, the NEON intrinsics have different names to
+    // the 32-bit ones. We only know the names used by the AArch64
+    // backend that replaced the original one in llvm 3.5.
     // On 32-bit, NEON can be disabled for older processors.
     bool neon_intrinsics_disabled() {
-        return target.bits == 64 || target.has_feature(Target::NoNEON);
+        #if LLVM_VERSION < 35
+        if (target.bits == 64) return true;
+        #endif
+        return target.has_feature(Target::NoNEON);
     }
 };
 
@@ -8,6 +8,8 @@
 #include "Param.h"
 #include "Var.h"
 #include "Lerp.h"
+#include "FixedPoint.h"
+#include "LowerFloat16.h"
 #include "Simplify.h"
 
 namespace Halide {
@@ -180,6 +182,10 @@ const string globals =
     // when used in this way. See http://blog.regehr.org/archives/959
     // for a detailed comparison of type-punning methods.
     "template<typename A, typename B> A reinterpret(B b) {A a; memcpy(&a, &b, sizeof(a)); return a;}\n"
+    // The same goes for loading and storing vectors at addresses that
+    // may not be aligned.
+    "template<typename V, typename T> V halide_vector_load(const T *p) {V v; memcpy(&v, p, sizeof(v)); return v;}\n"
+    "template<typename V, typename T> void halide_vector_store(T *p, V v) {memcpy(p, &v, sizeof(v));}\n"
     "\n"
     "static bool halide_rewrite_buffer(buffer_t *b, int32_t elem_size,\n"
     "                           int32_t min0, int32_t extent0, int32_t stride0,\n"
@@ -202,7 +208,8 @@ const string globals =
     "}\n";
 }
 
-CodeGen_C::CodeGen_C(ostream &s, bool is_header, const std::string &guard) : IRPrinter(s), id("$$ BAD ID $$"), is_header(is_header) {
+CodeGen_C::CodeGen_C(ostream &s, bool is_header, const std::string &guard) :
+    IRPrinter(s), id("$$ BAD ID $$"), is_header(is_header), vector_mode(NativeVectors) {
     if (is_header) {
         // If it's a header, emit an include guard.
         stream << "#ifndef HALIDE_" << print_name(guard) << '\n'
@@ -250,7 +257,11 @@ namespace {
 string type_to_c_type(Type type) {
     ostringstream oss;
     user_assert(type.width == 1) << "Can't use vector types when compiling to C (yet)\n";
-    if (type.is_float()) {
+    if (type.is_float16()) {
+        // 16-bit floats are only ever loaded, stored, and
+        // bit-twiddled, so we can represent them as their bits.
+        oss << "uint16_t";
+    } else if (type.is_float()) {
         if (type.bits == 32) {
             oss << "float";
         } else if (type.bits == 64) {
@@ -276,12 +287,98 @@ string type_to_c_type(Type type) {
     }
     return oss.str();
 }
+
+// The C type used for each lane of a vector. Vector extensions don't
+// allow bool lanes, so we store bools one per byte as 0 or 1.
+string lane_c_type(Type type) {
+    return type.is_bool() ? "int8_t" : type_to_c_type(type.element_of());
+}
+
+string join_strings(const vector<string> &strs, const string &sep) {
+    string result;
+    for (size_t i = 0; i < strs.size(); i++) {
+        if (i > 0) result += sep;
+        result += strs[i];
+    }
+    return result;
+}
+
+// E.g. halide_int32x4_t
+string vector_type_name(Type type) {
+    user_assert(!type.is_handle()) << "Can't use vectors of handles when compiling to C\n";
+    string elem = type.is_bool() ? "bool" : type_to_c_type(type.element_of());
+    if (ends_with(elem, "_t")) {
+        elem = elem.substr(0, elem.size() - 2);
+    }
+    ostringstream oss;
+    oss << "halide_" << elem << "x" << type.width << "_t";
+    return oss.str();
+}
 }
 
 string CodeGen_C::print_type(Type type) {
+    if (is_c_vector(type)) {
+        return vector_type_name(type);
+    }
     return type_to_c_type(type);
 }
 
+bool CodeGen_C::is_c_vector(Type t) const {
+    return t.width > 1 && vector_mode != NativeVectors;
+}
+
+bool CodeGen_C::has_vector_operators(Type t) const {
+    // GCC only allows vector types with a power-of-two size.
+    return (is_c_vector(t) &&
+            vector_mode == VectorExtensions &&
+            (t.width & (t.width - 1)) == 0);
+}
+
+void CodeGen_C::emit_vector_typedefs(int width) {
+    string key = "vector typedefs x" + int_to_string(width);
+    if (emitted.count(key)) return;
+    emitted.insert(key);
+
+    Type types[] = {Bool(width),
+                    Int(8, width), Int(16, width), Int(32, width), Int(64, width),
+                    UInt(8, width), UInt(16, width), UInt(32, width), UInt(64, width),
+                    Float(32, width), Float(64, width)};
+    for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); i++) {
+        Type t = types[i];
+        string lane = lane_c_type(t);
+        string name = vector_type_name(t);
+        if (has_vector_operators(t)) {
+            stream << "typedef " << lane << " " << name
+                   << " __attribute__((vector_size(" << t.width * t.bytes() << ")));\n";
+        } else {
+            stream << "struct " << name << " {\n"
+                   << " " << lane << " lanes[" << t.width << "];\n"
+                   << " " << lane << " &operator[](int i) {return lanes[i];}\n"
+                   << " " << lane << " operator[](int i) const {return lanes[i];}\n"
+                   << "};\n";
+        }
+    }
+}
+
+string CodeGen_C::print_lanewise(Type t, const string &lane, const string &rhs) {
+    string result = unique_name('_');
+    do_indent();
+    stream << print_type(t) << " " << result << ";\n";
+    do_indent();
+    stream << "for (int " << lane << " = 0; " << lane << " < " << t.width << "; " << lane << "++) "
+           << result << "[" << lane << "] = " << rhs << ";\n";
+    id = result;
+    return id;
+}
+
+string CodeGen_C::lane_of(Type t, const string &value, const string &lane) {
+    if (t.width > 1) {
+        return value + "[" + lane + "]";
+    } else {
+        return value;
+    }
+}
+
 string CodeGen_C::print_reinterpret(Type type, Expr e) {
     ostringstream oss;
     oss << "reinterpret<" << print_type(type) << ">(" << print_expr(e) << ")";
@@ -320,7 +417,9 @@ class ExternCallPrototypes : public IRGraphVisitor {
 
         if (op->call_type == Call::Extern) {
             if (!emitted.count(op->name)) {
-                stream << type_to_c_type(op->type) << " " << op->name << "(";
+                // Vector calls are emitted one lane at a time, so
+                // declare the scalar version.
+                stream << type_to_c_type(op->type.element_of()) << " " << op->name << "(";
                 if (function_takes_user_context(op->name)) {
                     stream << "void *";
                     if (op->args.size()) {
@@ -334,7 +433,7 @@ class ExternCallPrototypes : public IRGraphVisitor {
                     if (op->args[i].as<StringImm>()) {
                         stream << "const char *";
                     } else {
-                        stream << type_to_c_type(op->args[i].type());
+                        stream << type_to_c_type(op->args[i].type().element_of());
                     }
                 }
                 stream << ");\n";
@@ -366,9 +465,27 @@ public:
         }
     }
 };
+
+// Find the widths of all vector types used.
+class VectorWidths : public IRGraphVisitor {
+    using IRGraphVisitor::include;
+    using IRGraphVisitor::visit;
+
+    void include(const Expr &e) {
+        if (e.type().width > 1) {
+            widths.insert(e.type().width);
+        }
+        IRGraphVisitor::include(e);
+    }
+
+public:
+    std::set<int> widths;
+};
 }
 
 void CodeGen_C::compile(const Module &input) {
+    vector_mode = (input.target().has_feature(Target::NoVectorExtensions) ?
+                   ScalarVectors : VectorExtensions);
     for (size_t i = 0; i < input.buffers.size(); i++) {
         compile(input.buffers[i]);
     }
@@ -401,6 +518,17 @@ void CodeGen_C::compile(const LoweredFunc &f) {
         ExternCallPrototypes e(stream, emitted);
         f.body.accept(&e);
         stream << "\n";
+
+        // Emit typedefs for the vector types used. Lowering some
+        // intrinsics can introduce vectors of types not in the
+        // original code, so we define all types for each width.
+        if (vector_mode != NativeVectors) {
+            VectorWidths w;
+            f.body.accept(&w);
+            for (std::set<int>::iterator iter = w.widths.begin(); iter != w.widths.end(); ++iter) {
+                emit_vector_typedefs(*iter);
+            }
+        }
     }
 
     // Emit the function prototype
@@ -521,6 +649,13 @@ void CodeGen_C::push_buffer(Type t, const std::string &buffer_name) {
     do_indent();
     stream << "(void)" << name << ";\n";
 
+    // The untyped host pointer, used by the host alignment checks.
+    string host_name = print_name(buffer_name + ".host");
+    do_indent();
+    stream << "void *" << host_name << " = " << buf_name << "->host;\n";
+    do_indent();
+    stream << "(void)" << host_name << ";\n";
+
     do_indent();
     stream << "const bool "
            << name
@@ -625,13 +760,99 @@ void CodeGen_C::visit(const Variable *op) {
 }
 
 void CodeGen_C::visit(const Cast *op) {
-    print_assignment(op->type, "(" + print_type(op->type) + ")(" + print_expr(op->value) + ")");
+    if (op->value.type().is_float16()) {
+        // C has no 16-bit float type, so convert by bit manipulation.
+        Expr e = float16_to_float32(op->value);
+        if (op->type.is_float16()) {
+            e = float32_to_float16(e, op->type);
+        } else {
+            e = Cast::make(op->type, e);
+        }
+        print_expr(e);
+    } else if (op->type.is_float16()) {
+        Expr e = op->value;
+        if (e.type() != Float(32, op->type.width)) {
+            e = Cast::make(Float(32, op->type.width), e);
+        }
+        print_expr(float32_to_float16(e, op->type));
+    } else if (is_c_vector(op->type)) {
+        string value = print_expr(op->value);
+        string lane = unique_name('i');
+        print_lanewise(op->type, lane,
+                       "(" + type_to_c_type(op->type.element_of()) + ")" + value + "[" + lane + "]");
+    } else {
+        print_assignment(op->type, "(" + print_type(op->type) + ")(" + print_expr(op->value) + ")");
+    }
+}
+
+void CodeGen_C::visit(const Ramp *op) {
+    string base = print_expr(op->base);
+    string stride = print_expr(op->stride);
+    // Narrow types get promoted to int by the arithmetic, and then
+    // narrowing conversions aren't allowed in an initializer list.
+    string cast = op->type.bits < 32 ? "(" + lane_c_type(op->type) + ")" : "";
+    ostringstream rhs;
+    rhs << "{" << base;
+    for (int i = 1; i < op->width; i++) {
+        rhs << ", " << cast << "(" << base << " + " << stride << " * " << i << ")";
+    }
+    rhs << "}";
+    print_assignment(op->type, rhs.str());
+}
+
+void CodeGen_C::visit(const Broadcast *op) {
+    string value = print_expr(op->value);
+    ostringstream rhs;
+    rhs << "{" << value;
+    for (int i = 1; i < op->width; i++) {
+        rhs << ", " << value;
+    }
+    rhs << "}";
+    print_assignment(op->type, rhs.str());
+}
+
+void CodeGen_C::visit(const VectorReduce *op) {
+    string value = print_expr(op->value);
+    int factor = op->value.type().width / op->type.width;
+    // As for Ramp, keep narrow types from being promoted to int.
+    string cast = "(" + lane_c_type(op->type) + ")";
+    vector<string> lanes(op->type.width);
+    for (int i = 0; i < op->type.width; i++) {
+        string acc = lane_of(op->value.type(), value, int_to_string(i * factor));
+        for (int j = 1; j < factor; j++) {
+            string v = lane_of(op->value.type(), value, int_to_string(i * factor + j));
+            switch (op->op) {
+            case VectorReduce::Add: acc = cast + "(" + acc + " + " + v + ")"; break;
+            case VectorReduce::Mul: acc = cast + "(" + acc + " * " + v + ")"; break;
+            case VectorReduce::Min: acc = "min(" + acc + ", " + v + ")"; break;
+            case VectorReduce::Max: acc = "max(" + acc + ", " + v + ")"; break;
+            case VectorReduce::And: acc = "(" + acc + " && " + v + ")"; break;
+            case VectorReduce::Or: acc = "(" + acc + " || " + v + ")"; break;
+            }
+        }
+        lanes[i] = acc;
+    }
+    if (op->type.is_vector()) {
+        print_assignment(op->type, "{" + join_strings(lanes, ", ") + "}");
+    } else {
+        print_assignment(op->type, lanes[0]);
+    }
 }
 
 void CodeGen_C::visit_binop(Type t, Expr a, Expr b, const char * op) {
     string sa = print_expr(a);
     string sb = print_expr(b);
-    print_assignment(t, sa + " " + op + " " + sb);
+    // Comparisons of vectors produce masks rather than bools, so do
+    // those a lane at a time too.
+    if (is_c_vector(t) &&
+        !(has_vector_operators(t) &&
+          has_vector_operators(a.type()) &&
+          t.is_bool() == a.type().is_bool())) {
+        string lane = unique_name('i');
+        print_lanewise(t, lane, lane_of(a.type(), sa, lane) + " " + op + " " + lane_of(b.type(), sb, lane));
+    } else {
+        print_assignment(t, sa + " " + op + " " + sb);
+    }
 }
 
 void CodeGen_C::visit(const Add *op) {
@@ -649,9 +870,7 @@ void CodeGen_C::visit(const Mul *op) {
 void CodeGen_C::visit(const Div *op) {
     int bits;
     if (is_const_power_of_two(op->b, &bits)) {
-        ostringstream oss;
-        oss << print_expr(op->a) << " >> " << bits;
-        print_assignment(op->type, oss.str());
+        visit_binop(op->type, op->a, bits, ">>");
     } else if (op->type.is_int()) {
         print_expr(Call::make(op->type, "sdiv", vec(op->a, op->b), Call::Extern));
     } else {
@@ -662,9 +881,7 @@ void CodeGen_C::visit(const Div *op) {
 void CodeGen_C::visit(const Mod *op) {
     int bits;
     if (is_const_power_of_two(op->b, &bits)) {
-        ostringstream oss;
-        oss << print_expr(op->a) << " & " << ((1 << bits)-1);
-        print_assignment(op->type, oss.str());
+        visit_binop(op->type, op->a, (1 << bits) - 1, "&");
     } else if (op->type.is_int()) {
         print_expr(Call::make(op->type, "smod", vec(op->a, op->b), Call::Extern));
     } else {
@@ -705,15 +922,24 @@ void CodeGen_C::visit(const GE *op) {
 }
 
 void CodeGen_C::visit(const Or *op) {
-    visit_binop(op->type, op->a, op->b, "||");
+    // Vectors of bools hold 0 or 1 in each lane.
+    visit_binop(op->type, op->a, op->b, has_vector_operators(op->type) ? "|" : "||");
 }
 
 void CodeGen_C::visit(const And *op) {
-    visit_binop(op->type, op->a, op->b, "&&");
+    visit_binop(op->type, op->a, op->b, has_vector_operators(op->type) ? "&" : "&&");
 }
 
 void CodeGen_C::visit(const Not *op) {
-    print_assignment(op->type, "!(" + print_expr(op->a) + ")");
+    string a = print_expr(op->a);
+    if (has_vector_operators(op->type)) {
+        print_assignment(op->type, a + " ^ 1");
+    } else if (is_c_vector(op->type)) {
+        string lane = unique_name('i');
+        print_lanewise(op->type, lane, "!" + a + "[" + lane + "]");
+    } else {
+        print_assignment(op->type, "!(" + a + ")");
+    }
 }
 
 void CodeGen_C::visit(const IntImm *op) {
@@ -772,6 +998,78 @@ void CodeGen_C::visit(const Call *op) {
 
     ostringstream rhs;
 
+    // Shuffles, and vector ops without a C operator for the type, are
+    // done one lane at a time.
+    bool is_operator = (op->call_type == Call::Intrinsic &&
+                        (op->name == Call::bitwise_and ||
+                         op->name == Call::bitwise_xor ||
+                         op->name == Call::bitwise_or ||
+                         op->name == Call::bitwise_not ||
+                         op->name == Call::shift_left ||
+                         op->name == Call::shift_right));
+    if (op->call_type == Call::Intrinsic &&
+        op->name == Call::shuffle_vector &&
+        is_c_vector(op->args[0].type())) {
+        string v = print_expr(op->args[0]);
+        vector<string> lanes;
+        for (size_t i = 1; i < op->args.size(); i++) {
+            const IntImm *idx = op->args[i].as<IntImm>();
+            internal_assert(idx);
+            // An index one past the end means the lane is undefined.
+            int j = idx->value < op->args[0].type().width ? idx->value : 0;
+            lanes.push_back(v + "[" + int_to_string(j) + "]");
+        }
+        if (op->type.is_scalar()) {
+            print_assignment(op->type, lanes[0]);
+        } else {
+            print_assignment(op->type, "{" + join_strings(lanes, ", ") + "}");
+        }
+        return;
+    } else if (op->call_type == Call::Intrinsic &&
+               op->name == Call::interleave_vectors &&
+               is_c_vector(op->type)) {
+        vector<string> args(op->args.size());
+        for (size_t i = 0; i < op->args.size(); i++) {
+            args[i] = print_expr(op->args[i]);
+        }
+        vector<string> lanes;
+        for (int i = 0; i < op->type.width; i++) {
+            lanes.push_back(lane_of(op->args[i % args.size()].type(),
+                                    args[i % args.size()],
+                                    int_to_string(i / (int)args.size())));
+        }
+        print_assignment(op->type, "{" + join_strings(lanes, ", ") + "}");
+        return;
+    } else if (is_c_vector(op->type) &&
+               (op->call_type == Call::Extern ||
+                (op->call_type == Call::Intrinsic && op->name == Call::abs) ||
+                (is_operator && !has_vector_operators(op->type)))) {
+        string lane = unique_name('i');
+        vector<string> args(op->args.size());
+        for (size_t i = 0; i < op->args.size(); i++) {
+            args[i] = lane_of(op->args[i].type(), print_expr(op->args[i]), lane);
+        }
+        if (op->name == Call::abs) {
+            rhs << "(" << args[0] << " > 0 ? " << args[0] << " : -" << args[0] << ")";
+        } else if (op->name == Call::bitwise_not) {
+            rhs << "~" << args[0];
+        } else if (is_operator) {
+            const char *c_op = (op->name == Call::bitwise_and ? " & " :
+                                op->name == Call::bitwise_xor ? " ^ " :
+                                op->name == Call::bitwise_or ? " | " :
+                                op->name == Call::shift_left ? " << " : " >> ");
+            rhs << args[0] << c_op << args[1];
+        } else {
+            rhs << op->name << "(";
+            if (function_takes_user_context(op->name)) {
+                rhs << (have_user_context ? "__user_context_, " : "NULL, ");
+            }
+            rhs << join_strings(args, ", ") << ")";
+        }
+        print_lanewise(op->type, lane, rhs.str());
+        return;
+    }
+
     // Handle intrinsics first
     if (op->call_type == Call::Intrinsic) {
         if (op->name == Call::debug_to_file) {
@@ -857,6 +1155,8 @@ void CodeGen_C::visit(const Call *op) {
             internal_assert(op->args.size() == 3);
             Expr e = lower_lerp(op->args[0], op->args[1], op->args[2]);
             rhs << print_expr(e);
+        } else if (is_fixed_point_intrinsic(op)) {
+            rhs << print_expr(lower_fixed_point_intrinsic(op));
         } else if (op->name == Call::absd) {
             internal_assert(op->args.size() == 2);
             Expr a = op->args[0];
@@ -1066,6 +1366,21 @@ void CodeGen_C::visit(const Call *op) {
 }
 
 void CodeGen_C::visit(const Load *op) {
+    if (is_c_vector(op->type)) {
+        string ptr = "((" + print_type(op->type.element_of()) + " *)" + print_name(op->name) + ")";
+        const Ramp *ramp = op->index.as<Ramp>();
+        if (ramp && is_one(ramp->stride)) {
+            string base = print_expr(ramp->base);
+            print_assignment(op->type, "halide_vector_load<" + print_type(op->type) + ">(" + ptr + " + " + base + ")");
+        } else {
+            // A gather
+            string index = print_expr(op->index);
+            string lane = unique_name('i');
+            print_lanewise(op->type, lane, ptr + "[" + index + "[" + lane + "]]");
+        }
+        return;
+    }
+
     bool type_cast_needed = !(allocations.contains(op->name) &&
                               allocations.get(op->name) == op->type);
     ostringstream rhs;
@@ -1089,6 +1404,26 @@ void CodeGen_C::visit(const Store *op) {
 
     Type t = op->value.type();
 
+    if (is_c_vector(t)) {
+        string ptr = "((" + print_type(t.element_of()) + " *)" + print_name(op->name) + ")";
+        string id_value = print_expr(op->value);
+        const Ramp *ramp = op->index.as<Ramp>();
+        if (ramp && is_one(ramp->stride)) {
+            string base = print_expr(ramp->base);
+            do_indent();
+            stream << "halide_vector_store(" << ptr << " + " << base << ", " << id_value << ");\n";
+        } else {
+            // A scatter
+            string index = print_expr(op->index);
+            string lane = unique_name('i');
+            do_indent();
+            stream << "for (int " << lane << " = 0; " << lane << " < " << t.width << "; " << lane << "++) "
+                   << ptr << "[" << index << "[" << lane << "]] = " << id_value << "[" << lane << "];\n";
+        }
+        cache.clear();
+        return;
+    }
+
     bool type_cast_needed = !(allocations.contains(op->name) &&
                               allocations.get(op->name) == t);
 
@@ -1126,6 +1461,14 @@ void CodeGen_C::visit(const Select *op) {
     string true_val = print_expr(op->true_value);
     string false_val = print_expr(op->false_value);
     string cond = print_expr(op->condition);
+    if (is_c_vector(op->condition.type())) {
+        string lane = unique_name('i');
+        print_lanewise(op->type, lane,
+                       lane_of(op->condition.type(), cond, lane) +
+                       " ? " + lane_of(op->type, true_val, lane) +
+                       " : " + lane_of(op->type, false_val, lane));
+        return;
+    }
     rhs << "(" << print_type(op->type) << ")"
         << "(" << cond
         << " ? " << true_val
@@ -1391,6 +1734,8 @@ void CodeGen_C::test() {
         "int test1(buffer_t *_buf_buffer, const float _alpha, const int32_t _beta, const void * __user_context) HALIDE_FUNCTION_ATTRS {\n"
         " int32_t *_buf = (int32_t *)(_buf_buffer->host);\n"
         " (void)_buf;\n"
+        " void *_buf_host = _buf_buffer->host;\n"
+        " (void)_buf_host;\n"
         " const bool _buf_host_and_dev_are_null = (_buf_buffer->host == NULL) && (_buf_buffer->dev == 0);\n"
         " (void)_buf_host_and_dev_are_null;\n"
         " const int32_t _buf_min_0 = _buf_buffer->min[0];\n"
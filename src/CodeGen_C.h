@@ -93,6 +93,42 @@ protected:
     /** True if there is a void * __user_context parameter in the arguments. */
     bool have_user_context;
 
+    /** How vector types are emitted. */
+    enum VectorMode {
+        /** The language has its own vector types, which are handled
+         * by a subclass (e.g. OpenCL C). */
+        NativeVectors,
+        /** Use GCC/clang vector extension types. Vectors with a
+         * non-power-of-two number of lanes are emitted as in
+         * ScalarVectors. */
+        VectorExtensions,
+        /** Use structs wrapping arrays, operated on one lane at a
+         * time. This works with any C++ compiler. */
+        ScalarVectors
+    };
+    VectorMode vector_mode;
+
+    /** Is this a vector type that this class is responsible for
+     * emitting? */
+    bool is_c_vector(Type t) const;
+
+    /** Can the usual C operators be applied directly to values of
+     * this vector type? */
+    bool has_vector_operators(Type t) const;
+
+    /** Emit typedefs for vectors of every scalar type with the given
+     * number of lanes, if we haven't already. */
+    void emit_vector_typedefs(int width);
+
+    /** Emit a loop that computes the vector of type t one lane at a
+     * time, and set id to the result. The rhs should refer to the
+     * current lane by the given name. Return id. */
+    std::string print_lanewise(Type t, const std::string &lane, const std::string &rhs);
+
+    /** Return the element of a value at the given lane. Scalars are
+     * the same in every lane. */
+    std::string lane_of(Type t, const std::string &value, const std::string &lane);
+
     using IRPrinter::visit;
 
     void visit(const Variable *);
@@ -100,6 +136,9 @@ protected:
     void visit(const StringImm *);
     void visit(const FloatImm *);
     void visit(const Cast *);
+    void visit(const Ramp *);
+    void visit(const Broadcast *);
+    void visit(const VectorReduce *);
     void visit(const Add *);
     void visit(const Sub *);
     void visit(const Mul *);
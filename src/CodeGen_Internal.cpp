@@ -189,7 +189,11 @@ void Closure::unpack_struct(Scope<Value *> &dst,
 
 llvm::Type *llvm_type_of(LLVMContext *c, Halide::Type t) {
     if (t.width == 1) {
-        if (t.is_float()) {
+        if (t.is_bfloat()) {
+            // llvm has no bfloat type. We only ever load, store, and
+            // bit-twiddle them (see LowerFloat16.h).
+            return llvm::Type::getIntNTy(*c, t.bits);
+        } else if (t.is_float()) {
             switch (t.bits) {
             case 16:
                 return llvm::Type::getHalfTy(*c);
@@ -11,6 +11,7 @@
 #include "JITModule.h"
 #include "CodeGen_Internal.h"
 #include "Lerp.h"
+#include "FixedPoint.h"
 #include "Util.h"
 #include "LLVM_Runtime_Linker.h"
 #include "MatlabWrapper.h"
@@ -1190,6 +1191,11 @@ void CodeGen_LLVM::visit(const Cast *op) {
         value = builder->CreateUIToFP(value, llvm_dst);
     } else {
         internal_assert(src.is_float() && dst.is_float());
+        // Casts involving bfloats are replaced with bit manipulation
+        // by lower_float16. The ones involving halfs that remain can
+        // be done in hardware (e.g. with F16C).
+        internal_assert(!src.is_bfloat() && !dst.is_bfloat())
+            << "Casts to and from bfloat should have been lowered: " << Expr(op) << "\n";
         // Float widening or narrowing
         value = builder->CreateFPCast(value, llvm_dst);
     }
@@ -1603,9 +1609,50 @@ void CodeGen_LLVM::add_tbaa_metadata(llvm::Instruction *inst, string buffer, Exp
     inst->setMetadata("tbaa", tbaa);
 }
 
+int CodeGen_LLVM::max_alignment(const string &buffer) {
+    int native_bytes = native_vector_bits() / 8;
+    if (might_be_misaligned.find(buffer) == might_be_misaligned.end()) {
+        // We allocated it ourselves.
+        return native_bytes;
+    }
+    map<string, int>::const_iterator iter = host_alignment.find(buffer);
+    if (iter != host_alignment.end()) {
+        return std::min(iter->second, native_bytes);
+    }
+    return 0;
+}
+
+namespace {
+// Find the buffers whose host pointers a condition checks the
+// alignment of, in the form made by OutputImageParam::is_host_aligned,
+// and record the alignment in bytes.
+void find_host_alignment(Expr cond, map<string, int> &result) {
+    if (const And *a = cond.as<And>()) {
+        find_host_alignment(a->a, result);
+        find_host_alignment(a->b, result);
+        return;
+    }
+    const EQ *eq = cond.as<EQ>();
+    const Mod *mod = eq ? eq->a.as<Mod>() : NULL;
+    const Call *call = mod ? mod->a.as<Call>() : NULL;
+    int bits = 0;
+    if (!call || call->call_type != Call::Intrinsic || call->name != Call::reinterpret ||
+        !is_zero(eq->b) ||
+        !is_const_power_of_two(mod->b, &bits)) {
+        return;
+    }
+    const Variable *var = call->args[0].as<Variable>();
+    if (!var || !ends_with(var->name, ".host")) {
+        return;
+    }
+    string buffer = var->name.substr(0, var->name.size() - 5);
+    result[buffer] = std::max(result[buffer], 1 << bits);
+}
+}
+
 void CodeGen_LLVM::visit(const Load *op) {
 
-    bool possibly_misaligned = (might_be_misaligned.find(op->name) != might_be_misaligned.end());
+    int alignment_limit = max_alignment(op->name);
 
     // There are several cases. Different architectures may wish to override some.
     if (op->type.is_scalar()) {
@@ -1625,14 +1672,12 @@ void CodeGen_LLVM::visit(const Load *op) {
 
             // Boost the alignment if possible, up to the native vector width.
             ModulusRemainder mod_rem = modulus_remainder(ramp->base, alignment_info);
-            if (!possibly_misaligned) {
-                while ((mod_rem.remainder & 1) == 0 &&
-                       (mod_rem.modulus & 1) == 0 &&
-                       alignment < native_bits) {
-                    mod_rem.modulus /= 2;
-                    mod_rem.remainder /= 2;
-                    alignment *= 2;
-                }
+            while ((mod_rem.remainder & 1) == 0 &&
+                   (mod_rem.modulus & 1) == 0 &&
+                   alignment < alignment_limit) {
+                mod_rem.modulus /= 2;
+                mod_rem.remainder /= 2;
+                alignment *= 2;
             }
 
             // For dense vector loads wider than the native vector
@@ -1800,6 +1845,52 @@ void CodeGen_LLVM::visit(const Broadcast *op) {
     value = create_broadcast(codegen(op->value), op->width);
 }
 
+void CodeGen_LLVM::visit(const VectorReduce *op) {
+    // Repeatedly combine adjacent lanes with the reduction operator
+    // until each group of lanes has been reduced to a single lane. We
+    // halve the width while we can, which gives a shuffle tree for
+    // power-of-two factors, and otherwise combine all the lanes of
+    // each group at once.
+    value = codegen(op->value);
+    Type t = op->value.type();
+    while (t.width != op->type.width) {
+        int factor = t.width / op->type.width;
+        int parts = (factor % 2 == 0) ? 2 : factor;
+
+        string name = unique_name('r');
+        sym_push(name, value);
+        Expr v = Variable::make(t, name);
+
+        Type part_type = t;
+        part_type.width /= parts;
+        Expr result;
+        for (int j = 0; j < parts; j++) {
+            vector<Expr> args;
+            args.push_back(v);
+            for (int i = 0; i < part_type.width; i++) {
+                args.push_back(i * parts + j);
+            }
+            Expr part = Call::make(part_type, Call::shuffle_vector, args, Call::Intrinsic);
+            if (j == 0) {
+                result = part;
+                continue;
+            }
+            switch (op->op) {
+            case VectorReduce::Add: result = result + part; break;
+            case VectorReduce::Mul: result = result * part; break;
+            case VectorReduce::Min: result = Min::make(result, part); break;
+            case VectorReduce::Max: result = Max::make(result, part); break;
+            case VectorReduce::And: result = result && part; break;
+            case VectorReduce::Or: result = result || part; break;
+            }
+        }
+
+        value = codegen(result);
+        sym_pop(name);
+        t = part_type;
+    }
+}
+
 // Pass through scalars, and unpack broadcasts. Assert if it's a non-vector broadcast.
 Expr unbroadcast(Expr e) {
     if (e.type().is_vector()) {
@@ -2367,6 +2458,8 @@ void CodeGen_LLVM::visit(const Call *op) {
         } else if (op->name == Call::lerp) {
             internal_assert(op->args.size() == 3);
             value = codegen(lower_lerp(op->args[0], op->args[1], op->args[2]));
+        } else if (is_fixed_point_intrinsic(op)) {
+            value = codegen(lower_fixed_point_intrinsic(op));
         } else if (op->name == Call::popcount) {
             internal_assert(op->args.size() == 1);
             std::vector<llvm::Type*> arg_type(1);
@@ -2976,7 +3069,7 @@ void CodeGen_LLVM::visit(const For *op) {
 void CodeGen_LLVM::visit(const Store *op) {
     Value *val = codegen(op->value);
     Halide::Type value_type = op->value.type();
-    bool possibly_misaligned = (might_be_misaligned.find(op->name) != might_be_misaligned.end());
+    int alignment_limit = max_alignment(op->name);
     // Scalar
     if (value_type.is_scalar()) {
         Value *ptr = codegen_buffer_pointer(op->name, value_type, op->index);
@@ -2991,14 +3084,12 @@ void CodeGen_LLVM::visit(const Store *op) {
 
             // Boost the alignment if possible, up to the native vector width.
             ModulusRemainder mod_rem = modulus_remainder(ramp->base, alignment_info);
-            if (!possibly_misaligned) {
-                while ((mod_rem.remainder & 1) == 0 &&
-                       (mod_rem.modulus & 1) == 0 &&
-                       alignment < native_bits) {
-                    mod_rem.modulus /= 2;
-                    mod_rem.remainder /= 2;
-                    alignment *= 2;
-                }
+            while ((mod_rem.remainder & 1) == 0 &&
+                   (mod_rem.modulus & 1) == 0 &&
+                   alignment < alignment_limit) {
+                mod_rem.modulus /= 2;
+                mod_rem.remainder /= 2;
+                alignment *= 2;
             }
 
             // For dense vector stores wider than the native vector
@@ -3079,10 +3170,18 @@ void CodeGen_LLVM::visit(const IfThenElse *op) {
     BasicBlock *after_bb = BasicBlock::Create(*context, "after_bb", function);
     builder->CreateCondBr(codegen(op->condition), true_bb, false_bb);
 
+    // If the condition checks the alignment of some host pointers
+    // (e.g. it's a specialization on ImageParam::is_host_aligned),
+    // loads and stores in the true branch may rely on it.
+    map<string, int> old_host_alignment = host_alignment;
+    find_host_alignment(op->condition, host_alignment);
+
     builder->SetInsertPoint(true_bb);
     codegen(op->then_case);
     builder->CreateBr(after_bb);
 
+    host_alignment.swap(old_host_alignment);
+
     builder->SetInsertPoint(false_bb);
     if (op->else_case.defined()) {
         codegen(op->else_case);
@@ -298,6 +298,7 @@ protected:
     virtual void visit(const Load *);
     virtual void visit(const Ramp *);
     virtual void visit(const Broadcast *);
+    virtual void visit(const VectorReduce *);
     virtual void visit(const Call *);
     virtual void visit(const Let *);
     virtual void visit(const LetStmt *);
@@ -345,6 +346,16 @@ protected:
      * guarantee their alignment) */
     std::set<std::string> might_be_misaligned;
 
+    /** The alignment in bytes known for the host pointers of some of
+     * the buffers in might_be_misaligned, because the code being
+     * generated is inside a branch that checked it. */
+    std::map<std::string, int> host_alignment;
+
+    /** The largest alignment in bytes that dense vector loads and
+     * stores from the given buffer may assume, given the alignment of
+     * the index within the buffer. */
+    int max_alignment(const std::string &buffer);
+
     /** The user_context argument. May be a constant null if the
      * function is being compiled without a user context. */
     llvm::Value *get_user_context() const;
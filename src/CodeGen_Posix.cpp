@@ -8,6 +8,7 @@
 #include "Debug.h"
 #include "IRPrinter.h"
 #include "Simplify.h"
+#include "PreparedPipeline.h"
 
 namespace Halide {
 namespace Internal {
@@ -120,20 +121,36 @@ CodeGen_Posix::Allocation CodeGen_Posix::create_allocation(const std::string &na
     } else {
         // call malloc
         llvm::Function *malloc_fn = module->getFunction("halide_malloc");
-        malloc_fn->setDoesNotAlias(0);
         internal_assert(malloc_fn) << "Could not find halide_malloc in module\n";
+        llvm::Function *free_fn = module->getFunction("halide_free");
+        internal_assert(free_fn) << "Could not find halide_free in module.\n";
+        Value *malloc_context = get_user_context();
+
+        // In the _prepared entry point made for the prepare_run
+        // target feature, allocations outside of parallel loops come
+        // from the prepared pipeline, which keeps them for its next
+        // call. (Parallel loop bodies don't see the context.)
+        if (sym_exists(prepared_context_name)) {
+            malloc_fn = module->getFunction("halide_prepared_malloc");
+            internal_assert(malloc_fn) << "Could not find halide_prepared_malloc in module\n";
+            free_fn = module->getFunction("halide_prepared_free");
+            internal_assert(free_fn) << "Could not find halide_prepared_free in module\n";
+            malloc_context = builder->CreatePointerCast(sym_get(prepared_context_name),
+                                                        malloc_fn->arg_begin()->getType());
+        }
+        malloc_fn->setDoesNotAlias(0);
 
         llvm::Function::arg_iterator arg_iter = malloc_fn->arg_begin();
         ++arg_iter;  // skip the user context *
         llvm_size = builder->CreateIntCast(llvm_size, arg_iter->getType(), false);
 
-        debug(4) << "Creating call to halide_malloc for allocation " << name
+        debug(4) << "Creating call to " << malloc_fn->getName().str() << " for allocation " << name
                  << " of size " << type.bytes();
         for (size_t i = 0; i < extents.size(); i++) {
             debug(4) << " x " << extents[i];
         }
         debug(4) << "\n";
-        Value *args[2] = { get_user_context(), llvm_size };
+        Value *args[2] = { malloc_context, llvm_size };
 
         CallInst *call = builder->CreateCall(malloc_fn, args);
         allocation.ptr = call;
@@ -147,8 +164,6 @@ CodeGen_Posix::Allocation CodeGen_Posix::create_allocation(const std::string &na
                                            std::vector<Expr>(), Call::Extern));
 
         // Register a destructor for it.
-        llvm::Function *free_fn = module->getFunction("halide_free");
-        internal_assert(free_fn) << "Could not find halide_free in module.\n";
         allocation.destructor = register_destructor(free_fn, allocation.ptr);
     }
 
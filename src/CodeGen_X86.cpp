@@ -9,6 +9,7 @@
 #include "Var.h"
 #include "Param.h"
 #include "IntegerDivisionTable.h"
+#include "FixedPoint.h"
 #include "LLVM_Headers.h"
 #include "IRMutator.h"
 
@@ -461,6 +462,69 @@ void CodeGen_X86::visit(const Cast *op) {
     CodeGen_Posix::visit(op);
 }
 
+void CodeGen_X86::visit(const Call *op) {
+    if (!op->type.is_vector() || !is_fixed_point_intrinsic(op)) {
+        CodeGen_Posix::visit(op);
+        return;
+    }
+
+    struct Pattern {
+        const char *op;
+        Type type;
+        string intrin;
+    };
+
+    static Pattern patterns[] = {
+        {Call::saturating_add, Int(8, 16), "llvm.x86.sse2.padds.b"},
+        {Call::saturating_add, UInt(8, 16), "llvm.x86.sse2.paddus.b"},
+        {Call::saturating_add, Int(16, 8), "llvm.x86.sse2.padds.w"},
+        {Call::saturating_add, UInt(16, 8), "llvm.x86.sse2.paddus.w"},
+        {Call::saturating_sub, Int(8, 16), "llvm.x86.sse2.psubs.b"},
+        {Call::saturating_sub, UInt(8, 16), "llvm.x86.sse2.psubus.b"},
+        {Call::saturating_sub, Int(16, 8), "llvm.x86.sse2.psubs.w"},
+        {Call::saturating_sub, UInt(16, 8), "llvm.x86.sse2.psubus.w"},
+        {Call::rounding_halving_add, UInt(8, 16), "llvm.x86.sse2.pavg.b"},
+        {Call::rounding_halving_add, UInt(16, 8), "llvm.x86.sse2.pavg.w"}
+    };
+
+    for (size_t i = 0; i < sizeof(patterns)/sizeof(patterns[0]); i++) {
+        const Pattern &pattern = patterns[i];
+        if (op->name == pattern.op && op->type.element_of() == pattern.type.element_of()) {
+            value = call_intrin(op->type, pattern.type.width, pattern.intrin, op->args);
+            return;
+        }
+    }
+
+    if (op->name == Call::mul_shift_right &&
+        op->type.bits == 16 && is_const(op->args[2], 16)) {
+        // The high half of a 16-bit multiply.
+        string intrin = op->type.is_int() ? "llvm.x86.sse2.pmulh.w" : "llvm.x86.sse2.pmulhu.w";
+        value = call_intrin(op->type, 8, intrin, vec(op->args[0], op->args[1]));
+        return;
+    }
+
+    // pmulhrsw is SSSE3, but there's no target feature for that. The
+    // baseline x86 target doesn't assume it (see mcpu below), so
+    // SSE41 is the weakest feature that implies it.
+    if (op->name == Call::rounding_mul_shift_right &&
+        op->type.element_of() == Int(16) && is_const(op->args[2], 15) &&
+        target.has_feature(Target::SSE41)) {
+        Value *a = codegen(op->args[0]);
+        Value *b = codegen(op->args[1]);
+        value = call_intrin(llvm_type_of(op->type), 8, "llvm.x86.ssse3.pmul.hr.sw.128", vec(a, b));
+        // pmulhrsw doesn't saturate, so -32768 * -32768 gives -32768
+        // instead of 32767. That's the only way to get -32768 from
+        // two equal inputs, so flip the bits in that case.
+        Value *min_val = codegen(make_const(op->type, -32768));
+        Value *overflow = builder->CreateAnd(builder->CreateICmpEQ(value, min_val),
+                                             builder->CreateICmpEQ(a, b));
+        value = builder->CreateXor(value, builder->CreateSExt(overflow, value->getType()));
+        return;
+    }
+
+    CodeGen_Posix::visit(op);
+}
+
 void CodeGen_X86::visit(const Div *op) {
 
     user_assert(!is_zero(op->b)) << "Division by constant zero in expression: " << Expr(op) << "\n";
@@ -690,6 +754,102 @@ void CodeGen_X86::visit(const Max *op) {
     }
 }
 
+void CodeGen_X86::visit(const VectorReduce *op) {
+    const int factor = op->value.type().width / op->type.width;
+    const int width = op->type.width;
+    const bool use_avx2 = target.has_feature(Target::AVX2);
+    const Mul *mul = op->value.as<Mul>();
+    const Cast *cast = op->value.as<Cast>();
+
+    if (op->op == VectorReduce::Add && factor % 2 == 0 && mul &&
+        op->type.element_of() == Int(32) && op->value.type().width % 8 == 0) {
+        // Sums of adjacent products of 16-bit values are pmaddwd.
+        Type narrow = Int(16, op->value.type().width);
+        Expr a = lossless_cast(narrow, mul->a);
+        Expr b = lossless_cast(narrow, mul->b);
+        if (a.defined() && b.defined()) {
+            Value *va = codegen(a), *vb = codegen(b);
+            int half_width = op->value.type().width / 2;
+            vector<Value *> results;
+            for (int i = 0; i < half_width; ) {
+                if (use_avx2 && i + 8 <= half_width) {
+                    results.push_back(call_intrin(i32x8, 8, "llvm.x86.avx2.pmadd.wd",
+                                                  vec(slice_vector(va, i*2, 16), slice_vector(vb, i*2, 16))));
+                    i += 8;
+                } else {
+                    results.push_back(call_intrin(i32x4, 4, "llvm.x86.sse2.pmadd.wd",
+                                                  vec(slice_vector(va, i*2, 8), slice_vector(vb, i*2, 8))));
+                    i += 4;
+                }
+            }
+            value = concat_vectors(results);
+
+            if (factor > 2) {
+                // Reduce the pairwise sums the rest of the way.
+                string name = unique_name('r');
+                sym_push(name, value);
+                Expr sums = Variable::make(Int(32, half_width), name);
+                value = codegen(VectorReduce::make(VectorReduce::Add, sums, width));
+                sym_pop(name);
+            }
+            return;
+        }
+    }
+
+    if (op->op == VectorReduce::Add && factor % 8 == 0 && cast &&
+        cast->value.type().element_of() == UInt(8) &&
+        op->type.bits >= 16 && op->value.type().width % 16 == 0) {
+        // Sums of groups of eight bytes are psadbw against zero. The
+        // sums fit in 16 bits, so this works for any wider type.
+        Value *v = codegen(cast->value);
+        int in_width = op->value.type().width;
+        vector<Value *> results;
+        for (int i = 0; i < in_width; ) {
+            if (use_avx2 && i + 32 <= in_width) {
+                Value *zero = Constant::getNullValue(i8x32);
+                results.push_back(call_intrin(i64x4, 4, "llvm.x86.avx2.psad.bw",
+                                              vec(slice_vector(v, i, 32), zero)));
+                i += 32;
+            } else {
+                Value *zero = Constant::getNullValue(i8x16);
+                results.push_back(call_intrin(i64x2, 2, "llvm.x86.sse2.psad.bw",
+                                              vec(slice_vector(v, i, 16), zero)));
+                i += 16;
+            }
+        }
+
+        // Reduce the partial sums the rest of the way.
+        string name = unique_name('r');
+        sym_push(name, concat_vectors(results));
+        Expr sums = Variable::make(UInt(64, in_width / 8), name);
+        sums = Cast::make(op->type.element_of().vector_of(in_width / 8), sums);
+        value = codegen(VectorReduce::make(VectorReduce::Add, sums, width));
+        sym_pop(name);
+        return;
+    }
+
+    if (op->op == VectorReduce::Min && factor == 8 &&
+        op->type.element_of() == UInt(16) &&
+        target.has_feature(Target::SSE41)) {
+        // phminposuw finds the minimum of eight unsigned 16-bit values.
+        Value *v = codegen(op->value);
+        value = UndefValue::get(llvm_type_of(op->type));
+        for (int i = 0; i < width; i++) {
+            Value *m = call_intrin(i16x8, 8, "llvm.x86.sse41.phminposuw",
+                                   vec(slice_vector(v, i*8, 8)));
+            m = builder->CreateExtractElement(m, ConstantInt::get(i32, 0));
+            if (op->type.is_scalar()) {
+                value = m;
+            } else {
+                value = builder->CreateInsertElement(value, m, ConstantInt::get(i32, i));
+            }
+        }
+        return;
+    }
+
+    CodeGen_Posix::visit(op);
+}
+
 string CodeGen_X86::mcpu() const {
     if (target.has_feature(Target::AVX)) return "corei7-avx";
     // We want SSE4.1 but not SSE4.2, hence "penryn" rather than "corei7"
@@ -48,6 +48,8 @@ protected:
     void visit(const EQ *);
     void visit(const NE *);
     void visit(const Select *);
+    void visit(const Call *);
+    void visit(const VectorReduce *);
     // @}
 };
 
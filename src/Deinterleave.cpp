@@ -247,6 +247,23 @@ private:
         }
     }
 
+    void visit(const VectorReduce *op) {
+        if (op->type.is_scalar()) {
+            expr = op;
+        } else {
+            // The lanes we want each depend on a contiguous group of
+            // lanes of the value, so just shuffle the result.
+            Type t = op->type;
+            t.width = new_width;
+            std::vector<Expr> args;
+            args.push_back(op);
+            for (int i = 0; i < new_width; i++) {
+                args.push_back(i*lane_stride + starting_lane);
+            }
+            expr = Call::make(t, Call::shuffle_vector, args, Call::Intrinsic);
+        }
+    }
+
     void visit(const Call *op) {
         Type t = op->type;
         t.width = new_width;
@@ -300,6 +300,11 @@ class Monotonic : public IRVisitor {
         internal_error << "Monotonic of vector\n";
     }
 
+    void visit(const VectorReduce *op) {
+        internal_assert(op->type.is_scalar()) << "Monotonic of vector\n";
+        result = Unknown;
+    }
+
     void visit(const Call *op) {
         // Some functions are known to be monotonic
         if (op->name == Call::likely && op->call_type == Call::Intrinsic) {
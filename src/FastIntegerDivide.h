@@ -30,7 +30,10 @@ EXPORT Image<uint32_t> integer_divide_table_s32();
  *
  * If your divisor is compile-time constant, Halide performs a
  * slightly better optimization automatically, so there's no need to
- * use this function (but it won't hurt).
+ * use this function (but it won't hurt). Similarly, if your divisor
+ * doesn't vary within the innermost loop (e.g. it's a Param), Halide
+ * computes the multiplier and shifts once outside the loop, for
+ * divisors of any value.
  *
  * This function vectorizes well on arm, and well on x86 for 16 and 8
  * bit vectors. For 32-bit vectors on x86 you're better off using
@@ -0,0 +1,118 @@
+#include "FixedPoint.h"
+#include "IROperator.h"
+
+namespace Halide {
+namespace Internal {
+
+namespace {
+// Get the value of a constant shift, which may have been cast or
+// broadcast.
+bool const_shift(Expr e, int *value) {
+    if (const Broadcast *b = e.as<Broadcast>()) {
+        return const_shift(b->value, value);
+    } else if (const Cast *c = e.as<Cast>()) {
+        return const_shift(c->value, value);
+    } else if (const IntImm *i = e.as<IntImm>()) {
+        *value = i->value;
+        return true;
+    } else {
+        return false;
+    }
+}
+}
+
+bool is_fixed_point_intrinsic(const Call *op) {
+    return (op->call_type == Call::Intrinsic &&
+            (op->name == Call::widening_add ||
+             op->name == Call::widening_sub ||
+             op->name == Call::widening_mul ||
+             op->name == Call::saturating_add ||
+             op->name == Call::saturating_sub ||
+             op->name == Call::halving_add ||
+             op->name == Call::halving_sub ||
+             op->name == Call::rounding_halving_add ||
+             op->name == Call::rounding_shift_right ||
+             op->name == Call::mul_shift_right ||
+             op->name == Call::rounding_mul_shift_right));
+}
+
+Expr lower_fixed_point_intrinsic(const Call *op) {
+    internal_assert(is_fixed_point_intrinsic(op));
+    internal_assert(op->args.size() >= 2);
+
+    Type t = op->args[0].type();
+    Type wide = t;
+    wide.bits *= 2;
+    Type wide_signed = Int(wide.bits, wide.width);
+
+    Expr a = op->args[0], b = op->args[1];
+    Expr wa = cast(wide, a), wb = cast(wide, b);
+
+    // The range of the narrow type, in the wide type.
+    Expr narrow_min = cast(wide, t.min());
+    Expr narrow_max = cast(wide, t.max());
+
+    if (op->name == Call::widening_add) {
+        return wa + wb;
+    } else if (op->name == Call::widening_sub) {
+        return cast(wide_signed, a) - cast(wide_signed, b);
+    } else if (op->name == Call::widening_mul) {
+        return wa * wb;
+    } else if (op->name == Call::saturating_add) {
+        if (t.is_uint()) {
+            return cast(t, min(wa + wb, narrow_max));
+        } else {
+            return cast(t, clamp(wa + wb, narrow_min, narrow_max));
+        }
+    } else if (op->name == Call::saturating_sub) {
+        Expr diff = cast(wide_signed, a) - cast(wide_signed, b);
+        if (t.is_uint()) {
+            return cast(t, max(diff, 0));
+        } else {
+            return cast(t, clamp(diff, cast(wide_signed, t.min()), cast(wide_signed, t.max())));
+        }
+    } else if (op->name == Call::halving_add) {
+        return cast(t, (wa + wb) / 2);
+    } else if (op->name == Call::halving_sub) {
+        return cast(t, (cast(wide_signed, a) - cast(wide_signed, b)) / 2);
+    } else if (op->name == Call::rounding_halving_add) {
+        return cast(t, (wa + wb + 1) / 2);
+    } else if (op->name == Call::rounding_shift_right) {
+        // Adding half of 2^b and shifting can't overflow the wide
+        // type, and the result always fits in the narrow type.
+        Expr half = (make_one(wide) << wb) >> make_one(wide);
+        return cast(t, (wa + half) >> wb);
+    }
+
+    internal_assert(op->args.size() == 3);
+    Expr q = op->args[2];
+    Expr wq = cast(wide, q);
+    Expr product = wa * wb;
+    Expr result = product >> wq;
+    if (op->name == Call::rounding_mul_shift_right) {
+        // Adding 2^(q-1) to the product before shifting can overflow
+        // the wide type (e.g. for uint16 with q >= 18, or int16 with q
+        // = 31), so add the bit that would carry in instead: bit q - 1
+        // of the product, which is bit q of the product shifted left
+        // by one. That's zero when q is zero.
+        result = result + (((product << make_one(wide)) >> wq) & make_one(wide));
+    } else {
+        internal_assert(op->name == Call::mul_shift_right);
+    }
+
+    // The product of two narrow values shifted right by at least
+    // the width of the narrow type always fits, so we only need to
+    // saturate for smaller shifts.
+    int const_q = 0;
+    if (!const_shift(q, &const_q) || const_q < t.bits) {
+        if (t.is_uint()) {
+            result = min(result, narrow_max);
+        } else {
+            result = clamp(result, narrow_min, narrow_max);
+        }
+    }
+    return cast(t, result);
+}
+
+}
+}
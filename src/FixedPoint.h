@@ -0,0 +1,26 @@
+#ifndef HALIDE_FIXED_POINT_H
+#define HALIDE_FIXED_POINT_H
+
+/** \file
+ * Defines methods for converting the fixed-point intrinsics
+ * (saturating_add, rounding_halving_add, mul_shift_right, etc) into
+ * Halide IR.
+ */
+
+#include "IR.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Is this a call to one of the fixed-point intrinsics? */
+bool is_fixed_point_intrinsic(const Call *op);
+
+/** Build Halide IR that computes a fixed-point intrinsic using
+ * arithmetic at twice the bit width. Used by codegen targets that
+ * don't have an instruction for it. */
+EXPORT Expr lower_fixed_point_intrinsic(const Call *op);
+
+}
+}
+
+#endif
@@ -0,0 +1,83 @@
+#include <string.h>
+
+#include "Float16.h"
+
+namespace Halide {
+
+namespace {
+
+uint32_t float_to_bits(float f) {
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    return bits;
+}
+
+float bits_to_float(uint32_t bits) {
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+}
+
+// These are scalar versions of the conversions done by the
+// lower_float16 lowering pass. See LowerFloat16.cpp for more
+// explanation.
+
+float16_t::float16_t(float value) {
+    uint32_t bits = float_to_bits(value);
+    uint32_t sign = bits & 0x80000000;
+    bits ^= sign;
+
+    uint32_t result;
+    if (bits >= (uint32_t)(127 + 16) << 23) {
+        // Too large, infinity, or nan
+        result = (bits > (uint32_t)255 << 23) ? 0x7e00 : 0x7c00;
+    } else if (bits < (uint32_t)113 << 23) {
+        // Denormal or zero. Adding this magic number shifts the
+        // mantissa bits we want into the bottom of the word, with the
+        // rounding done by the floating point unit.
+        const uint32_t magic = ((127 - 15) + (23 - 10) + 1) << 23;
+        result = float_to_bits(bits_to_float(bits) + bits_to_float(magic)) - magic;
+    } else {
+        // Normal. Rebias the exponent and round to nearest even.
+        uint32_t mant_odd = (bits >> 13) & 1;
+        bits += ((uint32_t)(15 - 127) << 23) + 0xfff + mant_odd;
+        result = bits >> 13;
+    }
+    data = (uint16_t)(result | (sign >> 16));
+}
+
+float16_t::operator float() const {
+    uint32_t bits = ((uint32_t)data & 0x7fff) << 13;
+    uint32_t exponent = bits & (0x7c00 << 13);
+    bits += (127 - 15) << 23;
+    if (exponent == (0x7c00 << 13)) {
+        // Infinity or nan
+        bits += (128 - 16) << 23;
+    } else if (exponent == 0) {
+        // Denormal or zero. Renormalize with a floating point subtract.
+        bits += 1 << 23;
+        bits = float_to_bits(bits_to_float(bits) - bits_to_float(113 << 23));
+    }
+    bits |= ((uint32_t)data & 0x8000) << 16;
+    return bits_to_float(bits);
+}
+
+bfloat16_t::bfloat16_t(float value) {
+    uint32_t bits = float_to_bits(value);
+    if ((bits & 0x7fffffff) > 0x7f800000) {
+        // Keep nans as nans by setting the quiet bit.
+        data = (uint16_t)((bits >> 16) | 0x40);
+    } else {
+        // Round to nearest even.
+        bits += 0x7fff + ((bits >> 16) & 1);
+        data = (uint16_t)(bits >> 16);
+    }
+}
+
+bfloat16_t::operator float() const {
+    return bits_to_float((uint32_t)data << 16);
+}
+
+}
@@ -0,0 +1,74 @@
+#ifndef HALIDE_FLOAT16_H
+#define HALIDE_FLOAT16_H
+
+#include <stdint.h>
+#include "Util.h"
+
+/** \file
+ * Defines C++ types that store 16-bit floating point values, for use
+ * with Image and Param.
+ */
+
+namespace Halide {
+
+/** An IEEE half-precision floating point number: a sign bit, five
+ * bits of exponent and ten bits of mantissa. This is the C++ type
+ * corresponding to Float(16). It's only meant for storage; do
+ * arithmetic on it by converting to float. */
+struct float16_t {
+    /** The raw bits. */
+    uint16_t data;
+
+    /** Construct a zero. */
+    float16_t() : data(0) {}
+
+    /** Construct from a float, rounding to the nearest representable
+     * value (ties to even). */
+    EXPORT explicit float16_t(float value);
+
+    /** Convert to a float. This is exact. */
+    EXPORT operator float() const;
+
+    /** Construct from raw bits. */
+    static float16_t make_from_bits(uint16_t bits) {
+        float16_t result;
+        result.data = bits;
+        return result;
+    }
+
+    /** Get the raw bits. */
+    uint16_t to_bits() const {return data;}
+};
+
+/** A brain floating point number: a float with the bottom 16 bits of
+ * mantissa dropped. It has the range of a float with about three
+ * significant decimal digits of precision. This is the C++ type
+ * corresponding to BFloat(16). */
+struct bfloat16_t {
+    /** The raw bits. */
+    uint16_t data;
+
+    /** Construct a zero. */
+    bfloat16_t() : data(0) {}
+
+    /** Construct from a float, rounding to the nearest representable
+     * value (ties to even). */
+    EXPORT explicit bfloat16_t(float value);
+
+    /** Convert to a float. This is exact. */
+    EXPORT operator float() const;
+
+    /** Construct from raw bits. */
+    static bfloat16_t make_from_bits(uint16_t bits) {
+        bfloat16_t result;
+        result.data = bits;
+        return result;
+    }
+
+    /** Get the raw bits. */
+    uint16_t to_bits() const {return data;}
+};
+
+}
+
+#endif
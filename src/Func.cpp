@@ -18,6 +18,7 @@
 #include "Image.h"
 #include "Param.h"
 #include "PrintLoopNest.h"
+#include "PreparedPipeline.h"
 #include "Debug.h"
 #include "IREquality.h"
 #include "CodeGen_LLVM.h"
@@ -54,6 +55,25 @@ vector<Argument> add_user_context_arg(vector<Argument> args, const Target& targe
     return args;
 }
 
+// Make the body of a public function that calls the private function
+// with the given arguments, and returns its error code.
+Stmt call_private_function(const string &private_name, const vector<Argument> &private_args) {
+    vector<Expr> private_params;
+    for (size_t i = 0; i < private_args.size(); i++) {
+        const Argument &arg = private_args[i];
+        if (arg.is_buffer()) {
+            private_params.push_back(Variable::make(type_of<void*>(), arg.name + ".buffer"));
+        } else {
+            private_params.push_back(Variable::make(arg.type, arg.name));
+        }
+    }
+    string private_result_name = unique_name(private_name + "_result", false);
+    Expr private_result_var = Variable::make(Int(32), private_result_name);
+    Expr call_private = Call::make(Int(32), private_name, private_params, Call::Extern);
+    Stmt public_body = AssertStmt::make(private_result_var == 0, private_result_var);
+    return LetStmt::make(private_result_name, call_private, public_body);
+}
+
 }  // namespace
 
 Func::Func(const string &name) : func(unique_name(name)),
@@ -187,6 +207,17 @@ void Func::define_extern(const std::string &function_name,
     func.define_extern(function_name, args, types, dimensionality);
 }
 
+void Func::define_extern(const std::string &function_name,
+                         const std::vector<ExternFuncArgument> &args,
+                         const std::vector<Type> &types,
+                         const std::vector<Var> &arguments) {
+    std::vector<std::string> dims;
+    for (const Var &v : arguments) {
+        dims.push_back(v.name());
+    }
+    func.define_extern(function_name, args, types, dims);
+}
+
 /** Get the types of the buffers returned by an extern definition. */
 const std::vector<Type> &Func::output_types() const {
     return func.output_types();
@@ -293,7 +324,11 @@ void Stage::set_dim_type(VarOrRVar var, ForType t) {
 
             // If it's an rvar and the for type is parallel, we need to
             // validate that this doesn't introduce a race condition.
-            if (!dims[i].pure && var.is_rvar && (t == ForType::Vectorized || t == ForType::Parallel)) {
+            // Vectorizing an associative update is fine though, because
+            // the lanes get reduced horizontally before the store.
+            if (!dims[i].pure && var.is_rvar &&
+                (t == ForType::Parallel ||
+                 (t == ForType::Vectorized && !dims[i].associative))) {
                 user_assert(schedule.allow_race_conditions())
                     << "In schedule for " << stage_name
                     << ", marking var " << var.name()
@@ -432,12 +467,13 @@ Stage &Stage::fuse(VarOrRVar inner, VarOrRVar outer, VarOrRVar fused) {
     string inner_name, outer_name, fused_name;
     vector<Dim> &dims = schedule.dims();
 
-    bool outer_pure = false;
+    bool outer_pure = false, outer_associative = false;
     for (size_t i = 0; (!found_outer) && i < dims.size(); i++) {
         if (var_name_match(dims[i].var, outer.name())) {
             found_outer = true;
             outer_name = dims[i].var;
             outer_pure = dims[i].pure;
+            outer_associative = dims[i].associative;
             dims.erase(dims.begin() + i);
         }
     }
@@ -456,6 +492,7 @@ Stage &Stage::fuse(VarOrRVar inner, VarOrRVar outer, VarOrRVar fused) {
             fused_name = inner_name + "." + fused.name();
             dims[i].var = fused_name;
             dims[i].pure &= outer_pure;
+            dims[i].associative &= outer_associative;
         }
     }
 
@@ -1121,6 +1158,35 @@ Func &Func::reorder_storage(const std::vector<Var> &dims) {
     return reorder_storage(dims, 0);
 }
 
+Func &Func::fold_storage(Var dim, Expr extent) {
+    invalidate_cache();
+    bool found = false;
+    for (size_t i = 0; i < func.args().size(); i++) {
+        if (dim.name() == func.args()[i]) {
+            found = true;
+        }
+    }
+    user_assert(found)
+        << "Can't fold storage of variable " << dim.name()
+        << " of function " << name()
+        << " because " << dim.name()
+        << " is not one of the pure variables of " << name() << ".\n";
+    user_assert(extent.defined() && extent.type().is_int() && extent.type().width == 1)
+        << "Fold extent for variable " << dim.name()
+        << " of function " << name()
+        << " must be a scalar signed integer expression.\n";
+    if (const IntImm *i = extent.as<IntImm>()) {
+        user_assert(i->value > 0)
+            << "Fold extent for variable " << dim.name()
+            << " of function " << name()
+            << " must be positive.\n";
+    }
+
+    StorageFold f = {dim.name(), cast<int>(extent)};
+    func.schedule().storage_folds().push_back(f);
+    return *this;
+}
+
 Func &Func::compute_at(Func f, RVar var) {
     return compute_at(f, Var(var.name()));
 }
@@ -1873,23 +1939,29 @@ Module Func::compile_to_module(const vector<Argument> &args, const std::string &
 
     // Generate a call to the private function, adding an arguments
     // for the global images.
-    vector<Expr> private_params;
-    for (size_t i = 0; i < private_args.size(); i++) {
-        const Argument &arg = private_args[i];
-        if (arg.is_buffer()) {
-            private_params.push_back(Variable::make(type_of<void*>(), arg.name + ".buffer"));
-        } else {
-            private_params.push_back(Variable::make(arg.type, arg.name));
-        }
-    }
-    string private_result_name = unique_name(private_name + "_result", false);
-    Expr private_result_var = Variable::make(Int(32), private_result_name);
-    Expr call_private = Call::make(Int(32), private_name, private_params, Call::Extern);
-    Stmt public_body = AssertStmt::make(private_result_var == 0, private_result_var);
-    public_body = LetStmt::make(private_result_name, call_private, public_body);
+    Stmt public_body = call_private_function(private_name, private_args);
 
     module.append(LoweredFunc(public_name, public_args, public_body, LoweredFunc::External));
 
+    if (target.has_feature(Target::PrepareRun)) {
+        // The _prepared entry point takes the prepared pipeline it
+        // belongs to as an extra last argument. It skips the checks
+        // on the arguments when the runtime says they have already
+        // passed them, and allocates through the prepared pipeline.
+        Argument context(prepared_context_name, Argument::InputScalar, Handle(), 0);
+        string prepared_name = public_name + "_prepared";
+        vector<Argument> prepared_public_args = public_args;
+        vector<Argument> prepared_private_args = private_args;
+        prepared_public_args.push_back(context);
+        prepared_private_args.push_back(context);
+
+        module.append(LoweredFunc("__" + prepared_name, prepared_private_args,
+                                  skip_validated_checks(private_body), LoweredFunc::Internal));
+        module.append(LoweredFunc(prepared_name, prepared_public_args,
+                                  call_private_function("__" + prepared_name, prepared_private_args),
+                                  LoweredFunc::External));
+    }
+
     return module;
 }
 
@@ -1942,6 +2014,16 @@ void Func::compile_to_object(const string &filename, const vector<Argument> &arg
     compile_to_object(filename, args, "", target);
 }
 
+void Func::compile_to_multitarget_object(const string &filename, const vector<Argument> &args,
+                                         const string &fn_name, const vector<Target> &targets) {
+    string public_name = fn_name.empty() ? name() : fn_name;
+    compile_multitarget_to_object(public_name, targets,
+                                  [&](const string &variant_name, const Target &target) {
+                                      return compile_to_module(args, variant_name, target);
+                                  },
+                                  filename);
+}
+
 void Func::compile_to_header(const string &filename, const vector<Argument> &args, const string &fn_name, const Target &target) {
     compile_module_to_c_header(compile_to_module(args, fn_name, target), filename);
 }
@@ -553,6 +553,19 @@ public:
                                   const Target &target = get_target_from_environment());
     // @}
 
+    /** Statically compile this function to an object file containing
+     * one variant per target, and an entry point named fn_name that
+     * picks the first variant the host cpu can run. List the targets
+     * best first (e.g. x86-64-linux-avx-avx2-fma, then
+     * x86-64-linux-sse41, then x86-64-linux); the last is the
+     * fallback, and provides the runtime. The targets must only
+     * differ in x86 instruction set features. The header emitted by
+     * compile_to_header for the last target matches this object. See
+     * compile_multitarget_to_object. */
+    EXPORT void compile_to_multitarget_object(const std::string &filename, const std::vector<Argument> &,
+                                              const std::string &fn_name,
+                                              const std::vector<Target> &targets);
+
     /** Emit a header file with the given filename for this
      * function. The header will define a function with the type
      * signature given by the second argument, and a name given by the
@@ -845,6 +858,40 @@ public:
                               int dimensionality);
     // @}
 
+    /** Add an extern definition for this Func, naming its
+     * dimensions. The names can then be used to schedule the extern
+     * stage. In particular, splitting or tiling its dimensions makes
+     * Halide call the extern function once per tile, with an output
+     * buffer covering just that tile, so the calls can be
+     * parallelized like any other loop:
+     \code
+     Func f;
+     Var x, y, xi, yi;
+     f.define_extern("my_filter", {input}, Float(32), {x, y});
+     f.tile(x, y, xi, yi, 64, 64).parallel(y);
+     \endcode
+     * The tile dimensions themselves (xi and yi above) are traversed
+     * by the extern function, so they can't be parallelized or
+     * unrolled. Vectorizing one of them instead shifts the tiles at
+     * the far edge inwards, so every tile is exactly the split factor
+     * wide along it, and the extern function can use vector code
+     * without a scalar tail. Inputs of the extern stage can be
+     * computed at the loops over the tiles, in which case each
+     * bounds query describes just the tiles inside that loop. */
+    // @{
+    EXPORT void define_extern(const std::string &function_name,
+                              const std::vector<ExternFuncArgument> &params,
+                              Type t,
+                              const std::vector<Var> &arguments) {
+        define_extern(function_name, params, Internal::vec<Type>(t), arguments);
+    }
+
+    EXPORT void define_extern(const std::string &function_name,
+                              const std::vector<ExternFuncArgument> &params,
+                              const std::vector<Type> &types,
+                              const std::vector<Var> &arguments);
+    // @}
+
     /** Get the types of the outputs of this Func. */
     EXPORT const std::vector<Type> &output_types() const;
 
@@ -1308,6 +1355,33 @@ public:
     }
     // @}
 
+    /** Store this function as a circular buffer of the given extent
+     * in the given dimension. Normally Halide only folds storage
+     * when it can prove that the region used in each iteration of
+     * the loop that walks along the dimension is bounded. This lets
+     * you fold when the bound depends on something Halide can't
+     * reason about (e.g. data-dependent access), or to pick a larger
+     * fold than the minimum. The extent is rounded up to a power of
+     * two, so that indexing into the circular buffer is a mask. If
+     * Halide can't prove the extent is large enough, a check is
+     * inserted that fails at runtime if the region used in one
+     * iteration does not fit, and if it can prove the extent is too
+     * small, that's a compile-time error. Requires a serial loop along the
+     * dimension between the store_at and compute_at levels of this
+     * function, and can't be used on functions consumed by extern
+     * stages, e.g.
+     *
+     \code
+     Func f, g;
+     Var x, y;
+     Param<int> k;
+     f(x, y) = x + y;
+     g(x, y) = f(x, y) + f(x, y + k);
+     f.store_root().compute_at(g, y).fold_storage(y, k + 1);
+     \endcode
+     */
+    EXPORT Func &fold_storage(Var dim, Expr extent);
+
     /** Compute this function as needed for each unique value of the
      * given var for the given calling function f.
      *
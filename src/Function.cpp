@@ -295,14 +295,14 @@ void Function::define(const vector<string> &args, vector<Expr> values) {
     }
 
     for (size_t i = 0; i < args.size(); i++) {
-        Dim d = {args[i], ForType::Serial, DeviceAPI::Parent, true};
+        Dim d = {args[i], ForType::Serial, DeviceAPI::Parent, true, false};
         contents.ptr->schedule.dims().push_back(d);
         contents.ptr->schedule.storage_dims().push_back(args[i]);
     }
 
     // Add the dummy outermost dim
     {
-        Dim d = {Var::outermost().name(), ForType::Serial, DeviceAPI::Parent, true};
+        Dim d = {Var::outermost().name(), ForType::Serial, DeviceAPI::Parent, true, false};
         contents.ptr->schedule.dims().push_back(d);
     }
 
@@ -469,8 +469,9 @@ void Function::define_update(const vector<Expr> &_args, vector<Expr> values) {
             const string &v = r.domain.domain()[i].var;
 
             bool pure = can_parallelize_rvar(v, name(), r);
+            bool associative = can_vectorize_rvar_as_reduction(v, name(), r);
 
-            Dim d = {v, ForType::Serial, DeviceAPI::Parent, pure};
+            Dim d = {v, ForType::Serial, DeviceAPI::Parent, pure, associative};
             r.schedule.dims().push_back(d);
         }
     }
@@ -478,14 +479,14 @@ void Function::define_update(const vector<Expr> &_args, vector<Expr> values) {
     // Then add the pure args outside of that
     for (size_t i = 0; i < pure_args.size(); i++) {
         if (!pure_args[i].empty()) {
-            Dim d = {pure_args[i], ForType::Serial, DeviceAPI::Parent, true};
+            Dim d = {pure_args[i], ForType::Serial, DeviceAPI::Parent, true, false};
             r.schedule.dims().push_back(d);
         }
     }
 
     // Then the dummy outermost dim
     {
-        Dim d = {Var::outermost().name(), ForType::Serial, DeviceAPI::Parent, true};
+        Dim d = {Var::outermost().name(), ForType::Serial, DeviceAPI::Parent, true, false};
         r.schedule.dims().push_back(d);
     }
 
@@ -511,6 +512,18 @@ void Function::define_extern(const std::string &function_name,
                              const std::vector<ExternFuncArgument> &args,
                              const std::vector<Type> &types,
                              int dimensionality) {
+    // Make some synthetic var names for scheduling purposes (e.g. reorder_storage).
+    vector<string> dims(dimensionality);
+    for (int i = 0; i < dimensionality; i++) {
+        dims[i] = unique_name('e');
+    }
+    define_extern(function_name, args, types, dims);
+}
+
+void Function::define_extern(const std::string &function_name,
+                             const std::vector<ExternFuncArgument> &args,
+                             const std::vector<Type> &types,
+                             const std::vector<std::string> &dims) {
 
     user_assert(!has_pure_definition() && !has_update_definition())
         << "In extern definition for Func \"" << name() << "\":\n"
@@ -529,16 +542,24 @@ void Function::define_extern(const std::string &function_name,
         if (types.size() > 1) {
             buffer_name += '.' + int_to_string((int)i);
         }
-        Parameter output(types[i], true, dimensionality, buffer_name);
+        Parameter output(types[i], true, (int)dims.size(), buffer_name);
         contents.ptr->output_buffers.push_back(output);
     }
 
-    // Make some synthetic var names for scheduling purposes (e.g. reorder_storage).
-    contents.ptr->args.resize(dimensionality);
-    for (int i = 0; i < dimensionality; i++) {
-        string arg = unique_name('e');
-        contents.ptr->args[i] = arg;
-        contents.ptr->schedule.storage_dims().push_back(arg);
+    // The dims can be used to reorder the storage, or to split the
+    // extern stage into tiles that are each computed by a separate
+    // call (see build_produce).
+    contents.ptr->args = dims;
+    for (size_t i = 0; i < dims.size(); i++) {
+        Dim d = {dims[i], ForType::Serial, DeviceAPI::Parent, true, false};
+        contents.ptr->schedule.dims().push_back(d);
+        contents.ptr->schedule.storage_dims().push_back(dims[i]);
+    }
+
+    // Add the dummy outermost dim
+    {
+        Dim d = {Var::outermost().name(), ForType::Serial, DeviceAPI::Parent, true, false};
+        contents.ptr->schedule.dims().push_back(d);
     }
 }
 
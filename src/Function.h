@@ -157,6 +157,13 @@ public:
                               const std::vector<Type> &types,
                               int dimensionality);
 
+    /** Add an external definition of this Func, using the given
+     * names for its dimensions. */
+    EXPORT void define_extern(const std::string &function_name,
+                              const std::vector<ExternFuncArgument> &args,
+                              const std::vector<Type> &types,
+                              const std::vector<std::string> &dims);
+
     /** Retrive the arguments of the extern definition */
     EXPORT const std::vector<ExternFuncArgument> &extern_arguments() const;
 
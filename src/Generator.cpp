@@ -1,4 +1,7 @@
+#include <set>
+
 #include "Generator.h"
+#include "Output.h"
 
 namespace {
 
@@ -48,7 +51,11 @@ int generate_filter_main(int argc, char **argv, std::ostream &cerr) {
     const char kUsage[] = "gengen [-g GENERATOR_NAME] [-f FUNCTION_NAME] [-o OUTPUT_DIR] [-e EMIT_OPTIONS] "
                           "target=target-string [generator_arg=value [...]]\n\n"
                           "  -e  A comma separated list of optional files to emit. Accepted values are "
-                          "[assembly, bitcode, stmt, html]\n";
+                          "[assembly, bitcode, stmt, html]\n\n"
+                          "  target may be a comma separated list of targets, best first, which only differ\n"
+                          "  in x86 instruction set features (e.g. x86-64-linux-avx-avx2,x86-64-linux-sse41,x86-64-linux).\n"
+                          "  The object file then contains a variant per target, and picks one at runtime.\n"
+                          "  The header and the files given by -e are for the last target.\n";
 
     std::map<std::string, std::string> flags_info = { { "-f", "" }, { "-g", "" }, { "-o", "" }, { "-e", "" } };
     std::map<std::string, std::string> generator_args;
@@ -131,6 +138,32 @@ int generate_filter_main(int argc, char **argv, std::ostream &cerr) {
         }
     }
 
+    std::vector<std::string> target_strings = split_string(generator_args["target"], ",");
+    if (target_strings.size() > 1) {
+        // Compile the object with a fresh Generator for each target, so
+        // that schedules can depend on the target, and emit everything
+        // else for the fallback (last) target.
+        std::vector<Target> targets;
+        for (const std::string &s : target_strings) {
+            targets.push_back(parse_target_string(s));
+        }
+        generator_args["target"] = target_strings.back();
+        if (GeneratorRegistry::create(generator_name, generator_args) == nullptr) {
+            cerr << "Unknown generator: " << generator_name << "\n";
+            cerr << kUsage;
+            return 1;
+        }
+        auto module_producer = [&](const std::string &name, const Target &t) {
+            GeneratorParamValues variant_args = generator_args;
+            variant_args["target"] = t.to_string();
+            std::unique_ptr<GeneratorBase> variant = GeneratorRegistry::create(generator_name, variant_args);
+            return variant->build_module(name, t);
+        };
+        compile_multitarget_to_object(function_name, targets, module_producer,
+                                      output_dir + "/" + function_name + ".o");
+        emit_options.emit_o = false;
+    }
+
     std::unique_ptr<GeneratorBase> gen = GeneratorRegistry::create(generator_name, generator_args);
     if (gen == nullptr) {
         cerr << "Unknown generator: " << generator_name << "\n";
@@ -200,7 +233,8 @@ std::vector<std::string> GeneratorRegistry::enumerate() {
     return result;
 }
 
-GeneratorBase::GeneratorBase(size_t size, const void *introspection_helper) : size(size), params_built(false) {
+GeneratorBase::GeneratorBase(size_t size, const void *introspection_helper)
+    : size(size), params_built(false), current_size_class(-1) {
     ObjectInstanceRegistry::register_instance(this, size, ObjectInstanceRegistry::Generator, this, introspection_helper);
 }
 
@@ -274,17 +308,79 @@ void GeneratorBase::set_generator_param_values(const GeneratorParamValues &param
     }
 }
 
+Module GeneratorBase::build_module(const std::string &function_name, const Target &target) {
+    build_params();
+
+    std::vector<SizeClass> classes = size_classes();
+    if (classes.empty()) {
+        return build().compile_to_module(get_filter_arguments(), function_name, target);
+    }
+
+    user_assert(!generator_name().empty())
+        << "Only registered Generators can have size classes.\n";
+    std::vector<Module> variants;
+    std::vector<Expr> conditions;
+    std::set<std::string> names;
+    for (size_t i = 0; i < classes.size(); i++) {
+        const SizeClass &c = classes[i];
+        user_assert(is_valid_name(c.name) && names.insert(c.name).second)
+            << "Invalid or duplicate size class name: " << c.name << "\n";
+        user_assert(c.condition.defined() == (i + 1 < classes.size()))
+            << "Size class " << c.name << " of Generator " << generator_name() << " "
+            << (c.condition.defined() ? "is the last one, so it must not have a condition.\n"
+                                      : "must have a condition, because it isn't the last one.\n");
+
+        // Build each variant with a fresh Generator, so that build()
+        // is only ever called once per instance.
+        std::unique_ptr<GeneratorBase> variant =
+            GeneratorRegistry::create(generator_name(), get_generator_param_values());
+        variant->current_size_class = (int)i;
+        Func f = variant->build();
+        variants.push_back(f.compile_to_module(variant->get_filter_arguments(),
+                                               function_name + "_" + c.name, target));
+        conditions.push_back(c.condition);
+    }
+    return link_variants_with_dispatch(function_name, variants, conditions);
+}
+
 void GeneratorBase::emit_filter(const std::string &output_dir,
                                 const std::string &function_name,
                                 const std::string &file_base_name,
                                 const EmitOptions &options) {
     build_params();
 
+    // With size classes, the object has a variant per size class, and
+    // everything else is emitted for the last one.
+    std::vector<SizeClass> classes = size_classes();
+    if (!classes.empty()) {
+        current_size_class = (int)classes.size() - 1;
+    }
+
     Func func = build();
 
     std::vector<Halide::Argument> inputs = get_filter_arguments();
     std::string base_path = output_dir + "/" + (file_base_name.empty() ? function_name : file_base_name);
-    if (options.emit_o || options.emit_assembly || options.emit_bitcode) {
+    if (!classes.empty() && (options.emit_o || options.emit_assembly || options.emit_bitcode)) {
+        Module module = build_module(function_name, target);
+        bool pnacl = Target(target).arch == Target::PNaCl;
+        if (options.emit_o) {
+            if (pnacl) {
+                compile_module_to_llvm_bitcode(module, base_path + ".bc");
+            } else {
+                compile_module_to_object(module, base_path + ".o");
+            }
+        }
+        if (options.emit_assembly) {
+            if (pnacl) {
+                compile_module_to_llvm_assembly(module, base_path + ".s");
+            } else {
+                compile_module_to_assembly(module, base_path + ".s");
+            }
+        }
+        if (options.emit_bitcode) {
+            compile_module_to_llvm_bitcode(module, base_path + ".bc");
+        }
+    } else if (options.emit_o || options.emit_assembly || options.emit_bitcode) {
         Outputs output_files;
         if (options.emit_o) {
             // If the target arch is pnacl, then the output "object" file is
@@ -310,7 +406,11 @@ void GeneratorBase::emit_filter(const std::string &output_dir,
         func.compile_to_header(base_path + ".h", inputs, function_name, target);
     }
     if (options.emit_cpp) {
-        func.compile_to_c(base_path + ".cpp", inputs, function_name, target);
+        if (!classes.empty()) {
+            compile_module_to_c_source(build_module(function_name, target), base_path + ".cpp");
+        } else {
+            func.compile_to_c(base_path + ".cpp", inputs, function_name, target);
+        }
     }
     if (options.emit_stmt) {
         func.compile_to_lowered_stmt(base_path + ".stmt", inputs, Halide::Text, target);
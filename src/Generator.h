@@ -379,6 +379,36 @@ public:
     /** Build and return a Halide::Func. All Generators must override this. */
     virtual Func build() = 0;
 
+    /** A named condition on the arguments of the pipeline. See size_classes. */
+    struct SizeClass {
+        std::string name;
+        Expr condition;
+    };
+
+    /** Generators can override this to compile a variant of the
+     * pipeline per size class into a single object, so that (for
+     * example) small and large inputs can use different tile sizes and
+     * parallelism. Each variant is built by a fresh instance of the
+     * Generator, whose size_class() returns the index of the variant,
+     * so build() can use it to choose a schedule. The entry point of
+     * the object calls the first variant whose condition is true. The
+     * conditions may refer to Params and to the sizes of ImageParams
+     * (e.g. input.width() >= 1920), and must be cheap to evaluate. The
+     * condition of the last size class must be undefined: it's used
+     * when none of the others apply. Returns no size classes by
+     * default, in which case a single variant is built. */
+    virtual std::vector<SizeClass> size_classes() { return std::vector<SizeClass>(); }
+
+    /** The index in size_classes() of the variant being built, or -1
+     * if the Generator has no size classes. */
+    int size_class() const { return current_size_class; }
+
+    /** Build the pipeline and lower it to a Module whose entry point is
+     * named function_name. If the Generator has size classes, this
+     * builds each variant, and links them together with an entry
+     * point that dispatches between them. */
+    EXPORT Module build_module(const std::string &function_name, const Target &target);
+
     /** Return a Func that calls a previously-generated instance of this Generator.
      * This is (essentially) a smart wrapper around define_extern(), but uses the
      * output types and dimensionality of the Func returned by build. It is
@@ -445,6 +475,7 @@ private:
     std::map<std::string, Internal::Parameter *> filter_params;
     std::map<std::string, Internal::GeneratorParamBase *> generator_params;
     bool params_built;
+    int current_size_class;
 
     virtual const std::string &generator_name() const = 0;
 
@@ -0,0 +1,175 @@
+#include "HoistParallelAllocations.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "Bounds.h"
+#include "ExprUsesVar.h"
+#include "Simplify.h"
+#include "Scope.h"
+#include "CodeGen_GPU_Dev.h"
+#include "Debug.h"
+#include "ParallelTasks.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::string;
+using std::vector;
+
+namespace {
+
+// Allocations at or below this size that are constant-sized will be
+// placed on the stack by the code generator, so there's nothing to
+// be gained by hoisting them. Must match CodeGen_Posix.
+const int64_t max_stack_bytes = 1024 * 16;
+
+struct HoistedAllocation {
+    string name;
+    Type type;
+    vector<Expr> extents;
+};
+
+bool allocation_fits_on_stack(const Allocate *op) {
+    int64_t bytes = op->type.bytes();
+    for (size_t i = 0; i < op->extents.size(); i++) {
+        const int *c = as_const_int(op->extents[i]);
+        if (!c) return false;
+        bytes *= *c;
+        if (bytes > max_stack_bytes) return false;
+    }
+    return true;
+}
+
+// Strip allocations out of the body of a parallel loop whose extents
+// can be bounded in terms of things defined outside the loop, and
+// record them with their maximum size.
+class RemoveHoistableAllocations : public IRMutator {
+    using IRMutator::visit;
+
+    // The bounds of everything defined within the loop body.
+    Scope<Interval> scope;
+    // The names defined within the loop body, which must not appear
+    // in the hoisted extents.
+    Scope<int> inner_vars;
+
+    void visit(const LetStmt *op) {
+        Interval i = bounds_of_expr_in_scope(op->value, scope);
+        scope.push(op->name, i);
+        inner_vars.push(op->name, 0);
+        IRMutator::visit(op);
+        inner_vars.pop(op->name);
+        scope.pop(op->name);
+    }
+
+    void visit(const For *op) {
+        if (op->for_type == ForType::Parallel ||
+            CodeGen_GPU_Dev::is_gpu_var(op->name)) {
+            // Allocations inside a nested parallel loop (or a gpu
+            // kernel) can't be shared between the iterations of that
+            // loop. Leave them for the inner loop to deal with.
+            stmt = op;
+            return;
+        }
+        Interval min_bounds = bounds_of_expr_in_scope(op->min, scope);
+        Interval extent_bounds = bounds_of_expr_in_scope(op->extent, scope);
+        Interval i;
+        if (min_bounds.min.defined()) {
+            i.min = min_bounds.min;
+        }
+        if (min_bounds.max.defined() && extent_bounds.max.defined()) {
+            i.max = (min_bounds.max + extent_bounds.max) - 1;
+        }
+        scope.push(op->name, i);
+        inner_vars.push(op->name, 0);
+        IRMutator::visit(op);
+        inner_vars.pop(op->name);
+        scope.pop(op->name);
+    }
+
+    void visit(const Allocate *op) {
+        if (!is_one(op->condition) || allocation_fits_on_stack(op)) {
+            IRMutator::visit(op);
+            return;
+        }
+
+        vector<Expr> max_extents;
+        for (size_t i = 0; i < op->extents.size(); i++) {
+            Interval bounds = bounds_of_expr_in_scope(op->extents[i], scope);
+            if (!bounds.max.defined() ||
+                expr_uses_vars(bounds.max, inner_vars)) {
+                debug(3) << "Not hoisting allocation of " << op->name
+                         << " out of parallel loop because extent "
+                         << op->extents[i] << " could not be bounded\n";
+                IRMutator::visit(op);
+                return;
+            }
+            max_extents.push_back(simplify(max(bounds.max, 0)));
+        }
+
+        HoistedAllocation h = {op->name, op->type, max_extents};
+        hoisted.push_back(h);
+        debug(3) << "Hoisting allocation of " << op->name << " out of parallel loop\n";
+        stmt = mutate(op->body);
+    }
+
+public:
+    vector<HoistedAllocation> hoisted;
+
+    RemoveHoistableAllocations(const string &loop_var, Interval loop_bounds) {
+        scope.push(loop_var, loop_bounds);
+        inner_vars.push(loop_var, 0);
+    }
+};
+
+class HoistParallelAllocations : public IRMutator {
+    using IRMutator::visit;
+
+    void visit(const For *op) {
+        if (op->for_type != ForType::Parallel ||
+            CodeGen_GPU_Dev::is_gpu_var(op->name) ||
+            (op->device_api != DeviceAPI::Host &&
+             op->device_api != DeviceAPI::Parent)) {
+            IRMutator::visit(op);
+            return;
+        }
+
+        // Handle any nested parallel loops first.
+        Stmt body = mutate(op->body);
+
+        Interval loop_bounds(op->min, op->min + op->extent - 1);
+        RemoveHoistableAllocations remover(op->name, loop_bounds);
+        body = remover.mutate(body);
+
+        if (remover.hoisted.empty()) {
+            if (body.same_as(op->body)) {
+                stmt = op;
+            } else {
+                stmt = For::make(op->name, op->min, op->extent, op->for_type, op->device_api, body);
+            }
+            return;
+        }
+
+        // Split the loop into at most max_parallel_tasks parallel
+        // tasks, each of which runs a contiguous chunk of the
+        // iterations serially.
+        ParallelTasks tasks(op, "task");
+        body = For::make(op->name, tasks.inner_min, tasks.inner_extent, ForType::Serial, op->device_api, body);
+
+        // Wrap the hoisted allocations around the serial loop, in
+        // their original nesting order.
+        for (size_t i = remover.hoisted.size(); i > 0; i--) {
+            const HoistedAllocation &h = remover.hoisted[i-1];
+            body = Allocate::make(h.name, h.type, h.extents, const_true(), body);
+        }
+
+        stmt = tasks.wrap(body);
+    }
+};
+
+}
+
+Stmt hoist_parallel_allocations(Stmt s) {
+    return HoistParallelAllocations().mutate(s);
+}
+
+}
+}
@@ -0,0 +1,49 @@
+#ifndef HALIDE_HOIST_PARALLEL_ALLOCATIONS_H
+#define HALIDE_HOIST_PARALLEL_ALLOCATIONS_H
+
+/** \file
+ * Defines the lowering pass that moves heap allocations out of the
+ * body of parallel for loops, so that they are made once per task
+ * instead of once per loop iteration.
+ */
+
+#include "IR.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Find allocations inside the body of parallel for loops whose size
+ * can be bounded across all iterations of the loop. Each such loop is
+ * then split into a bounded number of parallel tasks that each run a
+ * contiguous chunk of the original iterations serially, and the
+ * allocations are moved up to the task level at their maximum size,
+ * so that each task's scratch buffers are reused across the
+ * iterations it runs. E.g:
+ *
+ \code
+ parallel for (f.s0.y, 0, 1000) {
+   allocate g[int32 * g.extent.0(f.s0.y)]
+   ...
+ }
+ \endcode
+ *
+ * becomes:
+ *
+ \code
+ parallel for (f.s0.y.task, 0, 63) {
+   allocate g[int32 * max over f.s0.y of g.extent.0(f.s0.y)]
+   for (f.s0.y, f.s0.y.task*16, min(16, 1000 - f.s0.y.task*16)) {
+     ...
+   }
+ }
+ \endcode
+ *
+ * Allocations small enough and constant-sized enough to live on the
+ * stack are left alone. Should be done before early frees are
+ * injected. */
+Stmt hoist_parallel_allocations(Stmt s);
+
+}
+}
+
+#endif
@@ -299,6 +299,21 @@ Expr Broadcast::make(Expr value, int width) {
     return node;
 }
 
+Expr VectorReduce::make(VectorReduce::Operator op, Expr value, int width) {
+    internal_assert(value.defined()) << "VectorReduce of undefined\n";
+    internal_assert(width > 0) << "VectorReduce to non-positive width\n";
+    internal_assert(value.type().width % width == 0)
+        << "VectorReduce of " << value.type().width << " lanes to " << width << " lanes\n";
+    internal_assert((op != And && op != Or) || value.type().is_bool())
+        << "Logical VectorReduce of non-boolean vector\n";
+
+    VectorReduce *node = new VectorReduce;
+    node->type = value.type().element_of().vector_of(width);
+    node->value = value;
+    node->op = op;
+    return node;
+}
+
 Expr Let::make(std::string name, Expr value, Expr body) {
     internal_assert(value.defined()) << "Let of undefined\n";
     internal_assert(body.defined()) << "Let of undefined\n";
@@ -534,6 +549,7 @@ template<> void ExprNode<Select>::accept(IRVisitor *v) const { v->visit((const S
 template<> void ExprNode<Load>::accept(IRVisitor *v) const { v->visit((const Load *)this); }
 template<> void ExprNode<Ramp>::accept(IRVisitor *v) const { v->visit((const Ramp *)this); }
 template<> void ExprNode<Broadcast>::accept(IRVisitor *v) const { v->visit((const Broadcast *)this); }
+template<> void ExprNode<VectorReduce>::accept(IRVisitor *v) const { v->visit((const VectorReduce *)this); }
 template<> void ExprNode<Call>::accept(IRVisitor *v) const { v->visit((const Call *)this); }
 template<> void ExprNode<Let>::accept(IRVisitor *v) const { v->visit((const Let *)this); }
 template<> void StmtNode<LetStmt>::accept(IRVisitor *v) const { v->visit((const LetStmt *)this); }
@@ -574,6 +590,7 @@ template<> IRNodeType ExprNode<Select>::_type_info = {};
 template<> IRNodeType ExprNode<Load>::_type_info = {};
 template<> IRNodeType ExprNode<Ramp>::_type_info = {};
 template<> IRNodeType ExprNode<Broadcast>::_type_info = {};
+template<> IRNodeType ExprNode<VectorReduce>::_type_info = {};
 template<> IRNodeType ExprNode<Call>::_type_info = {};
 template<> IRNodeType ExprNode<Let>::_type_info = {};
 template<> IRNodeType StmtNode<LetStmt>::_type_info = {};
@@ -614,6 +631,17 @@ Call::ConstString Call::set_dev_dirty = "set_dev_dirty";
 Call::ConstString Call::popcount = "popcount";
 Call::ConstString Call::count_leading_zeros = "count_leading_zeros";
 Call::ConstString Call::count_trailing_zeros = "count_trailing_zeros";
+Call::ConstString Call::widening_add = "widening_add";
+Call::ConstString Call::widening_sub = "widening_sub";
+Call::ConstString Call::widening_mul = "widening_mul";
+Call::ConstString Call::saturating_add = "saturating_add";
+Call::ConstString Call::saturating_sub = "saturating_sub";
+Call::ConstString Call::halving_add = "halving_add";
+Call::ConstString Call::halving_sub = "halving_sub";
+Call::ConstString Call::rounding_halving_add = "rounding_halving_add";
+Call::ConstString Call::rounding_shift_right = "rounding_shift_right";
+Call::ConstString Call::mul_shift_right = "mul_shift_right";
+Call::ConstString Call::rounding_mul_shift_right = "rounding_mul_shift_right";
 Call::ConstString Call::undef = "undef";
 Call::ConstString Call::address_of = "address_of";
 Call::ConstString Call::null_handle = "null_handle";
@@ -195,6 +195,24 @@ struct Broadcast : public ExprNode<Broadcast> {
     EXPORT static Expr make(Expr value, int width);
 };
 
+/** Horizontally reduce groups of adjacent lanes of a vector using an
+ * associative operator. The width of 'value' must be a multiple of
+ * the width of the result, and lane i of the result is the reduction
+ * of lanes i*k to i*k + k - 1 of 'value', where k is the ratio of
+ * the two widths. E.g. an Add reduction of an 8-wide vector to a
+ * 2-wide vector is (v0 + v1 + v2 + v3, v4 + v5 + v6 + v7). This is
+ * produced by vectorizing an associative update across a reduction
+ * variable, and lets backends use instructions like horizontal adds
+ * and pairwise-widening adds. */
+struct VectorReduce : public ExprNode<VectorReduce> {
+    enum Operator {Add, Mul, Min, Max, And, Or};
+
+    Expr value;
+    Operator op;
+
+    EXPORT static Expr make(Operator op, Expr value, int width);
+};
+
 /** A let expression, like you might find in a functional
  * language. Within the expression \ref Let::body, instances of the Var
  * node \ref Let::name refer to \ref Let::value. */
@@ -379,6 +397,17 @@ struct Call : public ExprNode<Call> {
         popcount,
         count_leading_zeros,
         count_trailing_zeros,
+        widening_add,
+        widening_sub,
+        widening_mul,
+        saturating_add,
+        saturating_sub,
+        halving_add,
+        halving_sub,
+        rounding_halving_add,
+        rounding_shift_right,
+        mul_shift_right,
+        rounding_mul_shift_right,
         undef,
         null_handle,
         address_of,
@@ -73,6 +73,7 @@ private:
     void visit(const Load *);
     void visit(const Ramp *);
     void visit(const Broadcast *);
+    void visit(const VectorReduce *);
     void visit(const Call *);
     void visit(const Let *);
     void visit(const LetStmt *);
@@ -307,6 +308,13 @@ void IRComparer::visit(const Broadcast *op) {
     compare_expr(e->value, op->value);
 }
 
+void IRComparer::visit(const VectorReduce *op) {
+    const VectorReduce *e = expr.as<VectorReduce>();
+    // No need to compare width because we already compared types
+    compare_scalar(e->op, op->op);
+    compare_expr(e->value, op->value);
+}
+
 void IRComparer::visit(const Call *op) {
     const Call *e = expr.as<Call>();
 
@@ -115,6 +115,12 @@ void IRMutator::visit(const Broadcast *op) {
     else expr = Broadcast::make(value, op->width);
 }
 
+void IRMutator::visit(const VectorReduce *op) {
+    Expr value = mutate(op->value);
+    if (value.same_as(op->value)) expr = op;
+    else expr = VectorReduce::make(op->op, value, op->type.width);
+}
+
 void IRMutator::visit(const Call *op) {
     vector<Expr > new_args(op->args.size());
     bool changed = false;
@@ -66,6 +66,7 @@ protected:
     EXPORT virtual void visit(const Load *);
     EXPORT virtual void visit(const Ramp *);
     EXPORT virtual void visit(const Broadcast *);
+    EXPORT virtual void visit(const VectorReduce *);
     EXPORT virtual void visit(const Call *);
     EXPORT virtual void visit(const Let *);
     EXPORT virtual void visit(const LetStmt *);
@@ -2,6 +2,7 @@
 #include <sstream>
 #include <cmath>
 #include <algorithm>
+#include <limits>
 
 #include "IROperator.h"
 #include "IRPrinter.h"
@@ -255,6 +256,37 @@ void check_representable(Type t, int x) {
         << " because it will be implicitly coerced to type " << t << "\n";
 }
 
+Expr make_fixed_point_op(const char *name, Expr a, Expr b, Expr shift) {
+    user_assert(a.defined() && b.defined()) << name << " of undefined Expr\n";
+    match_types(a, b);
+    Type t = a.type();
+    user_assert((t.is_int() || t.is_uint()) && t.bits <= 32)
+        << "The arguments to " << name << " must be integers of at most 32 bits, "
+        << "but " << a << " has type " << t << "\n";
+
+    std::vector<Expr> args = vec(a, b);
+    if (shift.defined()) {
+        user_assert(shift.type().is_int() || shift.type().is_uint())
+            << "The shift amount in " << name << " must be an integer: " << shift << "\n";
+        // The product of two narrow values has twice as many bits,
+        // and shifting it by that many or more isn't defined.
+        const int *const_shift = as_const_int(shift);
+        user_assert(!const_shift || (*const_shift >= 0 && *const_shift < 2 * t.bits))
+            << "The shift amount in " << name << " of " << t << " values must be in [0, "
+            << 2 * t.bits << "), but it is " << shift << "\n";
+        args.push_back(cast(t, shift));
+    }
+
+    Type result = t;
+    std::string n = name;
+    if (n == Call::widening_add || n == Call::widening_mul) {
+        result.bits *= 2;
+    } else if (n == Call::widening_sub) {
+        result = Int(t.bits * 2, t.width);
+    }
+    return Call::make(result, name, args, Call::Intrinsic);
+}
+
 void match_types(Expr &a, Expr &b) {
     user_assert(!a.type().is_handle() && !b.type().is_handle())
         << "Can't do arithmetic on opaque pointer types\n";
@@ -281,6 +313,10 @@ void match_types(Expr &a, Expr &b) {
         a = cast(tb, a);
     } else if (ta.is_float() && !tb.is_float()) {
         b = cast(ta, b);
+    } else if (ta.is_float() && tb.is_float() && ta.bits == tb.bits) {
+        // half(a) * bfloat(b) -> float(a) * float(b)
+        a = cast(Float(32, ta.width), a);
+        b = cast(Float(32, tb.width), b);
     } else if (ta.is_float() && tb.is_float()) {
         // float(a) * float(b) -> float(max(a, b))
         if (ta.bits > tb.bits) b = cast(ta, b);
@@ -563,6 +599,232 @@ Expr fast_exp(Expr x_full) {
     return result;
 }
 
+namespace {
+
+// The coefficient tables below were fit to minimize the maximum
+// relative error over the reduced range. They are indexed by
+// ApproximationPrecision.
+
+// sin(x) or cos(x) for Float(32).
+Expr fast_sin_cos(Expr x, bool is_cos, ApproximationPrecision precision) {
+    // sin(r) = r + r^3 * P(r^2) on [-pi/4, pi/4]
+    static float sin_fast[] = {
+        8.16328185e-03f,
+        -1.66633904e-01f};
+    static float sin_balanced[] = {
+        -1.95152831e-04f,
+        8.33216076e-03f,
+        -1.66666546e-01f};
+    static float sin_accurate[] = {
+        2.71812162e-06f,
+        -1.98393123e-04f,
+        8.33332930e-03f,
+        -1.66666666e-01f};
+
+    // cos(r) = 1 + r^2 * Q(r^2) on [-pi/4, pi/4]
+    static float cos_fast[] = {
+        4.04584518e-02f,
+        -4.99760557e-01f,
+        1.0f};
+    static float cos_balanced[] = {
+        -1.35918535e-03f,
+        4.16557770e-02f,
+        -4.99998847e-01f,
+        1.0f};
+    static float cos_accurate[] = {
+        2.43835672e-05f,
+        -1.38866816e-03f,
+        4.16666204e-02f,
+        -4.99999997e-01f,
+        1.0f};
+
+    float *sin_coeff, *cos_coeff;
+    int n;
+    switch (precision) {
+    case ApproximationPrecision::Fast:
+        sin_coeff = sin_fast;
+        cos_coeff = cos_fast;
+        n = 2;
+        break;
+    case ApproximationPrecision::Balanced:
+        sin_coeff = sin_balanced;
+        cos_coeff = cos_balanced;
+        n = 3;
+        break;
+    default:
+        sin_coeff = sin_accurate;
+        cos_coeff = cos_accurate;
+        n = 4;
+    }
+
+    // Reduce to [-pi/4, pi/4] by subtracting a multiple k of pi/2. pi/2
+    // is split into three parts so that k times the first part is exact
+    // for |k| < 2^16.
+    Expr k_real = floor(x * 0.636619772f + 0.5f);
+    Expr k = cast<int>(k_real);
+    if (is_cos) {
+        // cos(x) = sin(x + pi/2)
+        k += 1;
+    }
+    Expr r = x - k_real * 1.5703125f;
+    r -= k_real * 4.837512969970703125e-4f;
+    r -= k_real * 7.54978995489188216e-8f;
+    Expr r2 = r * r;
+
+    Expr sin_r = r + (r * r2) * evaluate_polynomial(r2, sin_coeff, n);
+    Expr cos_r = evaluate_polynomial(r2, cos_coeff, n + 1);
+
+    // Pick the right function and sign for the quadrant.
+    Expr result = select((k & 1) == 1, cos_r, sin_r);
+    result = select((k & 2) == 2, -result, result);
+    return common_subexpression_elimination(result);
+}
+
+}
+
+Expr fast_sin(Expr x, ApproximationPrecision precision) {
+    user_assert(x.type() == Float(32)) << "fast_sin only works for Float(32)";
+    return fast_sin_cos(x, false, precision);
+}
+
+Expr fast_cos(Expr x, ApproximationPrecision precision) {
+    user_assert(x.type() == Float(32)) << "fast_cos only works for Float(32)";
+    return fast_sin_cos(x, true, precision);
+}
+
+Expr fast_atan2(Expr y, Expr x, ApproximationPrecision precision) {
+    user_assert(x.type() == Float(32) && y.type() == Float(32))
+        << "fast_atan2 only works for Float(32)";
+
+    // atan(t) = t + t^3 * P(t^2) on [0, 1]
+    static float coeff_fast[] = {
+        2.48402529e-02f,
+        -9.40978849e-02f,
+        1.86814144e-01f,
+        -3.32130714e-01f};
+    static float coeff_balanced[] = {
+        8.10635777e-03f,
+        -3.77966907e-02f,
+        8.48410070e-02f,
+        -1.35445745e-01f,
+        1.98978730e-01f,
+        -3.33284919e-01f};
+    static float coeff_accurate[] = {
+        2.92068867e-03f,
+        -1.63679137e-02f,
+        4.32118376e-02f,
+        -7.55221232e-02f,
+        1.06660037e-01f,
+        -1.42110551e-01f,
+        1.99937728e-01f,
+        -3.33331527e-01f};
+
+    float *coeff;
+    int n;
+    switch (precision) {
+    case ApproximationPrecision::Fast:
+        coeff = coeff_fast;
+        n = sizeof(coeff_fast)/sizeof(coeff_fast[0]);
+        break;
+    case ApproximationPrecision::Balanced:
+        coeff = coeff_balanced;
+        n = sizeof(coeff_balanced)/sizeof(coeff_balanced[0]);
+        break;
+    default:
+        coeff = coeff_accurate;
+        n = sizeof(coeff_accurate)/sizeof(coeff_accurate[0]);
+    }
+
+    // Reduce to the first octant.
+    Expr ax = abs(x), ay = abs(y);
+    Expr hi = max(ax, ay), lo = min(ax, ay);
+    Expr t = select(hi == 0.0f, 0.0f, lo / hi);
+    Expr t2 = t * t;
+    Expr result = t + (t * t2) * evaluate_polynomial(t2, coeff, n);
+
+    // Reflect it back out again.
+    result = select(ay > ax, 1.57079637f - result, result);
+    result = select(x < 0.0f, 3.14159274f - result, result);
+    result = select(y < 0.0f, -result, result);
+    return common_subexpression_elimination(result);
+}
+
+Expr fast_tanh(Expr x, ApproximationPrecision precision) {
+    user_assert(x.type() == Float(32)) << "fast_tanh only works for Float(32)";
+
+    // tanh(x) = x + x^3 * P(x^2) on [-0.55, 0.55]
+    static float coeff_fast[] = {
+        1.13320675e-01f,
+        -3.31533433e-01f};
+    static float coeff_balanced[] = {
+        -4.30996419e-02f,
+        1.31523563e-01f,
+        -3.33245142e-01f};
+    static float coeff_accurate[] = {
+        2.39582213e-03f,
+        -8.41395734e-03f,
+        2.17828258e-02f,
+        -5.39596503e-02f,
+        1.33332937e-01f,
+        -3.33333327e-01f};
+
+    float *coeff;
+    int n;
+    switch (precision) {
+    case ApproximationPrecision::Fast:
+        coeff = coeff_fast;
+        n = sizeof(coeff_fast)/sizeof(coeff_fast[0]);
+        break;
+    case ApproximationPrecision::Balanced:
+        coeff = coeff_balanced;
+        n = sizeof(coeff_balanced)/sizeof(coeff_balanced[0]);
+        break;
+    default:
+        coeff = coeff_accurate;
+        n = sizeof(coeff_accurate)/sizeof(coeff_accurate[0]);
+    }
+
+    Expr x2 = x * x;
+    Expr small = x + (x * x2) * evaluate_polynomial(x2, coeff, n);
+
+    // Away from zero, tanh(x) = 1 - 2 / (e^2x + 1), which has no
+    // catastrophic cancellation. tanh(10) rounds to one.
+    Expr ax = min(abs(x), 10.0f);
+    Expr e = (precision == ApproximationPrecision::Fast ?
+              fast_exp(2 * ax) : Internal::halide_exp(2 * ax));
+    Expr large = 1.0f - 2.0f / (e + 1.0f);
+    large = select(x < 0.0f, -large, large);
+
+    Expr result = select(ax < 0.55f, small, large);
+    return common_subexpression_elimination(result);
+}
+
+Expr fast_cbrt(Expr x, ApproximationPrecision precision) {
+    user_assert(x.type() == Float(32)) << "fast_cbrt only works for Float(32)";
+
+    // Scale denormals up by 2^24 so that the initial guess below works,
+    // and scale the result back down by 2^8.
+    Expr ax = abs(x);
+    Expr denormal = ax < std::numeric_limits<float>::min();
+    Expr scaled = select(denormal, ax * 16777216.0f, ax);
+
+    // Dividing the exponent by three gives a guess within about 5%
+    // (Kahan's magic number).
+    Expr y = reinterpret<float>(reinterpret<int>(scaled) / 3 + 0x2a5137a0);
+
+    // Each Newton step roughly doubles the number of correct bits.
+    int steps = (precision == ApproximationPrecision::Fast ? 1 :
+                 precision == ApproximationPrecision::Balanced ? 2 : 3);
+    for (int i = 0; i < steps; i++) {
+        y = (y + y + scaled / (y * y)) * (1.0f / 3);
+    }
+
+    Expr result = select(denormal, y * (1.0f / 256), y);
+    result = select(ax == 0.0f, 0.0f, result);
+    result = select(x < 0.0f, -result, result);
+    return common_subexpression_elimination(result);
+}
+
 Expr print(const std::vector<Expr> &args) {
     // Insert spaces between each expr.
     std::vector<Expr> print_args(args.size()*2);
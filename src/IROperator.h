@@ -138,6 +138,12 @@ EXPORT Expr const_false(int width = 1);
  */
 EXPORT void match_types(Expr &a, Expr &b);
 
+/** Build a call to one of the fixed-point intrinsics (e.g.
+ * Call::saturating_add). The args are coerced to a common type with
+ * match_types, which must be an integer type of at most 32 bits. The
+ * shift amount, if given, is cast to that type too. */
+EXPORT Expr make_fixed_point_op(const char *name, Expr a, Expr b, Expr shift = Expr());
+
 /** Halide's vectorizable transcendentals. */
 // @{
 EXPORT Expr halide_log(Expr a);
@@ -866,6 +872,59 @@ inline Expr fast_inverse_sqrt(Expr x) {
     return Internal::Call::make(x.type(), "fast_inverse_sqrt_f32", vec(x), Internal::Call::Extern);
 }
 
+/** How accurate the fast transcendental functions below are. Each
+ * function documents its worst-case error for each tier, measured
+ * against libm in double precision. Errors in ULP are relative to the
+ * correctly-rounded float result. */
+enum class ApproximationPrecision {
+    Fast,      ///< About 10 to 16 bits of precision.
+    Balanced,  ///< Within tens of ULP.
+    Accurate   ///< Within a few ULP.
+};
+
+/** Fast approximate cleanly vectorizable sine for Float(32). Reduces
+ * the argument to [-pi/4, pi/4] and evaluates a polynomial. For |x| <=
+ * pi the maximum error is:
+ * - Fast: 1.5e-5 absolute (degree 5)
+ * - Balanced: 2.5 ULP (degree 7)
+ * - Accurate: 2 ULP (degree 9)
+ *
+ * The argument reduction adds up to 1e-6 absolute error for |x| <
+ * 1e5. Returns nonsense for larger inputs, infinities and nans. */
+EXPORT Expr fast_sin(Expr x, ApproximationPrecision precision = ApproximationPrecision::Balanced);
+
+/** Fast approximate cleanly vectorizable cosine for Float(32). Has
+ * the same error bounds as fast_sin. */
+EXPORT Expr fast_cos(Expr x, ApproximationPrecision precision = ApproximationPrecision::Balanced);
+
+/** Fast approximate cleanly vectorizable atan2 for Float(32). Reduces
+ * the argument to [0, 1] with a division and evaluates a
+ * polynomial. The maximum error is:
+ * - Fast: 3e-5 absolute (degree 7)
+ * - Balanced: 16 ULP (degree 11)
+ * - Accurate: 4 ULP (degree 15)
+ *
+ * fast_atan2(0, 0) is zero. */
+EXPORT Expr fast_atan2(Expr y, Expr x, ApproximationPrecision precision = ApproximationPrecision::Balanced);
+
+/** Fast approximate cleanly vectorizable hyperbolic tangent for
+ * Float(32). Uses a polynomial near zero, and exp elsewhere. The
+ * maximum error is:
+ * - Fast: 2.5e-5 absolute (degree 5, and uses fast_exp)
+ * - Balanced: 24 ULP (degree 7)
+ * - Accurate: 2 ULP (degree 11)
+ */
+EXPORT Expr fast_tanh(Expr x, ApproximationPrecision precision = ApproximationPrecision::Balanced);
+
+/** Fast approximate cleanly vectorizable cube root for
+ * Float(32). Starts from a guess made by dividing the exponent by
+ * three, and refines it with Newton's method. The maximum error is:
+ * - Fast: 1.1e-3 relative (one step)
+ * - Balanced: 16 ULP (two steps)
+ * - Accurate: 2 ULP (three steps)
+ */
+EXPORT Expr fast_cbrt(Expr x, ApproximationPrecision precision = ApproximationPrecision::Balanced);
+
 /** Return the greatest whole number less than or equal to a
  * floating-point expression. If the argument is not floating-point,
  * it is cast to Float(32). The return value is still in floating
@@ -1180,6 +1239,85 @@ inline Expr count_trailing_zeros(Expr x) {
                                 vec(x), Internal::Call::Intrinsic);
 }
 
+/** Fixed-point arithmetic. These all take two integer arguments of at
+ * most 32 bits, which are coerced to a common type using \ref
+ * Internal::match_types. They compute the exact answer as though done
+ * at twice the bit width, and return it narrowed back to the type of
+ * the args (except for the widening ops). They compile to single
+ * instructions on x86 and ARM where one exists, and to the equivalent
+ * widened arithmetic elsewhere. */
+// @{
+
+/** Return the sum of two integers, with the type widened to twice as
+ * many bits so that it can't overflow. */
+inline Expr widening_add(Expr a, Expr b) {
+    return Internal::make_fixed_point_op(Internal::Call::widening_add, a, b);
+}
+
+/** Return the difference of two integers as a signed integer with
+ * twice as many bits, so that it can't overflow. */
+inline Expr widening_sub(Expr a, Expr b) {
+    return Internal::make_fixed_point_op(Internal::Call::widening_sub, a, b);
+}
+
+/** Return the product of two integers, with the type widened to twice
+ * as many bits so that it can't overflow. */
+inline Expr widening_mul(Expr a, Expr b) {
+    return Internal::make_fixed_point_op(Internal::Call::widening_mul, a, b);
+}
+
+/** Return the sum of two integers, clamped to the range of the
+ * type. */
+inline Expr saturating_add(Expr a, Expr b) {
+    return Internal::make_fixed_point_op(Internal::Call::saturating_add, a, b);
+}
+
+/** Return the difference of two integers, clamped to the range of the
+ * type. For unsigned types this is zero if b > a. */
+inline Expr saturating_sub(Expr a, Expr b) {
+    return Internal::make_fixed_point_op(Internal::Call::saturating_sub, a, b);
+}
+
+/** Return the average of two integers, rounding down. */
+inline Expr halving_add(Expr a, Expr b) {
+    return Internal::make_fixed_point_op(Internal::Call::halving_add, a, b);
+}
+
+/** Return half the difference of two integers, rounding down. For
+ * unsigned types the result wraps around if b > a. */
+inline Expr halving_sub(Expr a, Expr b) {
+    return Internal::make_fixed_point_op(Internal::Call::halving_sub, a, b);
+}
+
+/** Return the average of two integers, rounding up. */
+inline Expr rounding_halving_add(Expr a, Expr b) {
+    return Internal::make_fixed_point_op(Internal::Call::rounding_halving_add, a, b);
+}
+
+/** Shift an integer right by a non-negative number of bits, rounding
+ * to the nearest integer (ties round up). Equivalent to (a + (1 << (b
+ * - 1))) >> b without the overflow. */
+inline Expr rounding_shift_right(Expr a, Expr b) {
+    return Internal::make_fixed_point_op(Internal::Call::rounding_shift_right, a, b);
+}
+
+/** Return the product of two fixed-point numbers shifted right by q
+ * bits, i.e. (a * b) >> q, saturated to the type of the args. E.g. for
+ * 16-bit types, q = 16 gives the high half of the product, and q = 15
+ * multiplies numbers with 15 fractional bits. q must be less than
+ * twice the number of bits in the type. */
+inline Expr mul_shift_right(Expr a, Expr b, Expr q) {
+    return Internal::make_fixed_point_op(Internal::Call::mul_shift_right, a, b, q);
+}
+
+/** Like mul_shift_right, but rounds to nearest instead of down,
+ * i.e. (a * b + (1 << (q - 1))) >> q, saturated to the type of the
+ * args. The rounding term never overflows, even for the largest q. */
+inline Expr rounding_mul_shift_right(Expr a, Expr b, Expr q) {
+    return Internal::make_fixed_point_op(Internal::Call::rounding_mul_shift_right, a, b, q);
+}
+// @}
+
 /** Return a random variable representing a uniformly distributed
  * float in the half-open interval [0.0f, 1.0f). For random numbers of
  * other types, use lerp with a random float as the last parameter.
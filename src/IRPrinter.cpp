@@ -26,6 +26,9 @@ ostream &operator<<(ostream &out, const Type &type) {
     case Type::Handle:
         out << "handle";
         break;
+    case Type::BFloat:
+        out << "bfloat";
+        break;
     }
     out << type.bits;
     if (type.width > 1) out << 'x' << type.width;
@@ -145,6 +148,30 @@ ostream &operator<<(ostream &out, const ForType &type) {
     return out;
 }
 
+ostream &operator<<(ostream &out, const VectorReduce::Operator &op) {
+    switch (op) {
+    case VectorReduce::Add:
+        out << "add";
+        break;
+    case VectorReduce::Mul:
+        out << "mul";
+        break;
+    case VectorReduce::Min:
+        out << "min";
+        break;
+    case VectorReduce::Max:
+        out << "max";
+        break;
+    case VectorReduce::And:
+        out << "and";
+        break;
+    case VectorReduce::Or:
+        out << "or";
+        break;
+    }
+    return out;
+}
+
 ostream &operator<<(ostream &stream, const Stmt &ir) {
     if (!ir.defined()) {
         stream << "(undefined)\n";
@@ -408,6 +435,12 @@ void IRPrinter::visit(const Broadcast *op) {
     stream << ")";
 }
 
+void IRPrinter::visit(const VectorReduce *op) {
+    stream << "(" << op->type << ")vector_reduce_" << op->op << "(";
+    print(op->value);
+    stream << ")";
+}
+
 void IRPrinter::visit(const Call *op) {
     // Special-case some intrinsics for readability
     if (op->call_type == Call::Intrinsic) {
@@ -46,6 +46,10 @@ EXPORT std::ostream &operator<<(std::ostream &stream, const Stmt &);
  * readable form */
 std::ostream &operator<<(std::ostream &stream, const ForType &);
 
+/** Emit the operator of a horizontal vector reduction in a human
+ * readable form */
+std::ostream &operator<<(std::ostream &stream, const VectorReduce::Operator &);
+
 /** An IRVisitor that emits IR to the given output stream in a human
  * readable form. Can be subclassed if you want to modify the way in
  * which it prints.
@@ -100,6 +104,7 @@ protected:
     void visit(const Load *);
     void visit(const Ramp *);
     void visit(const Broadcast *);
+    void visit(const VectorReduce *);
     void visit(const Call *);
     void visit(const Let *);
     void visit(const LetStmt *);
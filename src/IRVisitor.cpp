@@ -120,6 +120,10 @@ void IRVisitor::visit(const Broadcast *op) {
     op->value.accept(this);
 }
 
+void IRVisitor::visit(const VectorReduce *op) {
+    op->value.accept(this);
+}
+
 void IRVisitor::visit(const Call *op) {
     for (size_t i = 0; i < op->args.size(); i++) {
         op->args[i].accept(this);
@@ -351,6 +355,10 @@ void IRGraphVisitor::visit(const Broadcast *op) {
     include(op->value);
 }
 
+void IRGraphVisitor::visit(const VectorReduce *op) {
+    include(op->value);
+}
+
 void IRGraphVisitor::visit(const Call *op) {
     for (size_t i = 0; i < op->args.size(); i++) {
         include(op->args[i]);
@@ -47,6 +47,7 @@ public:
     EXPORT virtual void visit(const Load *);
     EXPORT virtual void visit(const Ramp *);
     EXPORT virtual void visit(const Broadcast *);
+    EXPORT virtual void visit(const VectorReduce *);
     EXPORT virtual void visit(const Call *);
     EXPORT virtual void visit(const Let *);
     EXPORT virtual void visit(const LetStmt *);
@@ -110,6 +111,7 @@ public:
     EXPORT virtual void visit(const Load *);
     EXPORT virtual void visit(const Ramp *);
     EXPORT virtual void visit(const Broadcast *);
+    EXPORT virtual void visit(const VectorReduce *);
     EXPORT virtual void visit(const Call *);
     EXPORT virtual void visit(const Let *);
     EXPORT virtual void visit(const LetStmt *);
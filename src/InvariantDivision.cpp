@@ -0,0 +1,274 @@
+#include "InvariantDivision.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "IREquality.h"
+#include "CodeGen_GPU_Dev.h"
+#include "Scope.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::string;
+using std::vector;
+using std::pair;
+
+namespace {
+
+// Checks whether an expression can be evaluated before the loop that
+// contains it, given the names defined inside that loop.
+class IsLoopInvariant : public IRVisitor {
+    using IRVisitor::visit;
+
+    const Scope<int> &loop_vars;
+
+    void visit(const Variable *op) {
+        if (loop_vars.contains(op->name)) {
+            result = false;
+        }
+    }
+
+    void visit(const Load *op) {
+        // The buffer may be written to within the loop.
+        result = false;
+    }
+
+    void visit(const Call *op) {
+        if (op->call_type != Call::Intrinsic) {
+            result = false;
+        } else {
+            IRVisitor::visit(op);
+        }
+    }
+
+public:
+    bool result;
+    IsLoopInvariant(const Scope<int> &v) : loop_vars(v), result(true) {}
+};
+
+// The magic numbers for dividing by some loop-invariant value. We use
+// the method in figure 4.1 of "Division by Invariant Integers using
+// Multiplication" by Granlund and Montgomery, which works for all
+// divisors from 1 to 2^N - 1 without needing an N+1 bit multiplier:
+//
+// t = (m * n) >> N
+// q = (t + ((n - t) >> shift1)) >> shift2
+//
+// Signed division is done in terms of unsigned division of the
+// numerator with its bits flipped if it's negative, in the same way
+// as for constant divisors in CodeGen_X86.
+struct Divisor {
+    Expr value, var;
+    Expr magic, shift1, shift2;
+    // For signed division, all ones if the divisor is negative, and
+    // zero otherwise.
+    Expr sign;
+};
+
+class LowerInvariantDivision : public IRMutator {
+    using IRMutator::visit;
+
+    // The names defined within the innermost loop we're in.
+    Scope<int> loop_vars;
+    bool in_loop;
+
+    // The divisors seen so far within the innermost loop, and the
+    // lets that compute their magic numbers, which get wrapped around
+    // the loop.
+    vector<Divisor> divisors;
+    vector<pair<string, Expr> > lets;
+
+    Expr make_let(const string &name, Expr value) {
+        lets.push_back(make_pair(name, value));
+        return Variable::make(value.type(), name);
+    }
+
+    const Divisor &get_divisor(Expr d) {
+        for (size_t i = 0; i < divisors.size(); i++) {
+            if (equal(divisors[i].value, d)) {
+                return divisors[i];
+            }
+        }
+
+        Type t = d.type();
+        Type u = UInt(t.bits);
+        Type u64 = UInt(64);
+        string prefix = unique_name('d') + ".";
+
+        Divisor div;
+        div.value = d;
+        Expr d_var = div.var = make_let(prefix + "divisor", d);
+
+        // The magnitude of the divisor. Using a divisor of one
+        // instead of zero means we don't introduce a trap outside the
+        // loop that might not have happened inside it.
+        Expr ud = cast(u, d_var);
+        if (t.is_int()) {
+            ud = select(d_var < make_zero(t), make_zero(u) - ud, ud);
+        }
+        ud = max(ud, make_one(u));
+        Expr ud64 = make_let(prefix + "abs", cast(u64, ud));
+
+        // l = ceil(log2(d)). The exponent of (d - 1) as a double is
+        // exact for divisors of up to 32 bits, and doesn't need an
+        // intrinsic that some backends lack.
+        Expr dm1 = cast(Float(64), ud64 - make_one(u64));
+        Expr exponent = cast(Int(32), reinterpret(u64, dm1) >> make_const(u64, 52)) - 1022;
+        Expr l = make_let(prefix + "log2", select(ud64 == make_one(u64), 0, exponent));
+
+        // m = floor(2^N * (2^l - d) / d) + 1, which always fits in
+        // N bits.
+        Expr two_l = make_one(u64) << cast(u64, l);
+        Expr m = (make_const(u64, (int64_t)1 << t.bits) * (two_l - ud64)) / ud64 + make_one(u64);
+        div.magic = make_let(prefix + "magic", cast(u, m));
+        div.shift1 = make_let(prefix + "shift1", cast(u, min(l, 1)));
+        div.shift2 = make_let(prefix + "shift2", cast(u, max(l - 1, 0)));
+
+        if (t.is_int()) {
+            div.sign = make_let(prefix + "sign", d_var >> make_const(t, t.bits - 1));
+        }
+
+        divisors.push_back(div);
+        return divisors.back();
+    }
+
+    // Divide an unsigned value by the divisor, rounding down.
+    Expr unsigned_quotient(Expr n, const Divisor &div) {
+        Type u = n.type();
+        string n_name = unique_name('n');
+        string t_name = unique_name('t');
+        Expr n_var = Variable::make(u, n_name);
+        Expr t_var = Variable::make(u, t_name);
+        Expr q = (t_var + ((n_var - t_var) >> div.shift1)) >> div.shift2;
+        q = Let::make(t_name, mul_shift_right(n_var, div.magic, u.bits), q);
+        return Let::make(n_name, n, q);
+    }
+
+    // Divide by the divisor with Halide's rounding semantics.
+    Expr quotient(Expr n, const Divisor &div) {
+        Type t = n.type();
+        if (t.is_uint()) {
+            return unsigned_quotient(n, div);
+        }
+
+        // Flip the bits of the numerator if it's negative, so that
+        // rounding down its magnitude rounds the quotient towards
+        // negative infinity.
+        string n_name = unique_name('n');
+        string sign_name = unique_name('s');
+        Expr n_var = Variable::make(t, n_name);
+        Expr sign_var = Variable::make(t, sign_name);
+        Expr flipped = cast(UInt(t.bits), n_var ^ sign_var);
+        Expr q = cast(t, unsigned_quotient(flipped, div)) ^ sign_var;
+
+        // Negate the result if the divisor is negative.
+        q = (q ^ div.sign) - div.sign;
+
+        q = Let::make(sign_name, n_var >> make_const(t, t.bits - 1), q);
+        return Let::make(n_name, n, q);
+    }
+
+    bool should_lower(Expr a, Expr b) {
+        Type t = a.type();
+        if (!in_loop ||
+            !(t.is_int() || t.is_uint()) ||
+            !(t.bits == 8 || t.bits == 16 || t.bits == 32) ||
+            t.is_vector() ||
+            is_const(b)) {
+            return false;
+        }
+        IsLoopInvariant check(loop_vars);
+        b.accept(&check);
+        return check.result;
+    }
+
+    void visit(const Div *op) {
+        Expr a = mutate(op->a), b = mutate(op->b);
+        if (should_lower(a, b)) {
+            expr = quotient(a, get_divisor(b));
+        } else if (a.same_as(op->a) && b.same_as(op->b)) {
+            expr = op;
+        } else {
+            expr = Div::make(a, b);
+        }
+    }
+
+    void visit(const Mod *op) {
+        Expr a = mutate(op->a), b = mutate(op->b);
+        if (should_lower(a, b)) {
+            const Divisor &div = get_divisor(b);
+            string n_name = unique_name('n');
+            Expr n_var = Variable::make(a.type(), n_name);
+            expr = Let::make(n_name, a, n_var - quotient(n_var, div) * div.var);
+        } else if (a.same_as(op->a) && b.same_as(op->b)) {
+            expr = op;
+        } else {
+            expr = Mod::make(a, b);
+        }
+    }
+
+    template<typename LetOrLetStmt>
+    void visit_let(const LetOrLetStmt *op) {
+        if (in_loop) {
+            loop_vars.push(op->name, 0);
+            IRMutator::visit(op);
+            loop_vars.pop(op->name);
+        } else {
+            IRMutator::visit(op);
+        }
+    }
+
+    void visit(const Let *op) {visit_let(op);}
+    void visit(const LetStmt *op) {visit_let(op);}
+
+    void visit(const For *op) {
+        if (CodeGen_GPU_Dev::is_gpu_var(op->name) ||
+            (op->device_api != DeviceAPI::Host &&
+             op->device_api != DeviceAPI::Parent)) {
+            stmt = op;
+            return;
+        }
+
+        Expr min = mutate(op->min);
+        Expr extent = mutate(op->extent);
+
+        // Start a new innermost loop.
+        Scope<int> old_loop_vars;
+        old_loop_vars.swap(loop_vars);
+        vector<Divisor> old_divisors;
+        old_divisors.swap(divisors);
+        vector<pair<string, Expr> > old_lets;
+        old_lets.swap(lets);
+        bool old_in_loop = in_loop;
+
+        in_loop = true;
+        loop_vars.push(op->name, 0);
+        Stmt body = mutate(op->body);
+
+        if (min.same_as(op->min) && extent.same_as(op->extent) && body.same_as(op->body)) {
+            stmt = op;
+        } else {
+            stmt = For::make(op->name, min, extent, op->for_type, op->device_api, body);
+        }
+
+        for (size_t i = lets.size(); i > 0; i--) {
+            stmt = LetStmt::make(lets[i-1].first, lets[i-1].second, stmt);
+        }
+
+        loop_vars.swap(old_loop_vars);
+        divisors.swap(old_divisors);
+        lets.swap(old_lets);
+        in_loop = old_in_loop;
+    }
+
+public:
+    LowerInvariantDivision() : in_loop(false) {}
+};
+
+}
+
+Stmt lower_invariant_division(Stmt s) {
+    return LowerInvariantDivision().mutate(s);
+}
+
+}
+}
@@ -0,0 +1,51 @@
+#ifndef HALIDE_INVARIANT_DIVISION_H
+#define HALIDE_INVARIANT_DIVISION_H
+
+/** \file
+ * Defines the lowering pass that replaces integer division by
+ * loop-invariant values with multiplication and shifting.
+ */
+
+#include "IR.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Find integer divisions and mods by values that are not
+ * compile-time constants, but which don't vary within the innermost
+ * loop that contains them (e.g. a Param, or a function of an outer
+ * loop variable). The magic numbers for the division are computed
+ * once, just outside that loop, and the division itself becomes a
+ * multiply-keep-high-half, a subtract, an add, and two shifts, all of
+ * which vectorize. E.g:
+ *
+ \code
+ for (f.s0.x, 0, 1024) {
+   f[f.s0.x] = input[f.s0.x] / p
+ }
+ \endcode
+ *
+ * becomes:
+ *
+ \code
+ let d0.magic = ...
+ let d0.shift1 = ...
+ let d0.shift2 = ...
+ for (f.s0.x, 0, 1024) {
+   let t = mul_shift_right(input[f.s0.x], d0.magic, 32)
+   f[f.s0.x] = (t + ((input[f.s0.x] - t) >> d0.shift1)) >> d0.shift2
+ }
+ \endcode
+ *
+ * Handles 8, 16, and 32-bit signed and unsigned integers, with
+ * Halide's rounding semantics for signed division. Division by zero
+ * gives an unspecified result instead of trapping. Should be done
+ * before vectorization, and after unrolling, so that divisions by
+ * values that become constant are left for the code generator. Loops
+ * that run on a device are left alone. */
+Stmt lower_invariant_division(Stmt s);
+
+}
+}
+
+#endif
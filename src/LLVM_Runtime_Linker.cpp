@@ -106,6 +106,10 @@ DECLARE_CPP_INITMOD(tracing)
 DECLARE_CPP_INITMOD(write_debug_image)
 DECLARE_CPP_INITMOD(posix_print)
 DECLARE_CPP_INITMOD(gpu_device_selection)
+DECLARE_CPP_INITMOD(halide_buffer)
+DECLARE_CPP_INITMOD(batch)
+DECLARE_CPP_INITMOD(prepared)
+DECLARE_CPP_INITMOD(par_for_strips)
 DECLARE_CPP_INITMOD(cache)
 DECLARE_CPP_INITMOD(nacl_host_cpu_count)
 DECLARE_CPP_INITMOD(to_string)
@@ -117,6 +121,7 @@ DECLARE_CPP_INITMOD(matlab)
 DECLARE_CPP_INITMOD(posix_get_symbol)
 DECLARE_CPP_INITMOD(osx_get_symbol)
 DECLARE_CPP_INITMOD(windows_get_symbol)
+DECLARE_CPP_INITMOD(x86_cpu_features)
 
 #ifdef WITH_ARM
 DECLARE_LL_INITMOD(arm)
@@ -371,6 +376,11 @@ llvm::Module *get_initial_module_for_target(Target t, llvm::LLVMContext *c, bool
         } else {
             module_type = ModuleJITInlined;
         }
+    } else if (t.has_feature(Target::NoRuntime)) {
+        // Only the parts of the runtime that get inlined. The rest
+        // must come from elsewhere (e.g. another object compiled for
+        // the same os and arch).
+        module_type = ModuleJITInlined;
     } else {
         module_type = ModuleAOT;
     }
@@ -452,6 +462,10 @@ llvm::Module *get_initial_module_for_target(Target t, llvm::LLVMContext *c, bool
             modules.push_back(get_initmod_to_string(c, bits_64, debug));
             modules.push_back(get_initmod_device_interface(c, bits_64, debug));
             modules.push_back(get_initmod_metadata(c, bits_64, debug));
+            modules.push_back(get_initmod_halide_buffer(c, bits_64, debug));
+            modules.push_back(get_initmod_batch(c, bits_64, debug));
+            modules.push_back(get_initmod_prepared(c, bits_64, debug));
+            modules.push_back(get_initmod_par_for_strips(c, bits_64, debug));
         }
 
         if (module_type != ModuleJITShared) {
@@ -515,6 +529,11 @@ llvm::Module *get_initial_module_for_target(Target t, llvm::LLVMContext *c, bool
         }
     }
 
+    if (module_type == ModuleAOT && t.arch == Target::X86 && t.os != Target::NaCl) {
+        // Used by multi-target dispatchers to pick a variant.
+        modules.push_back(get_initmod_x86_cpu_features(c, bits_64, debug));
+    }
+
     if (module_type == ModuleAOT && t.has_feature(Target::Matlab)) {
         modules.push_back(get_initmod_matlab(c, bits_64, debug));
     }
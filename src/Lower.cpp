@@ -18,13 +18,16 @@
 #include "FindCalls.h"
 #include "Function.h"
 #include "FuseGPUThreadLoops.h"
+#include "HoistParallelAllocations.h"
 #include "InjectHostDevBufferCopies.h"
 #include "InjectImageIntrinsics.h"
 #include "InjectOpenGLIntrinsics.h"
 #include "Inline.h"
+#include "InvariantDivision.h"
 #include "IRMutator.h"
 #include "IROperator.h"
 #include "IRPrinter.h"
+#include "LowerFloat16.h"
 #include "Memoization.h"
 #include "PartitionLoops.h"
 #include "Profiling.h"
@@ -33,6 +36,7 @@
 #include "RemoveDeadAllocations.h"
 #include "RemoveTrivialForLoops.h"
 #include "RemoveUndef.h"
+#include "ReuseAllocations.h"
 #include "ScheduleFunctions.h"
 #include "SkipStages.h"
 #include "SlidingWindow.h"
@@ -100,7 +104,7 @@ Stmt lower(Function f, const Target &t, const vector<IRMutator *> &custom_passes
     // can't simplify statements from here until we fix them up. (We
     // can still simplify Exprs).
     debug(1) << "Performing computation bounds inference...\n";
-    s = bounds_inference(s, order, env, func_bounds);
+    s = bounds_inference(s, order, env, func_bounds, t.has_feature(Target::PreciseBounds));
     debug(2) << "Lowering after computation bounds inference:\n" << s << '\n';
 
     debug(1) << "Performing sliding window optimization...\n";
@@ -108,7 +112,7 @@ Stmt lower(Function f, const Target &t, const vector<IRMutator *> &custom_passes
     debug(2) << "Lowering after sliding window:\n" << s << '\n';
 
     debug(1) << "Performing allocation bounds inference...\n";
-    s = allocation_bounds_inference(s, env, func_bounds);
+    s = allocation_bounds_inference(s, env, func_bounds, t.has_feature(Target::PreciseBounds));
     debug(2) << "Lowering after allocation bounds inference:\n" << s << '\n';
 
     debug(1) << "Removing code that depends on undef values...\n";
@@ -123,7 +127,7 @@ Stmt lower(Function f, const Target &t, const vector<IRMutator *> &custom_passes
     debug(2) << "Lowering after uniquifying variable names:\n" << s << "\n\n";
 
     debug(1) << "Performing storage folding optimization...\n";
-    s = storage_folding(s);
+    s = storage_folding(s, env);
     debug(2) << "Lowering after storage folding:\n" << s << '\n';
 
     debug(1) << "Injecting debug_to_file calls...\n";
@@ -177,6 +181,10 @@ Stmt lower(Function f, const Target &t, const vector<IRMutator *> &custom_passes
     s = simplify(s);
     debug(2) << "Lowering after unrolling:\n" << s << "\n\n";
 
+    debug(1) << "Lowering division by loop invariants...\n";
+    s = lower_invariant_division(s);
+    debug(2) << "Lowering after lowering division by loop invariants:\n" << s << "\n\n";
+
     debug(1) << "Vectorizing...\n";
     s = vectorize_loops(s);
     s = simplify(s);
@@ -187,11 +195,24 @@ Stmt lower(Function f, const Target &t, const vector<IRMutator *> &custom_passes
     s = simplify(s);
     debug(2) << "Lowering after rewriting vector interleavings:\n" << s << "\n\n";
 
+    debug(1) << "Lowering 16-bit floating point arithmetic...\n";
+    s = lower_float16(s, t);
+    s = simplify(s);
+    debug(2) << "Lowering after lowering 16-bit floating point arithmetic:\n" << s << "\n\n";
+
     debug(1) << "Partitioning loops to simplify boundary conditions...\n";
     s = partition_loops(s);
     s = simplify(s);
     debug(2) << "Lowering after partitioning loops:\n" << s << "\n\n";
 
+    debug(1) << "Sharing storage between allocations with disjoint lifetimes...\n";
+    s = reuse_allocations(s);
+    debug(2) << "Lowering after sharing storage between allocations:\n" << s << "\n\n";
+
+    debug(1) << "Hoisting allocations out of parallel loops...\n";
+    s = hoist_parallel_allocations(s);
+    debug(2) << "Lowering after hoisting allocations out of parallel loops:\n" << s << "\n\n";
+
     debug(1) << "Injecting early frees...\n";
     s = inject_early_frees(s);
     debug(2) << "Lowering after injecting early frees:\n" << s << "\n\n";
@@ -0,0 +1,236 @@
+#include "LowerFloat16.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "CodeGen_GPU_Dev.h"
+#include "Debug.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::string;
+
+// The conversions below are branch-free versions of the usual
+// bit-twiddling half <-> float conversions. They only use integer
+// operations, selects, and float additions, so they vectorize well on
+// any target. The scalar equivalents live in Float16.cpp.
+
+Expr float16_to_float32(Expr e) {
+    Type t = e.type();
+    internal_assert(t.is_float16()) << "Can't widen non-16-bit float " << e << "\n";
+    Type u32 = UInt(32, t.width);
+    Type f32 = Float(32, t.width);
+
+    Expr bits = cast(u32, reinterpret(UInt(16, t.width), e));
+    if (t.is_bfloat()) {
+        // A bfloat is just the top half of a float.
+        return reinterpret(f32, bits << make_const(u32, 16));
+    }
+
+    string bits_name = unique_name('h');
+    string shifted_name = unique_name('h');
+    Expr bits_var = Variable::make(u32, bits_name);
+    Expr shifted_var = Variable::make(u32, shifted_name);
+
+    // Shift the exponent and mantissa into place, and rebias the
+    // exponent.
+    Expr shifted = (bits_var & make_const(u32, 0x7fff)) << make_const(u32, 13);
+    Expr exponent = shifted_var & make_const(u32, 0x7c00 << 13);
+    Expr normal = shifted_var + make_const(u32, (127 - 15) << 23);
+
+    // Infinities and nans need the maximum exponent.
+    Expr inf_or_nan = normal + make_const(u32, (128 - 16) << 23);
+
+    // Denormals get renormalized by a floating point subtract.
+    Expr denormal = reinterpret(u32,
+                                reinterpret(f32, normal + make_const(u32, 1 << 23)) -
+                                reinterpret(f32, make_const(u32, 113 << 23)));
+
+    Expr result = select(exponent == make_const(u32, 0x7c00 << 13), inf_or_nan,
+                         exponent == make_zero(u32), denormal,
+                         normal);
+    result = result | ((bits_var & make_const(u32, 0x8000)) << make_const(u32, 16));
+    result = Let::make(shifted_name, shifted, result);
+    result = Let::make(bits_name, bits, result);
+    return reinterpret(f32, result);
+}
+
+Expr float32_to_float16(Expr e, Type t) {
+    internal_assert(e.type() == Float(32, t.width) && t.is_float16())
+        << "Can't narrow " << e << " to " << t << "\n";
+    Type u32 = UInt(32, t.width);
+    Type f32 = Float(32, t.width);
+
+    string bits_name = unique_name('f');
+    Expr bits_var = Variable::make(u32, bits_name);
+
+    Expr result;
+    if (t.is_bfloat()) {
+        // Round to nearest even, and keep nans as nans by setting
+        // the quiet bit.
+        Expr is_nan = (bits_var & make_const(u32, 0x7fffffff)) > make_const(u32, 0x7f800000);
+        Expr quiet_nan = (bits_var >> make_const(u32, 16)) | make_const(u32, 0x40);
+        Expr odd = (bits_var >> make_const(u32, 16)) & make_const(u32, 1);
+        Expr rounded = (bits_var + make_const(u32, 0x7fff) + odd) >> make_const(u32, 16);
+        result = select(is_nan, quiet_nan, rounded);
+        result = Let::make(bits_name, reinterpret(u32, e), result);
+        return reinterpret(t, cast(UInt(16, t.width), result));
+    }
+
+    string abs_name = unique_name('f');
+    Expr abs_var = Variable::make(u32, abs_name);
+
+    // Values too large for a half become infinity, and nans stay nans.
+    Expr too_large = abs_var >= make_const(u32, (127 + 16) << 23);
+    Expr inf_or_nan = select(abs_var > make_const(u32, 255 << 23),
+                             make_const(u32, 0x7e00), make_const(u32, 0x7c00));
+
+    // Denormals and zeros. Adding the magic number shifts the mantissa
+    // bits we want into the bottom of the word, and the floating point
+    // add does the rounding.
+    const int magic = ((127 - 15) + (23 - 10) + 1) << 23;
+    Expr too_small = abs_var < make_const(u32, 113 << 23);
+    Expr denormal = reinterpret(u32, reinterpret(f32, abs_var) + reinterpret(f32, make_const(u32, magic)));
+    denormal = denormal - make_const(u32, magic);
+
+    // Normal values. Rebias the exponent and round to nearest even.
+    const int rebias = (int)(((uint32_t)(15 - 127) << 23) + 0xfff);
+    Expr odd = (abs_var >> make_const(u32, 13)) & make_const(u32, 1);
+    Expr normal = (abs_var + make_const(u32, rebias) + odd) >> make_const(u32, 13);
+
+    result = select(too_large, inf_or_nan,
+                    too_small, denormal,
+                    normal);
+    Expr sign = (bits_var & make_const(u32, (int)0x80000000)) >> make_const(u32, 16);
+    result = result | sign;
+    result = Let::make(abs_name, bits_var & make_const(u32, 0x7fffffff), result);
+    result = Let::make(bits_name, reinterpret(u32, e), result);
+    return reinterpret(t, cast(UInt(16, t.width), result));
+}
+
+namespace {
+
+class LowerFloat16 : public IRMutator {
+    using IRMutator::visit;
+
+    // Can the target convert between Float(16) and Float(32) in
+    // hardware?
+    bool native;
+
+    int in_device_code;
+
+    Expr widen(Expr e) {
+        Type t = e.type();
+        if (!t.is_float16()) {
+            return e;
+        } else if (native && !in_device_code && !t.is_bfloat()) {
+            return Cast::make(Float(32, t.width), e);
+        } else {
+            return float16_to_float32(e);
+        }
+    }
+
+    Expr narrow(Expr e, Type t) {
+        internal_assert(t.is_float16());
+        if (e.type() != Float(32, t.width)) {
+            e = Cast::make(Float(32, t.width), e);
+        }
+        if (native && !in_device_code && !t.is_bfloat()) {
+            return Cast::make(t, e);
+        } else {
+            return float32_to_float16(e, t);
+        }
+    }
+
+    template<typename T>
+    void visit_binary_operator(const T *op) {
+        if (!op->a.type().is_float16()) {
+            IRMutator::visit(op);
+            return;
+        }
+        expr = T::make(widen(mutate(op->a)), widen(mutate(op->b)));
+        if (op->type.is_float16()) {
+            expr = narrow(expr, op->type);
+        }
+    }
+
+    void visit(const Add *op) {visit_binary_operator(op);}
+    void visit(const Sub *op) {visit_binary_operator(op);}
+    void visit(const Mul *op) {visit_binary_operator(op);}
+    void visit(const Div *op) {visit_binary_operator(op);}
+    void visit(const Mod *op) {visit_binary_operator(op);}
+    void visit(const Min *op) {visit_binary_operator(op);}
+    void visit(const Max *op) {visit_binary_operator(op);}
+    void visit(const EQ *op) {visit_binary_operator(op);}
+    void visit(const NE *op) {visit_binary_operator(op);}
+    void visit(const LT *op) {visit_binary_operator(op);}
+    void visit(const LE *op) {visit_binary_operator(op);}
+    void visit(const GT *op) {visit_binary_operator(op);}
+    void visit(const GE *op) {visit_binary_operator(op);}
+
+    void visit(const Cast *op) {
+        Type src = op->value.type(), dst = op->type;
+        if (!src.is_float16() && !dst.is_float16()) {
+            IRMutator::visit(op);
+            return;
+        }
+        // Go via Float(32). Note that this means conversions from
+        // Float(64) round twice.
+        Expr value = widen(mutate(op->value));
+        if (dst.is_float16()) {
+            expr = narrow(value, dst);
+        } else if (value.type() != dst) {
+            expr = Cast::make(dst, value);
+        } else {
+            expr = value;
+        }
+    }
+
+    void visit(const Call *op) {
+        bool uses_float16 = op->type.is_float16();
+        for (size_t i = 0; i < op->args.size(); i++) {
+            uses_float16 = uses_float16 || op->args[i].type().is_float16();
+        }
+        if (op->call_type != Call::Intrinsic || !uses_float16 ||
+            !(op->name == Call::abs ||
+              op->name == Call::absd ||
+              op->name == Call::lerp)) {
+            IRMutator::visit(op);
+            return;
+        }
+
+        // Arithmetic intrinsics get done in Float(32).
+        std::vector<Expr> args(op->args.size());
+        for (size_t i = 0; i < op->args.size(); i++) {
+            args[i] = widen(mutate(op->args[i]));
+        }
+        Type t = op->type.is_float16() ? Float(32, op->type.width) : op->type;
+        expr = Call::make(t, op->name, args, op->call_type);
+        if (op->type.is_float16()) {
+            expr = narrow(expr, op->type);
+        }
+    }
+
+    void visit(const For *op) {
+        bool device = (CodeGen_GPU_Dev::is_gpu_var(op->name) ||
+                       (op->device_api != DeviceAPI::Host &&
+                        op->device_api != DeviceAPI::Parent));
+        if (device) in_device_code++;
+        IRMutator::visit(op);
+        if (device) in_device_code--;
+    }
+
+public:
+    LowerFloat16(const Target &t) : in_device_code(0) {
+        native = ((t.arch == Target::X86 && t.has_feature(Target::F16C)) ||
+                  (t.arch == Target::ARM && t.bits == 64));
+    }
+};
+
+}
+
+Stmt lower_float16(Stmt s, const Target &t) {
+    return LowerFloat16(t).mutate(s);
+}
+
+}
+}
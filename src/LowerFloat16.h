@@ -0,0 +1,36 @@
+#ifndef HALIDE_LOWER_FLOAT16_H
+#define HALIDE_LOWER_FLOAT16_H
+
+/** \file
+ * Defines the lowering pass that removes arithmetic on 16-bit floating
+ * point types.
+ */
+
+#include "IR.h"
+#include "Target.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Convert a Float(16) or BFloat(16) expression to Float(32) using
+ * integer bit manipulation. Vectorizes cleanly. */
+Expr float16_to_float32(Expr e);
+
+/** Convert a Float(32) expression to Float(16) or BFloat(16),
+ * rounding to nearest even, using integer bit manipulation. Vectorizes
+ * cleanly. */
+Expr float32_to_float16(Expr e, Type t);
+
+/** Rewrite all arithmetic on 16-bit floating point types to happen in
+ * Float(32), and make conversions to and from them go via
+ * Float(32). Conversions between Float(16) and Float(32) are left as
+ * Cast nodes if the target can do them in hardware (e.g. with F16C on
+ * x86). All others are replaced with integer bit manipulation, so that
+ * after this pass 16-bit floats are only loaded, stored, selected
+ * between, and reinterpreted. */
+Stmt lower_float16(Stmt s, const Target &t);
+
+}
+}
+
+#endif
@@ -44,6 +44,7 @@ public:
     void visit(const Load *);
     void visit(const Ramp *);
     void visit(const Broadcast *);
+    void visit(const VectorReduce *);
     void visit(const Call *);
     void visit(const Let *);
     void visit(const LetStmt *);
@@ -341,6 +342,12 @@ void ComputeModulusRemainder::visit(const Broadcast *) {
     internal_assert(false) << "modulus_remainder of vector\n";
 }
 
+void ComputeModulusRemainder::visit(const VectorReduce *op) {
+    internal_assert(op->type.is_scalar()) << "modulus_remainder of vector\n";
+    modulus = 1;
+    remainder = 0;
+}
+
 void ComputeModulusRemainder::visit(const Call *) {
     modulus = 1;
     remainder = 0;
@@ -1,10 +1,13 @@
 #include "CodeGen_C.h"
 #include "StmtToHtml.h"
 #include "Output.h"
+#include "IROperator.h"
 #include "LLVM_Headers.h"
 #include "LLVM_Output.h"
+#include "Util.h"
 
 #include <fstream>
+#include <set>
 
 namespace Halide {
 
@@ -106,4 +109,274 @@ void compile_module_to_c(const Module &module,
     compile_module_to_c_source(module, c_filename);
 }
 
+namespace {
+
+// The x86 instruction set features that halide_can_use_target_features
+// in the runtime knows how to check for.
+const Target::Feature cpu_features[] = {
+    Target::SSE41, Target::AVX, Target::AVX2, Target::FMA, Target::FMA4, Target::F16C
+};
+const size_t num_cpu_features = sizeof(cpu_features) / sizeof(cpu_features[0]);
+
+uint64_t cpu_feature_mask(const Target &t) {
+    uint64_t mask = 0;
+    for (size_t i = 0; i < num_cpu_features; i++) {
+        if (t.has_feature(cpu_features[i])) {
+            mask |= ((uint64_t)1) << cpu_features[i];
+        }
+    }
+    return mask;
+}
+
+Target without_cpu_features(Target t) {
+    for (size_t i = 0; i < num_cpu_features; i++) {
+        t.set_feature(cpu_features[i], false);
+    }
+    return t;
+}
+
+// The names of the outputs can differ between variants, because they
+// come from the names of the output Funcs, which are made unique.
+bool same_arguments(const std::vector<Argument> &a, const std::vector<Argument> &b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if ((a[i].name != b[i].name && !a[i].is_output()) ||
+            a[i].kind != b[i].kind ||
+            a[i].type != b[i].type ||
+            a[i].dimensions != b[i].dimensions) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Call a variant of a pipeline with the arguments of the entry point
+// of the dispatcher, in the same way that the public wrapper made by
+// Func::compile_to_module calls the private function, and fail with
+// the error code it returns, if any.
+Internal::Stmt call_variant(const std::string &variant_name, const std::vector<Argument> &args) {
+    using namespace Internal;
+    std::vector<Expr> call_args;
+    for (size_t j = 0; j < args.size(); j++) {
+        if (args[j].is_buffer()) {
+            call_args.push_back(Variable::make(type_of<void *>(), args[j].name + ".buffer"));
+        } else {
+            call_args.push_back(Variable::make(args[j].type, args[j].name));
+        }
+    }
+    std::string result_name = unique_name(variant_name + "_result", false);
+    Expr result_var = Variable::make(Int(32), result_name);
+    Expr call = Call::make(Int(32), variant_name, call_args, Call::Extern);
+    Stmt check = AssertStmt::make(result_var == 0, result_var);
+    return LetStmt::make(result_name, call, check);
+}
+
+}  // namespace
+
+void compile_multitarget_to_object(const std::string &fn_name,
+                                   const std::vector<Target> &targets,
+                                   std::function<Module(const std::string &, const Target &)> module_producer,
+                                   std::string filename) {
+    using namespace Internal;
+
+    user_assert(!targets.empty()) << "compile_multitarget_to_object requires at least one target.\n";
+
+    // The last target is the fallback, and determines the runtime
+    // that goes into the object.
+    Target base = targets.back().without_feature(Target::NoRuntime);
+    user_assert(base.arch == Target::X86 && base.os != Target::NaCl)
+        << "compile_multitarget_to_object only supports x86 targets, not " << base.to_string() << "\n";
+    for (size_t i = 0; i < targets.size(); i++) {
+        const Target &t = targets[i];
+        user_assert(!t.has_feature(Target::JIT))
+            << "compile_multitarget_to_object can't be used with JIT targets.\n";
+        user_assert(without_cpu_features(t.without_feature(Target::NoRuntime)) == without_cpu_features(base))
+            << "The targets passed to compile_multitarget_to_object may only differ in their "
+            << "instruction set features, but " << t.to_string()
+            << " and " << base.to_string() << " differ in other ways.\n";
+        for (size_t j = 0; j < i; j++) {
+            user_assert(targets[j].without_feature(Target::NoRuntime) != t.without_feature(Target::NoRuntime))
+                << "The target " << t.to_string() << " was passed to compile_multitarget_to_object more than once.\n";
+        }
+    }
+
+    #if LLVM_VERSION < 37
+    user_error << "compile_multitarget_to_object requires LLVM 3.7 or later.\n";
+    #else
+
+    if (filename.empty()) filename = fn_name + ".o";
+
+    llvm::LLVMContext context;
+
+    // Compile each variant without a runtime, and build up the
+    // dispatch logic for the entry point, starting from the
+    // unconditional fallback.
+    std::vector<llvm::Module *> variants;
+    std::vector<Argument> args;
+    Stmt dispatch;
+    for (size_t i = targets.size(); i > 0; i--) {
+        const Target &target = targets[i-1];
+        // Metadata registration and mex wrappers belong to the entry
+        // point, not the variants.
+        Target variant_target = target
+            .with_feature(Target::NoRuntime)
+            .without_feature(Target::RegisterMetadata)
+            .without_feature(Target::Matlab);
+
+        std::string suffix = target.to_string();
+        std::string variant_name = fn_name + "_" + replace_all(suffix, "-", "_");
+
+        Module m = module_producer(variant_name, variant_target);
+        user_assert(m.target() == variant_target)
+            << "The module_producer passed to compile_multitarget_to_object must produce a module for the target it is given.\n";
+
+        const LoweredFunc *variant_fn = NULL;
+        for (size_t j = 0; j < m.functions.size(); j++) {
+            if (m.functions[j].name == variant_name &&
+                m.functions[j].linkage == LoweredFunc::External) {
+                variant_fn = &m.functions[j];
+            }
+        }
+        user_assert(variant_fn)
+            << "The module_producer passed to compile_multitarget_to_object must produce a function named "
+            << variant_name << "\n";
+        if (i == targets.size()) {
+            args = variant_fn->args;
+        } else {
+            user_assert(same_arguments(args, variant_fn->args))
+                << "All variants passed to compile_multitarget_to_object must have the same arguments, but "
+                << variant_name << " does not match " << fn_name << "_" << targets.back().to_string() << "\n";
+        }
+
+        llvm::Module *variant = compile_module_to_llvm_module(m, context);
+
+        // The variants all get linked into one module, which is
+        // compiled with the base target, so record each variant's
+        // cpu and features on its functions. Everything but the entry
+        // point is made internal to avoid clashes between variants.
+        llvm::TargetOptions options;
+        std::string mcpu, mattrs;
+        get_target_options(variant, options, mcpu, mattrs);
+        for (llvm::Module::iterator iter = variant->begin(); iter != variant->end(); iter++) {
+            llvm::Function *f = (llvm::Function *)(iter);
+            if (f->isDeclaration()) continue;
+            f->addFnAttr("target-cpu", mcpu);
+            f->addFnAttr("target-features", mattrs);
+            if (f->getName() != variant_name) {
+                f->setLinkage(llvm::GlobalValue::InternalLinkage);
+            }
+        }
+        for (llvm::Module::global_iterator iter = variant->global_begin(); iter != variant->global_end(); iter++) {
+            llvm::GlobalVariable *g = (llvm::GlobalVariable *)(iter);
+            if (!g->isDeclaration() && !starts_with(g->getName(), "llvm.")) {
+                g->setLinkage(llvm::GlobalValue::InternalLinkage);
+            }
+        }
+        // The module flags (e.g. halide_mcpu) of the base target win.
+        if (llvm::NamedMDNode *flags = variant->getModuleFlagsMetadata()) {
+            variant->eraseNamedMetadata(flags);
+        }
+        // Drop the argv wrapper and metadata that are no longer
+        // reachable.
+        llvm::legacy::PassManager pass_manager;
+        pass_manager.add(llvm::createGlobalDCEPass());
+        pass_manager.run(*variant);
+
+        variants.push_back(variant);
+
+        Stmt call = call_variant(variant_name, args);
+
+        if (!dispatch.defined()) {
+            dispatch = call;
+        } else {
+            Expr can_use = Call::make(Int(32), "halide_can_use_target_features",
+                                      vec<Expr>(make_const(UInt(64), (int64_t)cpu_feature_mask(target))),
+                                      Call::Extern);
+            dispatch = IfThenElse::make(can_use != 0, call, dispatch);
+        }
+    }
+
+    // Compile the entry point along with the runtime, and link in the
+    // variants.
+    Module entry(fn_name, base);
+    entry.append(LoweredFunc(fn_name, args, dispatch, LoweredFunc::External));
+    llvm::Module *result = compile_module_to_llvm_module(entry, context);
+    for (size_t i = 0; i < variants.size(); i++) {
+        bool failed = llvm::Linker::LinkModules(result, variants[i]);
+        internal_assert(!failed) << "Failure linking variant into multi-target module\n";
+        delete variants[i];
+    }
+
+    compile_llvm_module_to_object(result, filename);
+    delete result;
+    #endif
+}
+
+Module link_variants_with_dispatch(const std::string &fn_name,
+                                   const std::vector<Module> &variants,
+                                   const std::vector<Expr> &conditions) {
+    using namespace Internal;
+
+    user_assert(!variants.empty() && variants.size() == conditions.size())
+        << "link_variants_with_dispatch requires one condition per variant, and at least one variant.\n";
+
+    // Build up the dispatch logic for the entry point, starting from
+    // the unconditional fallback.
+    std::vector<Module> modules;
+    std::vector<Argument> args;
+    std::set<std::string> buffer_names;
+    Stmt dispatch;
+    for (size_t i = variants.size(); i > 0; i--) {
+        Module m = variants[i-1];
+        const std::string &variant_name = m.name();
+
+        // Only the entry point is visible from outside, so the
+        // variants don't get argv wrappers or metadata of their own.
+        bool found = false;
+        for (LoweredFunc &f : m.functions) {
+            if (f.linkage != LoweredFunc::External) continue;
+            if (f.name == variant_name) {
+                found = true;
+                if (i == variants.size()) {
+                    args = f.args;
+                } else {
+                    user_assert(same_arguments(args, f.args))
+                        << "All variants passed to link_variants_with_dispatch must have the same arguments, but "
+                        << variant_name << " does not match " << variants.back().name() << "\n";
+                }
+            }
+            f.linkage = LoweredFunc::Internal;
+        }
+        user_assert(found)
+            << "Each Module passed to link_variants_with_dispatch must contain "
+            << "a function with the same name as the Module, but " << variant_name << " does not.\n";
+
+        for (const Buffer &b : m.buffers) {
+            user_assert(buffer_names.insert(b.name()).second)
+                << "The variants passed to link_variants_with_dispatch both contain a buffer named "
+                << b.name() << "\n";
+        }
+
+        Stmt call = call_variant(variant_name, args);
+        if (!dispatch.defined()) {
+            dispatch = call;
+        } else {
+            user_assert(conditions[i-1].defined() && conditions[i-1].type().is_bool())
+                << "The condition for " << variant_name << " passed to link_variants_with_dispatch "
+                << "must be a boolean expression.\n";
+            dispatch = IfThenElse::make(conditions[i-1], call, dispatch);
+        }
+
+        modules.push_back(m);
+    }
+
+    // The variants have to be compiled before the entry point that
+    // calls them.
+    Module entry(fn_name, variants.back().target());
+    entry.append(LoweredFunc(fn_name, args, dispatch, LoweredFunc::External));
+    modules.push_back(entry);
+
+    return link_modules(fn_name, modules);
+}
+
 }  // namespace Halide
@@ -7,6 +7,8 @@
  * objects from Halide Module objects.
  */
 
+#include <functional>
+
 #include "Module.h"
 
 namespace Halide {
@@ -55,6 +57,38 @@ EXPORT void compile_module_to_html(const Module &module, std::string filename =
  * is the name of the module with the extension .stmt. */
 EXPORT void compile_module_to_text(const Module &module, std::string filename = "");
 
+/** Compile several variants of a pipeline, one per target, into a
+ * single object file, along with an entry point named fn_name that
+ * checks the features of the host cpu (once) and calls the first
+ * variant whose target the host can run. The targets should be
+ * listed best first; the last one is used unconditionally if none
+ * of the others can run, so it should be the lowest common
+ * denominator. module_producer is called once per target to produce
+ * the Module for that variant, and must produce a function with the
+ * given name and the same arguments for every target. All targets
+ * must have the same os, arch and bits, and only differ in
+ * instruction set features. Only x86 targets are supported, and
+ * only with LLVM 3.7 or later. The default filename is fn_name with
+ * the extension .o. */
+EXPORT void compile_multitarget_to_object(const std::string &fn_name,
+                                          const std::vector<Target> &targets,
+                                          std::function<Module(const std::string &, const Target &)> module_producer,
+                                          std::string filename = "");
+
+/** Link several variants of a pipeline for the same target, each made
+ * by Func::compile_to_module (e.g. with schedules tuned for different
+ * sizes of input), into a single Module with an entry point named
+ * fn_name that calls the first variant whose condition is true. Each
+ * variant must contain a function with the same name as the variant
+ * Module, and they must all have the same arguments. The conditions
+ * may refer to the scalar arguments by name, and to the fields of the
+ * buffer arguments (e.g. ImageParam::width()). The condition of the
+ * last variant is ignored: it's used when none of the others apply.
+ * Only the entry point is externally visible. */
+EXPORT Module link_variants_with_dispatch(const std::string &fn_name,
+                                          const std::vector<Module> &variants,
+                                          const std::vector<Expr> &conditions);
+
 }
 
 #endif
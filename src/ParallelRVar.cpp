@@ -4,6 +4,8 @@
 #include "Debug.h"
 #include "Simplify.h"
 #include "IROperator.h"
+#include "IREquality.h"
+#include "ExprUsesVar.h"
 
 namespace Halide {
 namespace Internal {
@@ -120,5 +122,77 @@ bool can_parallelize_rvar(const string &v,
     return is_zero(hazard);
 }
 
+namespace {
+
+/** Is an expression a call to the given function at the given site? */
+bool is_call_at_site(Expr e, const string &func, const vector<Expr> &args) {
+    const Call *call = e.as<Call>();
+    if (!call || call->name != func || call->call_type != Call::Halide ||
+        call->args.size() != args.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < args.size(); i++) {
+        if (!equal(call->args[i], args[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+bool can_vectorize_rvar_as_reduction(const string &v,
+                                     const string &f,
+                                     const UpdateDefinition &r) {
+    if (r.values.size() != 1) {
+        return false;
+    }
+
+    // Every value of the RVar must update the same site.
+    for (size_t i = 0; i < r.args.size(); i++) {
+        if (expr_uses_var(r.args[i], v)) {
+            return false;
+        }
+    }
+
+    // Common subexpressions of the value may have been pulled out
+    // into lets. None of them can depend on the function being
+    // updated.
+    FindLoads find(f);
+    Expr value = r.values[0];
+    while (const Let *let = value.as<Let>()) {
+        let->value.accept(&find);
+        value = let->body;
+    }
+
+    Expr a, b;
+    bool commutative = true;
+    if (const Add *op = value.as<Add>()) {
+        a = op->a; b = op->b;
+    } else if (const Sub *op = value.as<Sub>()) {
+        a = op->a; b = op->b;
+        commutative = false;
+    } else if (const Mul *op = value.as<Mul>()) {
+        a = op->a; b = op->b;
+    } else if (const Min *op = value.as<Min>()) {
+        a = op->a; b = op->b;
+    } else if (const Max *op = value.as<Max>()) {
+        a = op->a; b = op->b;
+    } else {
+        return false;
+    }
+
+    if (!is_call_at_site(a, f, r.args)) {
+        if (!commutative || !is_call_at_site(b, f, r.args)) {
+            return false;
+        }
+        std::swap(a, b);
+    }
+
+    // The new values can't depend on the function being updated.
+    b.accept(&find);
+    return find.loads.empty();
+}
+
 }
 }
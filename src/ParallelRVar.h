@@ -21,6 +21,16 @@ bool can_parallelize_rvar(const std::string &rvar,
                           const std::string &func,
                           const UpdateDefinition &r);
 
+/** Returns whether or not an update definition is an associative
+ * reduction into a single site that doesn't depend on the given
+ * reduction variable, e.g. f(x) = f(x) + g(x, r). These can be
+ * vectorized across the reduction variable by reducing each vector
+ * of values horizontally. Note that this reassociates floating point
+ * sums and products. */
+bool can_vectorize_rvar_as_reduction(const std::string &rvar,
+                                     const std::string &func,
+                                     const UpdateDefinition &r);
+
 }
 }
 
@@ -0,0 +1,30 @@
+#include "ParallelTasks.h"
+#include "IROperator.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::string;
+
+ParallelTasks::ParallelTasks(const For *l, const string &kind) : loop(l) {
+    task_name = loop->name + "." + kind;
+    task_size_name = loop->name + "." + kind + "_size";
+    loop_max_name = loop->name + "." + kind + "_loop_max";
+    Expr task = Variable::make(Int(32), task_name);
+    Expr task_size = Variable::make(Int(32), task_size_name);
+    Expr loop_max = Variable::make(Int(32), loop_max_name);
+    inner_min = loop->min + task * task_size;
+    inner_extent = min(task_size, loop_max - inner_min);
+}
+
+Stmt ParallelTasks::wrap(Stmt task_body) const {
+    Expr task_size = Variable::make(Int(32), task_size_name);
+    Expr num_tasks = (loop->extent + task_size - 1) / task_size;
+    Stmt s = For::make(task_name, 0, num_tasks, ForType::Parallel, loop->device_api, task_body);
+    s = LetStmt::make(loop_max_name, loop->min + loop->extent, s);
+    Expr size = max((loop->extent + (max_parallel_tasks - 1)) / max_parallel_tasks, 1);
+    return LetStmt::make(task_size_name, size, s);
+}
+
+}
+}
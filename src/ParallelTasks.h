@@ -0,0 +1,54 @@
+#ifndef HALIDE_PARALLEL_TASKS_H
+#define HALIDE_PARALLEL_TASKS_H
+
+/** \file
+ * Defines a helper for lowering passes that split a parallel loop
+ * into a bounded number of tasks.
+ */
+
+#include "IR.h"
+
+namespace Halide {
+namespace Internal {
+
+/** The maximum number of tasks a lowering pass splits a parallel loop
+ * into. This matches the maximum size of the thread pool in the
+ * runtime, so we never make more tasks (and hence per-task state) than
+ * could usefully be running at once, but still leave several tasks
+ * per thread for load balancing on typical machines. */
+const int max_parallel_tasks = 64;
+
+/** Splits a parallel for loop into at most max_parallel_tasks
+ * parallel tasks, each of which runs a contiguous chunk of the
+ * original iterations serially. The last task may get a short
+ * chunk. For a loop over x and a kind of "task", the tasks are a
+ * parallel loop over x.task, and each runs x from inner_min for
+ * inner_extent iterations. E.g:
+ *
+ \code
+ ParallelTasks tasks(op, "task");
+ Stmt body = For::make(op->name, tasks.inner_min, tasks.inner_extent,
+                       ForType::Serial, op->device_api, op->body);
+ stmt = tasks.wrap(body);
+ \endcode
+ */
+class ParallelTasks {
+    const For *loop;
+    std::string task_name, task_size_name, loop_max_name;
+
+public:
+    ParallelTasks(const For *loop, const std::string &kind);
+
+    /** The bounds of the serial loop each task runs, in terms of the
+     * task index and the task size. */
+    Expr inner_min, inner_extent;
+
+    /** Wrap the body of a task in the parallel loop over the tasks,
+     * and define the task size. */
+    Stmt wrap(Stmt task_body) const;
+};
+
+}
+}
+
+#endif
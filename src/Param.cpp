@@ -1,4 +1,5 @@
 #include "Param.h"
+#include "IROperator.h"
 
 
 namespace Halide {
@@ -60,6 +61,14 @@ Expr OutputImageParam::stride(int x) const {
     return Internal::Variable::make(Int(32), s.str(), param);
 }
 
+Expr OutputImageParam::is_host_aligned(int bytes) const {
+    user_assert(bytes > 0 && (bytes & (bytes - 1)) == 0)
+        << "Can't check whether the host pointer of " << name()
+        << " is aligned to " << bytes << " bytes, because it is not a power of two\n";
+    Expr host = Internal::Variable::make(Handle(), name() + ".host", param);
+    return (reinterpret(UInt(64), host) % Internal::make_const(UInt(64), bytes)) == Internal::make_zero(UInt(64));
+}
+
 OutputImageParam &OutputImageParam::set_extent(int dim, Expr extent) {
     param.set_extent_constraint(dim, extent);
     return *this;
@@ -221,6 +221,22 @@ public:
      * given dimension */
     EXPORT Expr stride(int x) const;
 
+    /** Get a boolean expression that is true when the host pointer of
+     * the buffer passed in is aligned to the given number of bytes,
+     * which must be a power of two. Use it as a specialization
+     * condition: inside the specialized branch, dense vector loads and
+     * stores at offsets that are known multiples of the alignment use
+     * aligned instructions. Buffers that aren't aligned take the other
+     * branch. E.g.:
+     \code
+     im.set_stride(0, Expr());
+     f.specialize(im.is_host_aligned(32) && im.stride(0) == 1);
+     f.specialize(im.stride(0) == 3 && im.stride(2) == 1);
+     \endcode
+     * compiles an aligned dense planar path, an interleaved path, and a
+     * generic fallback. */
+    EXPORT Expr is_host_aligned(int bytes) const;
+
     /** Set the extent in a given dimension to equal the given
      * expression. Images passed in that fail this check will generate
      * a runtime error. Returns a reference to the ImageParam so that
@@ -62,6 +62,10 @@ public:
     }
 
     Stmt simplify_prologue(Stmt s) {
+        // Note that the same min_val and replacement are only
+        // recorded once, so an expression that was duplicated across
+        // the pieces of an already-partitioned inner loop still
+        // counts as a single condition here.
         if (min_vals.size() == 1 &&
             prologue_replacements.size() == 1) {
             // If there is more than one min_val, then the boundary
@@ -128,6 +132,26 @@ private:
     };
     vector<Replacement> prologue_replacements, epilogue_replacements;
 
+    void add_replacement(vector<Replacement> &replacements, Replacement r) {
+        for (size_t i = 0; i < replacements.size(); i++) {
+            if (equal(replacements[i].old_expr, r.old_expr) &&
+                equal(replacements[i].new_expr, r.new_expr)) {
+                return;
+            }
+        }
+        replacements.push_back(r);
+    }
+
+    // Add a bound on the steady state, unless we already have it.
+    void add_val(vector<Expr> &vals, Expr v) {
+        for (size_t i = 0; i < vals.size(); i++) {
+            if (equal(vals[i], v)) {
+                return;
+            }
+        }
+        vals.push_back(v);
+    }
+
     // A set of let statements for common subexpressions inside the
     // min_vals and max_vals.
     vector<pair<string, Expr>> containing_lets;
@@ -326,6 +350,14 @@ private:
         // which this condition is true, and update min_max and
         // max_val accordingly.
 
+        // Conditions in terms of an inner loop var can't be pulled
+        // outside. Check this before solving, because the inner loops
+        // may themselves have been partitioned already, which makes
+        // this case common.
+        if (expr_uses_vars(cond, inner_loop_vars)) {
+            return cond;
+        }
+
         debug(3) << "Condition: " << cond << "\n";
         Expr solved = solve_expression(cond, loop_var, bound_vars);
         debug(3) << "Solved condition for " <<  loop_var << ": " << solved << "\n";
@@ -335,11 +367,6 @@ private:
             return cond;
         }
 
-        // Conditions in terms of an inner loop var can't be pulled outside
-        if (expr_uses_vars(cond, inner_loop_vars)) {
-            return cond;
-        }
-
         // Peel off lets.
         vector<pair<string, Expr>> new_lets;
         while (const Let *let = solved.as<Let>()) {
@@ -351,22 +378,22 @@ private:
         bool success = false;
         if (const LT *lt = solved.as<LT>()) {
             if (is_loop_var(lt->a)) {
-                max_vals.push_back(lt->b);
+                add_val(max_vals, lt->b);
                 success = true;
             }
         } else if (const LE *le = solved.as<LE>()) {
             if (is_loop_var(le->a)) {
-                max_vals.push_back(le->b + 1);
+                add_val(max_vals, le->b + 1);
                 success = true;
             }
         } else if (const GE *ge = solved.as<GE>()) {
             if (is_loop_var(ge->a)) {
-                min_vals.push_back(ge->b);
+                add_val(min_vals, ge->b);
                 success = true;
             }
         } else if (const GT *gt = solved.as<GT>()) {
             if (is_loop_var(gt->a)) {
-                min_vals.push_back(gt->b + 1);
+                add_val(min_vals, gt->b + 1);
                 success = true;
             }
         }
@@ -436,10 +463,10 @@ private:
                 if (!found_simplification_in_children && tight) {
                     Replacement r = {op, op_b};
                     if (min_vals.size() > old_num_min_vals) {
-                        prologue_replacements.push_back(r);
+                        add_replacement(prologue_replacements, r);
                     }
                     if (max_vals.size() > old_num_max_vals) {
-                        epilogue_replacements.push_back(r);
+                        add_replacement(epilogue_replacements, r);
                     }
                 }
             } else {
@@ -505,10 +532,10 @@ private:
                 if (!found_simplification_in_children && tight) {
                     Replacement r = {op->condition, const_false()};
                     if (min_vals.size() > old_num_min_vals) {
-                        prologue_replacements.push_back(r);
+                        add_replacement(prologue_replacements, r);
                     }
                     if (max_vals.size() > old_num_max_vals) {
-                        epilogue_replacements.push_back(r);
+                        add_replacement(epilogue_replacements, r);
                     }
                 }
                 return true_value;
@@ -525,10 +552,10 @@ private:
                 if (!found_simplification_in_children && tight) {
                     Replacement r = {op->condition, const_true()};
                     if (min_vals.size() > old_num_min_vals) {
-                        prologue_replacements.push_back(r);
+                        add_replacement(prologue_replacements, r);
                     }
                     if (max_vals.size() > old_num_max_vals) {
-                        epilogue_replacements.push_back(r);
+                        add_replacement(epilogue_replacements, r);
                     }
                 }
                 return false_value;
@@ -603,24 +630,33 @@ private:
 class PartitionLoops : public IRMutator {
     using IRMutator::visit;
 
-    void visit(const For *op) {
+    // The deepest nesting of partitioned loops within the statement
+    // most recently mutated.
+    int depth;
 
+    void visit(const For *op) {
+        int old_depth = depth;
+        depth = 0;
         Stmt body = mutate(op->body);
-
-        // We conservatively only apply this optimization at one loop
-        // level, which limits the expansion in code size to a factor
-        // of 3.  Comment out the check below to allow full expansion
-        // into 3^n cases for n loop levels.
-        //
-        // Another strategy is to not recursively call mutate on the
-        // body in the line above, but instead recursively call mutate
-        // only on simpler_body below. This results in a 2*n + 1
-        // expansion factor. Testing didn't reveal either of these
-        // strategies to be a performance win, so we'll just expand
-        // once.
-        if (!body.same_as(op->body)) {
-            stmt = For::make(op->name, op->min, op->extent,
-                             op->for_type, op->device_api, body);
+        int inner_depth = depth;
+        depth = std::max(old_depth, inner_depth);
+
+        // We partition inner loops first, and then partition the
+        // loops outside of them, so that boundary conditions in
+        // several dimensions give a steady state free of all of
+        // them. Each piece of the inner loops is simplified
+        // separately in the prologue, steady state, and epilogue of
+        // the outer loop, so the border regions get their own
+        // specialized code too. This expands the code size by a
+        // factor of 3^n for n partitioned loop levels, so we stop
+        // after a few levels.
+        if (inner_depth >= max_partition_depth) {
+            if (body.same_as(op->body)) {
+                stmt = op;
+            } else {
+                stmt = For::make(op->name, op->min, op->extent,
+                                 op->for_type, op->device_api, body);
+            }
             return;
         }
 
@@ -738,6 +774,7 @@ class PartitionLoops : public IRMutator {
             new_loop = f.add_containing_lets(new_loop);
 
             stmt = new_loop;
+            depth = std::max(old_depth, inner_depth + 1);
         } else if (body.same_as(op->body)) {
             stmt = op;
         } else {
@@ -745,6 +782,12 @@ class PartitionLoops : public IRMutator {
                              op->for_type, op->device_api, body);
         }
     }
+
+public:
+    // The maximum number of nested loop levels to partition.
+    static const int max_partition_depth = 3;
+
+    PartitionLoops() : depth(0) {}
 };
 
 // Remove any remaining 'likely' intrinsics. There may be some left
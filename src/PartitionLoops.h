@@ -14,7 +14,9 @@ namespace Internal {
 
 /** Partitions loop bodies into a prologue, a steady state, and an
  * epilogue. Finds the steady state by hunting for use of clamped
- * ramps, or the 'likely' intrinsic. */
+ * ramps, or the 'likely' intrinsic. Nested loops are partitioned
+ * too, up to a few levels deep, so that boundary conditions in
+ * several dimensions give a steady state free of all of them. */
 EXPORT Stmt partition_loops(Stmt s);
 
 }
@@ -0,0 +1,72 @@
+#include "PreparedPipeline.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "Util.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::string;
+
+const char *const prepared_context_name = "__prepared_context";
+
+namespace {
+
+// The checks that only depend on the shapes of the buffers and the
+// values of the scalar parameters, which the runtime compares against
+// the last call that passed them. The rest (e.g. host pointer
+// alignment, and the results of extern stages) still happen on every
+// call.
+bool is_shape_check(const AssertStmt *op) {
+    const Call *c = op->message.as<Call>();
+    if (!c || c->call_type != Call::Extern) {
+        return false;
+    }
+    static const char *checks[] = {
+        "halide_error_bad_elem_size",
+        "halide_error_access_out_of_bounds",
+        "halide_error_buffer_allocation_too_large",
+        "halide_error_buffer_extents_too_large",
+        "halide_error_constraints_make_required_region_smaller",
+        "halide_error_constraint_violated",
+    };
+    for (size_t i = 0; i < sizeof(checks) / sizeof(checks[0]); i++) {
+        if (c->name == checks[i]) {
+            return true;
+        }
+    }
+    return starts_with(c->name, "halide_error_param_");
+}
+
+class SkipValidatedChecks : public IRMutator {
+    Expr validated;
+
+    using IRMutator::visit;
+
+    void visit(const AssertStmt *op) {
+        if (is_shape_check(op)) {
+            stmt = IfThenElse::make(!validated, op);
+        } else {
+            stmt = op;
+        }
+    }
+
+public:
+    SkipValidatedChecks(Expr v) : validated(v) {}
+};
+
+}
+
+Stmt skip_validated_checks(Stmt s) {
+    string validated_name = unique_name("prepared_validated", false);
+    Expr validated = Variable::make(Bool(), validated_name);
+    Expr context = Variable::make(Handle(), prepared_context_name);
+    Expr query = Call::make(Int(32), "halide_prepared_validated",
+                            vec<Expr>(context), Call::Extern);
+
+    s = SkipValidatedChecks(validated).mutate(s);
+    return LetStmt::make(validated_name, query != 0, s);
+}
+
+}
+}
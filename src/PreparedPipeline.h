@@ -0,0 +1,27 @@
+#ifndef HALIDE_PREPARED_PIPELINE_H
+#define HALIDE_PREPARED_PIPELINE_H
+
+/** \file
+ * Defines the pass that makes the body of a pipeline's _prepared entry
+ * point, for the prepare_run target feature.
+ */
+
+#include "IR.h"
+
+namespace Halide {
+namespace Internal {
+
+/** The name of the extra argument of a _prepared entry point, which
+ * holds the halide_prepared_pipeline_t the call belongs to. */
+extern const char *const prepared_context_name;
+
+/** Guard the checks on the input and output buffers and the scalar
+ * parameters made by add_image_checks and add_parameter_checks so
+ * that they are skipped when the prepared pipeline says the arguments
+ * have already passed them. */
+Stmt skip_validated_checks(Stmt s);
+
+}
+}
+
+#endif
@@ -0,0 +1,467 @@
+#include <algorithm>
+#include <map>
+#include <set>
+
+#include "ReuseAllocations.h"
+#include "IRMutator.h"
+#include "IRVisitor.h"
+#include "IROperator.h"
+#include "Simplify.h"
+#include "CodeGen_GPU_Dev.h"
+#include "Debug.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::map;
+using std::set;
+using std::string;
+using std::vector;
+
+namespace {
+
+// Find the buffers loaded from or stored to by a statement, and the
+// ones referred to in any other way (e.g. via a buffer_t or from
+// within a gpu kernel), which we must not touch.
+class FindBufferUses : public IRGraphVisitor {
+    using IRGraphVisitor::visit;
+
+    int in_gpu_loop;
+
+    void visit(const Load *op) {
+        used.insert(op->name);
+        if (in_gpu_loop) special.insert(op->name);
+        IRGraphVisitor::visit(op);
+    }
+
+    void visit(const Store *op) {
+        used.insert(op->name);
+        if (in_gpu_loop) special.insert(op->name);
+        IRGraphVisitor::visit(op);
+    }
+
+    void visit(const Call *op) {
+        if (op->call_type == Call::Intrinsic &&
+            op->name == Call::address_of) {
+            // A pointer into the buffer escapes (e.g. into a
+            // buffer_t for an extern stage).
+            const Load *l = op->args[0].as<Load>();
+            internal_assert(l) << "The sole argument to address_of must be a Load node\n";
+            special.insert(l->name);
+        }
+        IRGraphVisitor::visit(op);
+    }
+
+    void visit(const Variable *op) {
+        // e.g. foo.buffer or foo.host
+        size_t last_dot = op->name.rfind('.');
+        if (last_dot != string::npos) {
+            special.insert(op->name.substr(0, last_dot));
+        }
+    }
+
+    void visit(const For *op) {
+        bool gpu = (CodeGen_GPU_Dev::is_gpu_var(op->name) ||
+                    (op->device_api != DeviceAPI::Host &&
+                     op->device_api != DeviceAPI::Parent));
+        if (gpu) in_gpu_loop++;
+        IRGraphVisitor::visit(op);
+        if (gpu) in_gpu_loop--;
+    }
+
+public:
+    set<string> used, special;
+    FindBufferUses() : in_gpu_loop(0) {}
+};
+
+// Find the names of the variables an expression refers to.
+class FindVariables : public IRGraphVisitor {
+    using IRGraphVisitor::visit;
+
+    void visit(const Variable *op) {
+        names.insert(op->name);
+    }
+
+public:
+    set<string> names;
+};
+
+// Flatten the statements executed one after the other into a list,
+// so that we can talk about the range of statements over which each
+// buffer is used.
+void flatten_sequence(Stmt s, vector<Stmt> &seq) {
+    if (const Block *b = s.as<Block>()) {
+        flatten_sequence(b->first, seq);
+        if (b->rest.defined()) {
+            flatten_sequence(b->rest, seq);
+        }
+    } else if (const Pipeline *p = s.as<Pipeline>()) {
+        flatten_sequence(p->produce, seq);
+        if (p->update.defined()) {
+            flatten_sequence(p->update, seq);
+        }
+        flatten_sequence(p->consume, seq);
+    } else if (const LetStmt *l = s.as<LetStmt>()) {
+        flatten_sequence(l->body, seq);
+    } else if (s.defined()) {
+        seq.push_back(s);
+    }
+}
+
+// Rename buffers in loads and stores.
+class RenameBuffers : public IRMutator {
+    const map<string, string> &renaming;
+
+    using IRMutator::visit;
+
+    void visit(const Load *op) {
+        IRMutator::visit(op);
+        op = expr.as<Load>();
+        map<string, string>::const_iterator iter = renaming.find(op->name);
+        if (iter != renaming.end()) {
+            expr = Load::make(op->type, iter->second, op->index, op->image, op->param);
+        }
+    }
+
+    void visit(const Store *op) {
+        IRMutator::visit(op);
+        op = stmt.as<Store>();
+        map<string, string>::const_iterator iter = renaming.find(op->name);
+        if (iter != renaming.end()) {
+            stmt = Store::make(iter->second, op->value, op->index);
+        }
+    }
+
+public:
+    RenameBuffers(const map<string, string> &r) : renaming(r) {}
+};
+
+Expr allocation_size(const Allocate *op) {
+    Expr size = 1;
+    for (size_t i = 0; i < op->extents.size(); i++) {
+        size *= op->extents[i];
+    }
+    return simplify(size);
+}
+
+// A buffer that is live from when it's allocated until after the last
+// statement in a sequence that uses it, when inject_early_frees frees
+// it.
+struct LiveRange {
+    int begin, end;
+    Expr bytes;
+};
+
+// The peak total size of a set of buffers that are live over the given
+// ranges of a sequence of statements.
+Expr peak_size(const vector<LiveRange> &ranges) {
+    // The peak is reached just after one of the buffers is allocated.
+    Expr peak = 0;
+    for (size_t i = 0; i < ranges.size(); i++) {
+        Expr live = 0;
+        for (size_t j = 0; j < ranges.size(); j++) {
+            if (ranges[j].begin <= ranges[i].begin &&
+                ranges[i].begin <= ranges[j].end) {
+                live += ranges[j].bytes;
+            }
+        }
+        peak = max(peak, live);
+    }
+    return simplify(peak);
+}
+
+class ReuseAllocations : public IRMutator {
+    using IRMutator::visit;
+
+    // A statement that encloses everything executed after it at the
+    // same loop level: an allocation, a let, the consume side of a
+    // pipeline, or the rest of a block. Storage flattening nests the
+    // allocations of compute_root stages this way, each one inside
+    // the consume side of the pipeline of the one before.
+    struct SpineNode {
+        Stmt node;
+        // The mutated produce and update steps of a pipeline, or the
+        // mutated first statement of a block.
+        Stmt first, second;
+        // The number of statements in the sequence that come before it.
+        int position;
+    };
+
+    // A buffer that may share storage with others.
+    struct Candidate {
+        const Allocate *alloc;
+        // The position of its Allocate node in the spine, and in the
+        // sequence of statements.
+        int depth, position;
+        // The first and last statement in the sequence that use it.
+        int first_use, last_use;
+        // The depth of the deepest let on the spine its size
+        // depends on, or -1 if it doesn't depend on any.
+        int size_depth;
+    };
+
+    // A buffer shared by a set of candidates with disjoint lifetimes.
+    struct Slot {
+        vector<int> members;
+        int last_use;
+        // The member whose Allocate node makes the shared allocation.
+        int owner;
+    };
+
+    // Find the member of a group of candidates whose Allocate node can
+    // make the allocation for all of them: one that comes before all
+    // of their uses, and after the lets that all of their sizes depend
+    // on. Returns -1 if there isn't one.
+    static int find_owner(const vector<Candidate> &candidates, const vector<int> &members) {
+        int first_use = candidates[members[0]].first_use, size_depth = -1;
+        for (size_t i = 0; i < members.size(); i++) {
+            const Candidate &c = candidates[members[i]];
+            first_use = std::min(first_use, c.first_use);
+            size_depth = std::max(size_depth, c.size_depth);
+        }
+        int owner = -1;
+        for (size_t i = 0; i < members.size(); i++) {
+            const Candidate &c = candidates[members[i]];
+            if (c.position <= first_use && c.depth > size_depth &&
+                (owner < 0 || c.depth > candidates[owner].depth)) {
+                owner = members[i];
+            }
+        }
+        return owner;
+    }
+
+    void visit(const Allocate *op) {
+        // Gather the spine of statements beginning with this
+        // allocation, mutating everything hanging off of it, and
+        // flatten the statements in between into a sequence.
+        vector<SpineNode> spine;
+        vector<Stmt> seq;
+        bool changed = false;
+        Stmt s = op;
+        while (s.defined()) {
+            SpineNode n = {s, Stmt(), Stmt(), (int)seq.size()};
+            if (const Allocate *a = s.as<Allocate>()) {
+                s = a->body;
+            } else if (const LetStmt *l = s.as<LetStmt>()) {
+                s = l->body;
+            } else if (const Pipeline *p = s.as<Pipeline>()) {
+                n.first = mutate(p->produce);
+                changed = changed || !n.first.same_as(p->produce);
+                flatten_sequence(n.first, seq);
+                if (p->update.defined()) {
+                    n.second = mutate(p->update);
+                    changed = changed || !n.second.same_as(p->update);
+                    flatten_sequence(n.second, seq);
+                }
+                s = p->consume;
+            } else if (const Block *b = s.as<Block>()) {
+                n.first = mutate(b->first);
+                changed = changed || !n.first.same_as(b->first);
+                flatten_sequence(n.first, seq);
+                s = b->rest;
+            } else {
+                break;
+            }
+            spine.push_back(n);
+        }
+
+        Stmt body;
+        if (s.defined()) {
+            body = mutate(s);
+            changed = changed || !body.same_as(s);
+            flatten_sequence(body, seq);
+        }
+
+        // Find the range of statements over which each allocation
+        // is used.
+        set<string> special;
+        map<string, int> let_depth;
+        for (size_t i = 0; i < spine.size(); i++) {
+            if (const LetStmt *l = spine[i].node.as<LetStmt>()) {
+                FindBufferUses uses;
+                l->value.accept(&uses);
+                special.insert(uses.used.begin(), uses.used.end());
+                special.insert(uses.special.begin(), uses.special.end());
+                // We don't bother tracking which of several lets of
+                // the same name a size refers to, so allocations
+                // whose sizes depend on such a name don't share.
+                let_depth[l->name] = let_depth.count(l->name) ? (int)spine.size() : (int)i;
+            }
+        }
+
+        map<string, int> first_use, last_use;
+        for (size_t i = 0; i < seq.size(); i++) {
+            FindBufferUses uses;
+            seq[i].accept(&uses);
+            special.insert(uses.special.begin(), uses.special.end());
+            for (set<string>::iterator iter = uses.used.begin();
+                 iter != uses.used.end(); ++iter) {
+                if (!first_use.count(*iter)) {
+                    first_use[*iter] = (int)i;
+                }
+                last_use[*iter] = (int)i;
+            }
+        }
+
+        vector<Candidate> candidates;
+        for (size_t i = 0; i < spine.size(); i++) {
+            const Allocate *a = spine[i].node.as<Allocate>();
+            if (!a || !is_one(a->condition) ||
+                special.count(a->name) || !first_use.count(a->name)) {
+                continue;
+            }
+            FindVariables vars;
+            for (size_t j = 0; j < a->extents.size(); j++) {
+                a->extents[j].accept(&vars);
+            }
+            int size_depth = -1;
+            for (set<string>::iterator iter = vars.names.begin();
+                 iter != vars.names.end(); ++iter) {
+                map<string, int>::iterator d = let_depth.find(*iter);
+                if (d != let_depth.end()) {
+                    size_depth = std::max(size_depth, d->second);
+                }
+            }
+            Candidate c = {a, (int)i, spine[i].position,
+                           first_use[a->name], last_use[a->name], size_depth};
+            candidates.push_back(c);
+        }
+
+        // Greedily assign candidates to slots in order of first use,
+        // like a linear scan register allocator.
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const Candidate &a, const Candidate &b) {
+                      return a.first_use < b.first_use;
+                  });
+        vector<Slot> slots;
+        for (size_t i = 0; i < candidates.size(); i++) {
+            const Candidate &c = candidates[i];
+            int best = -1, best_owner = -1;
+            for (size_t j = 0; j < slots.size() && best < 0; j++) {
+                const Candidate &other = candidates[slots[j].members[0]];
+                if (slots[j].last_use < c.first_use &&
+                    other.alloc->type == c.alloc->type) {
+                    vector<int> members = slots[j].members;
+                    members.push_back((int)i);
+                    best_owner = find_owner(candidates, members);
+                    if (best_owner >= 0) {
+                        best = (int)j;
+                    }
+                }
+            }
+            if (best < 0) {
+                Slot slot = {vector<int>(1, (int)i), c.last_use, (int)i};
+                slots.push_back(slot);
+            } else {
+                slots[best].members.push_back((int)i);
+                slots[best].last_use = c.last_use;
+                slots[best].owner = best_owner;
+            }
+        }
+
+        // Each shared slot is allocated by its owner's Allocate node,
+        // and named after it.
+        map<string, string> renaming;
+        map<int, vector<Expr> > new_extents;
+        set<int> removed;
+        vector<LiveRange> ranges_before, ranges_after;
+        for (size_t i = 0; i < slots.size(); i++) {
+            const Slot &slot = slots[i];
+            const Candidate &o = candidates[slot.owner];
+            Expr size;
+            for (size_t j = 0; j < slot.members.size(); j++) {
+                const Candidate &c = candidates[slot.members[j]];
+                Expr this_size = allocation_size(c.alloc);
+                size = size.defined() ? max(size, this_size) : this_size;
+                LiveRange r = {c.position, c.last_use, this_size * c.alloc->type.bytes()};
+                ranges_before.push_back(r);
+            }
+            LiveRange r = {o.position, slot.last_use, size * o.alloc->type.bytes()};
+            ranges_after.push_back(r);
+            if (slot.members.size() == 1) continue;
+
+            new_extents[o.depth] = vec(simplify(size));
+            for (size_t j = 0; j < slot.members.size(); j++) {
+                const Candidate &c = candidates[slot.members[j]];
+                if (slot.members[j] == slot.owner) continue;
+                renaming[c.alloc->name] = o.alloc->name;
+                removed.insert(c.depth);
+            }
+        }
+
+        // A shared slot is as big as its largest member for the
+        // lifetimes of all of them, so sharing can raise the peak
+        // (e.g. if a large buffer shares with a small one while some
+        // other large buffer is live). Don't share if it does.
+        Expr peak_before, peak_after;
+        if (!renaming.empty()) {
+            peak_before = peak_size(ranges_before);
+            peak_after = peak_size(ranges_after);
+        }
+        if (!renaming.empty() && is_one(simplify(peak_before < peak_after))) {
+            debug(3) << "Not sharing storage between the allocations beginning with " << op->name
+                     << ", because it would raise their peak size from " << peak_before
+                     << " bytes to " << peak_after << " bytes\n";
+            renaming.clear();
+            new_extents.clear();
+            removed.clear();
+        }
+
+        if (renaming.empty() && !changed) {
+            stmt = op;
+            return;
+        }
+
+        // Rebuild the spine around the new body.
+        for (size_t i = spine.size(); i > 0; i--) {
+            int idx = (int)i - 1;
+            const SpineNode &n = spine[idx];
+            if (const Allocate *a = n.node.as<Allocate>()) {
+                if (removed.count(idx)) continue;
+                map<int, vector<Expr> >::iterator iter = new_extents.find(idx);
+                const vector<Expr> &extents = (iter == new_extents.end()) ? a->extents : iter->second;
+                body = Allocate::make(a->name, a->type, extents, a->condition, body);
+            } else if (const LetStmt *l = n.node.as<LetStmt>()) {
+                body = LetStmt::make(l->name, l->value, body);
+            } else if (const Pipeline *p = n.node.as<Pipeline>()) {
+                body = Pipeline::make(p->name, n.first, n.second, body);
+            } else {
+                body = Block::make(n.first, body);
+            }
+        }
+
+        if (!renaming.empty()) {
+            for (map<string, string>::iterator iter = renaming.begin();
+                 iter != renaming.end(); ++iter) {
+                debug(3) << "Buffer " << iter->first << " will share storage with "
+                         << iter->second << "\n";
+            }
+            debug(1) << "Sharing storage between the allocations beginning with " << op->name
+                     << " changed their peak size from " << peak_before
+                     << " bytes to " << peak_after << " bytes\n";
+            body = RenameBuffers(renaming).mutate(body);
+        }
+
+        stmt = body;
+    }
+
+    void visit(const For *op) {
+        if (CodeGen_GPU_Dev::is_gpu_var(op->name) ||
+            (op->device_api != DeviceAPI::Host &&
+             op->device_api != DeviceAPI::Parent)) {
+            // Leave allocations in gpu kernels alone.
+            stmt = op;
+        } else {
+            IRMutator::visit(op);
+        }
+    }
+};
+
+}
+
+Stmt reuse_allocations(Stmt s) {
+    return ReuseAllocations().mutate(s);
+}
+
+}
+}
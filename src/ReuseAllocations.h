@@ -0,0 +1,46 @@
+#ifndef HALIDE_REUSE_ALLOCATIONS_H
+#define HALIDE_REUSE_ALLOCATIONS_H
+
+/** \file
+ * Defines the lowering pass that lets allocations with disjoint
+ * lifetimes share storage.
+ */
+
+#include "IR.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Find chains of allocations that are made one inside another
+ * (e.g. the compute_root stages of a pipeline, each of which is
+ * realized inside the consume step of the one before it), work out
+ * which produce and update steps along the chain use each one, and
+ * let allocations of the same type whose ranges of use don't overlap
+ * share a single buffer, sized to fit the largest of them. E.g:
+ *
+ \code
+ allocate f[int32 * 1000]
+ produce f {...}
+ consume {
+   allocate g[int32 * 1000]
+   produce g {... f ...}
+   consume {
+     allocate h[int32 * 1000]
+     produce h {... g ...}
+     consume {... h ...}
+   }
+ }
+ \endcode
+ *
+ * Here f and h can share storage, because f is dead by the time h is
+ * produced. The shared buffer is allocated at the outermost of the
+ * allocations it replaces, so its size may only depend on values
+ * defined outside that point. Allocations referred to through a buffer_t (e.g. because
+ * they're used by an extern stage) are left alone. Should be done
+ * after storage flattening and before early frees are injected. */
+Stmt reuse_allocations(Stmt s);
+
+}
+}
+
+#endif
@@ -16,6 +16,7 @@ struct ScheduleContents {
     std::vector<Dim> dims;
     std::vector<std::string> storage_dims;
     std::vector<Bound> bounds;
+    std::vector<StorageFold> storage_folds;
     std::vector<Specialization> specializations;
     ReductionDomain reduction_domain;
     bool memoized;
@@ -86,6 +87,14 @@ const std::vector<Bound> &Schedule::bounds() const {
     return contents.ptr->bounds;
 }
 
+std::vector<StorageFold> &Schedule::storage_folds() {
+    return contents.ptr->storage_folds;
+}
+
+const std::vector<StorageFold> &Schedule::storage_folds() const {
+    return contents.ptr->storage_folds;
+}
+
 const std::vector<Specialization> &Schedule::specializations() const {
     return contents.ptr->specializations;
 }
@@ -87,6 +87,11 @@ struct Dim {
     ForType for_type;
     DeviceAPI device_api;
     bool pure;
+
+    /** Is this the RVar of an associative update of a single site,
+     * which can be vectorized by reducing across the vector lanes,
+     * even though it isn't pure? */
+    bool associative;
 };
 
 struct Bound {
@@ -94,6 +99,11 @@ struct Bound {
     Expr min, extent;
 };
 
+struct StorageFold {
+    std::string var;
+    Expr extent;
+};
+
 struct ScheduleContents;
 
 struct Specialization {
@@ -171,6 +181,13 @@ public:
     std::vector<Bound> &bounds();
     // @}
 
+    /** You may explicitly request that the storage of some of the
+     * dimensions of a function be folded. See \ref Func::fold_storage */
+    // @{
+    const std::vector<StorageFold> &storage_folds() const;
+    std::vector<StorageFold> &storage_folds();
+    // @}
+
     /** You may create several specialized versions of a func with
      * different schedules. They trigger when the condition is
      * true. See \ref Func::specialize */
@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "ScheduleFunctions.h"
 #include "IROperator.h"
 #include "Simplify.h"
@@ -325,6 +327,209 @@ Stmt build_provide_loop_nest(Function f,
     return stmt;
 }
 
+namespace {
+
+// Make a buffer_t describing the given region of one of the outputs
+// of an extern stage. It points into the realization of the Func, so
+// it has the same strides.
+Expr make_extern_output_buffer(Function f, int j,
+                               const vector<Expr> &mins,
+                               const vector<Expr> &extents) {
+    string stride_name = f.name();
+    if (f.outputs() > 1) {
+        stride_name += ".0";
+    }
+
+    Expr host_ptr = Call::make(f, mins, j);
+    host_ptr = Call::make(Handle(), Call::address_of, vec(host_ptr), Call::Intrinsic);
+
+    vector<Expr> buffer_args(2);
+    buffer_args[0] = host_ptr;
+    buffer_args[1] = f.output_types()[j].bytes();
+    for (int k = 0; k < f.dimensions(); k++) {
+        Expr stride = Variable::make(Int(32), stride_name + ".stride." + int_to_string(k));
+        buffer_args.push_back(mins[k]);
+        buffer_args.push_back(extents[k]);
+        buffer_args.push_back(stride);
+    }
+
+    return Call::make(Handle(), Call::create_buffer_t,
+                      buffer_args, Call::Intrinsic);
+}
+
+// Call the extern function of f with the given input arguments,
+// followed by buffers describing the given region of each of its
+// outputs, and check that it succeeded. If no region is given, use
+// the output buffers already in the symbol table.
+Stmt make_extern_call(Function f, vector<Expr> extern_call_args,
+                      const vector<Expr> &mins,
+                      const vector<Expr> &extents) {
+    const string &extern_name = f.extern_function_name();
+
+    vector<pair<string, Expr>> lets;
+    for (int j = 0; j < f.outputs(); j++) {
+        if (mins.empty()) {
+            string buf_name = f.name();
+            if (f.outputs() > 1) {
+                buf_name += "." + int_to_string(j);
+            }
+            buf_name += ".buffer";
+            extern_call_args.push_back(Variable::make(Handle(), buf_name));
+        } else {
+            string buf_name = f.name() + "." + int_to_string(j) + ".tmp_buffer";
+            extern_call_args.push_back(Variable::make(Handle(), buf_name));
+            lets.push_back(make_pair(buf_name, make_extern_output_buffer(f, j, mins, extents)));
+        }
+    }
+
+    // Make the extern call
+    Expr e = Call::make(Int(32), extern_name,
+                        extern_call_args, Call::Extern);
+    string result_name = unique_name('t');
+    Expr result = Variable::make(Int(32), result_name);
+    // Check if it succeeded
+    Expr error = Call::make(Int(32), "halide_error_extern_stage_failed",
+                            vec<Expr>(extern_name, result), Call::Extern);
+    Stmt check = AssertStmt::make(EQ::make(result, 0), error);
+    check = LetStmt::make(result_name, e, check);
+
+    for (size_t i = 0; i < lets.size(); i++) {
+        check = LetStmt::make(lets[i].first, lets[i].second, check);
+    }
+
+    return check;
+}
+
+// Replace the Provide at the bottom of a loop nest with a given Stmt.
+class ReplaceProvide : public IRMutator {
+    const string &name;
+    Stmt replacement;
+
+    using IRMutator::visit;
+
+    void visit(const Provide *op) {
+        if (op->name == name) {
+            stmt = replacement;
+        } else {
+            stmt = op;
+        }
+    }
+public:
+    ReplaceProvide(const string &n, Stmt r) : name(n), replacement(r) {}
+};
+
+// Build a loop nest over the tiles of an extern stage whose
+// dimensions have been split, which calls the extern function once
+// per tile. The innermost var of each split dimension is traversed
+// by the extern function rather than by a loop, and dimensions that
+// aren't split are passed to it whole.
+Stmt build_extern_tiles(Function f, const vector<Expr> &extern_call_args) {
+    const Schedule &s = f.schedule();
+    string prefix = f.name() + ".s0.";
+
+    user_assert(s.specializations().empty())
+        << "In schedule for extern stage " << f.name() << ": "
+        << "extern stages can't be specialized.\n";
+
+    // Follow each dimension through the splits to find the var the
+    // extern function traverses, and the size of the tiles along it.
+    vector<string> tile_vars(f.dimensions());
+    vector<Expr> tile_factors(f.dimensions());
+    for (int k = 0; k < f.dimensions(); k++) {
+        string v = f.args()[k];
+        for (const Split &split : s.splits()) {
+            if (split.is_fuse()) {
+                user_assert(split.inner != v && split.outer != v)
+                    << "In schedule for extern stage " << f.name() << ": "
+                    << "can't fuse " << v << ", because it is traversed "
+                    << "by the extern function.\n";
+            } else if (split.old_var == v) {
+                if (split.is_split()) {
+                    v = split.inner;
+                    tile_factors[k] = split.factor;
+                } else {
+                    v = split.outer;
+                }
+            }
+        }
+        tile_vars[k] = v;
+    }
+
+    // Make a schedule for the loops over the tiles, which is the
+    // schedule of f without the dimensions traversed by the extern
+    // function.
+    // Vectorizing a split dimension's tile var asks for tiles that
+    // are all exactly the split factor wide.
+    Schedule tiles;
+    tiles.splits() = s.splits();
+    tiles.bounds() = s.bounds();
+    vector<bool> fixed_size(f.dimensions(), false);
+    for (const Dim &d : s.dims()) {
+        size_t k = std::find(tile_vars.begin(), tile_vars.end(), d.var) - tile_vars.begin();
+        if (k < tile_vars.size()) {
+            user_assert(d.for_type == ForType::Serial ||
+                        (d.for_type == ForType::Vectorized && tile_factors[k].defined()))
+                << "In schedule for extern stage " << f.name() << ": "
+                << "can't parallelize or unroll " << d.var
+                << ", because it is traversed by the extern function. "
+                << "It can only be vectorized if it's the inner var of a split.\n";
+            fixed_size[k] = (d.for_type == ForType::Vectorized);
+            continue;
+        }
+        user_assert(d.for_type != ForType::Vectorized &&
+                    (d.device_api == DeviceAPI::Parent || d.device_api == DeviceAPI::Host))
+            << "In schedule for extern stage " << f.name() << ": "
+            << "the loop over " << d.var << " calls an extern function, "
+            << "so it can't be vectorized or run on a device.\n";
+        tiles.dims().push_back(d);
+    }
+
+    // Tiles at the end of a split dimension are clipped to the
+    // region being computed, so that no part of the output is
+    // computed twice. Fixed-size tiles are instead shifted inwards,
+    // as a vectorized loop would be, unless the whole region is
+    // smaller than one tile. Bounds inference redefines the .max of
+    // each dimension inside the loops over the tiles, so use the
+    // .loop_min and .loop_max of the whole region.
+    vector<Expr> site, mins, extents;
+    for (int k = 0; k < f.dimensions(); k++) {
+        Expr min = Variable::make(Int(32), prefix + f.args()[k]);
+        Expr loop_min = Variable::make(Int(32), prefix + f.args()[k] + ".loop_min");
+        Expr max = Variable::make(Int(32), prefix + f.args()[k] + ".loop_max");
+        if (fixed_size[k]) {
+            min = Max::make(Min::make(min, max + 1 - tile_factors[k]), loop_min);
+        }
+        if (tile_factors[k].defined()) {
+            max = Min::make(min + tile_factors[k] - 1, max);
+        }
+        site.push_back(min);
+        mins.push_back(min);
+        extents.push_back(max + 1 - min);
+    }
+
+    vector<Expr> values(f.outputs());
+    for (int j = 0; j < f.outputs(); j++) {
+        values[j] = make_zero(f.output_types()[j]);
+    }
+
+    Stmt call = make_extern_call(f, extern_call_args, mins, extents);
+    Stmt stmt = build_provide_loop_nest(f, prefix, site, values, tiles, true);
+    stmt = ReplaceProvide(f.name(), call).mutate(stmt);
+
+    // Each call starts at the beginning of the tile vars.
+    for (int k = 0; k < f.dimensions(); k++) {
+        Expr start = 0;
+        if (!tile_factors[k].defined()) {
+            start = Variable::make(Int(32), prefix + f.args()[k] + ".min");
+        }
+        stmt = LetStmt::make(prefix + tile_vars[k], start, stmt);
+    }
+
+    return stmt;
+}
+
+}
+
 // Turn a function into a loop nest that computes it. It will
 // refer to external vars of the form function_name.arg_name.min
 // and function_name.arg_name.extent to define the bounds over
@@ -340,10 +545,6 @@ Stmt build_produce(Function f) {
         vector<Expr> extern_call_args;
         const vector<ExternFuncArgument> &args = f.extern_arguments();
 
-        const string &extern_name = f.extern_function_name();
-
-        vector<pair<string, Expr>> lets;
-
         // Iterate through all of the input args to the extern
         // function building a suitable argument list for the
         // extern function call.
@@ -376,78 +577,33 @@ Stmt build_produce(Function f) {
             }
         }
 
+        // If the extern stage has been split into tiles, call it
+        // once per tile.
+        if (!f.schedule().splits().empty()) {
+            return build_extern_tiles(f, extern_call_args);
+        }
+
         // Grab the buffer_ts representing the output. If the store
         // level matches the compute level, then we can use the ones
         // already injected by allocation bounds inference. If it's
         // the output to the pipeline then it will similarly be in the
         // symbol table.
         if (f.schedule().store_level() == f.schedule().compute_level()) {
-            for (int j = 0; j < f.outputs(); j++) {
-                string buf_name = f.name();
-                if (f.outputs() > 1) {
-                    buf_name += "." + int_to_string(j);
-                }
-                buf_name += ".buffer";
-                Expr buffer = Variable::make(Handle(), buf_name);
-                extern_call_args.push_back(buffer);
-            }
+            return make_extern_call(f, extern_call_args, vector<Expr>(), vector<Expr>());
         } else {
             // Store level doesn't match compute level. Make an output
             // buffer just for this subregion.
-            string stride_name = f.name();
-            if (f.outputs() > 1) {
-                stride_name += ".0";
-            }
             string stage_name = f.name() + ".s0.";
-            for (int j = 0; j < f.outputs(); j++) {
-
-                vector<Expr> buffer_args(2);
-
-                vector<Expr> top_left;
-                for (int k = 0; k < f.dimensions(); k++) {
-                    string var = stage_name + f.args()[k];
-                    top_left.push_back(Variable::make(Int(32), var + ".min"));
-                }
-                Expr host_ptr = Call::make(f, top_left, j);
-                host_ptr = Call::make(Handle(), Call::address_of, vec(host_ptr), Call::Intrinsic);
-
-                buffer_args[0] = host_ptr;
-                buffer_args[1] = f.output_types()[j].bytes();
-                for (int k = 0; k < f.dimensions(); k++) {
-                    string var = stage_name + f.args()[k];
-                    Expr min = Variable::make(Int(32), var + ".min");
-                    Expr max = Variable::make(Int(32), var + ".max");
-                    Expr stride = Variable::make(Int(32), stride_name + ".stride." + int_to_string(k));
-                    buffer_args.push_back(min);
-                    buffer_args.push_back(max - min + 1);
-                    buffer_args.push_back(stride);
-                }
-
-                Expr output_buffer_t = Call::make(Handle(), Call::create_buffer_t,
-                                                  buffer_args, Call::Intrinsic);
-
-                string buf_name = f.name() + "." + int_to_string(j) + ".tmp_buffer";
-                extern_call_args.push_back(Variable::make(Handle(), buf_name));
-                lets.push_back(make_pair(buf_name, output_buffer_t));
+            vector<Expr> mins, extents;
+            for (int k = 0; k < f.dimensions(); k++) {
+                string var = stage_name + f.args()[k];
+                Expr min = Variable::make(Int(32), var + ".min");
+                Expr max = Variable::make(Int(32), var + ".max");
+                mins.push_back(min);
+                extents.push_back(max - min + 1);
             }
+            return make_extern_call(f, extern_call_args, mins, extents);
         }
-
-        // Make the extern call
-        Expr e = Call::make(Int(32), extern_name,
-                            extern_call_args, Call::Extern);
-        string result_name = unique_name('t');
-        Expr result = Variable::make(Int(32), result_name);
-        // Check if it succeeded
-        Expr error = Call::make(Int(32), "halide_error_extern_stage_failed",
-                                vec<Expr>(extern_name, result), Call::Extern);
-        Stmt check = AssertStmt::make(EQ::make(result, 0), error);
-        check = LetStmt::make(result_name, e, check);
-
-        for (size_t i = 0; i < lets.size(); i++) {
-            check = LetStmt::make(lets[i].first, lets[i].second, check);
-        }
-
-        return check;
     } else {
 
         string prefix = f.name() + ".s0.";
@@ -589,6 +745,12 @@ bool function_is_used_in_stmt(Function f, Stmt s) {
     return is_called.result;
 }
 
+bool function_is_used_in_expr(Function f, Expr e) {
+    IsUsedInStmt is_called(f);
+    e.accept(&is_called);
+    return is_called.result;
+}
+
 // Inject the allocation and realization of a function into an
 // existing loop nest using its schedule
 class InjectRealization : public IRMutator {
@@ -659,9 +821,14 @@ private:
 
         Stmt body = for_loop->body;
 
-        // Dig through any let statements
+        // Dig through any let statements, stopping at any that use
+        // the function (e.g. a call to an extern stage computed in
+        // tiles), which must go inside the realization.
         vector<pair<string, Expr>> lets;
         while (const LetStmt *l = body.as<LetStmt>()) {
+            if (function_is_used_in_expr(func, l->value)) {
+                break;
+            }
             lets.push_back(make_pair(l->name, l->value));
             body = l->body;
         }
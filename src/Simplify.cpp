@@ -16,6 +16,7 @@
 #include "Substitute.h"
 #include "Bounds.h"
 #include "Deinterleave.h"
+#include "FixedPoint.h"
 
 #ifdef _MSC_VER
 #define snprintf _snprintf
@@ -170,6 +171,14 @@ private:
             expr = IntImm::make((int)f);
         } else if (op->type == Float(32) && const_int(value, &i)) {
             expr = FloatImm::make((float)i);
+        } else if (op->type == Float(32) && cast && cast->type.is_float16() &&
+                   const_float(cast->value, &f)) {
+            // Round a float constant to 16 bits and back.
+            if (cast->type.is_bfloat()) {
+                expr = FloatImm::make(float(bfloat16_t(f)));
+            } else {
+                expr = FloatImm::make(float(float16_t(f)));
+            }
         } else if (cast && op->type.code == cast->type.code && op->type.bits < cast->type.bits) {
             // If this is a cast of a cast of the same type, where the
             // outer cast is narrower, the inner cast can be
@@ -1819,6 +1828,30 @@ private:
         }
     }
 
+    void visit(const VectorReduce *op) {
+        Expr value = mutate(op->value);
+        int factor = value.type().width / op->type.width;
+        const Broadcast *b = value.as<Broadcast>();
+
+        if (factor == 1) {
+            // Nothing to reduce.
+            expr = value;
+        } else if (b && op->op != VectorReduce::Add && op->op != VectorReduce::Mul) {
+            // Reducing identical lanes with an idempotent operator.
+            expr = b->value;
+        } else if (b && op->op == VectorReduce::Add) {
+            expr = mutate(b->value * make_const(b->value.type(), factor));
+        } else if (value.same_as(op->value)) {
+            expr = op;
+        } else {
+            expr = VectorReduce::make(op->op, value, op->type.width);
+        }
+
+        if (b && !expr.same_as(op) && expr.type().width != op->type.width) {
+            expr = Broadcast::make(expr, op->type.width);
+        }
+    }
+
     void visit(const IfThenElse *op) {
         Expr condition = mutate(op->condition);
 
@@ -1975,7 +2008,10 @@ private:
                     ib = -ib;
                 }
 
-                if (ib < std::min(t.bits, 32)) {
+                // 1 << (bits - 1) isn't representable in a signed
+                // type, so dividing by it isn't the same as shifting.
+                int max_shift = t.is_int() ? t.bits - 1 : t.bits;
+                if (ib < std::min(max_shift, 32)) {
                     ib = 1 << ib;
                     b = make_const(t, ib);
 
@@ -2006,7 +2042,7 @@ private:
             if (const_castint(b, &ib) &&
                 ((ib < b.type().imax()) && (ib < std::numeric_limits<int>::max()) &&
                  is_const_power_of_two(ib + 1, &bits))) {
-                  expr = Mod::make(a, ib + 1);
+                  expr = Mod::make(a, make_const(a.type(), ib + 1));
             } else  if (a.same_as(op->args[0]) && b.same_as(op->args[1])) {
                 expr = op;
             } else {
@@ -2031,6 +2067,24 @@ private:
             } else {
                 expr = abs(a);
             }
+        } else if (is_fixed_point_intrinsic(op)) {
+            // Constant-fold fixed-point arithmetic.
+            std::vector<Expr> new_args(op->args.size());
+            bool changed = false, all_const = true;
+            for (size_t i = 0; i < op->args.size(); i++) {
+                new_args[i] = mutate(op->args[i]);
+                changed = changed || !new_args[i].same_as(op->args[i]);
+                all_const = all_const && is_const(new_args[i]);
+            }
+            Expr call = op;
+            if (changed) {
+                call = Call::make(op->type, op->name, new_args, op->call_type);
+            }
+            if (all_const) {
+                expr = mutate(lower_fixed_point_intrinsic(call.as<Call>()));
+            } else {
+                expr = call;
+            }
         } else if (op->call_type == Call::Extern &&
                    op->name == "is_nan_f32") {
             Expr arg = mutate(op->args[0]);
@@ -2814,6 +2868,10 @@ void simplify_test() {
     check(Cast::make(Int(16), x) << -10, Cast::make(Int(16), x) / 1024);
     // Correctly triggers a warning:
     //check(Cast::make(Int(16), x) << 20, Cast::make(Int(16), x) << 20);
+    // Dividing by -2^15 would round the wrong way:
+    //check(Cast::make(Int(16), x) >> 15, Cast::make(Int(16), x) >> 15);
+    check(Cast::make(UInt(16), x) >> 15, Cast::make(UInt(16), x) / 32768);
+    check(Cast::make(UInt(16), x) & Cast::make(UInt(16), 1), Cast::make(UInt(16), x) % 2);
 
     // Check that chains of widening casts don't lose the distinction
     // between zero-extending and sign-extending.
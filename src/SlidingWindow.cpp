@@ -8,6 +8,8 @@
 #include "Simplify.h"
 #include "Derivative.h"
 #include "Bounds.h"
+#include "CodeGen_GPU_Dev.h"
+#include "ParallelTasks.h"
 
 namespace Halide {
 namespace Internal {
@@ -323,6 +325,138 @@ public:
     SlidingWindowOnFunction(Function f) : func(f) {}
 };
 
+namespace {
+
+// Does a statement contain the computation of a function?
+class ContainsPipeline : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const Pipeline *op) {
+        if (op->name == func) {
+            result = true;
+        } else {
+            IRVisitor::visit(op);
+        }
+    }
+
+public:
+    string func;
+    bool result;
+    ContainsPipeline(string f) : func(f), result(false) {}
+};
+
+bool contains_pipeline(Stmt s, string func) {
+    ContainsPipeline c(func);
+    s.accept(&c);
+    return c.result;
+}
+
+// Is a function computed or used anywhere outside of a given loop?
+class UsedOutsideLoop : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const For *op) {
+        if (op != loop) {
+            IRVisitor::visit(op);
+        }
+    }
+
+    void visit(const Pipeline *op) {
+        if (op->name == func) {
+            result = true;
+        } else {
+            IRVisitor::visit(op);
+        }
+    }
+
+    void visit(const Call *op) {
+        if (op->name == func) {
+            result = true;
+        } else {
+            IRVisitor::visit(op);
+        }
+    }
+
+    void visit(const Provide *op) {
+        if (op->name == func) {
+            result = true;
+        } else {
+            IRVisitor::visit(op);
+        }
+    }
+
+public:
+    string func;
+    const For *loop;
+    bool result;
+    UsedOutsideLoop(string f, const For *l) : func(f), loop(l), result(false) {}
+};
+
+}
+
+// If a function is stored outside a parallel loop but computed
+// inside it, then it can't slide along that loop, because adjacent
+// iterations may run on different threads. Instead, split the loop
+// into a parallel loop over strips and a serial loop within each
+// strip, and move the storage inside the parallel loop, so that each
+// strip warms up and then slides its own window. Only done if the
+// sliding window would then actually apply.
+class SinkRealizeIntoParallelStrips : public IRMutator {
+    const Realize *realize;
+    Function func;
+
+    using IRMutator::visit;
+
+    void visit(const For *op) {
+        if (sunk) {
+            stmt = op;
+            return;
+        }
+
+        if (op->for_type != ForType::Parallel ||
+            CodeGen_GPU_Dev::is_gpu_var(op->name) ||
+            (op->device_api != DeviceAPI::Host &&
+             op->device_api != DeviceAPI::Parent) ||
+            !contains_pipeline(op->body, func.name())) {
+            IRMutator::visit(op);
+            return;
+        }
+
+        UsedOutsideLoop outside(func.name(), op);
+        realize->body.accept(&outside);
+        if (outside.result) {
+            debug(3) << "Not splitting " << op->name << " into strips for sliding "
+                     << func.name() << " because it is used outside of the loop\n";
+            stmt = op;
+            return;
+        }
+
+        ParallelTasks strips(op, "strip");
+        Stmt inner = For::make(op->name, strips.inner_min, strips.inner_extent, ForType::Serial, op->device_api, op->body);
+
+        // Check the function would actually slide along the serial loop.
+        Stmt slid = SlidingWindowOnFunctionAndLoop(func, op->name, strips.inner_min).mutate(op->body);
+        if (slid.same_as(op->body)) {
+            debug(3) << "Not splitting " << op->name << " into strips because "
+                     << func.name() << " would not slide along it\n";
+            stmt = op;
+            return;
+        }
+
+        debug(3) << "Splitting " << op->name << " into parallel strips to slide "
+                 << func.name() << " within each strip\n";
+
+        Stmt body = Realize::make(realize->name, realize->types, realize->bounds, realize->condition, inner);
+        stmt = strips.wrap(body);
+        sunk = true;
+    }
+
+public:
+    bool sunk;
+
+    SinkRealizeIntoParallelStrips(const Realize *r, Function f) : realize(r), func(f), sunk(false) {}
+};
+
 // Perform sliding window optimization for all functions
 class SlidingWindow : public IRMutator {
     const map<string, Function> &env;
@@ -348,6 +482,15 @@ class SlidingWindow : public IRMutator {
             return;
         }
 
+        // If the function is computed within a parallel loop inside
+        // its storage, move the storage inside strips of that loop.
+        SinkRealizeIntoParallelStrips sinker(op, iter->second);
+        Stmt sunk = sinker.mutate(op->body);
+        if (sinker.sunk) {
+            stmt = mutate(sunk);
+            return;
+        }
+
         Stmt new_body = op->body;
 
         debug(3) << "Doing sliding window analysis on realization of " << op->name << "\n";
@@ -269,6 +269,17 @@ private:
         stream << matched(")");
         stream << close_span();
     }
+    void visit(const VectorReduce *op) {
+        stream << open_span("VectorReduce");
+        stream << open_span("Matched");
+        std::ostringstream name;
+        name << "vector_reduce_" << op->op;
+        stream << symbol(name.str()) << "(";
+        stream << close_span();
+        print(op->value);
+        stream << matched(")");
+        stream << close_span();
+    }
     void visit(const Call *op) {
         stream << open_span("Call");
         if (op->call_type == Call::Intrinsic) {
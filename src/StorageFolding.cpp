@@ -6,6 +6,8 @@
 #include "IRPrinter.h"
 #include "Debug.h"
 #include "Derivative.h"
+#include "ExprUsesVar.h"
+#include "IREquality.h"
 
 namespace Halide {
 namespace Internal {
@@ -14,12 +16,87 @@ using std::string;
 using std::vector;
 using std::map;
 
+namespace {
+
+// Round a positive integer expression up to the next power of two,
+// by smearing the high bit of (e - 1) down and adding one.
+Expr round_up_to_power_of_two(Expr e) {
+    if (const IntImm *i = e.as<IntImm>()) {
+        int factor = 1;
+        while (factor < i->value) factor *= 2;
+        return factor;
+    }
+    Expr v = e - 1;
+    for (int shift = 1; shift < 32; shift *= 2) {
+        v = v | (v >> shift);
+    }
+    return simplify(v + 1);
+}
+
+
+// If e is the loop variable plus something that doesn't depend on
+// it, return that something. Otherwise return an undefined Expr. The
+// bounds of the region used by a loop iteration are usually of this
+// form (e.g. min(y, y + k)), and peeling the loop variable off the
+// min and max gives an extent the simplifier can see doesn't depend
+// on the loop variable.
+Expr offset_from_loop_var(Expr e, const string &var) {
+    if (const Variable *v = e.as<Variable>()) {
+        if (v->name == var) {
+            return make_zero(e.type());
+        }
+    } else if (const Add *add = e.as<Add>()) {
+        Expr a = offset_from_loop_var(add->a, var);
+        if (a.defined() && !expr_uses_var(add->b, var)) {
+            return a + add->b;
+        }
+        Expr b = offset_from_loop_var(add->b, var);
+        if (b.defined() && !expr_uses_var(add->a, var)) {
+            return add->a + b;
+        }
+    } else if (const Sub *sub = e.as<Sub>()) {
+        Expr a = offset_from_loop_var(sub->a, var);
+        if (a.defined() && !expr_uses_var(sub->b, var)) {
+            return a - sub->b;
+        }
+    } else if (const Min *m = e.as<Min>()) {
+        Expr a = offset_from_loop_var(m->a, var);
+        Expr b = offset_from_loop_var(m->b, var);
+        if (a.defined() && b.defined()) {
+            return min(a, b);
+        }
+    } else if (const Max *m = e.as<Max>()) {
+        Expr a = offset_from_loop_var(m->a, var);
+        Expr b = offset_from_loop_var(m->b, var);
+        if (a.defined() && b.defined()) {
+            return max(a, b);
+        }
+    }
+    return Expr();
+}
+
+}
+
 // Fold the storage of a function in a particular dimension by a particular factor
 class FoldStorageOfFunction : public IRMutator {
     string func;
     int dim;
     Expr factor;
 
+    // Factors are always powers of two. Constant ones are
+    // handled by the regular modulus (which codegen turns into a
+    // mask). For symbolic ones we know something the rest of the
+    // compiler doesn't, so we emit the mask directly.
+    Expr fold_index(Expr arg) {
+        if (is_one(factor)) {
+            return 0;
+        } else if (is_const(factor)) {
+            return arg % factor;
+        } else {
+            return arg & (factor - 1);
+        }
+    }
+
     using IRMutator::visit;
 
     void visit(const Call *op) {
@@ -29,7 +106,7 @@ class FoldStorageOfFunction : public IRMutator {
         if (op->name == func && op->call_type == Call::Halide) {
             vector<Expr> args = op->args;
             internal_assert(dim < (int)args.size());
-            args[dim] = is_one(factor) ? 0 : (args[dim] % factor);
+            args[dim] = fold_index(args[dim]);
             expr = Call::make(op->type, op->name, args, op->call_type,
                               op->func, op->value_index, op->image, op->param);
         }
@@ -41,7 +118,7 @@ class FoldStorageOfFunction : public IRMutator {
         internal_assert(op);
         if (op->name == func) {
             vector<Expr> args = op->args;
-            args[dim] = is_one(factor) ? 0 : (args[dim] % factor);
+            args[dim] = fold_index(args[dim]);
             stmt = Provide::make(op->name, op->values, args);
         }
     }
@@ -55,6 +132,14 @@ public:
 class AttemptStorageFoldingOfFunction : public IRMutator {
     string func;
 
+    // Fold factors requested explicitly via Func::fold_storage, one
+    // per dimension. Undefined for dimensions with no request.
+    vector<Expr> explicit_factors;
+
+    // Names defined inside the realization of the function. Folding
+    // factors used for the allocation can't depend on these.
+    Scope<int> defined_inside;
+
     using IRMutator::visit;
 
     void visit(const Pipeline *op) {
@@ -66,6 +151,12 @@ class AttemptStorageFoldingOfFunction : public IRMutator {
         }
     }
 
+    void visit(const LetStmt *op) {
+        defined_inside.push(op->name, 0);
+        IRMutator::visit(op);
+        defined_inside.pop(op->name);
+    }
+
     void visit(const For *op) {
         if (op->for_type != ForType::Serial && op->for_type != ForType::Unrolled) {
             // We can't proceed into a parallel for loop.
@@ -82,10 +173,18 @@ class AttemptStorageFoldingOfFunction : public IRMutator {
 
         Stmt result = op;
 
+        // Checks that explicit fold factors are large enough. These
+        // go at the top of the loop body.
+        vector<Stmt> checks;
+
         // Try each dimension in turn from outermost in
         for (size_t i = box.size(); i > 0; i--) {
             Expr min = simplify(box[i-1].min);
             Expr max = simplify(box[i-1].max);
+            Expr explicit_factor;
+            if (i - 1 < explicit_factors.size()) {
+                explicit_factor = explicit_factors[i-1];
+            }
 
             debug(3) << "\nConsidering folding " << func << " over for loop over " << op->name << '\n'
                      << "Min: " << min << '\n'
@@ -96,28 +195,85 @@ class AttemptStorageFoldingOfFunction : public IRMutator {
             if (is_monotonic(min, op->name) == MonotonicIncreasing ||
                 is_monotonic(max, op->name) == MonotonicDecreasing) {
 
-                // The max of the extent over all values of the loop variable must be a constant
+                // The max of the extent over all values of the loop
+                // variable must be a constant, or at least
+                // computable outside the realization.
                 Expr extent = simplify(max - min);
-                Scope<Interval> scope;
-                scope.push(op->name, Interval(Variable::make(Int(32), op->name + ".loop_min"),
-                                              Variable::make(Int(32), op->name + ".loop_max")));
-                Expr max_extent = bounds_of_expr_in_scope(extent, scope).max;
-                scope.pop(op->name);
+                Expr max_extent;
+                Expr min_offset = offset_from_loop_var(min, op->name);
+                Expr max_offset = offset_from_loop_var(max, op->name);
+                if (min_offset.defined() && max_offset.defined()) {
+                    // The extent is the same on every iteration.
+                    max_extent = max_offset - min_offset;
+                } else {
+                    Scope<Interval> scope;
+                    scope.push(op->name, Interval(Variable::make(Int(32), op->name + ".loop_min"),
+                                                  Variable::make(Int(32), op->name + ".loop_max")));
+                    max_extent = bounds_of_expr_in_scope(extent, scope).max;
+                    scope.pop(op->name);
+                }
 
-                max_extent = simplify(max_extent);
+                if (max_extent.defined()) {
+                    max_extent = simplify(max_extent);
+                }
 
-                const IntImm *max_extent_int = max_extent.as<IntImm>();
-                if (max_extent_int) {
+                Expr factor;
+                bool check_factor = false;
+                if (explicit_factor.defined() && max_extent.defined() &&
+                    is_zero(simplify(max_extent < round_up_to_power_of_two(explicit_factor)))) {
+                    // The requested factor is never large enough,
+                    // so folding by it would always fail at runtime.
+                    TooSmall t = {(int)i - 1, round_up_to_power_of_two(explicit_factor),
+                                  simplify(max_extent + 1), op->name};
+                    explicit_too_small.push_back(t);
+                    debug(3) << "Not folding because explicit factor " << t.factor
+                             << " is less than the max extent " << t.max_extent << "\n";
+                } else if (explicit_factor.defined()) {
+                    factor = round_up_to_power_of_two(explicit_factor);
+                    debug(3) << "Proceeding with explicit factor " << factor << "\n";
+
+                    // We may not be able to prove the requested
+                    // factor is large enough. If not, check it at
+                    // runtime on each iteration.
+                    check_factor = !max_extent.defined() || !is_one(simplify(max_extent < factor));
+                } else if (const IntImm *max_extent_int = max_extent.as<IntImm>()) {
                     int extent = max_extent_int->value;
 
-                    int factor = 1;
-                    while (factor <= extent) factor *= 2;
+                    int f = 1;
+                    while (f <= extent) f *= 2;
+                    factor = f;
 
                     debug(3) << "Proceeding with factor " << factor << "\n";
+                } else if (max_extent.defined() && !expr_uses_vars(max_extent, defined_inside)) {
+                    // The extent isn't constant, but it's bounded by
+                    // something we can compute before allocating
+                    // (e.g. it depends on a parameter).
+                    factor = round_up_to_power_of_two(max_extent + 1);
+
+                    debug(3) << "Proceeding with symbolic factor " << factor << "\n";
+                } else {
+                    debug(3) << "Not folding because extent not bounded by a constant\n"
+                             << "extent = " << extent << "\n"
+                             << "max extent = " << max_extent << "\n";
+                }
 
-                    Fold fold = {(int)i - 1, factor};
+                if (factor.defined()) {
+                    // Symbolic factors are computed once, outside the
+                    // realization, rather than in every folded index.
+                    Expr fold_factor = factor;
+                    if (!is_const(factor)) {
+                        fold_factor = Variable::make(Int(32), func + ".fold_factor." + int_to_string((int)i - 1));
+                    }
+                    Fold fold = {(int)i - 1, factor, fold_factor};
                     dims_folded.push_back(fold);
-                    result = FoldStorageOfFunction(func, (int)i - 1, factor).mutate(result);
+                    result = FoldStorageOfFunction(func, (int)i - 1, fold_factor).mutate(result);
+
+                    if (check_factor) {
+                        Expr error = Call::make(Int(32), "halide_error_fold_factor_too_small",
+                                                vec<Expr>(func, (int)i - 1, fold_factor, op->name, extent + 1),
+                                                Call::Extern);
+                        checks.push_back(AssertStmt::make(extent < fold_factor, error));
+                    }
 
                     Expr step = finite_difference(min, op->name);
 
@@ -127,14 +283,9 @@ class AttemptStorageFoldingOfFunction : public IRMutator {
                         // for further folding opportinities
                         // recursively.
                     } else {
-                        stmt = result;
+                        stmt = add_checks(result, checks);
                         return;
                     }
-
-                } else {
-                    debug(3) << "Not folding because extent not bounded by a constant\n"
-                             << "extent = " << extent << "\n"
-                             << "max extent = " << max_extent << "\n";
                 }
             } else {
                 debug(3) << "Not folding because loop min or max not monotonic in the loop variable\n"
@@ -145,7 +296,9 @@ class AttemptStorageFoldingOfFunction : public IRMutator {
 
         // Any folds that took place folded dimensions away entirely, so we can proceed recursively.
         if (const For *f = result.as<For>()) {
+            defined_inside.push(op->name, 0);
             Stmt body = mutate(f->body);
+            defined_inside.pop(op->name);
             if (body.same_as(f->body)) {
                 stmt = result;
             } else {
@@ -155,21 +308,47 @@ class AttemptStorageFoldingOfFunction : public IRMutator {
             stmt = result;
         }
 
+        stmt = add_checks(stmt, checks);
+    }
+
+    Stmt add_checks(Stmt s, const vector<Stmt> &checks) {
+        if (checks.empty()) {
+            return s;
+        }
+        const For *loop = s.as<For>();
+        internal_assert(loop);
+        Stmt body = loop->body;
+        for (size_t i = 0; i < checks.size(); i++) {
+            body = Block::make(checks[i], body);
+        }
+        return For::make(loop->name, loop->min, loop->extent, loop->for_type, loop->device_api, body);
     }
 
 public:
+    // The factor of each fold, and what the folded indices refer to
+    // it by: the factor itself if it's constant, and otherwise a
+    // variable that must be defined outside the realization.
     struct Fold {
         int dim;
-        Expr factor;
+        Expr factor, var;
     };
     vector<Fold> dims_folded;
 
-    AttemptStorageFoldingOfFunction(string f) : func(f) {}
+    // Explicit fold factors that were provably too small for the
+    // region used by each iteration of a loop.
+    struct TooSmall {
+        int dim;
+        Expr factor, max_extent;
+        string loop;
+    };
+    vector<TooSmall> explicit_too_small;
+
+    AttemptStorageFoldingOfFunction(string f, const vector<Expr> &e) : func(f), explicit_factors(e) {}
 };
 
 /** Check if a buffer's allocated is referred to directly via an
- * intrinsic. If so we should leave it alone. (e.g. it may be used
- * extern). */
+ * intrinsic, or its buffer_t is passed to an extern stage. If so we
+ * should leave it alone. */
 class IsBufferSpecial : public IRVisitor {
 public:
     string func;
@@ -181,26 +360,62 @@ private:
     using IRVisitor::visit;
 
     void visit(const Call *call) {
+        IRVisitor::visit(call);
         if (call->call_type == Call::Intrinsic &&
             call->name == func) {
             special = true;
         }
     }
+
+    void visit(const Variable *var) {
+        // The buffer_t of the function (or of one of its outputs) is
+        // named e.g. f.buffer or f.1.buffer.
+        if (var->type.is_handle() &&
+            starts_with(var->name, func + ".") &&
+            ends_with(var->name, ".buffer")) {
+            special = true;
+        }
+    }
 };
 
 // Look for opportunities for storage folding in a statement
 class StorageFolding : public IRMutator {
+    const map<string, Function> &env;
+
     using IRMutator::visit;
 
     void visit(const Realize *op) {
         Stmt body = mutate(op->body);
 
-        AttemptStorageFoldingOfFunction folder(op->name);
+        // Gather any explicitly requested fold factors.
+        vector<Expr> explicit_factors;
+        map<string, Function>::const_iterator iter = env.find(op->name);
+        if (iter != env.end()) {
+            const Function &f = iter->second;
+            const vector<StorageFold> &folds = f.schedule().storage_folds();
+            explicit_factors.resize(f.args().size());
+            for (size_t i = 0; i < folds.size(); i++) {
+                for (size_t j = 0; j < f.args().size(); j++) {
+                    if (f.args()[j] == folds[i].var) {
+                        explicit_factors[j] = folds[i].extent;
+                    }
+                }
+            }
+        }
+
+        AttemptStorageFoldingOfFunction folder(op->name, explicit_factors);
         IsBufferSpecial special(op->name);
         op->accept(&special);
 
         if (special.special) {
             debug(3) << "Not attempting to fold " << op->name << " because it is referenced by an intrinsic\n";
+            for (size_t i = 0; i < explicit_factors.size(); i++) {
+                user_assert(!explicit_factors[i].defined())
+                    << "Can't fold the storage of " << op->name
+                    << " in dimension " << env.find(op->name)->second.args()[i]
+                    << ", because its buffer is passed directly to an extern stage,"
+                    << " which can't index a folded buffer.\n";
+            }
             if (body.same_as(op->body)) {
                 stmt = op;
             } else {
@@ -219,7 +434,7 @@ class StorageFolding : public IRMutator {
 
                 for (size_t i = 0; i < folder.dims_folded.size(); i++) {
                     int d = folder.dims_folded[i].dim;
-                    Expr f = folder.dims_folded[i].factor;
+                    Expr f = folder.dims_folded[i].var;
                     internal_assert(d >= 0 &&
                                     d < (int)bounds.size());
 
@@ -227,9 +442,46 @@ class StorageFolding : public IRMutator {
                 }
 
                 stmt = Realize::make(op->name, op->types, bounds, op->condition, new_body);
+
+                for (size_t i = 0; i < folder.dims_folded.size(); i++) {
+                    const AttemptStorageFoldingOfFunction::Fold &fold = folder.dims_folded[i];
+                    if (const Variable *v = fold.var.as<Variable>()) {
+                        stmt = LetStmt::make(v->name, fold.factor, stmt);
+                    }
+                }
             }
         }
+
+        // Complain about any explicit folds we failed to perform.
+        for (size_t i = 0; i < explicit_factors.size(); i++) {
+            if (!explicit_factors[i].defined()) continue;
+            bool folded = false;
+            for (size_t j = 0; j < folder.dims_folded.size(); j++) {
+                folded = folded || (folder.dims_folded[j].dim == (int)i);
+            }
+            if (folded) continue;
+            const string &dim = env.find(op->name)->second.args()[i];
+            for (size_t j = 0; j < folder.explicit_too_small.size(); j++) {
+                const AttemptStorageFoldingOfFunction::TooSmall &t = folder.explicit_too_small[j];
+                user_assert(t.dim != (int)i)
+                    << "Can't fold the storage of " << op->name
+                    << " in dimension " << dim
+                    << " by " << explicit_factors[i]
+                    << (equal(t.factor, explicit_factors[i]) ? "" : " (rounded up to a power of two)")
+                    << ", because up to " << t.max_extent
+                    << " values of it are used in each iteration of the loop over "
+                    << t.loop << ".\n";
+            }
+            user_error
+                << "Can't fold the storage of " << op->name
+                << " in dimension " << dim
+                << ", because the region of it used is not monotonic in any"
+                << " serial loop between its store_at and compute_at levels.\n";
+        }
     }
+
+public:
+    StorageFolding(const map<string, Function> &e) : env(e) {}
 };
 
 // Because storage folding runs before simplification, it's useful to
@@ -266,9 +518,9 @@ class SubstituteInConstants : public IRMutator {
     }
 };
 
-Stmt storage_folding(Stmt s) {
+Stmt storage_folding(Stmt s, const map<string, Function> &env) {
     s = SubstituteInConstants().mutate(s);
-    s = StorageFolding().mutate(s);
+    s = StorageFolding(env).mutate(s);
     return s;
 }
 
@@ -6,7 +6,10 @@
  * down to smaller circular buffers when possible
  */
 
+#include <map>
+
 #include "IR.h"
+#include "Function.h"
 
 namespace Halide {
 namespace Internal {
@@ -23,8 +26,13 @@ namespace Internal {
  *
  * We can store f as a circular buffer of size two, instead of
  * allocating space for all of it.
+ *
+ * The fold factor is always a power of two. It may be symbolic if the
+ * extent of the region used in each iteration is bounded by something
+ * that can be computed before the allocation (e.g. a parameter), or
+ * if it was set explicitly with Func::fold_storage.
  */
-Stmt storage_folding(Stmt s);
+Stmt storage_folding(Stmt s, const std::map<std::string, Function> &env);
 
 }
 }
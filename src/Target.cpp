@@ -302,6 +302,14 @@ bool Target::merge_string(const std::string &target) {
             set_features(vec(Target::F16C, Target::SSE41, Target::AVX));
         } else if (tok == "matlab") {
             set_feature(Target::Matlab);
+        } else if (tok == "no_vector_extensions") {
+            set_feature(Target::NoVectorExtensions);
+        } else if (tok == "precise_bounds") {
+            set_feature(Target::PreciseBounds);
+        } else if (tok == "no_runtime") {
+            set_feature(Target::NoRuntime);
+        } else if (tok == "prepare_run") {
+            set_feature(Target::PrepareRun);
         } else {
             return false;
         }
@@ -362,7 +370,11 @@ std::string Target::to_string() const {
       "opengl",
       "user_context",
       "register_metadata",
-      "matlab"
+      "matlab",
+      "no_vector_extensions",
+      "precise_bounds",
+      "no_runtime",
+      "prepare_run"
   };
   internal_assert(sizeof(feature_names) / sizeof(feature_names[0]) == FeatureEnd);
   string result = string(arch_names[arch])
@@ -36,6 +36,8 @@ struct Target {
         NoAsserts,  ///< Disable all runtime checks, for slightly tighter code.
         NoBoundsQuery, ///< Disable the bounds querying functionality.
 
+        // NOTE: The indices of the x86 features below are mirrored in
+        // src/runtime/x86_cpu_features.cpp.
         SSE41,  ///< Use SSE 4.1 and earlier instructions. Only relevant on x86.
         AVX,  ///< Use AVX 1 instructions. Only relevant on x86.
         AVX2,  ///< Use AVX 2 instructions. Only relevant on x86.
@@ -63,6 +65,14 @@ struct Target {
 
         Matlab,  ///< Generate a mexFunction compatible with Matlab mex libraries. See tools/mex_halide.m.
 
+        NoVectorExtensions,  ///< Emit vectors in C output as arrays processed a lane at a time, rather than using GCC/clang vector extensions.
+
+        PreciseBounds,  ///< Use slower but more precise bounds inference, which understands correlated affine terms and selects. Footprints that couple dimensions are still bounded by a box.
+
+        NoRuntime,  ///< Do not include a copy of the Halide runtime in generated code, only the helpers that get inlined. The runtime must come from another object.
+
+        PrepareRun,  ///< Also generate a foo_prepared entry point for halide_prepare_pipeline, which skips the argument checks and reuses intermediates across calls with the same shapes.
+
         FeatureEnd
         // NOTE: Changes to this enum must be reflected in the definition of
         // to_string()!
@@ -47,6 +47,10 @@ Halide::Expr Type::max() const {
         return imax(); // No explicit cast of scalar i32.
     } else if ((is_int() || is_uint()) && bits <= 32) {
         return Internal::Cast::make(*this, imax());
+    } else if (is_float16()) {
+        // The largest finite value.
+        float val = is_bfloat() ? float(bfloat16_t::make_from_bits(0x7f7f)) : 65504.0f;
+        return Internal::Cast::make(*this, val);
     } else {
         // Use a run-time call to a math intrinsic (see posix_math.cpp)
         ostringstream ss;
@@ -91,6 +95,10 @@ Expr Type::min() const {
         return imin(); // No explicit cast of scalar i32.
     } else if ((is_int() || is_uint()) && bits <= 32) {
         return Internal::Cast::make(*this, imin());
+    } else if (is_float16()) {
+        // The most negative finite value.
+        float val = is_bfloat() ? float(bfloat16_t::make_from_bits(0xff7f)) : -65504.0f;
+        return Internal::Cast::make(*this, val);
     } else {
         // Use a run-time call to a math intrinsic (see posix_math.cpp)
         ostringstream ss;
@@ -111,7 +119,13 @@ bool Type::can_represent(Type other) const {
                 (other.is_uint() && other.bits < bits));
     } else if (is_uint()) {
         return other.is_uint() && other.bits <= bits;
+    } else if (is_bfloat()) {
+        // A bfloat has eight bits of precision.
+        return other.is_bfloat() || (!other.is_float() && other.bits <= 8);
     } else if (is_float()) {
+        if (other.is_bfloat()) {
+            return bits > 16;
+        }
         return ((other.is_float() && other.bits <= bits) ||
                 (bits == 64 && other.bits <= 32) ||
                 (bits == 32 && other.bits <= 16));
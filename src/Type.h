@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include "runtime/HalideRuntime.h"
 #include "Util.h"
+#include "Float16.h"
 
 /** \file
  * Defines halide types
@@ -14,12 +15,13 @@ namespace Halide {
 struct Expr;
 
 /** Types in the halide type system. They can be ints, unsigned ints,
- * or floats of various bit-widths (the 'bits' field). They can also
+ * or floats of various bit-widths (the 'bits' field), or bfloats. They can also
  * be vectors of the same (by setting the 'width' field to something
  * larger than one). Front-end code shouldn't use vector
  * types. Instead vectorize a function. */
 struct Type {
-    /** The basic type code: signed integer, unsigned integer, or floating point.
+    /** The basic type code: signed integer, unsigned integer, floating
+     * point, or brain floating point.
      *
      * Note that TypeCode is guaranteed to have values identical to those of
      * halide_type_code_t (HalideRuntime.h), but exists as a separate typedef
@@ -29,7 +31,8 @@ struct Type {
         Int = halide_type_int,
         UInt = halide_type_uint,
         Float = halide_type_float,
-        Handle = halide_type_handle
+        Handle = halide_type_handle,
+        BFloat = halide_type_bfloat
     } code;
 
     /** The number of bits of precision of a single scalar value of this type. */
@@ -64,8 +67,18 @@ struct Type {
     /** Is this type a scalar type? (width == 1) */
     bool is_scalar() const {return width == 1;}
 
-    /** Is this type a floating point type (float or double). */
-    bool is_float() const {return code == Float;}
+    /** Is this type a floating point type (half, float, double, or
+     * bfloat). */
+    bool is_float() const {return code == Float || code == BFloat;}
+
+    /** Is this type a brain floating point type? */
+    bool is_bfloat() const {return code == BFloat;}
+
+    /** Is this a 16-bit floating point type (half or bfloat)? Values
+     * of these types can only be loaded, stored, and converted to and
+     * from other types. All arithmetic on them is done in 32-bit
+     * float. */
+    bool is_float16() const {return is_float() && bits == 16;}
 
     /** Is this type a signed integer type? */
     bool is_int() const {return code == Int;}
@@ -139,6 +152,16 @@ inline Type Float(int bits, int width = 1) {
     return t;
 }
 
+/** Construct a brain floating-point type. The only supported width
+ * is 16 bits. */
+inline Type BFloat(int bits, int width = 1) {
+    Type t;
+    t.code = Type::BFloat;
+    t.bits = bits;
+    t.width = width;
+    return t;
+}
+
 /** Construct a boolean type */
 inline Type Bool(int width = 1) {
     return UInt(1, width);
@@ -174,6 +197,16 @@ struct type_of_helper<double> {
     operator Type() {return Float(64);}
 };
 
+template<>
+struct type_of_helper<float16_t> {
+    operator Type() {return Float(16);}
+};
+
+template<>
+struct type_of_helper<bfloat16_t> {
+    operator Type() {return BFloat(16);}
+};
+
 template<>
 struct type_of_helper<uint8_t> {
     operator Type() {return UInt(8);}
@@ -16,6 +16,27 @@ namespace Internal {
 using std::string;
 using std::vector;
 
+namespace {
+
+// Does an expression load from the named buffer?
+class LoadsFrom : public IRVisitor {
+    using IRVisitor::visit;
+
+    const string &buffer;
+
+    void visit(const Load *op) {
+        if (op->name == buffer) {
+            result = true;
+        }
+        IRVisitor::visit(op);
+    }
+public:
+    bool result;
+    LoadsFrom(const string &b) : buffer(b), result(false) {}
+};
+
+}
+
 class VectorizeLoops : public IRMutator {
     class VectorSubs : public IRMutator {
         string var;
@@ -362,9 +383,81 @@ class VectorizeLoops : public IRMutator {
             }
         }
 
+        bool is_load_of_store_site(Expr e, const Store *op) {
+            const Load *load = e.as<Load>();
+            return load && load->name == op->name && equal(load->index, op->index);
+        }
+
+        // If every lane of a vectorized associative update writes to
+        // the same site, e.g. f(x) = f(x) + g(x, r.x) vectorized
+        // across r.x, reduce the new values horizontally and do a
+        // single scalar update instead. Returns an undefined Expr if
+        // the store isn't of that form.
+        Expr reduce_across_lanes(const Store *op) {
+            Expr a, b;
+            VectorReduce::Operator reduce_op;
+            bool commutative = true;
+            if (const Add *add = op->value.as<Add>()) {
+                a = add->a; b = add->b; reduce_op = VectorReduce::Add;
+            } else if (const Sub *sub = op->value.as<Sub>()) {
+                // f - x0 - x1 - ... is f - (x0 + x1 + ...)
+                a = sub->a; b = sub->b; reduce_op = VectorReduce::Add;
+                commutative = false;
+            } else if (const Mul *mul = op->value.as<Mul>()) {
+                a = mul->a; b = mul->b; reduce_op = VectorReduce::Mul;
+            } else if (const Min *min = op->value.as<Min>()) {
+                a = min->a; b = min->b; reduce_op = VectorReduce::Min;
+            } else if (const Max *max = op->value.as<Max>()) {
+                a = max->a; b = max->b; reduce_op = VectorReduce::Max;
+            } else {
+                return Expr();
+            }
+
+            if (!is_load_of_store_site(a, op)) {
+                if (!commutative || !is_load_of_store_site(b, op)) {
+                    return Expr();
+                }
+                std::swap(a, b);
+            }
+
+            LoadsFrom loads(op->name);
+            b.accept(&loads);
+            if (loads.result) {
+                return Expr();
+            }
+
+            a = mutate(a);
+            b = mutate(b);
+            if (a.type().is_vector() || b.type().is_scalar()) {
+                return Expr();
+            }
+
+            Expr reduced = VectorReduce::make(reduce_op, b, 1);
+            if (op->value.as<Sub>()) {
+                return Sub::make(a, reduced);
+            } else if (reduce_op == VectorReduce::Add) {
+                return Add::make(a, reduced);
+            } else if (reduce_op == VectorReduce::Mul) {
+                return Mul::make(a, reduced);
+            } else if (reduce_op == VectorReduce::Min) {
+                return Min::make(a, reduced);
+            } else {
+                return Max::make(a, reduced);
+            }
+        }
+
         void visit(const Store *op) {
             Expr value = mutate(op->value);
             Expr index = mutate(op->index);
+
+            if (index.type().is_scalar() && value.type().is_vector() &&
+                !internal_allocations.contains(op->name)) {
+                Expr reduced = reduce_across_lanes(op);
+                if (reduced.defined()) {
+                    stmt = Store::make(op->name, reduced, index);
+                    return;
+                }
+            }
             // Internal allocations always get vectorized.
             if (internal_allocations.contains(op->name)) {
                 int width = replacement.type().width;
@@ -104,6 +104,74 @@ extern void halide_shutdown_thread_pool();
  * routine, shuts down and then reinitializes the thread pool. */
 extern void halide_set_num_threads(int n);
 
+/** Call a pipeline's argv entry point (e.g. foo_argv) once for each
+ * of num_items independent sets of arguments, where item_args[i] is
+ * the argument array for item i. The items are spread across the
+ * thread pool with a single halide_do_par_for, so the per-call cost of
+ * waking the pool is paid once per batch, and parallel loops inside
+ * the pipeline nest within it. Returns zero if every item succeeded,
+ * or the nonzero result of one of the items that failed. */
+extern int halide_call_argv_batched(void *user_context,
+                                    int (*pipeline)(void **args),
+                                    int num_items,
+                                    void ***item_args);
+
+/** An opaque handle on a pipeline that has been prepared for repeated
+ * calls with buffers of the same shape. See halide_prepare_pipeline. */
+struct halide_prepared_pipeline_t;
+struct halide_filter_metadata_t;
+
+/** Prepare a pipeline compiled with the prepare_run target feature for
+ * repeated calls. prepared_argv and metadata are the pipeline's
+ * _prepared entry point (e.g. foo_prepared_argv and
+ * foo_prepared_metadata), and args are its arguments without the
+ * trailing context argument. The pipeline is run once on args with all
+ * of the usual checks on the buffers and parameters, and the heap
+ * allocations it makes for intermediates are kept in *pipeline.
+ *
+ * Subsequent calls to halide_run_prepared_pipeline whose buffers have
+ * the same mins, extents, strides and element sizes, and whose scalar
+ * arguments have the same values, skip those checks and reuse the
+ * intermediates, so only the host and device pointers may change
+ * cheaply. Calls that differ in any other way fall back to running
+ * with all checks on, and become the new shapes to match. A prepared
+ * pipeline may only be run by one thread at a time. Returns zero on
+ * success, in which case *pipeline must be released with
+ * halide_release_prepared_pipeline. */
+// @{
+extern int halide_prepare_pipeline(void *user_context,
+                                   int (*prepared_argv)(void **args),
+                                   const struct halide_filter_metadata_t *metadata,
+                                   void **args,
+                                   struct halide_prepared_pipeline_t **pipeline);
+extern int halide_run_prepared_pipeline(void *user_context,
+                                        struct halide_prepared_pipeline_t *pipeline,
+                                        void **args);
+extern void halide_release_prepared_pipeline(void *user_context,
+                                             struct halide_prepared_pipeline_t *pipeline);
+// @}
+
+/** Used by code compiled with the prepare_run target feature. Returns
+ * nonzero if the checks on the arguments can be skipped. */
+extern int halide_prepared_validated(struct halide_prepared_pipeline_t *pipeline);
+
+/** Used by code compiled with the prepare_run target feature in place
+ * of halide_malloc and halide_free. Allocations are kept by the
+ * prepared pipeline, and reused by its later calls. */
+// @{
+extern void *halide_prepared_malloc(struct halide_prepared_pipeline_t *pipeline, size_t size);
+extern void halide_prepared_free(void *user_context, void *ptr);
+// @}
+
+/** Returns nonzero if the host cpu supports all of the given target
+ * features. The argument is a bitmask indexed by Halide::Target::Feature;
+ * only the x86 instruction set features (sse41, avx, avx2, fma, fma4,
+ * f16c) are checked, and the rest are ignored. Called by the
+ * dispatcher emitted by compile_multitarget_to_object to pick a
+ * variant. Only present in the runtime for x86 targets. Define your
+ * own version to force a particular variant to be used. */
+extern int halide_can_use_target_features(uint64_t features);
+
 /** Define halide_malloc and halide_free to replace the default memory
  * allocator.  See Func::set_custom_allocator. (Specifically note that
  * halide_malloc must return a 32-byte aligned pointer, and it must be
@@ -382,6 +450,23 @@ enum halide_error_code_t {
 
     /** There is a bug in the Halide compiler. */
     halide_error_code_internal_error = -22,
+
+    /** The region of a Func used in one iteration of a loop did not
+     * fit in the circular buffer requested with fold_storage. */
+    halide_error_code_fold_factor_too_small = -23,
+
+    /** The type of a halide_buffer_t passed in did not match the type
+     * of the corresponding argument of the pipeline. */
+    halide_error_code_bad_type = -24,
+
+    /** The number of dimensions of a halide_buffer_t passed in did
+     * not match the corresponding argument of the pipeline, or was
+     * more than a buffer_t can represent. */
+    halide_error_code_bad_dimensions = -25,
+
+    /** A halide_buffer_t passed in had a version this runtime does
+     * not understand. */
+    halide_error_code_bad_buffer_version = -26,
 };
 
 /** Halide calls the functions below on various error conditions. The
@@ -433,6 +518,16 @@ extern int halide_error_out_of_memory(void *user_context);
 extern int halide_error_buffer_argument_is_null(void *user_context, const char *buffer_name);
 extern int halide_error_debug_to_file_failed(void *user_context, const char *func,
                                              const char *filename, int error_code);
+extern int halide_error_fold_factor_too_small(void *user_context, const char *func_name, int dimension,
+                                              int fold_factor, const char *loop_name, int required_extent);
+extern int halide_error_bad_type(void *user_context, const char *func_name,
+                                 uint8_t code_given, uint8_t correct_code,
+                                 uint8_t bits_given, uint8_t correct_bits,
+                                 uint16_t lanes_given, uint16_t correct_lanes);
+extern int halide_error_bad_dimensions(void *user_context, const char *func_name,
+                                       int32_t dimensions_given, int32_t correct_dimensions);
+extern int halide_error_bad_buffer_version(void *user_context, const char *func_name,
+                                           int32_t version_given, int32_t correct_version);
 // @}
 
 
@@ -442,12 +537,29 @@ extern int halide_error_debug_to_file_failed(void *user_context, const char *fun
  * (the bit width is expected to be encoded in a separate value).
  */
 typedef enum halide_type_code_t {
-    halide_type_int = 0,   //!< signed integers
-    halide_type_uint = 1,  //!< unsigned integers
-    halide_type_float = 2, //!< floating point numbers
-    halide_type_handle = 3 //!< opaque pointer type (void *)
+    halide_type_int = 0,    //!< signed integers
+    halide_type_uint = 1,   //!< unsigned integers
+    halide_type_float = 2,  //!< floating point numbers
+    halide_type_handle = 3, //!< opaque pointer type (void *)
+    halide_type_bfloat = 4  //!< floating point numbers in the bfloat format
 } halide_type_code_t;
 
+/** A runtime tag for a type in the halide type system. The bits and
+ * lanes are for a single element; the size in memory of an element
+ * is ((bits + 7) / 8) * lanes bytes. */
+struct halide_type_t {
+    /** The basic type code: signed integer, unsigned integer, or
+     * floating point. Actually a halide_type_code_t. */
+    uint8_t code;
+
+    /** The number of bits of precision of a single scalar value of
+     * this type. */
+    uint8_t bits;
+
+    /** How many elements in a vector. This is 1 for scalar types. */
+    uint16_t lanes;
+};
+
 // Note that while __attribute__ can go before or after the declaration,
 // __declspec apparently is only allowed before.
 #ifndef HALIDE_ATTRIBUTE_ALIGN
@@ -512,6 +624,65 @@ typedef struct buffer_t {
 
 #endif
 
+/** The version of halide_buffer_t described by this header. Bump this
+ * whenever its layout or meaning changes. */
+#define HALIDE_BUFFER_VERSION 1
+
+/** Flags for the flags field of halide_buffer_t. */
+typedef enum halide_buffer_flags {
+    halide_buffer_flag_host_dirty = 1,
+    halide_buffer_flag_dev_dirty = 2
+} halide_buffer_flags;
+
+/** The min, extent and stride of one dimension of a halide_buffer_t.
+ * No per-dimension flags are defined yet; flags must be zero. */
+struct halide_dimension_t {
+    int32_t min, extent, stride;
+    uint32_t flags;
+};
+
+/** A versioned descriptor of an image, with a full type code. The
+ * memory address of an element at coordinates x[0..dimensions) is
+ * host + sum((x[i] - dim[i].min) * dim[i].stride) * ((type.bits + 7)
+ * / 8) * type.lanes.
+ *
+ * This is only an interface-level wrapper for now. Generated code,
+ * extern stages, the JIT and AOT calling conventions, and Image and
+ * Buffer all still use buffer_t, so a halide_buffer_t can only be
+ * handed to a pipeline by converting it, either with
+ * halide_buffer_to_buffer_t or through
+ * halide_call_argv_with_halide_buffers. Both are limited to the four
+ * dimensions buffer_t can describe, and reject anything larger with
+ * halide_error_code_bad_dimensions. The compiler likewise refuses to
+ * compile a pipeline with an input or output buffer of more than four
+ * dimensions. */
+typedef struct halide_buffer_t {
+    /** A device-handle for e.g. GPU memory used to back this buffer. */
+    uint64_t dev;
+
+    /** A bitmask of halide_buffer_flags. */
+    uint64_t flags;
+
+    /** The type of each element. */
+    struct halide_type_t type;
+
+    /** Must be HALIDE_BUFFER_VERSION. */
+    int32_t version;
+
+    /** The number of entries in dim. */
+    int32_t dimensions;
+
+    /** Explicit padding, see buffer_t. */
+    int32_t _padding;
+
+    /** A pointer to the start of the data in main memory. */
+    uint8_t *host;
+
+    /** The shape of the buffer, innermost dimension first. This is
+     * not owned by the buffer. */
+    struct halide_dimension_t *dim;
+} halide_buffer_t;
+
 /** halide_scalar_value_t is a simple union able to represent all the well-known
  * scalar values in a filter argument. Note that it isn't tagged with a type;
  * you must ensure you know the proper type before accessing. Most user
@@ -618,6 +789,51 @@ typedef int (*enumerate_func_t)(void* enumerate_context,
  */
 extern int halide_enumerate_registered_filters(void *user_context, void* enumerate_context, enumerate_func_t func);
 
+/** Convert between halide_buffer_t and the buffer_t taken by generated
+ * code. Both fail with halide_error_code_bad_dimensions for more than
+ * four dimensions. halide_buffer_from_buffer_t uses the caller's
+ * buf->dim, which must have room for the given number of dimensions,
+ * and fails with halide_error_code_bad_elem_size if the type doesn't
+ * match elem_size. Both return zero on success, or an error code. */
+// @{
+extern int halide_buffer_to_buffer_t(void *user_context, const halide_buffer_t *buf, buffer_t *legacy);
+extern int halide_buffer_from_buffer_t(void *user_context, const buffer_t *legacy,
+                                       struct halide_type_t type, int32_t dimensions,
+                                       halide_buffer_t *buf);
+// @}
+
+/** Call a pipeline through its argv entry point (e.g. foo_argv), with
+ * each buffer argument passed as a halide_buffer_t * rather than a
+ * buffer_t *. The args are in the order of metadata->arguments (e.g.
+ * foo_metadata), which matches the argv entry point. The type and
+ * dimensionality of each buffer are checked against the metadata
+ * before the call. Changes made by the pipeline to the buffer_t
+ * (bounds query results, device allocations, dirty bits) are copied
+ * back to the halide_buffer_t. */
+extern int halide_call_argv_with_halide_buffers(void *user_context,
+                                                int (*pipeline)(void **args),
+                                                const halide_filter_metadata_t *metadata,
+                                                void **args);
+
+/** A helper for extern stages that want to use the thread pool. Splits
+ * the region described by buf into strips of strip_extent along
+ * dimension dim, and calls f once per strip from the thread pool, with
+ * a copy of buf whose min, extent and host pointer are adjusted to
+ * describe just that strip. Like a vectorized loop in a pipeline, the
+ * last strip is shifted inwards to overlap the one before it, so every
+ * strip has exactly strip_extent (unless the whole region is smaller
+ * than that). A strip_extent that is a multiple of the vector width
+ * thus lets f use vector code with no scalar tail, but f must compute
+ * the same values each time it covers a site. buf must have
+ * a host allocation. task_context is passed through to f. Returns zero
+ * if every call returns zero, or the nonzero result of one of them
+ * otherwise. Parallel loops in pipelines called from f nest within the
+ * pool as usual. */
+extern int halide_do_par_for_strips(void *user_context,
+                                    int (*f)(void *user_context, void *task_context, buffer_t *strip),
+                                    const buffer_t *buf, int dim, int strip_extent,
+                                    void *task_context);
+
 #ifdef __cplusplus
 } // End extern "C"
 #endif
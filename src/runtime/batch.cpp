@@ -0,0 +1,36 @@
+#include "HalideRuntime.h"
+
+namespace Halide { namespace Runtime { namespace Internal {
+
+struct batch_closure {
+    int (*pipeline)(void **args);
+    void ***item_args;
+};
+
+WEAK int batch_task(void *user_context, int idx, uint8_t *closure) {
+    batch_closure *c = (batch_closure *)closure;
+    return c->pipeline(c->item_args[idx]);
+}
+
+}}} // namespace Halide::Runtime::Internal
+
+using namespace Halide::Runtime::Internal;
+
+extern "C" {
+
+WEAK int halide_call_argv_batched(void *user_context,
+                                  int (*pipeline)(void **args),
+                                  int num_items,
+                                  void ***item_args) {
+    if (num_items <= 0) {
+        return 0;
+    }
+    if (num_items == 1) {
+        // Don't wake up the thread pool for a batch of one.
+        return pipeline(item_args[0]);
+    }
+    batch_closure closure = {pipeline, item_args};
+    return halide_do_par_for(user_context, batch_task, 0, num_items, (uint8_t *)&closure);
+}
+
+}  // extern "C"
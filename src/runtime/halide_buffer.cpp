@@ -0,0 +1,155 @@
+#include "HalideRuntime.h"
+
+namespace Halide { namespace Runtime { namespace Internal {
+
+WEAK int32_t halide_buffer_elem_size(const halide_type_t &type) {
+    return ((type.bits + 7) / 8) * (type.lanes == 0 ? 1 : type.lanes);
+}
+
+WEAK const char *halide_buffer_type_code_name(uint8_t code) {
+    switch (code) {
+    case halide_type_int: return "int";
+    case halide_type_uint: return "uint";
+    case halide_type_float: return "float";
+    case halide_type_handle: return "handle";
+    case halide_type_bfloat: return "bfloat";
+    default: return "unknown";
+    }
+}
+
+}}} // namespace Halide::Runtime::Internal
+
+using namespace Halide::Runtime::Internal;
+
+extern "C" {
+
+WEAK int halide_buffer_to_buffer_t(void *user_context, const halide_buffer_t *buf, buffer_t *legacy) {
+    if (buf == NULL) {
+        return halide_error_buffer_argument_is_null(user_context, "halide_buffer_t");
+    }
+    if (buf->version != HALIDE_BUFFER_VERSION) {
+        return halide_error_bad_buffer_version(user_context, "halide_buffer_t",
+                                               buf->version, HALIDE_BUFFER_VERSION);
+    }
+    if (buf->dimensions < 0 || buf->dimensions > 4) {
+        return halide_error_bad_dimensions(user_context, "halide_buffer_t", buf->dimensions, 4);
+    }
+
+    memset(legacy, 0, sizeof(buffer_t));
+    legacy->dev = buf->dev;
+    legacy->host = buf->host;
+    legacy->elem_size = halide_buffer_elem_size(buf->type);
+    for (int i = 0; i < buf->dimensions; i++) {
+        legacy->min[i] = buf->dim[i].min;
+        legacy->extent[i] = buf->dim[i].extent;
+        legacy->stride[i] = buf->dim[i].stride;
+    }
+    legacy->host_dirty = (buf->flags & halide_buffer_flag_host_dirty) != 0;
+    legacy->dev_dirty = (buf->flags & halide_buffer_flag_dev_dirty) != 0;
+    return 0;
+}
+
+WEAK int halide_buffer_from_buffer_t(void *user_context, const buffer_t *legacy,
+                                     halide_type_t type, int32_t dimensions,
+                                     halide_buffer_t *buf) {
+    if (legacy == NULL) {
+        return halide_error_buffer_argument_is_null(user_context, "buffer_t");
+    }
+    if (dimensions < 0 || dimensions > 4) {
+        return halide_error_bad_dimensions(user_context, "buffer_t", dimensions, 4);
+    }
+    if (legacy->elem_size != halide_buffer_elem_size(type)) {
+        // buffer_t only records the element size, so that's all we can
+        // check. It can be any int32_t, so report it as a size rather
+        // than squeezing it into the bits of a halide_type_t.
+        return halide_error_bad_elem_size(user_context, "buffer_t",
+                                          halide_buffer_type_code_name(type.code),
+                                          legacy->elem_size, halide_buffer_elem_size(type));
+    }
+
+    buf->dev = legacy->dev;
+    buf->host = legacy->host;
+    buf->type = type;
+    buf->version = HALIDE_BUFFER_VERSION;
+    buf->dimensions = dimensions;
+    buf->_padding = 0;
+    buf->flags = 0;
+    if (legacy->host_dirty) buf->flags |= halide_buffer_flag_host_dirty;
+    if (legacy->dev_dirty) buf->flags |= halide_buffer_flag_dev_dirty;
+    for (int i = 0; i < dimensions; i++) {
+        buf->dim[i].min = legacy->min[i];
+        buf->dim[i].extent = legacy->extent[i];
+        buf->dim[i].stride = legacy->stride[i];
+        buf->dim[i].flags = 0;
+    }
+    return 0;
+}
+
+WEAK int halide_call_argv_with_halide_buffers(void *user_context,
+                                              int (*pipeline)(void **args),
+                                              const halide_filter_metadata_t *metadata,
+                                              void **args) {
+    int num_args = metadata->num_arguments;
+    void **legacy_args = (void **)__builtin_alloca(num_args * sizeof(void *));
+    buffer_t *legacy_buffers = (buffer_t *)__builtin_alloca(num_args * sizeof(buffer_t));
+
+    for (int i = 0; i < num_args; i++) {
+        const halide_filter_argument_t *arg = &metadata->arguments[i];
+        if (arg->kind == halide_argument_kind_input_scalar) {
+            legacy_args[i] = args[i];
+            continue;
+        }
+
+        const halide_buffer_t *buf = (const halide_buffer_t *)args[i];
+        if (buf == NULL) {
+            return halide_error_buffer_argument_is_null(user_context, arg->name);
+        }
+        if (buf->version != HALIDE_BUFFER_VERSION) {
+            return halide_error_bad_buffer_version(user_context, arg->name,
+                                                   buf->version, HALIDE_BUFFER_VERSION);
+        }
+        // Buffer arguments are always scalar types.
+        if (buf->type.code != arg->type_code ||
+            buf->type.bits != arg->type_bits ||
+            buf->type.lanes != 1) {
+            return halide_error_bad_type(user_context, arg->name,
+                                         buf->type.code, arg->type_code,
+                                         buf->type.bits, arg->type_bits,
+                                         buf->type.lanes, 1);
+        }
+        if (buf->dimensions != arg->dimensions) {
+            return halide_error_bad_dimensions(user_context, arg->name,
+                                               buf->dimensions, arg->dimensions);
+        }
+        int result = halide_buffer_to_buffer_t(user_context, buf, &legacy_buffers[i]);
+        if (result != 0) {
+            return result;
+        }
+        legacy_args[i] = &legacy_buffers[i];
+    }
+
+    int result = pipeline(legacy_args);
+
+    // Copy back anything the pipeline may have changed: the shape
+    // (for bounds queries), device allocations, and the dirty bits.
+    for (int i = 0; i < num_args; i++) {
+        if (metadata->arguments[i].kind == halide_argument_kind_input_scalar) {
+            continue;
+        }
+        halide_buffer_t *buf = (halide_buffer_t *)args[i];
+        const buffer_t *legacy = &legacy_buffers[i];
+        buf->dev = legacy->dev;
+        buf->flags &= ~(uint64_t)(halide_buffer_flag_host_dirty | halide_buffer_flag_dev_dirty);
+        if (legacy->host_dirty) buf->flags |= halide_buffer_flag_host_dirty;
+        if (legacy->dev_dirty) buf->flags |= halide_buffer_flag_dev_dirty;
+        for (int j = 0; j < buf->dimensions; j++) {
+            buf->dim[j].min = legacy->min[j];
+            buf->dim[j].extent = legacy->extent[j];
+            buf->dim[j].stride = legacy->stride[j];
+        }
+    }
+
+    return result;
+}
+
+}  // extern "C"
@@ -0,0 +1,63 @@
+#include "HalideRuntime.h"
+
+namespace Halide { namespace Runtime { namespace Internal {
+
+struct strips_closure {
+    int (*f)(void *user_context, void *task_context, buffer_t *strip);
+    const buffer_t *buf;
+    int dim;
+    int strip_extent;
+    void *task_context;
+};
+
+WEAK int strip_task(void *user_context, int idx, uint8_t *closure) {
+    strips_closure *c = (strips_closure *)closure;
+    buffer_t strip = *c->buf;
+    int extent = c->buf->extent[c->dim];
+    int offset = idx * c->strip_extent;
+    if (extent >= c->strip_extent && offset > extent - c->strip_extent) {
+        // Shift the last strip inwards, so that every strip has the
+        // same extent, which f can then vectorize without a tail.
+        offset = extent - c->strip_extent;
+    }
+    int remaining = extent - offset;
+    strip.min[c->dim] += offset;
+    strip.extent[c->dim] = remaining < c->strip_extent ? remaining : c->strip_extent;
+    strip.host += (int64_t)offset * c->buf->stride[c->dim] * c->buf->elem_size;
+    // The strip doesn't own the device allocation of the whole buffer.
+    strip.dev = 0;
+    return c->f(user_context, c->task_context, &strip);
+}
+
+}}} // namespace Halide::Runtime::Internal
+
+using namespace Halide::Runtime::Internal;
+
+extern "C" {
+
+WEAK int halide_do_par_for_strips(void *user_context,
+                                  int (*f)(void *user_context, void *task_context, buffer_t *strip),
+                                  const buffer_t *buf, int dim, int strip_extent,
+                                  void *task_context) {
+    if (buf == NULL) {
+        return halide_error_buffer_argument_is_null(user_context, "buf");
+    }
+    if (buf->host == NULL || dim < 0 || dim > 3 || strip_extent <= 0) {
+        halide_error(user_context, "halide_do_par_for_strips requires a buffer with a host "
+                     "allocation, a dimension from 0 to 3, and a positive strip extent\n");
+        return halide_error_code_generic_error;
+    }
+    int extent = buf->extent[dim];
+    if (extent <= 0) {
+        return 0;
+    }
+    int num_strips = (extent + strip_extent - 1) / strip_extent;
+    strips_closure closure = {f, buf, dim, strip_extent, task_context};
+    if (num_strips == 1) {
+        // Don't wake up the thread pool for a single strip.
+        return strip_task(user_context, 0, (uint8_t *)&closure);
+    }
+    return halide_do_par_for(user_context, strip_task, 0, num_strips, (uint8_t *)&closure);
+}
+
+}  // extern "C"
@@ -195,4 +195,44 @@ WEAK int halide_error_debug_to_file_failed(void *user_context, const char *func,
     return halide_error_code_debug_to_file_failed;
 }
 
+WEAK int halide_error_fold_factor_too_small(void *user_context, const char *func_name, int dimension,
+                                            int fold_factor, const char *loop_name, int required_extent) {
+    error(user_context)
+        << "The fold factor (" << fold_factor
+        << ") of dimension " << dimension << " of " << func_name
+        << " is too small to store the required region accessed by loop "
+        << loop_name << " (" << required_extent << ")";
+    return halide_error_code_fold_factor_too_small;
+}
+
+WEAK int halide_error_bad_type(void *user_context, const char *func_name,
+                               uint8_t code_given, uint8_t correct_code,
+                               uint8_t bits_given, uint8_t correct_bits,
+                               uint16_t lanes_given, uint16_t correct_lanes) {
+    error(user_context)
+        << func_name << " has type code " << (int)code_given
+        << ", bits " << (int)bits_given
+        << ", and lanes " << (int)lanes_given
+        << " instead of type code " << (int)correct_code
+        << ", bits " << (int)correct_bits
+        << ", and lanes " << (int)correct_lanes;
+    return halide_error_code_bad_type;
+}
+
+WEAK int halide_error_bad_dimensions(void *user_context, const char *func_name,
+                                     int32_t dimensions_given, int32_t correct_dimensions) {
+    error(user_context)
+        << func_name << " has " << dimensions_given
+        << " dimensions instead of " << correct_dimensions;
+    return halide_error_code_bad_dimensions;
+}
+
+WEAK int halide_error_bad_buffer_version(void *user_context, const char *func_name,
+                                         int32_t version_given, int32_t correct_version) {
+    error(user_context)
+        << func_name << " is a halide_buffer_t of version " << version_given
+        << " instead of " << correct_version;
+    return halide_error_code_bad_buffer_version;
+}
+
 }
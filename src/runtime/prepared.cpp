@@ -0,0 +1,232 @@
+#include "runtime_internal.h"
+#include "HalideRuntime.h"
+
+namespace Halide { namespace Runtime { namespace Internal {
+
+// Every block handed out by halide_prepared_malloc starts with this
+// header, padded to 32 bytes so the allocation stays 32-byte aligned.
+struct prepared_block_t {
+    halide_prepared_pipeline_t *owner;
+    prepared_block_t *next;
+    size_t size;
+    int in_use;
+};
+
+const size_t prepared_block_header_size = 32;
+
+WEAK bool is_buffer_argument(const halide_filter_argument_t *arg) {
+    return arg->kind != halide_argument_kind_input_scalar;
+}
+
+WEAK size_t scalar_argument_size(const halide_filter_argument_t *arg) {
+    return arg->type_bits == 1 ? 1 : arg->type_bits / 8;
+}
+
+}}} // namespace Halide::Runtime::Internal
+
+using namespace Halide::Runtime::Internal;
+
+struct halide_prepared_pipeline_t {
+    int (*argv_func)(void **args);
+    const halide_filter_metadata_t *metadata;
+    void *user_context;
+    // Nonzero when the arguments have the shapes and scalar values
+    // recorded below, which have passed all the checks.
+    int validated;
+    buffer_t *shapes;
+    uint64_t *scalars;
+    void **args;
+    prepared_block_t *blocks;
+};
+
+namespace Halide { namespace Runtime { namespace Internal {
+
+// Returns true if the arguments match the ones the last checked call
+// succeeded with, ignoring the host and device pointers.
+WEAK bool same_shapes(halide_prepared_pipeline_t *p, void **args) {
+    const halide_filter_metadata_t *md = p->metadata;
+    for (int i = 0; i < md->num_arguments - 1; i++) {
+        const halide_filter_argument_t *arg = &md->arguments[i];
+        if (is_buffer_argument(arg)) {
+            const buffer_t *a = (const buffer_t *)args[i];
+            const buffer_t *b = &p->shapes[i];
+            if (a == NULL || (a->host == NULL && a->dev == 0) ||
+                a->elem_size != b->elem_size ||
+                memcmp(a->min, b->min, sizeof(a->min)) != 0 ||
+                memcmp(a->extent, b->extent, sizeof(a->extent)) != 0 ||
+                memcmp(a->stride, b->stride, sizeof(a->stride)) != 0) {
+                return false;
+            }
+        } else if (arg->type_code != halide_type_handle) {
+            // Scalars feed into the checks too (e.g. as bounds of the
+            // region required of an input), so they have to match as
+            // well. Handles (e.g. the user context) don't.
+            uint64_t value = 0;
+            memcpy(&value, args[i], scalar_argument_size(arg));
+            if (value != p->scalars[i]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+WEAK void record_shapes(halide_prepared_pipeline_t *p, void **args) {
+    const halide_filter_metadata_t *md = p->metadata;
+    for (int i = 0; i < md->num_arguments - 1; i++) {
+        const halide_filter_argument_t *arg = &md->arguments[i];
+        if (is_buffer_argument(arg)) {
+            p->shapes[i] = *(const buffer_t *)args[i];
+            p->shapes[i].host = NULL;
+            p->shapes[i].dev = 0;
+        } else if (arg->type_code != halide_type_handle) {
+            p->scalars[i] = 0;
+            memcpy(&p->scalars[i], args[i], scalar_argument_size(arg));
+        }
+    }
+}
+
+WEAK bool is_bounds_query(halide_prepared_pipeline_t *p, void **args) {
+    const halide_filter_metadata_t *md = p->metadata;
+    for (int i = 0; i < md->num_arguments - 1; i++) {
+        if (is_buffer_argument(&md->arguments[i])) {
+            const buffer_t *b = (const buffer_t *)args[i];
+            if (b == NULL || (b->host == NULL && b->dev == 0)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+WEAK int call_prepared(void *user_context, halide_prepared_pipeline_t *p, void **args) {
+    const halide_filter_metadata_t *md = p->metadata;
+    bool bounds_query = is_bounds_query(p, args);
+    p->validated = !bounds_query && same_shapes(p, args);
+    p->user_context = user_context;
+    memcpy(p->args, args, (md->num_arguments - 1) * sizeof(void *));
+    p->args[md->num_arguments - 1] = &p;
+    int result = p->argv_func(p->args);
+    if (result == 0 && !p->validated && !bounds_query) {
+        record_shapes(p, args);
+        p->validated = 1;
+    } else if (result != 0) {
+        p->validated = 0;
+    }
+    return result;
+}
+
+}}} // namespace Halide::Runtime::Internal
+
+extern "C" {
+
+WEAK int halide_prepare_pipeline(void *user_context,
+                                 int (*prepared_argv)(void **args),
+                                 const halide_filter_metadata_t *metadata,
+                                 void **args,
+                                 halide_prepared_pipeline_t **pipeline) {
+    *pipeline = NULL;
+    int n = metadata->num_arguments;
+    if (n == 0 || strcmp(metadata->arguments[n - 1].name, "__prepared_context") != 0) {
+        halide_error(user_context, "halide_prepare_pipeline requires the _prepared entry point "
+                     "of a pipeline compiled with the prepare_run target feature\n");
+        return halide_error_code_generic_error;
+    }
+
+    size_t header_size = (sizeof(halide_prepared_pipeline_t) + 7) & ~7;
+    size_t size = header_size + n * (sizeof(buffer_t) + sizeof(uint64_t) + sizeof(void *));
+    uint8_t *mem = (uint8_t *)halide_malloc(user_context, size);
+    if (mem == NULL) {
+        return halide_error_out_of_memory(user_context);
+    }
+    memset(mem, 0, size);
+    halide_prepared_pipeline_t *p = (halide_prepared_pipeline_t *)mem;
+    p->argv_func = prepared_argv;
+    p->metadata = metadata;
+    p->shapes = (buffer_t *)(mem + header_size);
+    p->scalars = (uint64_t *)(p->shapes + n);
+    p->args = (void **)(p->scalars + n);
+
+    // Run once with all the checks on, which also allocates the
+    // intermediates that later calls will reuse.
+    int result = call_prepared(user_context, p, args);
+    if (result != 0) {
+        halide_release_prepared_pipeline(user_context, p);
+        return result;
+    }
+    *pipeline = p;
+    return 0;
+}
+
+WEAK int halide_run_prepared_pipeline(void *user_context,
+                                      halide_prepared_pipeline_t *pipeline,
+                                      void **args) {
+    if (pipeline == NULL) {
+        return halide_error_buffer_argument_is_null(user_context, "pipeline");
+    }
+    return call_prepared(user_context, pipeline, args);
+}
+
+WEAK void halide_release_prepared_pipeline(void *user_context,
+                                           halide_prepared_pipeline_t *pipeline) {
+    if (pipeline == NULL) return;
+    prepared_block_t *b = pipeline->blocks;
+    while (b) {
+        prepared_block_t *next = b->next;
+        halide_free(user_context, b);
+        b = next;
+    }
+    halide_free(user_context, pipeline);
+}
+
+WEAK int halide_prepared_validated(halide_prepared_pipeline_t *pipeline) {
+    return pipeline != NULL && pipeline->validated;
+}
+
+WEAK void *halide_prepared_malloc(halide_prepared_pipeline_t *pipeline, size_t size) {
+    if (size == 0) {
+        return NULL;
+    }
+    void *user_context = pipeline ? pipeline->user_context : NULL;
+    prepared_block_t *best = NULL;
+    if (pipeline) {
+        // Reuse the smallest free block that's big enough. Calls with
+        // the same shapes make the same sequence of requests, so after
+        // the first call this always finds one.
+        for (prepared_block_t *b = pipeline->blocks; b; b = b->next) {
+            if (!b->in_use && b->size >= size && (!best || b->size < best->size)) {
+                best = b;
+            }
+        }
+    }
+    if (!best) {
+        best = (prepared_block_t *)halide_malloc(user_context, size + prepared_block_header_size);
+        if (best == NULL) {
+            return NULL;
+        }
+        best->owner = pipeline;
+        best->size = size;
+        if (pipeline) {
+            best->next = pipeline->blocks;
+            pipeline->blocks = best;
+        } else {
+            best->next = NULL;
+        }
+    }
+    best->in_use = 1;
+    return (uint8_t *)best + prepared_block_header_size;
+}
+
+WEAK void halide_prepared_free(void *user_context, void *ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+    prepared_block_t *b = (prepared_block_t *)((uint8_t *)ptr - prepared_block_header_size);
+    if (b->owner) {
+        b->in_use = 0;
+    } else {
+        halide_free(user_context, b);
+    }
+}
+
+}  // extern "C"
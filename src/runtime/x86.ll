@@ -131,4 +131,29 @@ define weak_odr <2 x double> @max_f64x2(<2 x double> %a, <2 x double> %b) nounwi
   %c = fcmp olt <2 x double> %a, %b
   %result = select <2 x i1> %c, <2 x double> %b, <2 x double> %a
   ret <2 x double> %result
-}
\ No newline at end of file
+}
+
+; cpuid and xgetbv for runtime cpu feature detection. These are used
+; by x86_cpu_features.cpp, which is compiled for a generic target and
+; so can't contain x86 inline assembly itself. x86_cpuid_halide returns
+; the register selected by %reg (0 = eax, 1 = ebx, 2 = ecx, 3 = edx).
+define weak_odr i32 @x86_cpuid_halide(i32 %type, i32 %extra, i32 %reg) nounwind uwtable {
+  %1 = tail call { i32, i32, i32, i32 } asm sideeffect "cpuid", "={ax},={bx},={cx},={dx},0,2,~{dirflag},~{fpsr},~{flags}"(i32 %type, i32 %extra) nounwind
+  %eax = extractvalue { i32, i32, i32, i32 } %1, 0
+  %ebx = extractvalue { i32, i32, i32, i32 } %1, 1
+  %ecx = extractvalue { i32, i32, i32, i32 } %1, 2
+  %edx = extractvalue { i32, i32, i32, i32 } %1, 3
+  %is_eax = icmp eq i32 %reg, 0
+  %is_ebx = icmp eq i32 %reg, 1
+  %is_ecx = icmp eq i32 %reg, 2
+  %2 = select i1 %is_ecx, i32 %ecx, i32 %edx
+  %3 = select i1 %is_ebx, i32 %ebx, i32 %2
+  %4 = select i1 %is_eax, i32 %eax, i32 %3
+  ret i32 %4
+}
+
+define weak_odr i32 @x86_xgetbv_halide(i32 %xcr) nounwind uwtable {
+  %1 = tail call { i32, i32 } asm sideeffect "xgetbv", "={ax},={dx},{cx},~{dirflag},~{fpsr},~{flags}"(i32 %xcr) nounwind
+  %2 = extractvalue { i32, i32 } %1, 0
+  ret i32 %2
+}
@@ -0,0 +1,79 @@
+#include "runtime_internal.h"
+
+extern "C" {
+
+// Defined in x86.ll
+int32_t x86_cpuid_halide(int32_t type, int32_t extra, int32_t reg);
+int32_t x86_xgetbv_halide(int32_t xcr);
+
+}
+
+namespace Halide { namespace Runtime { namespace Internal {
+
+// These must match the indices of the corresponding values in
+// Target::Feature.
+enum {
+    feature_sse41 = 4,
+    feature_avx = 5,
+    feature_avx2 = 6,
+    feature_fma = 7,
+    feature_fma4 = 8,
+    feature_f16c = 9
+};
+
+// The features of the host cpu, or zero if not yet computed. Bit 0
+// (Target::JIT) is never a cpu feature, so it marks the value as
+// valid. All the bits fit in 32 bits so that the value is written
+// atomically on 32-bit targets too.
+WEAK uint32_t halide_host_features = 0;
+
+WEAK uint32_t get_host_features() {
+    uint32_t features = 1;
+
+    int32_t max_leaf = x86_cpuid_halide(0, 0, 0);
+    int32_t ecx = x86_cpuid_halide(1, 0, 2);
+
+    if (ecx & (1 << 19)) features |= 1 << feature_sse41;
+
+    // AVX and the things that depend on it also need the OS to save
+    // the ymm registers on context switches.
+    bool have_osxsave = ecx & (1 << 27);
+    bool os_saves_ymm = have_osxsave && ((x86_xgetbv_halide(0) & 6) == 6);
+    if (os_saves_ymm && (ecx & (1 << 28))) {
+        features |= 1 << feature_avx;
+        if (ecx & (1 << 12)) features |= 1 << feature_fma;
+        if (ecx & (1 << 29)) features |= 1 << feature_f16c;
+
+        if (max_leaf >= 7) {
+            int32_t ebx7 = x86_cpuid_halide(7, 0, 1);
+            if (ebx7 & (1 << 5)) features |= 1 << feature_avx2;
+        }
+
+        uint32_t max_extended_leaf = (uint32_t)x86_cpuid_halide((int32_t)0x80000000, 0, 0);
+        if (max_extended_leaf >= 0x80000001) {
+            int32_t ecx_ext = x86_cpuid_halide((int32_t)0x80000001, 0, 2);
+            if (ecx_ext & (1 << 16)) features |= 1 << feature_fma4;
+        }
+    }
+
+    return features;
+}
+
+}}} // namespace Halide::Runtime::Internal
+
+extern "C" {
+
+WEAK int halide_can_use_target_features(uint64_t features) {
+    // Concurrent first calls compute the same answer, so there's no
+    // need for a lock here.
+    uint32_t host = Halide::Runtime::Internal::halide_host_features;
+    if (host == 0) {
+        host = Halide::Runtime::Internal::get_host_features();
+        Halide::Runtime::Internal::halide_host_features = host;
+    }
+    // Only the cpu features are meaningful here.
+    features &= ~(uint64_t)1;
+    return (features & host) == features ? 1 : 0;
+}
+
+}
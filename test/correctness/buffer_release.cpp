@@ -0,0 +1,60 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+int releases = 0;
+
+void my_release(void *arg) {
+    releases += *(int *)arg;
+}
+
+int main(int argc, char **argv) {
+    float data[16 * 8];
+    buffer_t buf = {0};
+    buf.host = (uint8_t *)data;
+    buf.elem_size = sizeof(float);
+    buf.extent[0] = 16;
+    buf.extent[1] = 8;
+    buf.stride[0] = 1;
+    buf.stride[1] = 16;
+
+    int increment = 1;
+
+    {
+        Buffer b(Float(32), &buf, my_release, &increment);
+        ImageParam input(Float(32), 2);
+        input.set(b);
+
+        // The ImageParam still refers to the Buffer.
+        b = Buffer();
+        if (releases != 0) {
+            printf("The memory was released while still in use\n");
+            return -1;
+        }
+
+        for (int i = 0; i < 16 * 8; i++) {
+            data[i] = (float)i;
+        }
+        Var x, y;
+        Func f;
+        f(x, y) = input(x, y) * 2;
+        Image<float> out = f.realize(16, 8);
+        for (int y = 0; y < 8; y++) {
+            for (int x = 0; x < 16; x++) {
+                if (out(x, y) != data[y * 16 + x] * 2) {
+                    printf("out(%d, %d) = %f instead of %f\n", x, y, out(x, y), data[y * 16 + x] * 2);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    if (releases != 1) {
+        printf("The memory was released %d times instead of once\n", releases);
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
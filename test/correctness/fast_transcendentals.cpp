@@ -0,0 +1,144 @@
+#include "Halide.h"
+#include <stdio.h>
+#include <math.h>
+#include <float.h>
+
+using namespace Halide;
+
+// The error of a float result relative to a double-precision
+// reference, in units of the spacing between floats near the
+// reference.
+double ulp_error(float actual, double correct) {
+    double a = fabs(correct);
+    int e;
+    frexp(a < FLT_MIN ? FLT_MIN : a, &e);
+    double ulp = ldexp(1.0, e - 24);
+    return fabs(actual - correct) / ulp;
+}
+
+enum ErrorKind {Absolute, Relative, ULP};
+
+struct Test {
+    const char *name;
+    double (*reference)(double, double);
+    double lo, hi;
+    // The maximum error permitted by the docs for each precision.
+    ErrorKind kind[3];
+    double bound[3];
+};
+
+double sin_ref(double x, double) {return sin(x);}
+double cos_ref(double x, double) {return cos(x);}
+double atan2_ref(double y, double x) {return atan2(y, x);}
+double tanh_ref(double x, double) {return tanh(x);}
+double cbrt_ref(double x, double) {return cbrt(x);}
+
+Expr apply(int i, Expr x, Expr y, ApproximationPrecision p) {
+    switch (i) {
+    case 0: return fast_sin(x, p);
+    case 1: return fast_cos(x, p);
+    case 2: return fast_atan2(y, x, p);
+    case 3: return fast_tanh(x, p);
+    default: return fast_cbrt(x, p);
+    }
+}
+
+int main(int argc, char **argv) {
+    const float pi = 3.14159265f;
+    Test tests[] = {
+        {"sin", sin_ref, -pi, pi, {Absolute, ULP, ULP}, {1.5e-5, 2.5, 2}},
+        {"cos", cos_ref, -pi, pi, {Absolute, ULP, ULP}, {1.5e-5, 2.5, 2}},
+        {"atan2", atan2_ref, -100, 100, {Absolute, ULP, ULP}, {3e-5, 16, 4}},
+        {"tanh", tanh_ref, -12, 12, {Absolute, ULP, ULP}, {2.5e-5, 24, 2}},
+        {"cbrt", cbrt_ref, -1e10, 1e10, {Relative, ULP, ULP}, {1.1e-3, 16, 2}},
+    };
+    const ApproximationPrecision precisions[] = {
+        ApproximationPrecision::Fast,
+        ApproximationPrecision::Balanced,
+        ApproximationPrecision::Accurate
+    };
+    const char *precision_names[] = {"Fast", "Balanced", "Accurate"};
+
+    const int W = 1024, H = 64;
+
+    // Each row of the input has a different scale, so that we cover
+    // both small and large magnitudes.
+    Image<float> in_x(W, H), in_y(W, H);
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            float t = (float)x / (W - 1);
+            float scale = (float)pow(2.0, -(double)y / 2);
+            in_x(x, y) = (2 * t - 1) * scale;
+            in_y(x, y) = (1 - 2 * ((x * 7 + y * 13) % W) / (float)(W - 1)) * scale;
+        }
+    }
+    // Some special values.
+    in_x(0, 0) = 0.0f;
+    in_y(0, 0) = 0.0f;
+    in_x(1, 0) = 1.0f;
+    in_y(1, 0) = 0.0f;
+    in_x(2, 0) = 0.0f;
+    in_y(2, 0) = 1.0f;
+    in_x(3, 0) = -1.0f;
+    in_y(3, 0) = 0.0f;
+
+    for (int i = 0; i < 5; i++) {
+        const Test &test = tests[i];
+        for (int p = 0; p < 3; p++) {
+            Var x, y;
+            Func f;
+            Expr mid = (float)((test.hi + test.lo) / 2);
+            Expr half = (float)((test.hi - test.lo) / 2);
+            f(x, y) = apply(i, mid + in_x(x, y) * half, mid + in_y(x, y) * half, precisions[p]);
+            f.vectorize(x, 8);
+            Image<float> out = f.realize(W, H);
+
+            double max_err = 0;
+            for (int yi = 0; yi < H; yi++) {
+                for (int xi = 0; xi < W; xi++) {
+                    // Recompute the input the same way the pipeline did.
+                    float mid_f = (float)((test.hi + test.lo) / 2);
+                    float half_f = (float)((test.hi - test.lo) / 2);
+                    float a = mid_f + in_x(xi, yi) * half_f;
+                    float b = mid_f + in_y(xi, yi) * half_f;
+                    double correct = (i == 2) ? test.reference(b, a) : test.reference(a, b);
+                    float actual = out(xi, yi);
+                    double err;
+                    switch (test.kind[p]) {
+                    case Absolute: err = fabs(actual - correct); break;
+                    case Relative: err = correct == 0 ? fabs(actual) : fabs(actual - correct) / fabs(correct); break;
+                    default: err = ulp_error(actual, correct); break;
+                    }
+                    if (!(err <= test.bound[p])) {
+                        printf("fast_%s (%s) of (%.9g, %.9g) = %.9g instead of %.9g (error = %g, bound = %g)\n",
+                               test.name, precision_names[p], a, b, actual, correct, err, test.bound[p]);
+                        return -1;
+                    }
+                    if (err > max_err) max_err = err;
+                }
+            }
+            printf("fast_%s (%s): max error = %g\n", test.name, precision_names[p], max_err);
+        }
+    }
+
+    // Over a wider range, the argument reduction for sin and cos adds
+    // some absolute error.
+    {
+        Var x;
+        Func f;
+        f(x) = fast_sin(x * 97.65625f - 50000.0f, ApproximationPrecision::Accurate);
+        f.vectorize(x, 8);
+        Image<float> out = f.realize(1024);
+        for (int i = 0; i < 1024; i++) {
+            float a = i * 97.65625f - 50000.0f;
+            double err = fabs(out(i) - sin((double)a));
+            if (err > 1e-6) {
+                printf("fast_sin(%f) = %f instead of %f\n", a, out(i), sin((double)a));
+                return -1;
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
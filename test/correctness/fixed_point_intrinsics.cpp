@@ -0,0 +1,116 @@
+#include "Halide.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace Halide;
+
+// Reference implementations, done in 64 bits. Halide's signed
+// division is Euclidean (the remainder is never negative), so the
+// halving ops are too. For the positive divisors used here, that's
+// the same as rounding towards negative infinity.
+int64_t div_euclid(int64_t a, int64_t b) {
+    int64_t q = a / b;
+    if (a % b < 0) q += (b < 0) ? 1 : -1;
+    return q;
+}
+
+template<typename T>
+int64_t saturate(int64_t x) {
+    const int64_t lo = (int64_t)type_of<T>().imin();
+    const int64_t hi = (int64_t)type_of<T>().imax();
+    return x < lo ? lo : (x > hi ? hi : x);
+}
+
+template<typename T>
+bool test(const char *name) {
+    const int W = 256;
+    const int bits = sizeof(T) * 8;
+    const int q = type_of<T>().is_int() ? bits - 1 : bits;
+
+    // The largest shift the multiplies allow. Rounding at this shift
+    // used to overflow the wide type.
+    const int q_max = 2 * bits - 1;
+
+    Image<T> in_a(W), in_b(W), in_s(W), in_q(W);
+    for (int i = 0; i < W; i++) {
+        in_a(i) = (T)rand();
+        in_b(i) = (T)rand();
+        in_s(i) = (T)(rand() % bits);
+        in_q(i) = (T)(rand() % (2 * bits));
+    }
+    // Make sure we hit the extremes.
+    in_a(0) = in_b(0) = (T)type_of<T>().imin();
+    in_a(1) = in_b(1) = (T)type_of<T>().imax();
+    in_a(2) = (T)type_of<T>().imin();
+    in_b(2) = (T)type_of<T>().imax();
+
+    Var x;
+    Expr a = in_a(x), b = in_b(x), s = in_s(x), wide_s = in_q(x);
+
+    // Checking the shifts by up to twice the width against the 64-bit
+    // reference only works for types of up to 16 bits.
+    const int num_ops = bits <= 16 ? 12 : 9;
+    Func f[12];
+    f[0](x) = saturating_add(a, b);
+    f[1](x) = saturating_sub(a, b);
+    f[2](x) = halving_add(a, b);
+    f[3](x) = halving_sub(a, b);
+    f[4](x) = rounding_halving_add(a, b);
+    f[5](x) = rounding_shift_right(a, s);
+    f[6](x) = mul_shift_right(a, b, q);
+    f[7](x) = rounding_mul_shift_right(a, b, q);
+    f[8](x) = cast<T>(widening_mul(a, b) >> bits);
+    f[9](x) = rounding_mul_shift_right(a, b, q_max);
+    f[10](x) = rounding_mul_shift_right(a, b, wide_s);
+    f[11](x) = mul_shift_right(a, b, wide_s);
+
+    for (int vectorized = 0; vectorized < 2; vectorized++) {
+        for (int op = 0; op < num_ops; op++) {
+            Func g;
+            g(x) = f[op](x);
+            if (vectorized) {
+                g.vectorize(x, 16);
+            }
+            Image<T> out = g.realize(W);
+
+            for (int i = 0; i < W; i++) {
+                int64_t ia = in_a(i), ib = in_b(i), is = in_s(i), iq = in_q(i);
+                int64_t correct = 0;
+                switch (op) {
+                case 0: correct = saturate<T>(ia + ib); break;
+                case 1: correct = saturate<T>(ia - ib); break;
+                case 2: correct = (T)div_euclid(ia + ib, 2); break;
+                case 3: correct = (T)div_euclid(ia - ib, 2); break;
+                case 4: correct = (T)div_euclid(ia + ib + 1, 2); break;
+                case 5: correct = (T)((ia + ((int64_t)1 << is >> 1)) >> is); break;
+                case 6: correct = saturate<T>((ia * ib) >> q); break;
+                case 7: correct = saturate<T>((ia * ib + ((int64_t)1 << (q - 1))) >> q); break;
+                case 8: correct = (T)((ia * ib) >> bits); break;
+                case 9: correct = saturate<T>((ia * ib + ((int64_t)1 << (q_max - 1))) >> q_max); break;
+                case 10: correct = saturate<T>((ia * ib + ((int64_t)1 << iq >> 1)) >> iq); break;
+                case 11: correct = saturate<T>((ia * ib) >> iq); break;
+                }
+                if ((int64_t)out(i) != correct) {
+                    printf("%s op %d (vectorized = %d): f(%lld, %lld, %lld) = %lld instead of %lld\n",
+                           name, op, vectorized,
+                           (long long)ia, (long long)ib, (long long)(op >= 10 ? iq : is),
+                           (long long)out(i), (long long)correct);
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (!test<int8_t>("int8")) return -1;
+    if (!test<uint8_t>("uint8")) return -1;
+    if (!test<int16_t>("int16")) return -1;
+    if (!test<uint16_t>("uint16")) return -1;
+    if (!test<int32_t>("int32")) return -1;
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include "Halide.h"
+#include <stdio.h>
+#include <math.h>
+
+using namespace Halide;
+
+template<typename T>
+bool test(Type t, const char *name) {
+    const int W = 256, H = 64;
+
+    // An input covering a wide range of magnitudes, including
+    // denormals, infinities, and nans.
+    Image<T> in(W, H);
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            in(x, y) = T::make_from_bits((uint16_t)(y * W * 4 + x * 3));
+        }
+    }
+
+    Var x, y;
+    Func widened, f, g;
+
+    // Store an intermediate at 16 bits, but do the math in 32.
+    widened(x, y) = cast<float>(in(x, y));
+    f(x, y) = cast(t, widened(x, y) * 0.5f + 1.0f);
+    g(x, y) = f(x, y) + f(x, y);
+
+    f.compute_root().vectorize(x, 8);
+    g.vectorize(x, 16);
+
+    Image<T> out = g.realize(W, H);
+
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            float a = float(T(float(in(x, y)) * 0.5f + 1.0f));
+            float correct = float(T(a + a));
+            float actual = float(out(x, y));
+            bool both_nan = isnan(correct) && isnan(actual);
+            if (!both_nan && correct != actual) {
+                printf("%s: out(%d, %d) = %f (0x%x) instead of %f\n",
+                       name, x, y, actual, out(x, y).to_bits(), correct);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (!test<float16_t>(Float(16), "float16")) return -1;
+    if (!test<bfloat16_t>(BFloat(16), "bfloat16")) return -1;
+
+    // Check rounding of some constants.
+    if (float(float16_t(1.0f + 1.0f / 2048)) != 1.0f ||
+        float(float16_t(1.0f + 3.0f / 2048)) != 1.0f + 4.0f / 2048 ||
+        float(float16_t(1e6f)) != INFINITY ||
+        float(bfloat16_t(1.0f + 1.0f / 256)) != 1.0f) {
+        printf("Incorrect rounding of constants\n");
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
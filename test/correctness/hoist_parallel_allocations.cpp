@@ -0,0 +1,63 @@
+#include "Halide.h"
+#include <stdio.h>
+#include <atomic>
+
+using namespace Halide;
+
+// Count the heap allocations made by the pipeline. Parallel tasks
+// call these concurrently.
+std::atomic<int> mallocs(0);
+
+extern "C" {
+    void *my_malloc(void *ctx, size_t sz) {
+        mallocs++;
+        void *orig = malloc(sz + 32);
+        void *ptr = (void *)((((size_t)orig + 32) >> 5) << 5);
+        ((void **)ptr)[-1] = orig;
+        return ptr;
+    }
+
+    void my_free(void *ctx, void *ptr) {
+        free(((void**)ptr)[-1]);
+    }
+}
+
+int main(int argc, char **argv) {
+    Func f, g;
+    Var x, y;
+    Param<int> radius;
+
+    // g's footprint per row of f depends on a parameter, so it must
+    // live on the heap.
+    g(x, y) = x * 3 + y;
+    f(x, y) = g(x - radius, y) + g(x + radius, y);
+
+    g.compute_at(f, y);
+    f.parallel(y);
+
+    f.set_custom_allocator(&my_malloc, &my_free);
+
+    const int W = 1024, H = 2000;
+    radius.set(1000);
+    Image<int> out = f.realize(W, H);
+
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            int correct = (x - 1000) * 3 + y + (x + 1000) * 3 + y;
+            if (out(x, y) != correct) {
+                printf("out(%d, %d) = %d instead of %d\n", x, y, out(x, y), correct);
+                return -1;
+            }
+        }
+    }
+
+    // Without hoisting there would be one allocation per row. With
+    // hoisting there should be at most one per parallel task.
+    if (mallocs > 64) {
+        printf("There were %d heap allocations for %d rows\n", (int)mallocs, H);
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,140 @@
+#include "Halide.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace Halide;
+
+bool error_occurred;
+void halide_error(void *user_context, const char *msg) {
+    printf("Unexpected error: %s\n", msg);
+    error_occurred = true;
+}
+
+const int W = 64, H = 16;
+
+// Make a three-channel image that shares the given storage, either
+// planar or interleaved, with its host pointer offset by the given
+// number of floats.
+Image<float> make_image(Image<float> storage, bool interleaved, int offset) {
+    buffer_t b;
+    memset(&b, 0, sizeof(b));
+    b.host = (uint8_t *)(storage.data() + offset);
+    b.elem_size = sizeof(float);
+    b.extent[0] = W;
+    b.extent[1] = H;
+    b.extent[2] = 3;
+    if (interleaved) {
+        b.stride[0] = 3;
+        b.stride[1] = 3 * W;
+        b.stride[2] = 1;
+    } else {
+        b.stride[0] = 1;
+        b.stride[1] = W;
+        b.stride[2] = W * H;
+    }
+    Image<float> im(&b);
+    for (int c = 0; c < 3; c++) {
+        for (int y = 0; y < H; y++) {
+            for (int x = 0; x < W; x++) {
+                im(x, y, c) = (float)(x + y * W + c * 1000);
+            }
+        }
+    }
+    return im;
+}
+
+// Count the dense vector loads of floats in a file of LLVM assembly
+// that are aligned to at least 16 bytes.
+int count_aligned_vector_loads(const char *filename) {
+    FILE *f = fopen(filename, "r");
+    if (!f) return -1;
+    char line[4096];
+    int count = 0;
+    while (fgets(line, sizeof(line), f)) {
+        if (!strstr(line, "load <") || !strstr(line, " x float>")) continue;
+        const char *align = strstr(line, "align ");
+        if (align && atoi(align + 6) >= 16) count++;
+    }
+    fclose(f);
+    return count;
+}
+
+// Compile a vectorized pipeline over a dense 1-D input, optionally
+// specialized on the input being aligned, and count its aligned
+// vector loads. The input and output start at zero, so each vector
+// is at a multiple of eight floats from the host pointer.
+int aligned_vector_loads(bool specialize) {
+    ImageParam in(Float(32), 1, "in");
+    in.set_min(0, 0);
+    Var x;
+    Func f("f");
+    f(x) = in(x) * 2 + 1;
+    f.bound(x, 0, W).vectorize(x, 8);
+    if (specialize) {
+        f.specialize(in.is_host_aligned(32));
+    }
+
+    const char *filename = specialize ? "host_alignment_specialized.ll" : "host_alignment.ll";
+    compile_module_to_llvm_assembly(f.compile_to_module(f.infer_arguments()), filename);
+    return count_aligned_vector_loads(filename);
+}
+
+int main(int argc, char **argv) {
+    // Only the branch that checks the alignment of the host pointer
+    // may use aligned loads.
+    int unspecialized = aligned_vector_loads(false);
+    int specialized = aligned_vector_loads(true);
+    if (unspecialized != 0 || specialized <= 0) {
+        printf("Expected aligned vector loads only with the specialization, "
+               "but got %d without it and %d with it\n", unspecialized, specialized);
+        return -1;
+    }
+
+    Var x, y, c;
+    ImageParam in(Float(32), 3);
+
+    // Allow any stride in the innermost dimension.
+    in.set_stride(0, Expr());
+
+    Func f;
+    f(x, y, c) = in(x, y, c) * 2 + 1;
+
+    // An aligned dense planar path, an interleaved path, and a
+    // generic fallback, which misaligned planar inputs also take.
+    f.specialize(in.is_host_aligned(32) && in.stride(0) == 1).vectorize(x, 8);
+    f.specialize(in.stride(0) == 3 && in.stride(2) == 1).vectorize(x, 8);
+    f.set_error_handler(&halide_error);
+
+    // Images allocate their storage 32-byte aligned.
+    Image<float> storage(W * H * 3 + 1);
+
+    for (int i = 0; i < 3; i++) {
+        bool interleaved = (i == 1);
+        int offset = (i == 2) ? 1 : 0;
+        Image<float> im = make_image(storage, interleaved, offset);
+        in.set(im);
+        error_occurred = false;
+        Image<float> out = f.realize(W, H, 3);
+        if (error_occurred) {
+            printf("There should not have been an error\n");
+            return -1;
+        }
+
+        for (int ci = 0; ci < 3; ci++) {
+            for (int yi = 0; yi < H; yi++) {
+                for (int xi = 0; xi < W; xi++) {
+                    float correct = im(xi, yi, ci) * 2 + 1;
+                    if (out(xi, yi, ci) != correct) {
+                        printf("out(%d, %d, %d) = %f instead of %f (interleaved = %d, offset = %d)\n",
+                               xi, yi, ci, out(xi, yi, ci), correct, interleaved, offset);
+                        return -1;
+                    }
+                }
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
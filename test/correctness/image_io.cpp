@@ -0,0 +1,165 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+#include "image_io.h"
+
+#ifndef _WIN32
+
+const int W = 37, H = 19;
+
+// The sample written at each site. Fits in 8 bits.
+int pattern(int x, int y, int c) {
+    return (x * 7 + y * 13 + c * 59) & 0xff;
+}
+
+// Create a mapped file, fill it in by realizing a pipeline straight
+// into it, and close it.
+template<typename T>
+bool create(const std::string &filename, int channels) {
+    MappedImage<T> im;
+    im.create(filename, W, H, channels);
+    if (!im.is_mapped() || im.width() != W || im.height() != H || im.channels() != channels) {
+        printf("Creating %s gave a %dx%dx%d image that is%s mapped\n", filename.c_str(),
+               im.width(), im.height(), im.channels(), im.is_mapped() ? "" : " not");
+        return false;
+    }
+
+    Func f;
+    Var x, y, c;
+    f(x, y, c) = cast<T>((x * 7 + y * 13 + c * 59) & 0xff);
+    if (channels == 1) {
+        // The buffer is two-dimensional.
+        Func g;
+        g(x, y) = f(x, y, 0);
+        g.realize(Buffer(type_of<T>(), (buffer_t *)im));
+    } else {
+        // The channels are interleaved.
+        f.output_buffer().set_stride(0, Expr());
+        f.realize(Buffer(type_of<T>(), (buffer_t *)im));
+    }
+    return true;
+}
+
+// Check a mapped image holds the pattern, with each sample scaled by
+// the given factor, and was or wasn't converted as expected.
+template<typename T>
+bool check(MappedImage<T> &im, const std::string &filename, int channels,
+           int scale, bool expect_mapped) {
+    if (im.is_mapped() != expect_mapped) {
+        printf("%s was %s when it should have been %s\n", filename.c_str(),
+               im.is_mapped() ? "mapped" : "converted", expect_mapped ? "mapped" : "converted");
+        return false;
+    }
+    if (im.width() != W || im.height() != H || im.channels() != channels) {
+        printf("%s is %dx%dx%d instead of %dx%dx%d\n", filename.c_str(),
+               im.width(), im.height(), im.channels(), W, H, channels);
+        return false;
+    }
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            for (int c = 0; c < channels; c++) {
+                int correct = pattern(x, y, c) * scale;
+                if ((int)im(x, y, c) != correct) {
+                    printf("%s(%d, %d, %d) = %d instead of %d\n", filename.c_str(),
+                           x, y, c, (int)im(x, y, c), correct);
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Create a file with samples of type A, then open it as samples of
+// type B.
+template<typename A, typename B>
+bool round_trip(const std::string &filename, int channels, bool expect_mapped) {
+    if (!create<A>(filename, channels)) return false;
+    MappedImage<B> im;
+    im.open(filename);
+    int scale = (sizeof(B) > sizeof(A)) ? 256 : 1;
+    return check(im, filename, channels, scale, expect_mapped);
+}
+
+template<typename T>
+bool raw_round_trip(const std::string &filename, int channels) {
+    if (!create<T>(filename, channels)) return false;
+    MappedImage<T> im;
+    im.open_raw(filename, W, H, channels);
+    return check(im, filename, channels, 1, true);
+}
+
+int main(int argc, char **argv) {
+    // Samples of the type asked for are used in place.
+    if (!round_trip<uint8_t, uint8_t>("image_io.ppm", 3, true) ||
+        !round_trip<uint8_t, uint8_t>("image_io.pgm", 1, true) ||
+        !round_trip<uint8_t, uint8_t>("image_io_u8.tif", 1, true) ||
+        !round_trip<uint8_t, uint8_t>("image_io_u8.tif", 2, true) ||
+        !round_trip<uint8_t, uint8_t>("image_io_u8.tif", 3, true) ||
+        !round_trip<uint16_t, uint16_t>("image_io_u16.tif", 1, true) ||
+        !round_trip<uint16_t, uint16_t>("image_io_u16.tif", 2, true) ||
+        !round_trip<uint16_t, uint16_t>("image_io_u16.tif", 4, true) ||
+        !round_trip<float, float>("image_io_f32.tif", 3, true) ||
+        !raw_round_trip<uint8_t>("image_io_u8.raw", 3) ||
+        !raw_round_trip<uint16_t>("image_io_u16.raw", 2)) {
+        return -1;
+    }
+
+    // Samples of other types are converted into a copy.
+    if (!round_trip<uint8_t, uint16_t>("image_io.ppm", 3, false) ||
+        !round_trip<uint8_t, uint16_t>("image_io_u8.tif", 2, false) ||
+        !round_trip<uint8_t, uint16_t>("image_io_u8.tif", 3, false)) {
+        return -1;
+    }
+
+    // So are samples that aren't aligned, or not in native byte
+    // order. 16-bit PPM files are big-endian, and save_ppm doesn't
+    // align the samples after the header.
+    {
+        Image<uint16_t> im(W, H, 3);
+        for (int y = 0; y < H; y++) {
+            for (int x = 0; x < W; x++) {
+                for (int c = 0; c < 3; c++) {
+                    im(x, y, c) = pattern(x, y, c);
+                }
+            }
+        }
+        save_ppm(im, "image_io_u16.ppm");
+        MappedImage<uint16_t> mapped;
+        mapped.open("image_io_u16.ppm");
+        if (!check(mapped, "image_io_u16.ppm", 3, 1, false)) {
+            return -1;
+        }
+
+        FILE *f = fopen("image_io_misaligned.raw", "wb");
+        fputc(0, f);
+        for (int y = 0; y < H; y++) {
+            for (int x = 0; x < W; x++) {
+                for (int c = 0; c < 3; c++) {
+                    uint16_t value = pattern(x, y, c);
+                    fwrite(&value, sizeof(value), 1, f);
+                }
+            }
+        }
+        fclose(f);
+        mapped.open_raw("image_io_misaligned.raw", W, H, 3, 1);
+        if (!check(mapped, "image_io_misaligned.raw", 3, 1, false)) {
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
+
+#else
+
+int main(int argc, char **argv) {
+    printf("Skipping test: MappedImage is not supported on Windows\n");
+    printf("Success!\n");
+    return 0;
+}
+
+#endif
@@ -0,0 +1,100 @@
+#include "Halide.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace Halide;
+
+// Halide's division rounds such that the remainder is always
+// non-negative.
+int64_t div_euclid(int64_t a, int64_t b) {
+    int64_t q = a / b, r = a % b;
+    if (r < 0) q += (b > 0) ? -1 : 1;
+    return q;
+}
+
+template<typename T>
+bool test(const char *name, int vector_width) {
+    const int W = 256, H = 16;
+    const int64_t lo = (int64_t)type_of<T>().imin();
+    const int64_t hi = (int64_t)type_of<T>().imax();
+
+    Image<T> in(W);
+    for (int i = 0; i < W; i++) {
+        in(i) = (T)(rand() ^ (rand() << 16));
+    }
+    in(0) = (T)lo;
+    in(1) = (T)hi;
+    in(2) = 0;
+    in(3) = (T)1;
+    in(4) = (T)-1;
+
+    // Divisors given as a param, including the extremes of the type.
+    Param<T> p;
+    Var x, y;
+    Func f;
+    f(x, y) = Tuple(in(x) / p, in(x) % p);
+    if (vector_width > 1) {
+        f.vectorize(x, vector_width);
+    }
+
+    int64_t divisors[] = {1, 2, 3, 7, 10, 100, 127, hi, hi - 1, -1, -2, -3, -7, -100, lo, lo + 1};
+    for (size_t i = 0; i < sizeof(divisors)/sizeof(divisors[0]); i++) {
+        int64_t d = divisors[i];
+        if (d < lo || d > hi) continue;
+        p.set((T)d);
+        Realization r = f.realize(W, 1);
+        Image<T> q = r[0], m = r[1];
+        for (int j = 0; j < W; j++) {
+            int64_t n = in(j);
+            if (n == lo && d == -1) continue;
+            T correct_q = (T)div_euclid(n, d);
+            T correct_m = (T)(n - div_euclid(n, d) * d);
+            if (q(j, 0) != correct_q || m(j, 0) != correct_m) {
+                printf("%s x %d: %lld / %lld = %lld, %lld %% %lld = %lld instead of %lld, %lld\n",
+                       name, vector_width, (long long)n, (long long)d, (long long)q(j, 0),
+                       (long long)n, (long long)d, (long long)m(j, 0),
+                       (long long)correct_q, (long long)correct_m);
+                return false;
+            }
+        }
+    }
+
+    // Divisors that vary with an outer loop variable.
+    Func g;
+    Expr d = cast<T>(select(y < H/2, y - H/2, y - H/2 + 1) * 3);
+    g(x, y) = in(x) / d;
+    if (vector_width > 1) {
+        g.vectorize(x, vector_width);
+    }
+    Image<T> out = g.realize(W, H);
+    for (int y = 0; y < H; y++) {
+        int64_t d = (y < H/2 ? y - H/2 : y - H/2 + 1) * 3;
+        if (d < lo || d > hi) continue;
+        for (int j = 0; j < W; j++) {
+            int64_t n = in(j);
+            T correct = (T)div_euclid(n, d);
+            if (out(j, y) != correct) {
+                printf("%s x %d: %lld / %lld = %lld instead of %lld\n",
+                       name, vector_width, (long long)n, (long long)d,
+                       (long long)out(j, y), (long long)correct);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv) {
+    for (int w = 1; w <= 16; w *= 4) {
+        if (!test<int8_t>("int8", w)) return -1;
+        if (!test<uint8_t>("uint8", w)) return -1;
+        if (!test<int16_t>("int16", w)) return -1;
+        if (!test<uint16_t>("uint16", w)) return -1;
+        if (!test<int32_t>("int32", w)) return -1;
+        if (!test<uint32_t>("uint32", w)) return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
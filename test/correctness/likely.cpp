@@ -106,16 +106,27 @@ int main(int argc, char **argv) {
         count_partitions(g, 2);
     }
 
-    // The slicing only applies to a single loop level - the
-    // innermost one where it can be applied. So adding a boundary
-    // condition to a 2D computation will produce 3 code paths, not 9.
+    // The slicing applies to each loop level, up to three levels
+    // deep. Adding a boundary condition to a 2D computation will
+    // produce 9 code paths: a clean interior, edges that only clamp
+    // in one dimension, and corners that clamp in both.
     {
         Var y;
         Func g;
         g(x, y) = x + y;
         g.compute_root();
         Func h = BoundaryConditions::mirror_image(g, 0, 10, 0, 10);
-        count_partitions(h, 3);
+        count_partitions(h, 9);
+    }
+
+    // In 3D there are 27.
+    {
+        Var y, z;
+        Func g;
+        g(x, y, z) = x + y + z;
+        g.compute_root();
+        Func h = BoundaryConditions::repeat_edge(g, 0, 10, 0, 10, 0, 10);
+        count_partitions(h, 27);
     }
 
     // If you split and also have a boundary condition, or have
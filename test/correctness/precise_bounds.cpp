@@ -0,0 +1,141 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+// The number of values of f stored, and the size of its allocation.
+int stores = 0, allocated = 0;
+
+int my_trace(void *user_context, const halide_trace_event *e) {
+    if (e->event == halide_trace_store) {
+        stores += e->vector_width;
+    } else if (e->event == halide_trace_begin_realization) {
+        // The coordinates are the min and extent of each dimension.
+        int size = 1;
+        for (int i = 1; i < e->dimensions; i += 2) {
+            size *= e->coordinates[i];
+        }
+        allocated += size;
+    }
+    return 0;
+}
+
+const int W = 64, H = 16;
+
+// Realize one of a few pipelines that interval arithmetic
+// overestimates the region required of f for, and check the output.
+// The last one couples the two dimensions of f, which precise bounds
+// doesn't help with, because regions are still boxes.
+bool run(int pipeline, bool precise) {
+    Func f("f"), g("g");
+    Var x("x"), y("y");
+
+    f(x, y) = x + y * 256;
+
+    switch (pipeline) {
+    case 0:
+        // Wrap around in x. Interval arithmetic doesn't know that the
+        // two sides of the select use disjoint ranges of x.
+        g(x, y) = f(select(x < 8, x + W - 8, x - 8), y);
+        break;
+    case 1:
+        // Correlated terms.
+        g(x, y) = f(x*3 - x*2, y) + f(x, y);
+        break;
+    case 2:
+        // Both, with a select that reads the row above, except for
+        // the first row which reads the row below.
+        g(x, y) = f(select(y > 0, x + y - y, x), select(y < 1, 1, y - 1));
+        break;
+    case 3:
+        // A blur with a periodic boundary, as the blur in
+        // apps/nacl_demos/reaction_diffusion_2 would be written if its
+        // state wrapped around in x instead of repeating the edge.
+        g(x, y) = (f(select(x < 1, x + W - 1, x - 1), y) +
+                   f(x, y) +
+                   f(select(x > W - 2, x - W + 1, x + 1), y));
+        break;
+    case 4:
+        // A shear. The box covering the footprint is W + H - 1 wide,
+        // even though only W values of each row of f are used.
+        g(x, y) = f(x + y, y);
+        break;
+    }
+
+    f.compute_root();
+    f.trace_stores().trace_realizations();
+    g.set_custom_trace(&my_trace);
+
+    Target t = get_jit_target_from_environment();
+    if (precise) {
+        t.set_feature(Target::PreciseBounds);
+    }
+
+    stores = allocated = 0;
+    Image<int> out = g.realize(W, H, t);
+
+    for (int yy = 0; yy < H; yy++) {
+        for (int xx = 0; xx < W; xx++) {
+            int correct = 0;
+            switch (pipeline) {
+            case 0:
+                correct = (xx < 8 ? xx + W - 8 : xx - 8) + yy * 256;
+                break;
+            case 1:
+                correct = 2 * (xx + yy * 256);
+                break;
+            case 2:
+                correct = xx + (yy < 1 ? 1 : yy - 1) * 256;
+                break;
+            case 3:
+                correct = 3 * (xx + yy * 256);
+                break;
+            case 4:
+                correct = xx + yy + yy * 256;
+                break;
+            }
+            if (out(xx, yy) != correct) {
+                printf("Pipeline %d (precise = %d): out(%d, %d) = %d instead of %d\n",
+                       pipeline, precise, xx, yy, out(xx, yy), correct);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    for (int p = 0; p < 5; p++) {
+        if (!run(p, false)) return -1;
+        int interval_stores = stores, interval_allocated = allocated;
+        if (!run(p, true)) return -1;
+
+        printf("Pipeline %d: computed %d values of f with interval bounds, %d with precise bounds. "
+               "Allocated %d and %d.\n",
+               p, interval_stores, stores, interval_allocated, allocated);
+
+        if (p == 4) {
+            // Coupled dimensions are out of scope, so nothing should change.
+            if (stores != interval_stores || allocated != interval_allocated ||
+                stores != (W + H - 1) * H) {
+                printf("Precise bounds changed the region of f for a shear\n");
+                return -1;
+            }
+            continue;
+        }
+
+        if (stores >= interval_stores || allocated >= interval_allocated) {
+            printf("Precise bounds didn't shrink the region of f\n");
+            return -1;
+        }
+        // Pipeline 2 never uses the last row of f.
+        int expected = (p == 2) ? W * (H - 1) : W * H;
+        if (stores != expected || allocated != expected) {
+            printf("Precise bounds should have computed and allocated exactly %d values of f\n", expected);
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,131 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+// Count the heap allocations made by the pipeline that are big enough
+// to hold one of its intermediate buffers, and track the peak number
+// of bytes allocated at once.
+size_t min_counted_bytes = 0;
+int big_allocations = 0;
+size_t live_bytes = 0, peak_bytes = 0;
+
+extern "C" {
+    void *my_malloc(void *ctx, size_t sz) {
+        if (sz >= min_counted_bytes) big_allocations++;
+        live_bytes += sz;
+        if (live_bytes > peak_bytes) peak_bytes = live_bytes;
+        void *orig = malloc(sz + 64);
+        void *ptr = (void *)((((size_t)orig + 64) >> 5) << 5);
+        ((void **)ptr)[-1] = orig;
+        ((size_t *)ptr)[-2] = sz;
+        return ptr;
+    }
+
+    void my_free(void *ctx, void *ptr) {
+        live_bytes -= ((size_t *)ptr)[-2];
+        free(((void**)ptr)[-1]);
+    }
+}
+
+void reset_counters() {
+    big_allocations = 0;
+    live_bytes = peak_bytes = 0;
+}
+
+int main(int argc, char **argv) {
+    const int size = 1 << 20;
+    min_counted_bytes = size * sizeof(int);
+
+    {
+        Func f0, f1, f2, f3, out;
+        Var x;
+
+        // A chain of compute_root stages. Each stage is only needed by
+        // the next one, so the buffers of f0 and f2 can share storage, as
+        // can the buffers of f1 and f3.
+        f0(x) = x;
+        f1(x) = f0(x) * 2;
+        f2(x) = f1(x) + 3;
+        f3(x) = f2(x) * 5;
+        out(x) = f3(x) - 7;
+
+        f0.compute_root();
+        f1.compute_root();
+        f2.compute_root();
+        f3.compute_root();
+
+        out.set_custom_allocator(&my_malloc, &my_free);
+
+        reset_counters();
+        Image<int> result = out.realize(size);
+
+        for (int x = 0; x < size; x++) {
+            int correct = (x * 2 + 3) * 5 - 7;
+            if (result(x) != correct) {
+                printf("result(%d) = %d instead of %d\n", x, result(x), correct);
+                return -1;
+            }
+        }
+
+        // Without sharing there would be one allocation per intermediate.
+        if (big_allocations != 2) {
+            printf("The intermediates were stored in %d allocations instead of 2\n",
+                   big_allocations);
+            return -1;
+        }
+
+        // Each buffer is freed after its last use whether or not it
+        // shares storage, so at most two are ever live at once.
+        if (peak_bytes > 2 * min_counted_bytes) {
+            printf("Peak memory use was %d bytes instead of %d\n",
+                   (int)peak_bytes, (int)(2 * min_counted_bytes));
+            return -1;
+        }
+    }
+
+    {
+        Func g0, g1, g2, g3, out;
+        Var x;
+
+        // g0 and g3 are large, and g1 and g2 are a quarter of the
+        // size. g2 could share storage with g0, but then the shared
+        // buffer would be large while g3 is live, which raises the
+        // peak from 1.25 large buffers to 2.
+        g0(x) = x;
+        g1(x) = g0(x * 4);
+        g2(x) = g1(x) + 1;
+        g3(x) = cast<float>(g2(x / 4));
+        out(x) = g3(x);
+
+        g0.compute_root();
+        g1.compute_root();
+        g2.compute_root();
+        g3.compute_root();
+
+        // Constant sizes let the compiler compare the peaks.
+        out.bound(x, 0, size);
+        out.set_custom_allocator(&my_malloc, &my_free);
+
+        reset_counters();
+        Image<float> result = out.realize(size);
+
+        for (int x = 0; x < size; x++) {
+            float correct = (float)((x / 4) * 4 + 1);
+            if (result(x) != correct) {
+                printf("result(%d) = %f instead of %f\n", x, result(x), correct);
+                return -1;
+            }
+        }
+
+        size_t expected = min_counted_bytes + min_counted_bytes / 4;
+        if (peak_bytes > expected) {
+            printf("Peak memory use was %d bytes instead of %d\n",
+                   (int)peak_bytes, (int)expected);
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -27,21 +27,15 @@ vector<job> jobs;
 
 Target target;
 
-void check(const char *op, int vector_width, Expr e) {
-    if (filter) {
-        if (strncmp(op, filter, strlen(filter)) != 0) return;
-    }
-
-    // printf("%s %d\n", op, vector_width);
-
+std::string test_name(const char *op) {
     std::string name = std::string("test_") + op + Internal::unique_name('_');
     for (size_t i = 0; i < name.size(); i++) {
         if (name[i] == '.') name[i] = '_';
     }
-    Func f(name);
-    f(x, y) = e;
-    f.vectorize(x, vector_width);
+    return name;
+}
 
+void add_job(const char *op, Func f) {
     vector<Argument> arg_types;
     arg_types.push_back(Argument("in_f32", Argument::InputBuffer, Int(1), 1));
     arg_types.push_back(Argument("in_f64", Argument::InputBuffer, Int(1), 1));
@@ -62,6 +56,48 @@ void check(const char *op, int vector_width, Expr e) {
     jobs.push_back(j);
 }
 
+void check(const char *op, int vector_width, Expr e) {
+    if (filter) {
+        if (strncmp(op, filter, strlen(filter)) != 0) return;
+    }
+
+    // printf("%s %d\n", op, vector_width);
+
+    Func f(test_name(op));
+    f(x, y) = e;
+    f.vectorize(x, vector_width);
+    add_job(op, f);
+}
+
+// Check a horizontal reduction of vector_width values, as made by
+// vectorizing an associative update across its reduction
+// domain. Each lane of the reduction evaluates e with x replaced by
+// the index of the lane.
+enum ReduceOp {ReduceAdd, ReduceMin, ReduceMax};
+
+void check_reduce(const char *op, int vector_width, ReduceOp reduce, Expr e) {
+    if (filter) {
+        if (strncmp(op, filter, strlen(filter)) != 0) return;
+    }
+
+    Func f(test_name(op));
+    RDom r(0, vector_width);
+    e = Internal::substitute(x.name(), x * vector_width + r, e);
+    Type t = e.type();
+    if (reduce == ReduceAdd) {
+        f(x, y) = Internal::make_zero(t);
+        f(x, y) = f(x, y) + e;
+    } else if (reduce == ReduceMin) {
+        f(x, y) = t.max();
+        f(x, y) = min(f(x, y), e);
+    } else {
+        f(x, y) = t.min();
+        f(x, y) = max(f(x, y), e);
+    }
+    f.update().vectorize(r);
+    add_job(op, f);
+}
+
 void do_job(job &j) {
     const char *op = j.op;
     const char *module = j.module;
@@ -282,6 +318,20 @@ void check_sse_all() {
         check("pmulhuw", 4*w, u16((u32(u16_1) * u32(u16_2))>>16));
         check("pmulhuw", 4*w, u16_1 / 15);
 
+        // The explicit fixed-point ops
+        check("paddsb",  8*w, saturating_add(i8_1, i8_2));
+        check("paddusb", 8*w, saturating_add(u8_1, u8_2));
+        check("psubsb",  8*w, saturating_sub(i8_1, i8_2));
+        check("psubusb", 8*w, saturating_sub(u8_1, u8_2));
+        check("paddsw",  4*w, saturating_add(i16_1, i16_2));
+        check("paddusw", 4*w, saturating_add(u16_1, u16_2));
+        check("psubsw",  4*w, saturating_sub(i16_1, i16_2));
+        check("psubusw", 4*w, saturating_sub(u16_1, u16_2));
+        check("pavgb",   8*w, rounding_halving_add(u8_1, u8_2));
+        check("pavgw",   4*w, rounding_halving_add(u16_1, u16_2));
+        check("pmulhw",  4*w, mul_shift_right(i16_1, i16_2, 16));
+        check("pmulhuw", 4*w, mul_shift_right(u16_1, u16_2, 16));
+
 
         check("cmpeqps", 2*w, select(f32_1 == f32_2, 1.0f, 2.0f));
         check("cmpltps", 2*w, select(f32_1 < f32_2, 1.0f, 2.0f));
@@ -352,6 +402,7 @@ void check_sse_all() {
             check("pabsb", 8*w, abs(i8_1));
             check("pabsw", 4*w, abs(i16_1));
             check("pabsd", 2*w, abs(i32_1));
+            check("pmulhrsw", 4*w, rounding_mul_shift_right(i16_1, i16_2, 15));
         }
     }
 
@@ -369,6 +420,17 @@ void check_sse_all() {
         check("pmaddwd", 8, i32(i16_1) * 3 + i32(i16_2) * 4);
     }
 
+    // Horizontal reductions: dot products of 16-bit values, sums of
+    // bytes, and the min of eight unsigned 16-bit values.
+    for (int w = 1; w <= 2; w++) {
+        check_reduce("pmaddwd", 8*w, ReduceAdd, i32(i16_1) * i32(i16_2));
+        check_reduce("psadbw", 16*w, ReduceAdd, u16(u8_1));
+        check_reduce("psadbw", 16*w, ReduceAdd, i32(u8_1));
+    }
+    if (use_sse41) {
+        check_reduce("phminposuw", 8, ReduceMin, u16_1);
+    }
+
     // llvm doesn't distinguish between signed and unsigned multiplies
     //check("pmuldq", 4, i64(i32_1) * i64(i32_2));
 
@@ -785,6 +847,11 @@ void check_neon_all() {
         check("vhsub.s32", 2*w, (i32_1 - i32_2)/2);
         check("vhsub.u32", 2*w, (u32_1 - u32_2)/2);
 
+        check("vhadd.s8",  8*w, halving_add(i8_1, i8_2));
+        check("vhadd.u16", 4*w, halving_add(u16_1, u16_2));
+        check("vhsub.u8",  8*w, halving_sub(u8_1, u8_2));
+        check("vhsub.s32", 2*w, halving_sub(i32_1, i32_2));
+
         // VLD1     X       -       Load Single-Element Structures
         // dense loads with unknown alignments should use vld1 variants
         check("vld1.8",  8*w, in_i8(x+y));
@@ -976,7 +1043,12 @@ void check_neon_all() {
         // VPADDL   I       -       Pairwise Add Long
         // VPMAX    I, F    -       Pairwise Maximum
         // VPMIN    I, F    -       Pairwise Minimum
-        // We don't do horizontal ops
+        // Horizontal sums start with pairwise adds. We only reduce to
+        // a single value, so there's nothing for vpadal to accumulate.
+        check_reduce("vpadd.i32", 4*w, ReduceAdd, i32_1);
+        check_reduce("vpadd.i16", 8*w, ReduceAdd, i16_1);
+        check_reduce("vpaddl.u8", 16*w, ReduceAdd, u16(u8_1));
+        check_reduce("vpaddl.s16", 8*w, ReduceAdd, i32(i16_1));
 
         // VPOP     X       F, D    Pop from Stack
         // VPUSH    X       F, D    Push to Stack
@@ -1006,11 +1078,18 @@ void check_neon_all() {
         check("vqadd.u8",  8*w,  u8(min(u16(u8_1)  + 17,  max_u8)));
         check("vqadd.u16", 4*w, u16(min(u32(u16_1) + 17, max_u16)));
 
+        check("vqadd.s8",  8*w, saturating_add(i8_1, i8_2));
+        check("vqadd.u16", 4*w, saturating_add(u16_1, u16_2));
+        check("vqadd.s32", 2*w, saturating_add(i32_1, i32_2));
+
         // Can't do larger ones because we only have i32 constants
 
         // VQDMLAL  I       -       Saturating Double Multiply Accumulate Long
         // VQDMLSL  I       -       Saturating Double Multiply Subtract Long
         // VQDMULH  I       -       Saturating Doubling Multiply Returning High Half
+        check("vqdmulh.s16", 4*w, mul_shift_right(i16_1, i16_2, 15));
+        check("vqdmulh.s32", 2*w, mul_shift_right(i32_1, i32_2, 31));
+
         // VQDMULL  I       -       Saturating Doubling Multiply Long
         // Not sure why I'd use these
 
@@ -1033,6 +1112,9 @@ void check_neon_all() {
         check("vqneg.s32", 2*w, -max(i32_1, -max_i32));
 
         // VQRDMULH I       -       Saturating Rounding Doubling Multiply Returning High Half
+        check("vqrdmulh.s16", 4*w, rounding_mul_shift_right(i16_1, i16_2, 15));
+        check("vqrdmulh.s32", 2*w, rounding_mul_shift_right(i32_1, i32_2, 31));
+
         // VQRSHL   I       -       Saturating Rounding Shift Left
         // VQRSHRN  I       -       Saturating Rounding Shift Right Narrow
         // VQRSHRUN I       -       Saturating Rounding Shift Right Unsigned Narrow
@@ -1070,6 +1152,10 @@ void check_neon_all() {
         check("vqsub.u16", 4*w, u16(clamp(i32(u16_1) - i32(u16_2), 0, max_u16)));
         check("vqsub.u32", 2*w, u32(clamp(i64(u32_1) - i64(u32_2), 0, max_u32)));
 
+        check("vqsub.u8",  8*w, saturating_sub(u8_1, u8_2));
+        check("vqsub.s16", 4*w, saturating_sub(i16_1, i16_2));
+        check("vqsub.u32", 2*w, saturating_sub(u32_1, u32_2));
+
         // VRADDHN  I       -       Rounding Add and Narrow Returning High Half
         /* No rounding ops
            check("vraddhn.i16", 8, i8((i16_1 + i16_2 + 128)/256));
@@ -1102,8 +1188,14 @@ void check_neon_all() {
         check("vrhadd.s32", 2*w, i32((i64(i32_1) + i64(i32_2) + 1)/2));
         check("vrhadd.u32", 2*w, u32((u64(u32_1) + u64(u32_2) + 1)/2));
 
+        check("vrhadd.u8",  8*w, rounding_halving_add(u8_1, u8_2));
+        check("vrhadd.s16", 4*w, rounding_halving_add(i16_1, i16_2));
+        check("vrhadd.u32", 2*w, rounding_halving_add(u32_1, u32_2));
+
         // VRSHL    I       -       Rounding Shift Left
         // VRSHR    I       -       Rounding Shift Right
+        check("vrshl.s16", 4*w, rounding_shift_right(i16_1, i16_2));
+        check("vrshl.u8",  8*w, rounding_shift_right(u8_1, u8_2));
         // VRSHRN   I       -       Rounding Shift Right Narrow
         // We use the non-rounding forms of these
 
@@ -1320,6 +1412,206 @@ void check_neon_all() {
     // halide.
 }
 
+// AArch64 has mostly the same instructions as 32-bit ARM, but with
+// different mnemonics, and some new ones. These are checked by cross
+// compiling, so they can be run on any host with
+// HL_TARGET=arm-64-linux.
+void check_aarch64_all() {
+    ImageParam in_f32(Float(32), 1, "in_f32");
+    ImageParam in_f64(Float(64), 1, "in_f64");
+    ImageParam in_i8(Int(8), 1, "in_i8");
+    ImageParam in_u8(UInt(8), 1, "in_u8");
+    ImageParam in_i16(Int(16), 1, "in_i16");
+    ImageParam in_u16(UInt(16), 1, "in_u16");
+    ImageParam in_i32(Int(32), 1, "in_i32");
+    ImageParam in_u32(UInt(32), 1, "in_u32");
+    ImageParam in_i64(Int(64), 1, "in_i64");
+    ImageParam in_u64(UInt(64), 1, "in_u64");
+
+    Expr f64_1 = in_f64(x), f64_2 = in_f64(x+16);
+    Expr f32_1 = in_f32(x), f32_2 = in_f32(x+16);
+    Expr i8_1  = in_i8(x),  i8_2  = in_i8(x+16),  i8_3  = in_i8(x+32);
+    Expr u8_1  = in_u8(x),  u8_2  = in_u8(x+16),  u8_3  = in_u8(x+32);
+    Expr i16_1 = in_i16(x), i16_2 = in_i16(x+16), i16_3 = in_i16(x+32);
+    Expr u16_1 = in_u16(x), u16_2 = in_u16(x+16), u16_3 = in_u16(x+32);
+    Expr i32_1 = in_i32(x), i32_2 = in_i32(x+16), i32_3 = in_i32(x+32);
+    Expr u32_1 = in_u32(x), u32_2 = in_u32(x+16), u32_3 = in_u32(x+32);
+    Expr i64_1 = in_i64(x);
+    Expr u64_1 = in_u64(x);
+
+    const int min_i8 = -128, max_i8 = 127;
+    const int min_i16 = -32768, max_i16 = 32767;
+    const int min_i32 = 0x80000000, max_i32 = 0x7fffffff;
+    const int max_u8 = 255;
+    const int max_u16 = 65535;
+    Expr max_u32 = UInt(32).max();
+
+    // As for 32-bit ARM, try 64, 128, 192, and 256 bits for everything.
+    for (int w = 1; w <= 4; w++) {
+        // Saturating adds and subtracts
+        check("sqadd", 8*w, i8(clamp(i16(i8_1) + i16(i8_2), min_i8, max_i8)));
+        check("sqadd", 4*w, i16(clamp(i32(i16_1) + i32(i16_2), min_i16, max_i16)));
+        check("sqadd", 2*w, saturating_add(i32_1, i32_2));
+        check("uqadd", 8*w, u8(min(u16(u8_1) + u16(u8_2), max_u8)));
+        check("uqadd", 4*w, saturating_add(u16_1, u16_2));
+        check("sqsub", 8*w, i8(clamp(i16(i8_1) - i16(i8_2), min_i8, max_i8)));
+        check("sqsub", 4*w, saturating_sub(i16_1, i16_2));
+        check("uqsub", 8*w, u8(max(i16(u8_1) - i16(u8_2), 0)));
+        check("uqsub", 2*w, saturating_sub(u32_1, u32_2));
+
+        // Halving adds and subtracts
+        check("shadd", 8*w, i8((i16(i8_1) + i16(i8_2))/2));
+        check("shadd", 4*w, (i16_1 + i16_2)/2);
+        check("uhadd", 8*w, u8((u16(u8_1) + u16(u8_2))/2));
+        check("uhadd", 2*w, halving_add(u32_1, u32_2));
+        check("shsub", 4*w, i16((i32(i16_1) - i32(i16_2))/2));
+        check("uhsub", 8*w, halving_sub(u8_1, u8_2));
+        check("srhadd", 8*w, i8((i16(i8_1) + i16(i8_2) + 1)/2));
+        check("urhadd", 4*w, u16((u32(u16_1) + u32(u16_2) + 1)/2));
+        check("urhadd", 8*w, rounding_halving_add(u8_1, u8_2));
+
+        // Saturating narrowing
+        check("sqxtn", 8*w, i8(clamp(i16_1, min_i8, max_i8)));
+        check("sqxtn", 4*w, i16(clamp(i32_1, min_i16, max_i16)));
+        check("sqxtn", 2*w, i32(clamp(i64_1, min_i32, max_i32)));
+        check("uqxtn", 8*w, u8(min(u16_1, max_u8)));
+        check("uqxtn", 2*w, u32(min(u64_1, max_u32)));
+        check("sqxtun", 8*w, u8(clamp(i16_1, 0, max_u8)));
+        check("sqxtun", 4*w, u16(clamp(i32_1, 0, max_u16)));
+
+        // Narrowing shifts, with and without rounding and saturation
+        check("sqshrn", 8*w, i8(clamp(i16_1/16, min_i8, max_i8)));
+        check("sqshrn", 4*w, i16(clamp(i32_1/16, min_i16, max_i16)));
+        check("uqshrn", 8*w, u8(min(u16_1/16, max_u8)));
+        check("sqshrun", 8*w, u8(clamp(i16_1/16, 0, max_u8)));
+        check("rshrn", 8*w, u8(rounding_shift_right(u16_1, 4)));
+        check("rshrn", 4*w, i16(rounding_shift_right(i32_1, 8)));
+        check("sqrshrn", 8*w, i8(clamp(rounding_shift_right(i16_1, 4), min_i8, max_i8)));
+        check("uqrshrn", 8*w, u8(min(rounding_shift_right(u16_1, 4), max_u8)));
+        check("sqrshrun", 4*w, u16(clamp(rounding_shift_right(i32_1, 4), 0, max_u16)));
+
+        // Saturating left shifts
+        check("sqshl", 8*w, i8(clamp(i16(i8_1)*16, min_i8, max_i8)));
+        check("sqshl", 4*w, i16(clamp(i32(i16_1)*16, min_i16, max_i16)));
+        check("uqshl", 8*w, u8(min(u16(u8_1)*16, max_u8)));
+        check("uqshl", 2*w, u32(min(u64(u32_1)*16, max_u32)));
+        check("sqshlu", 8*w, u8(clamp(i16(i8_1)*16, 0, max_u8)));
+
+        // Rounding shifts
+        check("srshl", 4*w, rounding_shift_right(i16_1, i16_2));
+        check("urshl", 8*w, rounding_shift_right(u8_1, u8_2));
+
+        // Widening multiplies and multiply-accumulates
+        check("smull", 8*w, i16(i8_1)*i8_2);
+        check("smull", 4*w, i32(i16_1)*i16_2);
+        check("smull", 2*w, i64(i32_1)*i32_2);
+        check("umull", 8*w, u16(u8_1)*u8_2);
+        check("umull", 4*w, u32(u16_1)*u16_2);
+        check("umull", 2*w, u64(u32_1)*u32_2);
+        check("smlal", 8*w, i16_1 + i16(i8_2)*i8_3);
+        check("smlal", 4*w, i32_1 + i32(i16_2)*i16_3);
+        check("umlal", 8*w, u16_1 + u16(u8_2)*u8_3);
+        check("umlal", 2*w, u64_1 + u64(u32_2)*u32_3);
+
+        // Doubling multiplies returning the high half
+        check("sqdmulh", 4*w, mul_shift_right(i16_1, i16_2, 15));
+        check("sqdmulh", 2*w, mul_shift_right(i32_1, i32_2, 31));
+        check("sqrdmulh", 4*w, rounding_mul_shift_right(i16_1, i16_2, 15));
+        check("sqrdmulh", 2*w, rounding_mul_shift_right(i32_1, i32_2, 31));
+
+        // Absolute differences
+        check("sabd", 8*w, absd(i8_1, i8_2));
+        check("uabd", 4*w, absd(u16_1, u16_2));
+        check("sabd", 2*w, absd(i32_1, i32_2));
+        check("uabdl", 8*w, u16(absd(u8_1, u8_2)));
+        check("uabdl", 4*w, abs(i32(u16_1) - i32(u16_2)));
+
+        // Saturating negation
+        check("sqneg", 8*w, -max(i8_1, -max_i8));
+        check("sqneg", 4*w, -max(i16_1, -max_i16));
+        check("sqneg", 2*w, -max(i32_1, -max_i32));
+
+        // Min and max
+        check("smin", 8*w, min(i8_1, i8_2));
+        check("umin", 4*w, min(u16_1, u16_2));
+        check("smin", 2*w, min(i32_1, i32_2));
+        check("smax", 4*w, max(i16_1, i16_2));
+        check("umax", 8*w, max(u8_1, u8_2));
+        check("umax", 2*w, max(u32_1, u32_2));
+        check("fmin", 2*w, min(f32_1, f32_2));
+        check("fmax", 2*w, max(f32_1, f32_2));
+        check("fmin", w, min(f64_1, f64_2));
+        check("fmax", w, max(f64_1, f64_2));
+
+        // Pairwise adds
+        check("addp", 8*w, in_u8(x*2) + in_u8(x*2+1));
+        check("addp", 4*w, in_i16(x*2) + in_i16(x*2+1));
+        check("addp", 2*w, in_u32(x*2) + in_u32(x*2+1));
+        check("uaddlp", 8*w, u16(in_u8(x*2)) + u16(in_u8(x*2+1)));
+        check("uaddlp", 4*w, u32(in_u16(x*2)) + u32(in_u16(x*2+1)));
+        check("saddlp", 8*w, i16(in_i8(x*2)) + i16(in_i8(x*2+1)));
+        check("saddlp", 2*w, i64(in_i32(x*2)) + i64(in_i32(x*2+1)));
+
+        // Interleaving loads. These use multiplies rather than adds,
+        // which would become pairwise adds.
+        check("ld2", 8*w, in_u8(x*2) * in_u8(x*2+1));
+        check("ld2", 4*w, in_i16(x*2) * in_i16(x*2+1));
+        check("ld2", 2*w, in_f32(x*2) * in_f32(x*2+1));
+        check("ld3", 8*w, in_i8(x*3+y));
+        check("ld3", 4*w, in_u16(x*3+y));
+        check("ld3", 2*w, in_f32(x*3+y));
+        check("ld4", 8*w, in_u8(x*4+y));
+        check("ld4", 2*w, in_i32(x*4+y));
+    }
+
+    // Interleaving stores
+    for (int bits = 8; bits <= 32; bits *= 2) {
+        int width = 128 / bits;
+        for (int n = 2; n <= 4; n++) {
+            Func tmp1, tmp2;
+            tmp1(x) = cast(UInt(bits), x);
+            tmp1.compute_root();
+            Expr e = tmp1(x/n + 16*(n-1));
+            for (int i = n-2; i >= 0; i--) {
+                e = select(x%n == i, tmp1(x/n + 16*i), e);
+            }
+            tmp2(x, y) = e;
+            tmp2.compute_root().vectorize(x, width*n);
+            char *op = (char *)malloc(32);
+            snprintf(op, 32, "st%d", n);
+            check(op, width, tmp2(0, 0) + tmp2(0, 127));
+        }
+    }
+
+    // Horizontal reductions. Those of a whole 64 or 128-bit register
+    // are single across-lane instructions.
+    for (int w = 1; w <= 2; w++) {
+        check_reduce("addv", 8*w, ReduceAdd, i8_1);
+        check_reduce("saddlv", 4*w, ReduceAdd, i32(i16_1));
+        check_reduce("uaddlv", 8*w, ReduceAdd, u16(u8_1));
+        check_reduce("sminv", 4*w, ReduceMin, i16_1);
+        check_reduce("umaxv", 8*w, ReduceMax, u8_1);
+    }
+    check_reduce("addv", 4, ReduceAdd, i32_1);
+    check_reduce("fmaxv", 4, ReduceMax, f32_1);
+    check_reduce("fminv", 4, ReduceMin, f32_1);
+
+    // Wider ones start with pairwise adds, which may widen.
+    check_reduce("addp", 8, ReduceAdd, i32_1);
+    check_reduce("addp", 32, ReduceAdd, u8_1);
+    check_reduce("saddlp", 32, ReduceAdd, i16(i8_1));
+    check_reduce("uaddlp", 32, ReduceAdd, u16(u8_1));
+    check_reduce("saddlp", 16, ReduceAdd, i32(i16_1));
+
+    // Table lookups into a small lookup table
+    for (int w = 1; w <= 4; w++) {
+        Func lut;
+        lut(x) = cast<uint8_t>(x * 17 + 3);
+        lut.compute_root();
+        check("tbl", 8*w, lut(min(u8_1, 15)));
+    }
+}
+
 using std::string;
 
 int main(int argc, char **argv) {
@@ -1342,6 +1634,8 @@ int main(int argc, char **argv) {
     use_sse42 = use_avx;
     if (target.arch == Target::X86) {
         check_sse_all();
+    } else if (target.arch == Target::ARM && target.bits == 64) {
+        check_aarch64_all();
     } else {
         check_neon_all();
     }
@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <atomic>
 #include "Halide.h"
 
 using namespace Halide;
@@ -16,6 +17,13 @@ extern "C" DLLEXPORT int call_counter(int x, int y) {
 }
 HalideExtern_2(int, call_counter, int, int);
 
+std::atomic<int> parallel_count(0);
+extern "C" DLLEXPORT int parallel_call_counter(int x, int y) {
+    parallel_count++;
+    return 0;
+}
+HalideExtern_2(int, parallel_call_counter, int, int);
+
 extern "C" void *my_malloc(void *, size_t x) {
     printf("Malloc wasn't supposed to be called!\n");
     exit(-1);
@@ -101,6 +109,23 @@ int main(int argc, char **argv) {
     g5.set_custom_allocator(&my_malloc, &my_free);
     Image<int> im5 = g5.realize(10, 10);
 
+    // Sliding over a parallel loop. Each parallel strip of g6 should
+    // warm up its own window of f6 and then slide, so only the two
+    // rows of warm up per strip get computed redundantly.
+    Func f6("f6"), g6("g6");
+    f6(x, y) = parallel_call_counter(x, y);
+    g6(x, y) = f6(x, y-1) + f6(x, y) + f6(x, y+1);
+    f6.store_root().compute_at(g6, y);
+    g6.parallel(y);
+
+    Image<int> im6 = g6.realize(10, 1000);
+    // At most 64 strips.
+    if (parallel_count > (1000 + 64*2)*10) {
+        printf("f was called %d times instead of at most %d times\n",
+               (int)parallel_count, (1000 + 64*2)*10);
+        return -1;
+    }
+
     printf("Success!\n");
     return 0;
 }
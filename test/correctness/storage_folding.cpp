@@ -19,6 +19,11 @@ void my_free(void *user_context, void *ptr) {
     free(((void**)ptr)[-1]);
 }
 
+bool error_occurred = false;
+void my_error_handler(void *user_context, const char *msg) {
+    error_occurred = true;
+}
+
 int main(int argc, char **argv) {
     Var x, y;
 
@@ -180,6 +185,132 @@ int main(int argc, char **argv) {
 
     }
 
+    {
+        custom_malloc_size = 0;
+        Func f, g;
+        Param<int> k;
+
+        g(x, y) = x * y;
+        f(x, y) = g(x, y) + g(x, y + k);
+
+        // The vertical footprint of f depends on a parameter. We
+        // should still fold g down to the next power of two above k+1
+        // scanlines.
+        g.store_root().compute_at(f, y);
+
+        f.set_custom_allocator(my_malloc, my_free);
+
+        k.set(5);
+        Image<int> im = f.realize(1000, 1000);
+
+        if (custom_malloc_size == 0 || custom_malloc_size > 1000*8*sizeof(int)) {
+            printf("Scratch space allocated was %d instead of %d\n", (int)custom_malloc_size, (int)(1000*8*sizeof(int)));
+            return -1;
+        }
+
+        for (int y = 0; y < im.height(); y++) {
+            for (int x = 0; x < im.width(); x++) {
+                int correct = x*y + x*(y+5);
+                if (im(x, y) != correct) {
+                    printf("im(%d, %d) = %d instead of %d\n", x, y, im(x, y), correct);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    {
+        custom_malloc_size = 0;
+        Func f, g;
+        ImageParam offsets(Int(32), 1);
+
+        g(x, y) = x * y;
+        f(x, y) = g(x, y + clamp(offsets(x), 0, 2));
+
+        // Explicitly request that g be stored as a circular buffer
+        // of three scanlines (which gets rounded up to four). This is
+        // also the fold Halide would have picked by itself.
+        g.store_root().compute_at(f, y).fold_storage(y, 3);
+
+        f.set_custom_allocator(my_malloc, my_free);
+
+        Image<int> offsets_im(1000);
+        for (int x = 0; x < 1000; x++) {
+            offsets_im(x) = x % 3;
+        }
+        offsets.set(offsets_im);
+
+        Image<int> im = f.realize(1000, 1000);
+
+        if (custom_malloc_size == 0 || custom_malloc_size > 1000*4*sizeof(int)) {
+            printf("Scratch space allocated was %d instead of %d\n", (int)custom_malloc_size, (int)(1000*4*sizeof(int)));
+            return -1;
+        }
+
+        for (int y = 0; y < im.height(); y++) {
+            for (int x = 0; x < im.width(); x++) {
+                int correct = x*(y + x % 3);
+                if (im(x, y) != correct) {
+                    printf("im(%d, %d) = %d instead of %d\n", x, y, im(x, y), correct);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    {
+        custom_malloc_size = 0;
+        Func f, g;
+
+        g(x, y) = x * y;
+        f(x, y) = g(x, y) + g(x, y + y/100);
+
+        // The number of scanlines of g used by each scanline of f
+        // grows with y, so g is only folded because we ask for it.
+        g.store_root().compute_at(f, y).fold_storage(y, 16);
+
+        f.set_custom_allocator(my_malloc, my_free);
+
+        Image<int> im = f.realize(1000, 1000);
+
+        if (custom_malloc_size == 0 || custom_malloc_size > 1000*16*sizeof(int)) {
+            printf("Scratch space allocated was %d instead of %d\n", (int)custom_malloc_size, (int)(1000*16*sizeof(int)));
+            return -1;
+        }
+
+        for (int y = 0; y < im.height(); y++) {
+            for (int x = 0; x < im.width(); x++) {
+                int correct = x*y + x*(y + y/100);
+                if (im(x, y) != correct) {
+                    printf("im(%d, %d) = %d instead of %d\n", x, y, im(x, y), correct);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    {
+        Func f, g;
+
+        g(x, y) = x * y;
+        f(x, y) = g(x, y) + g(x, y + y/100);
+
+        // Up to ten scanlines of g are used by the last scanline of
+        // f, which doesn't fit in a fold of four. Halide can't prove
+        // that ahead of time, so it should be caught at runtime.
+        g.store_root().compute_at(f, y).fold_storage(y, 4);
+
+        f.set_error_handler(my_error_handler);
+
+        error_occurred = false;
+        f.realize(1000, 1000);
+
+        if (!error_occurred) {
+            printf("There should have been an error for a fold factor that is too small\n");
+            return -1;
+        }
+    }
+
     printf("Success!\n");
     return 0;
 }
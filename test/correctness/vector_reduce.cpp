@@ -0,0 +1,97 @@
+#include "Halide.h"
+#include <stdio.h>
+#include <math.h>
+
+using namespace Halide;
+
+const int W = 256, H = 8;
+
+// An update of each row of f with one of several associative
+// reductions over the row.
+template<typename A>
+Func make_reduction(int op, Func in_a, Func in_b, RDom r) {
+    Var y;
+    Type t = type_of<A>();
+    Expr a = cast<A>(in_a(r, y)), b = cast<A>(in_b(r, y));
+    Func f;
+    switch (op) {
+    case 0:
+        f(y) = cast<A>(0);
+        f(y) += a;
+        break;
+    case 1:
+        f(y) = cast<A>(0);
+        f(y) += a * b;
+        break;
+    case 2:
+        f(y) = cast<A>(0);
+        f(y) -= a;
+        break;
+    case 3:
+        f(y) = t.max();
+        f(y) = min(f(y), a);
+        break;
+    case 4:
+        f(y) = t.min();
+        f(y) = max(b, f(y));
+        break;
+    case 5:
+        // The repeated subexpression gets pulled out into a let.
+        f(y) = cast<A>(0);
+        f(y) += a * a;
+        break;
+    }
+    return f;
+}
+
+// Check that vectorizing the RVar of an associative update gives the
+// same answer as the serial reduction.
+template<typename T, typename A>
+bool test(const char *name) {
+    Image<T> in_a(W, H), in_b(W, H);
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            in_a(x, y) = (T)(rand() % 64 - (type_of<T>().is_uint() ? 0 : 32));
+            in_b(x, y) = (T)(rand() % 64 - (type_of<T>().is_uint() ? 0 : 32));
+        }
+    }
+
+    Var x, y;
+    Func a, b;
+    a(x, y) = in_a(x, y);
+    b(x, y) = in_b(x, y);
+    RDom r(0, W);
+
+    for (int op = 0; op < 6; op++) {
+        Image<A> correct = make_reduction<A>(op, a, b, r).realize(H);
+
+        for (int width = 4; width <= 32; width *= 2) {
+            Func f = make_reduction<A>(op, a, b, r);
+            f.update().vectorize(r, width);
+            Image<A> out = f.realize(H);
+
+            for (int i = 0; i < H; i++) {
+                // Float sums get reassociated, so allow a little slop.
+                double error = fabs((double)out(i) - (double)correct(i));
+                if (error > 1e-5 * fabs((double)correct(i))) {
+                    printf("%s op %d (vectorized by %d): f(%d) = %f instead of %f\n",
+                           name, op, width, i, (double)out(i), (double)correct(i));
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (!test<uint8_t, uint32_t>("uint8 -> uint32")) return -1;
+    if (!test<uint8_t, uint16_t>("uint8 -> uint16")) return -1;
+    if (!test<int16_t, int32_t>("int16 -> int32")) return -1;
+    if (!test<int32_t, int32_t>("int32")) return -1;
+    if (!test<float, float>("float")) return -1;
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,23 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    // Pipeline inputs are passed as buffer_t, which can't describe a
+    // fifth dimension.
+    ImageParam in(Int(32), 5);
+    Var x;
+
+    std::vector<Expr> coords(5, 0);
+    coords[0] = x;
+
+    Func f;
+    f(x) = in(coords);
+
+    f.compile_jit();
+
+    printf("I should not have reached here\n");
+
+    return 0;
+}
@@ -0,0 +1,24 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    Func f("f"), g("g");
+    Var x("x"), y("y");
+
+    g(x, y) = x * y;
+
+    // The extern stage gets g's buffer_t, and indexes it as if it
+    // weren't folded.
+    std::vector<ExternFuncArgument> args;
+    args.push_back(g);
+    f.define_extern("extern_stage", args, Int(32), 2);
+
+    g.compute_root().fold_storage(y, 4);
+
+    f.compile_jit();
+
+    printf("I should not have reached here\n");
+    return 0;
+}
@@ -0,0 +1,21 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    Func f("f"), g("g");
+    Var x("x"), y("y");
+
+    g(x, y) = x * y;
+    f(x, y) = g(x, y) + g(x, y + 2);
+
+    // Each scanline of f uses three scanlines of g, which can never
+    // fit in a fold of two.
+    g.store_root().compute_at(f, y).fold_storage(y, 2);
+
+    f.realize(10, 10);
+
+    printf("I should not have reached here\n");
+    return 0;
+}
@@ -0,0 +1,18 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    Func f("f");
+    Var x("x");
+
+    // The product of two 16-bit values has 32 bits, so it can't be
+    // shifted right by 32.
+    f(x) = rounding_mul_shift_right(cast<int16_t>(x), cast<int16_t>(x), 32);
+
+    f.realize(10);
+
+    printf("I should not have reached here\n");
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include "HalideRuntime.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "batched.h"
+#include "static_image.h"
+
+static int errors = 0;
+
+extern "C" void halide_error(void *user_context, const char *msg) {
+    errors++;
+}
+
+const int num_items = 37;
+
+int main(int argc, char **argv) {
+    std::vector<Image<uint8_t> > inputs;
+    std::vector<Image<int32_t> > outputs;
+    std::vector<int32_t> offsets(num_items);
+    std::vector<std::vector<void *> > args(num_items);
+    std::vector<void **> item_args(num_items);
+
+    // Items of different sizes, like a batch of thumbnails.
+    for (int i = 0; i < num_items; i++) {
+        int w = 8 + (i * 7) % 29, h = 4 + (i * 5) % 17;
+        Image<uint8_t> in(w, h);
+        for (int y = 0; y < h; y++) {
+            for (int x = 0; x < w; x++) {
+                in(x, y) = (uint8_t)(x + y * 3 + i);
+            }
+        }
+        inputs.push_back(in);
+        outputs.push_back(Image<int32_t>(w, h));
+        offsets[i] = i * 1000;
+    }
+    for (int i = 0; i < num_items; i++) {
+        args[i].push_back((buffer_t *)inputs[i]);
+        args[i].push_back(&offsets[i]);
+        args[i].push_back((buffer_t *)outputs[i]);
+        item_args[i] = &args[i][0];
+    }
+
+    int result = halide_call_argv_batched(NULL, batched_argv, num_items, &item_args[0]);
+    if (result != 0) {
+        fprintf(stderr, "Result: %d\n", result);
+        exit(-1);
+    }
+
+    for (int i = 0; i < num_items; i++) {
+        const Image<uint8_t> &in = inputs[i];
+        const Image<int32_t> &out = outputs[i];
+        for (int y = 0; y < in.height(); y++) {
+            for (int x = 0; x < in.width(); x++) {
+                int32_t correct = in(x, y) * 2 + offsets[i];
+                if (out(x, y) != correct) {
+                    fprintf(stderr, "Item %d: out(%d, %d) = %d instead of %d\n",
+                            i, x, y, out(x, y), correct);
+                    exit(-1);
+                }
+            }
+        }
+    }
+
+    // A failing item fails the batch, without stopping the others.
+    Image<uint16_t> wrong_type(8, 8);
+    args[5][0] = (buffer_t *)wrong_type;
+    for (int i = 0; i < num_items; i++) {
+        for (int y = 0; y < outputs[i].height(); y++) {
+            for (int x = 0; x < outputs[i].width(); x++) {
+                outputs[i](x, y) = -1;
+            }
+        }
+    }
+    result = halide_call_argv_batched(NULL, batched_argv, num_items, &item_args[0]);
+    if (result == 0 || errors != 1) {
+        fprintf(stderr, "Expected exactly one item to fail (result = %d, errors = %d)\n", result, errors);
+        exit(-1);
+    }
+    if (outputs[4](0, 0) != inputs[4](0, 0) * 2 + offsets[4] || outputs[5](0, 0) != -1) {
+        fprintf(stderr, "The other items should still have run\n");
+        exit(-1);
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,25 @@
+#include "Halide.h"
+
+namespace {
+
+class Batched : public Halide::Generator<Batched> {
+public:
+    ImageParam input{ UInt(8), 2, "input" };
+    Param<int32_t> offset{ "offset", 0 };
+
+    Func build() override {
+        Var x, y;
+
+        Func f;
+        f(x, y) = cast<int32_t>(input(x, y)) * 2 + offset;
+
+        // A parallel loop inside each item, which nests inside the
+        // parallel loop over items.
+        f.parallel(y);
+        return f;
+    }
+};
+
+Halide::RegisterGenerator<Batched> register_my_gen{"batched"};
+
+}  // namespace
@@ -0,0 +1,128 @@
+#include "HalideRuntime.h"
+
+#include <atomic>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "extern_tiles.h"
+#include "static_image.h"
+
+const int W = 100, H = 50;
+const int tile_w = 32, tile_h = 16, strip_h = 4;
+
+std::atomic<int> tiles(0), strips(0);
+std::atomic<bool> bad_tile(false), bad_input(false);
+
+float input_value(int x, int y) {
+    return (float)(x * 3 + y * 100);
+}
+
+struct blur_context {
+    const buffer_t *in;
+};
+
+int blur_strip(void *user_context, void *task_context, buffer_t *out) {
+    const buffer_t *in = ((blur_context *)task_context)->in;
+    strips++;
+    // Only the tiles at the bottom, which are clipped to fewer rows
+    // than a strip, have strips shorter than strip_h.
+    if (out->extent[1] != strip_h && out->extent[1] != H % tile_h) {
+        bad_tile = true;
+    }
+    for (int y = out->min[1]; y < out->min[1] + out->extent[1]; y++) {
+        for (int x = out->min[0]; x < out->min[0] + out->extent[0]; x++) {
+            float sum = 0;
+            for (int dx = -1; dx <= 1; dx++) {
+                int i = (x + dx - in->min[0]) * in->stride[0] + (y - in->min[1]) * in->stride[1];
+                sum += ((const float *)in->host)[i];
+            }
+            int o = (x - out->min[0]) * out->stride[0] + (y - out->min[1]) * out->stride[1];
+            ((float *)out->host)[o] = sum;
+        }
+    }
+    return 0;
+}
+
+extern "C" int extern_tiles_blur(buffer_t *in, buffer_t *out) {
+    if (in->host == NULL) {
+        // Bounds query: we need one extra column on each side.
+        in->min[0] = out->min[0] - 1;
+        in->extent[0] = out->extent[0] + 2;
+        in->min[1] = out->min[1];
+        in->extent[1] = out->extent[1];
+        return 0;
+    }
+
+    tiles++;
+    // The tiles are shifted inwards in x, so they're all exactly
+    // tile_w wide, and clipped in y.
+    if (out->extent[0] != tile_w || out->extent[1] > tile_h ||
+        out->min[0] < 0 || out->min[1] < 0 ||
+        out->min[0] + out->extent[0] > W || out->min[1] + out->extent[1] > H) {
+        bad_tile = true;
+    }
+
+    // The input is computed per tile, so it should cover just what
+    // the bounds query asked for above.
+    if (in->min[0] != out->min[0] - 1 || in->extent[0] != out->extent[0] + 2 ||
+        in->min[1] != out->min[1] || in->extent[1] != out->extent[1]) {
+        bad_input = true;
+    }
+
+    // Split the tile again into strips of rows, which nest within
+    // the parallel loop over the tiles.
+    blur_context context = {in};
+    return halide_do_par_for_strips(NULL, blur_strip, out, 1, strip_h, &context);
+}
+
+int main(int argc, char **argv) {
+    Image<float> input(W + 2, H);
+    input.set_min(-1, 0);
+    for (int y = 0; y < H; y++) {
+        for (int x = -1; x < W + 1; x++) {
+            input(x, y) = input_value(x, y);
+        }
+    }
+
+    Image<float> output(W, H);
+    int result = extern_tiles(input, output);
+    if (result != 0) {
+        fprintf(stderr, "Result: %d\n", result);
+        exit(-1);
+    }
+
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            float correct = 2 * (input_value(x - 1, y) + input_value(x, y) + input_value(x + 1, y) + 3);
+            if (output(x, y) != correct) {
+                fprintf(stderr, "output(%d, %d) = %f instead of %f\n", x, y, output(x, y), correct);
+                exit(-1);
+            }
+        }
+    }
+
+    // One call per tile.
+    int expected_tiles = ((W + tile_w - 1) / tile_w) * ((H + tile_h - 1) / tile_h);
+    if (tiles != expected_tiles || bad_tile) {
+        fprintf(stderr, "Extern stage was called for %d tiles instead of %d%s\n",
+                (int)tiles, expected_tiles, bad_tile ? ", and some were the wrong shape" : "");
+        exit(-1);
+    }
+
+    if (bad_input) {
+        fprintf(stderr, "The input to the extern stage wasn't narrowed to each tile\n");
+        exit(-1);
+    }
+
+    // Each tile is 16 rows (or the 2 left over at the bottom), split
+    // into strips of 4 rows.
+    int strips_per_column = (H / tile_h) * (tile_h / strip_h) + ((H % tile_h) + strip_h - 1) / strip_h;
+    int expected_strips = strips_per_column * ((W + tile_w - 1) / tile_w);
+    if (strips != expected_strips) {
+        fprintf(stderr, "Extern stage computed %d strips instead of %d\n", (int)strips, expected_strips);
+        exit(-1);
+    }
+
+    printf("Success!\n");
+    return 0;
+}
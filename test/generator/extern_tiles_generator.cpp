@@ -0,0 +1,36 @@
+#include "Halide.h"
+
+namespace {
+
+class ExternTiles : public Halide::Generator<ExternTiles> {
+public:
+    ImageParam input{ Float(32), 2, "input" };
+
+    Func build() override {
+        Var x, y, xi, yi;
+
+        // A blur implemented outside of Halide (in
+        // extern_tiles_aottest.cpp), called once per 32x16 tile, with
+        // the tiles spread across the thread pool. Vectorizing xi
+        // makes every tile exactly 32 wide. The input to the blur is
+        // computed per tile, for just the region that tile needs.
+        Func brighter;
+        brighter(x, y) = input(x, y) + 1.0f;
+
+        Func blur;
+        blur.define_extern("extern_tiles_blur", {brighter}, Float(32), {x, y});
+        blur.compute_root()
+            .tile(x, y, xi, yi, 32, 16)
+            .vectorize(xi)
+            .parallel(y);
+        brighter.compute_at(blur, x);
+
+        Func f;
+        f(x, y) = blur(x, y) * 2.0f;
+        return f;
+    }
+};
+
+Halide::RegisterGenerator<ExternTiles> register_my_gen{"extern_tiles"};
+
+}  // namespace
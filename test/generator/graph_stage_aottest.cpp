@@ -0,0 +1,90 @@
+#include "HalideRuntime.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "graph_stage.h"
+#include "static_image.h"
+#include "filter_graph.h"
+
+static int errors = 0;
+
+extern "C" void halide_error(void *user_context, const char *msg) {
+    errors++;
+}
+
+const int W = 50, H = 30;
+
+int input_value(int x, int y) {
+    return x * 3 + y * 100;
+}
+
+int stage(int a, int b, int bias) {
+    return a + b * 2 + bias;
+}
+
+int main(int argc, char **argv) {
+    // The input covers everything the graph reads from it.
+    Image<int32_t> input(W + 8, H + 8);
+    input.set_min(-4, -4);
+    for (int y = -4; y < H + 4; y++) {
+        for (int x = -4; x < W + 4; x++) {
+            input(x, y) = input_value(x, y);
+        }
+    }
+
+    // Two independent stages feeding a third.
+    int32_t bias[] = {1, 2, 3};
+    FilterGraph graph;
+    int n0 = graph.add("graph_stage");
+    int n1 = graph.add("graph_stage");
+    int n2 = graph.add("graph_stage");
+    if (n0 < 0 || n1 < 0 || n2 < 0) {
+        fprintf(stderr, "graph_stage is not registered\n");
+        exit(-1);
+    }
+    graph.bind_input(n0, "a", input);
+    graph.bind_input(n0, "b", input);
+    graph.bind_input(n1, "a", input);
+    graph.bind_input(n1, "b", input);
+    graph.connect(n0, n2, "a");
+    graph.connect(n1, n2, "b");
+    graph.bind_scalar(n0, "bias", &bias[0]);
+    graph.bind_scalar(n1, "bias", &bias[1]);
+    graph.bind_scalar(n2, "bias", &bias[2]);
+    graph.set_tile_extent(16, 8);
+
+    Image<int32_t> output(W, H);
+    int result = graph.run(output);
+    if (result != 0 || errors != 0) {
+        fprintf(stderr, "Result: %d\n", result);
+        exit(-1);
+    }
+
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            int n0_value = stage(input_value(x - 2, y), input_value(x - 1, y + 1), bias[0]);
+            int n1_value = stage(input_value(x - 1, y + 1), input_value(x, y + 2), bias[1]);
+            int correct = stage(n0_value, n1_value, bias[2]);
+            if (output(x, y) != correct) {
+                fprintf(stderr, "output(%d, %d) = %d instead of %d\n", x, y, output(x, y), correct);
+                exit(-1);
+            }
+        }
+    }
+
+    // Mistakes in building the graph are reported.
+    if (graph.add("no_such_filter") != -1 || errors != 1) {
+        fprintf(stderr, "Expected an error for an unknown filter\n");
+        exit(-1);
+    }
+    FilterGraph unbound;
+    unbound.add("graph_stage");
+    if (unbound.run(output) == 0 || errors != 2) {
+        fprintf(stderr, "Expected an error for unbound arguments\n");
+        exit(-1);
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,25 @@
+#include "Halide.h"
+
+namespace {
+
+class GraphStage : public Halide::Generator<GraphStage> {
+public:
+    ImageParam a{ Int(32), 2, "a" };
+    ImageParam b{ Int(32), 2, "b" };
+    Param<int32_t> bias{ "bias", 0 };
+
+    Func build() override {
+        Var x, y;
+
+        // Reads its inputs at different offsets, so that the regions
+        // of a and b each tile needs differ from the tile.
+        Func f;
+        f(x, y) = a(x - 1, y) + b(x, y + 1) * 2 + bias;
+        f.parallel(y);
+        return f;
+    }
+};
+
+Halide::RegisterGenerator<GraphStage> register_my_gen{"graph_stage"};
+
+}  // namespace
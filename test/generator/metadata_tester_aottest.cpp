@@ -453,6 +453,62 @@ int main(int argc, char **argv) {
 
     verify(input, output0, output1);
 
+    // Call the argv entry point with halide_buffer_t in place of buffer_t.
+    {
+        Image<float> output0(kSize, kSize, 3);
+        Image<float> output1(kSize, kSize, 3);
+
+        const halide_type_t u8_type = { halide_type_uint, 8, 1 };
+        const halide_type_t f32_type = { halide_type_float, 32, 1 };
+        halide_dimension_t input_dim[3], output0_dim[3], output1_dim[3];
+        halide_buffer_t input_buf, output0_buf, output1_buf;
+        input_buf.dim = input_dim;
+        output0_buf.dim = output0_dim;
+        output1_buf.dim = output1_dim;
+        EXPECT_EQ(0, halide_buffer_from_buffer_t(user_context, input, u8_type, 3, &input_buf));
+        EXPECT_EQ(0, halide_buffer_from_buffer_t(user_context, output0, f32_type, 3, &output0_buf));
+        EXPECT_EQ(0, halide_buffer_from_buffer_t(user_context, output1, f32_type, 3, &output1_buf));
+        // The element size doesn't match the type.
+        halide_buffer_t bad_buf;
+        bad_buf.dim = input_dim;
+        EXPECT_EQ(halide_error_code_bad_elem_size, halide_buffer_from_buffer_t(user_context, input, f32_type, 3, &bad_buf));
+        // buffer_t can't describe more than four dimensions.
+        buffer_t legacy;
+        bad_buf = input_buf;
+        bad_buf.dimensions = 5;
+        EXPECT_EQ(halide_error_code_bad_dimensions, halide_buffer_to_buffer_t(user_context, &bad_buf, &legacy));
+
+        bool b = false;
+        int8_t i8 = 0;
+        int16_t i16 = 0;
+        int32_t i32 = 0;
+        int64_t i64 = 0;
+        uint8_t u8 = 0;
+        uint16_t u16 = 0;
+        uint32_t u32 = 0;
+        uint64_t u64 = 0;
+        float f32 = 0.f;
+        double f64 = 0.0;
+        void *h = NULL;
+        void *args[15] = { &input_buf, &b, &i8, &i16, &i32, &i64, &u8, &u16, &u32, &u64,
+                           &f32, &f64, &h, &output0_buf, &output1_buf };
+        result = halide_call_argv_with_halide_buffers(user_context, metadata_tester_argv,
+                                                      &metadata_tester_metadata, args);
+        EXPECT_EQ(0, result);
+        verify(input, output0, output1);
+
+        // Type and dimensionality are checked against the metadata.
+        input_buf.type = f32_type;
+        result = halide_call_argv_with_halide_buffers(user_context, metadata_tester_argv,
+                                                      &metadata_tester_metadata, args);
+        EXPECT_EQ(halide_error_code_bad_type, result);
+        input_buf.type = u8_type;
+        input_buf.dimensions = 2;
+        result = halide_call_argv_with_halide_buffers(user_context, metadata_tester_argv,
+                                                      &metadata_tester_metadata, args);
+        EXPECT_EQ(halide_error_code_bad_dimensions, result);
+    }
+
     check_metadata(metadata_tester_metadata, false);
     if (!strcmp(metadata_tester_metadata.name, "metadata_tester_metadata")) {
         fprintf(stderr, "Expected name %s\n", "metadata_tester_metadata");
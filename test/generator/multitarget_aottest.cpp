@@ -0,0 +1,102 @@
+#include "HalideRuntime.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "multitarget.h"
+#include "static_image.h"
+
+// The variants differ only in x86 features. Elsewhere, multitarget is
+// built for the host alone and there's nothing to test.
+#if defined(__x86_64__) || defined(_M_X64)
+
+// The indices of these in Target::Feature.
+const uint64_t sse41_mask = 1ULL << 4;
+const uint64_t avx2_mask = (1ULL << 4) | (1ULL << 5) | (1ULL << 6);
+
+// Override the runtime's cpu feature check, so that we can see which
+// variants get considered and force the fallback.
+static bool force_fallback = false;
+static int queries = 0;
+static uint64_t first_query = 0;
+
+extern "C" int halide_can_use_target_features(uint64_t features) {
+    if (queries++ == 0) {
+        first_query = features;
+    }
+    if (force_fallback) {
+        return 0;
+    }
+    if ((features & avx2_mask) == avx2_mask) {
+        return __builtin_cpu_supports("avx2");
+    }
+    if (features & sse41_mask) {
+        return __builtin_cpu_supports("sse4.1");
+    }
+    return 1;
+}
+
+const int W = 67, H = 13;
+
+bool run_and_check(const Image<uint16_t> &input) {
+    Image<uint32_t> output(W, H);
+    queries = 0;
+    int result = multitarget(input, output);
+    if (result != 0) {
+        fprintf(stderr, "Result: %d\n", result);
+        return false;
+    }
+    if (queries == 0 || first_query != avx2_mask) {
+        fprintf(stderr, "Expected the avx2 variant to be considered first (queries = %d, features = %llx)\n",
+                queries, (unsigned long long)first_query);
+        return false;
+    }
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            uint32_t correct = (uint32_t)input(x, y) * input(x, y) + 1;
+            if (output(x, y) != correct) {
+                fprintf(stderr, "output(%d, %d) = %u instead of %u\n", x, y, output(x, y), correct);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    Image<uint16_t> input(W, H);
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            input(x, y) = (uint16_t)rand();
+        }
+    }
+
+    // Use the best variant the host can run.
+    force_fallback = false;
+    if (!run_and_check(input)) {
+        return -1;
+    }
+
+    // Every check fails, so the fallback gets used.
+    force_fallback = true;
+    if (!run_and_check(input)) {
+        return -1;
+    }
+    if (queries != 2) {
+        fprintf(stderr, "Expected both variants to be considered before the fallback, not %d\n", queries);
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
+
+#else
+
+int main(int argc, char **argv) {
+    printf("Skipping test: multitarget is only built with several variants on x86-64 hosts\n");
+    printf("Success!\n");
+    return 0;
+}
+
+#endif
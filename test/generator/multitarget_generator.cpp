@@ -0,0 +1,24 @@
+#include "Halide.h"
+
+namespace {
+
+class Multitarget : public Halide::Generator<Multitarget> {
+public:
+    ImageParam input{ UInt(16), 2, "input" };
+
+    Func build() override {
+        Var x, y;
+
+        Func f;
+        f(x, y) = cast<uint32_t>(input(x, y)) * input(x, y) + 1;
+
+        // The vector width depends on the target, so each variant is
+        // scheduled differently.
+        f.vectorize(x, natural_vector_size<uint32_t>());
+        return f;
+    }
+};
+
+Halide::RegisterGenerator<Multitarget> register_my_gen{"multitarget"};
+
+}  // namespace
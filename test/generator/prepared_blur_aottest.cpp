@@ -0,0 +1,122 @@
+#include "HalideRuntime.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "prepared_blur.h"
+#include "static_image.h"
+
+static int errors = 0;
+static int mallocs = 0;
+
+extern "C" void halide_error(void *user_context, const char *msg) {
+    errors++;
+}
+
+extern "C" void *halide_malloc(void *user_context, size_t size) {
+    mallocs++;
+    // The runtime relies on 32-byte alignment.
+    void *orig = malloc(size + 40);
+    void *ptr = (void *)((((size_t)orig + 32) >> 5) << 5);
+    ((void **)ptr)[-1] = orig;
+    return ptr;
+}
+
+extern "C" void halide_free(void *user_context, void *ptr) {
+    free(((void **)ptr)[-1]);
+}
+
+Image<float> make_input(int w, int h, int seed) {
+    Image<float> im(w, h);
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            im(x, y) = (float)((x * 7 + y * 13 + seed) % 101);
+        }
+    }
+    return im;
+}
+
+bool check(const Image<float> &in, float scale, const Image<float> &out) {
+    for (int y = 0; y < out.height(); y++) {
+        for (int x = 0; x < out.width(); x++) {
+            float correct = 0;
+            for (int dy = 0; dy < 2; dy++) {
+                correct += (in(x, y + dy) + in(x + 1, y + dy) + in(x + 2, y + dy)) * scale;
+            }
+            if (fabs(out(x, y) - correct) > 0.001f) {
+                printf("out(%d, %d) = %f instead of %f\n", x, y, out(x, y), correct);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    const int W = 200, H = 100;
+    Image<float> in_a = make_input(W + 2, H + 1, 0), in_b = make_input(W + 2, H + 1, 1);
+    Image<float> out_a(W, H), out_b(W, H);
+    float scale = 0.5f;
+
+    void *args[] = {(buffer_t *)in_a, &scale, (buffer_t *)out_a};
+    halide_prepared_pipeline_t *pipeline = NULL;
+    int result = halide_prepare_pipeline(NULL, prepared_blur_prepared_argv,
+                                         &prepared_blur_prepared_metadata, args, &pipeline);
+    if (result != 0 || !check(in_a, scale, out_a)) {
+        printf("halide_prepare_pipeline failed: %d\n", result);
+        return -1;
+    }
+
+    // Calls with the same shapes, but different data, don't allocate.
+    int mallocs_after_prepare = mallocs;
+    for (int i = 0; i < 10; i++) {
+        Image<float> &in = (i & 1) ? in_b : in_a;
+        Image<float> &out = (i & 1) ? out_b : out_a;
+        args[0] = (buffer_t *)in;
+        args[2] = (buffer_t *)out;
+        result = halide_run_prepared_pipeline(NULL, pipeline, args);
+        if (result != 0 || !check(in, scale, out)) {
+            printf("halide_run_prepared_pipeline failed: %d\n", result);
+            return -1;
+        }
+    }
+    if (mallocs != mallocs_after_prepare) {
+        printf("Reusing the prepared pipeline called halide_malloc %d times\n",
+               mallocs - mallocs_after_prepare);
+        return -1;
+    }
+
+    // A new shape or parameter value falls back to checking everything.
+    Image<float> out_small(W / 2, H / 3);
+    scale = 2.0f;
+    args[0] = (buffer_t *)in_a;
+    args[2] = (buffer_t *)out_small;
+    result = halide_run_prepared_pipeline(NULL, pipeline, args);
+    if (result != 0 || !check(in_a, scale, out_small)) {
+        printf("Running with a new shape failed: %d\n", result);
+        return -1;
+    }
+
+    // So an output that needs more of the input than there is gets
+    // caught.
+    Image<float> out_big(W + 1, H);
+    args[2] = (buffer_t *)out_big;
+    result = halide_run_prepared_pipeline(NULL, pipeline, args);
+    if (result == 0 || errors != 1) {
+        printf("Expected an out of bounds error: %d %d\n", result, errors);
+        return -1;
+    }
+
+    // The regular entry point still works as before.
+    result = prepared_blur(in_b, scale, out_a);
+    if (result != 0 || !check(in_b, scale, out_a)) {
+        printf("prepared_blur failed: %d\n", result);
+        return -1;
+    }
+
+    halide_release_prepared_pipeline(NULL, pipeline);
+
+    printf("Success!\n");
+    return 0;
+}
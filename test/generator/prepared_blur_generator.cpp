@@ -0,0 +1,28 @@
+#include "Halide.h"
+
+namespace {
+
+class PreparedBlur : public Halide::Generator<PreparedBlur> {
+public:
+    ImageParam input{ Float(32), 2, "input" };
+    Param<float> scale{ "scale", 1.0f };
+
+    Func build() override {
+        Var x, y;
+
+        // blur_x is too big for the stack, so it's allocated on the
+        // heap, outside of the parallel loops.
+        Func blur_x;
+        blur_x(x, y) = (input(x, y) + input(x + 1, y) + input(x + 2, y)) * scale;
+        blur_x.compute_root().parallel(y);
+
+        Func blur_y;
+        blur_y(x, y) = blur_x(x, y) + blur_x(x, y + 1);
+        blur_y.parallel(y);
+        return blur_y;
+    }
+};
+
+Halide::RegisterGenerator<PreparedBlur> register_my_gen{"prepared_blur"};
+
+}  // namespace
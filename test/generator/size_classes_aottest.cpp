@@ -0,0 +1,72 @@
+#include "HalideRuntime.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "size_classes.h"
+#include "static_image.h"
+
+// Record how each call used the thread pool, which tells us which
+// variant ran.
+static int par_for_calls = 0;
+static int par_for_tasks = 0;
+
+extern "C" int halide_do_par_for(void *user_context,
+                                 int (*f)(void *ctx, int, uint8_t *),
+                                 int min, int size, uint8_t *closure) {
+    par_for_calls++;
+    par_for_tasks = size;
+    for (int i = min; i < min + size; i++) {
+        int result = f(user_context, i, closure);
+        if (result) return result;
+    }
+    return 0;
+}
+
+bool run(int w, int h, int expected_par_for_calls, int expected_tasks) {
+    Image<float> input(w, h);
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            input(x, y) = (float)(x + y * 7);
+        }
+    }
+
+    par_for_calls = par_for_tasks = 0;
+    Image<float> output(w, h);
+    int result = size_classes(input, output);
+    if (result != 0) {
+        fprintf(stderr, "%dx%d: result %d\n", w, h, result);
+        return false;
+    }
+
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            float correct = input(x, y) * 3.0f + 1.0f;
+            if (output(x, y) != correct) {
+                fprintf(stderr, "%dx%d: output(%d, %d) = %f instead of %f\n",
+                        w, h, x, y, output(x, y), correct);
+                return false;
+            }
+        }
+    }
+
+    if (par_for_calls != expected_par_for_calls ||
+        (expected_par_for_calls && par_for_tasks != expected_tasks)) {
+        fprintf(stderr, "%dx%d: ran %d parallel loops of %d tasks, instead of %d of %d\n",
+                w, h, par_for_calls, par_for_tasks, expected_par_for_calls, expected_tasks);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    // A thumbnail is computed serially.
+    if (!run(100, 80, 0, 0)) return -1;
+    // Frames up to 1920 wide are parallelized over rows.
+    if (!run(640, 48, 1, 48)) return -1;
+    // Wider frames are parallelized over rows of 64x16 tiles.
+    if (!run(2000, 40, 1, 3)) return -1;
+
+    printf("Success!\n");
+    return 0;
+}
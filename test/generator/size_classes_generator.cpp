@@ -0,0 +1,41 @@
+#include "Halide.h"
+
+namespace {
+
+class SizeClasses : public Halide::Generator<SizeClasses> {
+public:
+    ImageParam input{ Float(32), 2, "input" };
+
+    // Thumbnails aren't worth waking up the thread pool for, and very
+    // wide frames are better done in tiles than in rows.
+    std::vector<SizeClass> size_classes() override {
+        return {
+            { "thumbnail", input.width() * input.height() <= 128 * 128 },
+            { "hd", input.width() <= 1920 },
+            { "uhd", Expr() }
+        };
+    }
+
+    Func build() override {
+        Var x, y, xi, yi;
+
+        Func f;
+        f(x, y) = input(x, y) * 3.0f + 1.0f;
+
+        switch (size_class()) {
+        case 0:
+            break;
+        case 1:
+            f.parallel(y);
+            break;
+        default:
+            f.tile(x, y, xi, yi, 64, 16).parallel(y);
+            break;
+        }
+        return f;
+    }
+};
+
+Halide::RegisterGenerator<SizeClasses> register_my_gen{"size_classes"};
+
+}  // namespace
@@ -0,0 +1,124 @@
+#include "HalideRuntime.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "stream_stencil.h"
+#include "static_image.h"
+#include "streaming.h"
+
+const int W = 100, H = 70;
+const int tile_w = 32, tile_h = 16;
+
+int input_value(int x, int y) {
+    return x * 3 + y * 1000;
+}
+
+// Generates the input on demand, and checks that only each tile's
+// footprint is requested.
+class GeneratedReader : public StreamReader {
+public:
+    int reads = 0;
+    bool ok = true;
+
+    int read(const buffer_t *buf) override {
+        reads++;
+        if (buf->extent[0] > tile_w + 2 || buf->extent[1] > tile_h + 2) {
+            fprintf(stderr, "Read a region of %d x %d for a tile of at most %d x %d\n",
+                    buf->extent[0], buf->extent[1], tile_w, tile_h);
+            ok = false;
+        }
+        for (int y = 0; y < buf->extent[1]; y++) {
+            for (int x = 0; x < buf->extent[0]; x++) {
+                int32_t *dst = (int32_t *)buf->host + x * buf->stride[0] + y * buf->stride[1];
+                *dst = input_value(x + buf->min[0], y + buf->min[1]);
+            }
+        }
+        return 0;
+    }
+};
+
+class ImageWriter : public StreamWriter {
+public:
+    Image<int32_t> output;
+    int writes = 0, last_min_y = 0, last_min_x = -1;
+    bool ok = true;
+
+    ImageWriter() : output(W, H) {}
+
+    int write(const buffer_t *buf) override {
+        writes++;
+        // Tiles arrive in order.
+        if (buf->min[1] < last_min_y ||
+            (buf->min[1] == last_min_y && buf->min[0] <= last_min_x)) {
+            fprintf(stderr, "Tile at %d, %d written out of order\n", buf->min[0], buf->min[1]);
+            ok = false;
+        }
+        last_min_x = buf->min[0];
+        last_min_y = buf->min[1];
+        for (int y = 0; y < buf->extent[1]; y++) {
+            for (int x = 0; x < buf->extent[0]; x++) {
+                const int32_t *src = (const int32_t *)buf->host + x * buf->stride[0] + y * buf->stride[1];
+                output(x + buf->min[0], y + buf->min[1]) = *src;
+            }
+        }
+        return 0;
+    }
+};
+
+class FailingWriter : public StreamWriter {
+public:
+    int write(const buffer_t *buf) override {
+        return -1234;
+    }
+};
+
+int main(int argc, char **argv) {
+    GeneratedReader reader;
+    ImageWriter writer;
+    int32_t offset = 17;
+    void *args[] = {&reader, &offset, &writer};
+    int output_extent[] = {W, H};
+
+    StreamOptions options;
+    options.tile_extent[0] = tile_w;
+    options.tile_extent[1] = tile_h;
+
+    int result = halide_stream(stream_stencil_argv, &stream_stencil_metadata, args, output_extent, options);
+    if (result != 0) {
+        fprintf(stderr, "Result: %d\n", result);
+        exit(-1);
+    }
+    if (!reader.ok || !writer.ok) {
+        exit(-1);
+    }
+
+    const int tiles = ((W + tile_w - 1) / tile_w) * ((H + tile_h - 1) / tile_h);
+    if (reader.reads != tiles || writer.writes != tiles) {
+        fprintf(stderr, "%d reads and %d writes instead of %d\n", reader.reads, writer.writes, tiles);
+        exit(-1);
+    }
+
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            int32_t correct = (input_value(x - 1, y) + input_value(x + 1, y) * 2 +
+                               input_value(x, y + 2) * 3 + offset);
+            if (writer.output(x, y) != correct) {
+                fprintf(stderr, "output(%d, %d) = %d instead of %d\n", x, y, writer.output(x, y), correct);
+                exit(-1);
+            }
+        }
+    }
+
+    // Errors from writers are reported.
+    FailingWriter failing;
+    args[2] = &failing;
+    result = halide_stream(stream_stencil_argv, &stream_stencil_metadata, args, output_extent, options);
+    if (result != -1234) {
+        fprintf(stderr, "Expected an error from the writer, got %d\n", result);
+        exit(-1);
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,24 @@
+#include "Halide.h"
+
+namespace {
+
+class StreamStencil : public Halide::Generator<StreamStencil> {
+public:
+    ImageParam input{ Int(32), 2, "input" };
+    Param<int32_t> offset{ "offset", 0 };
+
+    Func build() override {
+        Var x, y;
+
+        // A stencil with an asymmetric footprint, so that the region of
+        // the input needed by each tile differs from the tile itself.
+        Func f;
+        f(x, y) = input(x - 1, y) + input(x + 1, y) * 2 + input(x, y + 2) * 3 + offset;
+        f.parallel(y);
+        return f;
+    }
+};
+
+Halide::RegisterGenerator<StreamStencil> register_my_gen{"stream_stencil"};
+
+}  // namespace
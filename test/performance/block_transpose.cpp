@@ -1,6 +1,6 @@
 #include "Halide.h"
 #include <stdio.h>
-#include "clock.h"
+#include "benchmark.h"
 #include <memory>
 
 using namespace Halide;
@@ -28,21 +28,24 @@ void test_transpose(int mode) {
     // Do 8 vectorized loads from the input.
     block.compute_at(output, x).vectorize(x).unroll(y);
 
-    std::string algorithm;
+    std::string algorithm, name;
     switch(mode) {
         case scalar_trans:
             block_transpose.compute_at(output, x).unroll(x).unroll(y);
             algorithm = "Scalar transpose";
+            name = "block_transpose/scalar";
             output.compile_to_assembly("scalar_transpose.s", std::vector<Argument>());
             break;
         case vec_y_trans:
             block_transpose.compute_at(output, x).vectorize(y).unroll(x);
             algorithm = "Transpose vectorized in y";
+            name = "block_transpose/vectorize_y";
             output.compile_to_assembly("fast_transpose_y.s", std::vector<Argument>());
             break;
         case vec_x_trans:
             block_transpose.compute_at(output, x).vectorize(x).unroll(y);
             algorithm = "Transpose vectorized in x";
+            name = "block_transpose/vectorize_x";
             output.compile_to_assembly("fast_transpose_x.s", std::vector<Argument>());
             break;
     }
@@ -51,15 +54,11 @@ void test_transpose(int mode) {
     Image<uint16_t> result(1024, 1024);
     output.compile_jit();
 
-    output.realize(result);
-
-    double t1 = current_time();
-    for (int i = 0; i < 10; i++) {
+    BenchmarkResult r = benchmark(name, [&]() {
         output.realize(result);
-    }
-    double t2 = current_time();
+    });
 
-    std::cout << algorithm << " bandwidth " << ((1024*1024 / (t2 - t1)) * 1000 * 10) << " byte/s.\n";
+    std::cout << algorithm << " bandwidth " << (1024*1024 / r.p50) << " byte/s.\n";
 }
 
 int main(int argc, char **argv) {
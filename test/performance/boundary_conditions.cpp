@@ -1,7 +1,7 @@
 #include "Halide.h"
 #include <stdio.h>
 
-#include "clock.h"
+#include "benchmark.h"
 
 const int W = 1024, H = 768;
 
@@ -22,21 +22,9 @@ struct Test {
 
         Image<float> out = g.realize(W, H);
 
-        // Best of 5
-        for (int i = 0; i < 5; i++) {
-            double t1 = current_time();
-            // 10 runs
-            for (int j = 0; j < 10; j++) {
-                g.realize(out);
-            }
-            double t2 = current_time();
-            double delta = t2 - t1;
-            if (delta < time || i == 0) {
-                time = delta;
-            }
-        }
-
-        printf("%s: %f\n", name, time);
+        time = benchmark(std::string("boundary_conditions/") + name, [&]() {
+            g.realize(out);
+        }).p50;
     }
 };
 
@@ -1,7 +1,7 @@
 #include "Halide.h"
 #include <stdio.h>
 #include <algorithm>
-#include "clock.h"
+#include "benchmark.h"
 
 using namespace Halide;
 
@@ -11,7 +11,7 @@ Image<uint16_t> output;
 #define MIN 1
 #define MAX 1020
 
-double test(Func f, bool test_correctness = true) {
+double test(const char *name, Func f, bool test_correctness = true) {
     f.compile_to_assembly(f.name() + ".s", Internal::vec<Argument>(input), f.name());
     f.compile_jit();
     f.realize(output);
@@ -31,11 +31,9 @@ double test(Func f, bool test_correctness = true) {
         }
     }
 
-    double t1 = current_time();
-    for (int i = 0; i < 10; i++) {
+    return benchmark(std::string("clamped_vector_load/") + name, [&]() {
         f.realize(output);
-    }
-    return current_time() - t1;
+    }).p50;
 }
 
 int main(int argc, char **argv) {
@@ -63,7 +61,7 @@ int main(int argc, char **argv) {
 
         f.vectorize(x, 8);
 
-        t_ref = test(f, false);
+        t_ref = test("unclamped", f, false);
     }
 
     {
@@ -77,7 +75,7 @@ int main(int argc, char **argv) {
         f.vectorize(x, 8);
         f.compile_to_lowered_stmt("debug_clamped_vector_load.stmt", f.infer_arguments());
 
-        t_clamped = test(f);
+        t_clamped = test("clamped", f);
     }
 
     {
@@ -91,7 +89,7 @@ int main(int argc, char **argv) {
         f.vectorize(x, 8);
         g.compute_at(f, x);
 
-        t_scalar = test(f);
+        t_scalar = test("scalar_load", f);
     }
 
     {
@@ -105,7 +103,7 @@ int main(int argc, char **argv) {
         f.vectorize(x, 8);
         g.compute_at(f, y);
 
-        t_pad = test(f);
+        t_pad = test("pad", f);
     }
 
     // This constraint is pretty lax, because the op is so trivial
@@ -1,7 +1,7 @@
 #include "Halide.h"
 #include <stdio.h>
 #include <stdint.h>
-#include "clock.h"
+#include "benchmark.h"
 #include "time.h"
 
 using namespace Halide;
@@ -58,18 +58,16 @@ bool test(int w) {
     g.compile_jit();
     h.compile_jit();
 
-    double t1 = current_time();
+    std::string name = "const_division/" + std::string(is_signed ? "" : "u") +
+        "int" + std::to_string(bits) + "x" + std::to_string(w);
     Image<T> correct = g.realize(input.width(), num_vals);
-    for (int i = 0; i < 30; i++) g.realize(correct);
-    double t2 = current_time();
+    double t_correct = benchmark(name + "/reference", [&]() { g.realize(correct); }).p50;
     Image<T> fast = f.realize(input.width(), num_vals);
-    for (int i = 0; i < 30; i++) f.realize(fast);
-    double t3 = current_time();
+    double t_fast = benchmark(name + "/constant", [&]() { f.realize(fast); }).p50;
     Image<T> fast_dynamic = h.realize(input.width(), num_vals);
-    for (int i = 0; i < 30; i++) h.realize(fast_dynamic);
-    double t4 = current_time();
-    printf("compile-time-constant divisor path is %1.3f x faster \n", (t2-t1)/(t3-t2));
-    printf("fast_integer_divide path is           %1.3f x faster \n", (t4-t3)/(t3-t2));
+    double t_fast_dynamic = benchmark(name + "/fast_integer_divide", [&]() { h.realize(fast_dynamic); }).p50;
+    printf("compile-time-constant divisor path is %1.3f x faster \n", t_correct/t_fast);
+    printf("fast_integer_divide path is           %1.3f x faster \n", t_fast_dynamic/t_fast);
 
     for (int y = 0; y < num_vals; y++) {
         for (int x = 0; x < input.width(); x++) {
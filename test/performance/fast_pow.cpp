@@ -1,6 +1,6 @@
 #include "Halide.h"
 #include <stdio.h>
-#include "clock.h"
+#include "benchmark.h"
 
 using namespace Halide;
 
@@ -36,21 +36,9 @@ int main(int argc, char **argv) {
     Image<float> fast_result(2048, 768);
     Image<float> faster_result(2048, 768);
 
-    const int iterations = 20;
-
-    double t1 = current_time();
-    for (int i = 0; i < iterations; i++) {
-        f.realize(correct_result);
-    }
-    double t2 = current_time();
-    for (int i = 0; i < iterations; i++) {
-        g.realize(fast_result);
-    }
-    double t3 = current_time();
-    for (int i = 0; i < iterations; i++) {
-        h.realize(faster_result);
-    }
-    double t4 = current_time();
+    double t_powf = benchmark("fast_pow/powf", [&]() { f.realize(correct_result); }).p50;
+    double t_pow = benchmark("fast_pow/pow", [&]() { g.realize(fast_result); }).p50;
+    double t_fast_pow = benchmark("fast_pow/fast_pow", [&]() { h.realize(faster_result); }).p50;
 
     RDom r(correct_result);
     Func fast_error, faster_error;
@@ -62,16 +50,22 @@ int main(int argc, char **argv) {
     Image<double> fast_err = fast_error.realize();
     Image<double> faster_err = faster_error.realize();
 
-    int N = correct_result.width() * correct_result.height() * iterations;
-    fast_err(0) = sqrt(fast_err(0)/N);
-    faster_err(0) = sqrt(faster_err(0)/N);
+    int N = correct_result.width() * correct_result.height();
+
+    // The error thresholds below were chosen when this test timed 20
+    // iterations by hand and divided the summed error by the number of
+    // pixels times that count, so keep normalizing the same way.
+    const int iterations = 20;
+    double error_N = (double)N * iterations;
+    fast_err(0) = sqrt(fast_err(0)/error_N);
+    faster_err(0) = sqrt(faster_err(0)/error_N);
 
     printf("powf: %f ns per pixel\n"
            "Halide's pow: %f ns per pixel (rms error = %0.10f)\n"
            "Halide's fast_pow: %f ns per pixel (rms error = %0.10f)\n",
-           1000000*(t2-t1) / N,
-           1000000*(t3-t2) / N, fast_err(0),
-           1000000*(t4-t3) / N, faster_err(0));
+           1e9 * t_powf / N,
+           1e9 * t_pow / N, fast_err(0),
+           1e9 * t_fast_pow / N, faster_err(0));
 
     if (fast_err(0) > 0.000001) {
         printf("Error for pow too large\n");
@@ -83,12 +77,12 @@ int main(int argc, char **argv) {
         return -1;
     }
 
-    if (t2-t1 < t3-t2) {
+    if (t_powf < t_pow) {
         printf("powf is faster than Halide's pow\n");
         return -1;
     }
 
-    if (t3-t2 < t4-t3) {
+    if (t_pow < t_fast_pow) {
         printf("pow is faster than fast_pow\n");
         return -1;
     }
@@ -0,0 +1,100 @@
+#include "Halide.h"
+#include <stdio.h>
+#include <math.h>
+#include "benchmark.h"
+
+using namespace Halide;
+
+// 32-bit windows defines some of these as macros, which won't work
+// for us.
+#ifdef WIN32
+#define EXPORT_REF extern "C" __declspec(dllexport)
+#else
+#define EXPORT_REF extern "C"
+#endif
+
+EXPORT_REF float sin_ref(float x) {return (float)sin(x);}
+EXPORT_REF float cos_ref(float x) {return (float)cos(x);}
+EXPORT_REF float atan2_ref(float y, float x) {return (float)atan2(y, x);}
+EXPORT_REF float tanh_ref(float x) {return (float)tanh(x);}
+EXPORT_REF float cbrt_ref(float x) {return (float)cbrt(x);}
+
+HalideExtern_1(float, sin_ref, float);
+HalideExtern_1(float, cos_ref, float);
+HalideExtern_2(float, atan2_ref, float, float);
+HalideExtern_1(float, tanh_ref, float);
+HalideExtern_1(float, cbrt_ref, float);
+
+const int W = 2048, H = 768;
+
+double time_func(const std::string &name, Func f, Image<float> out) {
+    f.vectorize(f.args()[0], 8);
+    f.compile_jit();
+    double t = benchmark("fast_transcendentals/" + name, [&]() {
+        f.realize(out);
+    }).p50;
+    return 1e9 * t / (W * H);
+}
+
+int main(int argc, char **argv) {
+    Var x, y;
+    Expr a = (x - W/2) / 256.0f;
+    Expr b = (y - H/2) / 256.0f;
+
+    const char *names[] = {"sin", "cos", "atan2", "tanh", "cbrt"};
+    const ApproximationPrecision precisions[] = {
+        ApproximationPrecision::Fast,
+        ApproximationPrecision::Balanced,
+        ApproximationPrecision::Accurate
+    };
+    const char *precision_names[] = {"Fast", "Balanced", "Accurate"};
+
+    bool ok = true;
+    for (int i = 0; i < 5; i++) {
+        Func ref;
+        switch (i) {
+        case 0: ref(x, y) = sin_ref(a); break;
+        case 1: ref(x, y) = cos_ref(a); break;
+        case 2: ref(x, y) = atan2_ref(b, a); break;
+        case 3: ref(x, y) = tanh_ref(a); break;
+        default: ref(x, y) = cbrt_ref(a); break;
+        }
+        Image<float> correct(W, H), approx(W, H);
+        double ref_time = time_func(std::string(names[i]) + "/libm", ref, correct);
+        printf("%s from libm: %f ns per pixel\n", names[i], ref_time);
+
+        for (int p = 0; p < 3; p++) {
+            Func f;
+            ApproximationPrecision prec = precisions[p];
+            switch (i) {
+            case 0: f(x, y) = fast_sin(a, prec); break;
+            case 1: f(x, y) = fast_cos(a, prec); break;
+            case 2: f(x, y) = fast_atan2(b, a, prec); break;
+            case 3: f(x, y) = fast_tanh(a, prec); break;
+            default: f(x, y) = fast_cbrt(a, prec); break;
+            }
+            double t = time_func(std::string(names[i]) + "/" + precision_names[p], f, approx);
+
+            double max_err = 0;
+            for (int yi = 0; yi < H; yi++) {
+                for (int xi = 0; xi < W; xi++) {
+                    double err = fabs(correct(xi, yi) - approx(xi, yi));
+                    if (err > max_err) max_err = err;
+                }
+            }
+
+            printf("Halide's fast_%s (%s): %f ns per pixel (max abs error = %g)\n",
+                   names[i], precision_names[p], t, max_err);
+
+            if (t > ref_time) {
+                printf("fast_%s (%s) is slower than libm\n", names[i], precision_names[p]);
+                ok = false;
+            }
+        }
+    }
+
+    if (!ok) return -1;
+
+    printf("Success!\n");
+    return 0;
+}
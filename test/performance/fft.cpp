@@ -6,7 +6,7 @@
 #include <stdio.h>
 #include "Halide.h"
 #include <vector>
-#include "clock.h"
+#include "benchmark.h"
 
 const float pi = 3.14159265f;
 
@@ -533,15 +533,11 @@ double log2(double x) {
     return log(x)/log(2.0);
 }
 
-double bench_realization(Func f, Realization R, int samples, Target target) {
-    double t = 1e6f;
-    for (int i = 0; i < samples; i++) {
-        double t1 = current_time();
+// Returns the minimum time in seconds, following FFTW's methodology.
+double bench_realization(const std::string &name, Func f, Realization R, Target target) {
+    return benchmark("fft/" + name, [&]() {
         f.realize(R, target);
-        double dt = current_time() - t1;
-        if (dt < t) t = dt;
-    }
-    return t;
+    }).min;
 }
 
 int main(int argc, char **argv) {
@@ -632,9 +628,8 @@ int main(int argc, char **argv) {
     // For a description of the methodology used here, see
     // http://www.fftw.org/speed/method.html
 
-    // Take the minimum time over many of iterations to minimize
+    // Take the minimum time over many iterations to minimize
     // noise.
-    const int samples = 10;
     const int reps = 1000;
 
     Var rep("rep");
@@ -658,7 +653,7 @@ int main(int argc, char **argv) {
     R_c2c[0].raw_buffer()->stride[2] = 0;
     R_c2c[1].raw_buffer()->stride[2] = 0;
 
-    double t = bench_realization(bench_c2c, R_c2c, samples, target)*1e3/reps;
+    double t = bench_realization("c2c", bench_c2c, R_c2c, target)*1e6/reps;
     printf("c2c  time: %f us, %f MFLOP/s\n", t, 5*W*H*(log2(W) + log2(H))/t);
 
     Func r2c_in;
@@ -670,7 +665,7 @@ int main(int argc, char **argv) {
     R_r2c[0].raw_buffer()->stride[2] = 0;
     R_r2c[1].raw_buffer()->stride[2] = 0;
 
-    t = bench_realization(bench_r2c, R_r2c, samples, target)*1e3/reps;
+    t = bench_realization("r2c", bench_r2c, R_r2c, target)*1e6/reps;
     printf("r2c time: %f us, %f MFLOP/s\n", t, 2.5*W*H*(log2(W) + log2(H))/t);
 
     Func c2r_in;
@@ -681,7 +676,7 @@ int main(int argc, char **argv) {
     // Write all reps to the same place in memory. See notes on R_c2c.
     R_c2r[0].raw_buffer()->stride[2] = 0;
 
-    t = bench_realization(bench_c2r, R_c2r, samples, target)*1e3/reps;
+    t = bench_realization("c2r", bench_c2r, R_c2r, target)*1e6/reps;
     printf("c2r time: %f us, %f MFLOP/s\n", t, 2.5*W*H*(log2(W) + log2(H))/t);
 
     twiddles.clear();
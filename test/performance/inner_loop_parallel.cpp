@@ -1,6 +1,6 @@
 #include "Halide.h"
 #include <stdio.h>
-#include "clock.h"
+#include "benchmark.h"
 
 using namespace Halide;
 
@@ -26,13 +26,9 @@ int main(int argc, char **argv) {
         // Start the thread pool without giving any hints as to the
         // number of tasks we'll be using.
         f.realize(t, 1);
-        double min_time = 1e20;
-        for (int i = 0; i < 3; i++) {
-            double t1 = current_time();
+        double min_time = benchmark("inner_loop_parallel/" + std::to_string(t) + "_threads", [&]() {
             f.realize(2, 1000000);
-            double t2 = current_time() - t1;
-            if (t2 < min_time) min_time = t2;
-        }
+        }).min * 1000;
 
         printf("%d: %f ms\n", t, min_time);
         if (t == 2) {
@@ -0,0 +1,110 @@
+#include "Halide.h"
+#include <stdio.h>
+#include <stdint.h>
+#include "benchmark.h"
+
+using namespace Halide;
+
+// Compare division by a runtime parameter against division by a
+// compile-time constant, and against native division by a divisor
+// loaded per pixel (which is what division by a runtime parameter
+// used to compile to).
+template<typename T>
+bool test(int w) {
+    size_t bits = sizeof(T)*8;
+    bool is_signed = (T)(-1) < (T)(0);
+
+    printf("Testing %sint%d_t x %d\n",
+           is_signed ? "" : "u",
+           (int)bits, w);
+
+    const int W = 1024, H = 256;
+    const T divisor = 7;
+
+    Image<T> input(W, H), divisors(W);
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            uint32_t bits = rand() ^ (rand() << 16);
+            input(x, y) = (T)bits;
+        }
+    }
+    for (int x = 0; x < W; x++) {
+        divisors(x) = divisor;
+    }
+
+    Var x, y;
+    Param<T> p;
+    p.set(divisor);
+
+    Func native, invariant, constant;
+    native(x, y) = input(x, y) / divisors(x);
+    invariant(x, y) = input(x, y) / p;
+    constant(x, y) = input(x, y) / cast<T>((int)divisor);
+
+    if (w > 1) {
+        native.vectorize(x, w);
+        invariant.vectorize(x, w);
+        constant.vectorize(x, w);
+    }
+
+    native.compile_jit();
+    invariant.compile_jit();
+    constant.compile_jit();
+
+    Image<T> correct(W, H), fast(W, H), fastest(W, H);
+
+    std::string name = "invariant_division/" + std::string(is_signed ? "" : "u") +
+        "int" + std::to_string(bits) + "x" + std::to_string(w);
+    double t_native = benchmark(name + "/native", [&]() { native.realize(correct); }).p50;
+    double t_invariant = benchmark(name + "/invariant", [&]() { invariant.realize(fast); }).p50;
+    double t_constant = benchmark(name + "/constant", [&]() { constant.realize(fastest); }).p50;
+
+    printf("runtime-invariant divisor path is     %1.3f x faster \n", t_native/t_invariant);
+    printf("compile-time-constant divisor path is %1.3f x faster \n", t_native/t_constant);
+
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            if (fast(x, y) != correct(x, y)) {
+                printf("fast(%d, %d) = %lld instead of %lld (%lld/%d)\n",
+                       x, y,
+                       (long long int)fast(x, y),
+                       (long long int)correct(x, y),
+                       (long long int)input(x, y),
+                       (int)divisor);
+                return false;
+            }
+        }
+    }
+
+    if (w > 1 && t_invariant > t_native) {
+        printf("Division by a runtime-invariant divisor is slower than native division\n");
+        return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv) {
+    bool success = true;
+    // Scalar
+    success = success && test<int32_t>(1);
+    success = success && test<int16_t>(1);
+    success = success && test<int8_t>(1);
+    success = success && test<uint32_t>(1);
+    success = success && test<uint16_t>(1);
+    success = success && test<uint8_t>(1);
+    // Vector
+    success = success && test<int32_t>(4);
+    success = success && test<int16_t>(8);
+    success = success && test<int8_t>(16);
+    success = success && test<uint32_t>(4);
+    success = success && test<uint16_t>(8);
+    success = success && test<uint8_t>(16);
+
+    if (success) {
+        printf("Success!\n");
+        return 0;
+    } else {
+        return -1;
+    }
+}
@@ -1,6 +1,6 @@
 #include <stdio.h>
 #include "Halide.h"
-#include "clock.h"
+#include "benchmark.h"
 
 using namespace Halide;
 
@@ -14,18 +14,16 @@ int main(int argc, char **argv) {
     a.set(c);
 
 
-    double t1, t2;
-    t1 = current_time();
-
-    for (int i = 0; i < 100; i++) {
+    int i = 0;
+    BenchmarkResult r = benchmark("jit_stress/compile", [&]() {
         Func f;
         f(x) = a(x) + b(x);
         f.realize(c);
-        assert(c(0) == (i+1)*17);
-    }
+        i++;
+        assert(c(0) == i*17);
+    });
 
-    t2 = current_time();
-    int elapsed = (int)(10.0 * (t2-t1));
+    int elapsed = (int)(1e6 * r.p50);
 
     printf("%d us per jit compilation\n", elapsed);
 
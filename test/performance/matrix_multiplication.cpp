@@ -1,6 +1,6 @@
 #include "Halide.h"
 #include <stdio.h>
-#include "clock.h"
+#include "benchmark.h"
 
 using namespace Halide;
 
@@ -48,8 +48,6 @@ int main(int argc, char **argv) {
 
     matrix_mul.compile_jit();
 
-    const int iterations = 50;
-
     Image<float> mat_A(matrix_size, matrix_size);
     Image<float> mat_B(matrix_size, matrix_size);
     Image<float> output(matrix_size, matrix_size);
@@ -65,15 +63,9 @@ int main(int argc, char **argv) {
     A.set(mat_A);
     B.set(mat_B);
 
-    matrix_mul.realize(output);
-
-    double t = 0;
-    for (int i = 0; i < iterations; i++) {
-        double t3 = current_time();
+    double t = benchmark("matrix_multiplication/halide", [&]() {
         matrix_mul.realize(output);
-        double t4 = current_time();
-        t += t4 - t3;
-    }
+    }).p50;
 
 
     // check results
@@ -108,7 +100,7 @@ int main(int argc, char **argv) {
 
     float flops = 2.0f * matrix_size * matrix_size * matrix_size;
 
-    printf("Halide: %fms, %f GFLOP/s\n\n", t, (flops / t) * iterations / 1000000);
+    printf("Halide: %fms, %f GFLOP/s\n\n", t * 1000, flops / t / 1e9);
 
     printf("Success!\n");
     return 0;
@@ -1,6 +1,6 @@
 #include "Halide.h"
 #include <stdio.h>
-#include "clock.h"
+#include "benchmark.h"
 
 using namespace Halide;
 
@@ -20,33 +20,21 @@ int main(int argc, char **argv) {
     dst.compile_jit();
 
     const int32_t buffer_size = 12345678;
-    const int iterations = 50;
 
     Image<uint8_t> input(buffer_size);
     Image<uint8_t> output(buffer_size);
 
     src.set(input);
 
-    // Get past one-time set-up issues for the ptx backend.
-    dst.realize(output);
-
-    double halide = 0, system = 0;
-    for (int i = 0; i < iterations; i++) {
-        double t1 = current_time();
-        dst.realize(output);
-        dst.realize(output);
+    double halide = benchmark("memcpy/halide", [&]() {
         dst.realize(output);
-        double t2 = current_time();
+    }).p50;
+    double system = benchmark("memcpy/system", [&]() {
         memcpy(output.data(), input.data(), input.width());
-        memcpy(output.data(), input.data(), input.width());
-        memcpy(output.data(), input.data(), input.width());
-        double t3 = current_time();
-        system += t3-t2;
-        halide += t2-t1;
-    }
+    }).p50;
 
-    printf("system memcpy: %.3e byte/s\n", (buffer_size / system) * 3 * 1000 * iterations);
-    printf("halide memcpy: %.3e byte/s\n", (buffer_size / halide) * 3 * 1000 * iterations);
+    printf("system memcpy: %.3e byte/s\n", buffer_size / system);
+    printf("halide memcpy: %.3e byte/s\n", buffer_size / halide);
 
     // memcpy will win by a little bit for large inputs because it uses streaming stores
     if (halide > system * 2) {
@@ -1,11 +1,11 @@
 #include "Halide.h"
 #include <stdio.h>
-#include "clock.h"
+#include "benchmark.h"
 #include <memory>
 
 using namespace Halide;
 
-double test_copy(Image<uint8_t> src, Image<uint8_t> dst) {
+double test_copy(const char *name, Image<uint8_t> src, Image<uint8_t> dst) {
     Var x, y, c;
     Func f;
     f(x, y, c) = src(x, y, c);
@@ -28,16 +28,9 @@ double test_copy(Image<uint8_t> src, Image<uint8_t> dst) {
 
     f.compile_to_assembly(std::string("copy_") + f.name() + ".s", Internal::vec<Argument>(src), "copy");
 
-    f.realize(dst);
-
-
-
-    double t1 = current_time();
-    for (int i = 0; i < 10; i++) {
+    return benchmark(std::string("packed_planar_fusion/") + name, [&]() {
         f.realize(dst);
-    }
-    double t2 = current_time();
-    return t2 - t1;
+    }).p50;
 }
 
 Image<uint8_t> make_packed(uint8_t *host, int W, int H) {
@@ -78,13 +71,13 @@ int main(int argc, char **argv) {
     while ((size_t)ptr_1 & 0x1f) ptr_1 ++;
     while ((size_t)ptr_2 & 0x1f) ptr_2 ++;
 
-    double t_packed_packed = test_copy(make_packed(ptr_1, W, H),
+    double t_packed_packed = test_copy("packed_packed", make_packed(ptr_1, W, H),
                                        make_packed(ptr_2, W, H));
-    double t_packed_planar = test_copy(make_packed(ptr_1, W, H),
+    double t_packed_planar = test_copy("packed_planar", make_packed(ptr_1, W, H),
                                        make_planar(ptr_2, W, H));
-    double t_planar_packed = test_copy(make_planar(ptr_1, W, H),
+    double t_planar_packed = test_copy("planar_packed", make_planar(ptr_1, W, H),
                                        make_packed(ptr_2, W, H));
-    double t_planar_planar = test_copy(make_planar(ptr_1, W, H),
+    double t_planar_planar = test_copy("planar_planar", make_planar(ptr_1, W, H),
                                        make_planar(ptr_2, W, H));
 
 
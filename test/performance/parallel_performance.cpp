@@ -1,6 +1,6 @@
 #include <stdio.h>
 #include "Halide.h"
-#include "clock.h"
+#include "benchmark.h"
 
 using namespace Halide;
 
@@ -20,21 +20,17 @@ int main(int argc, char **argv) {
 
     Image<float> imf = f.realize(W, H);
 
-    double t1, t2;
-
-    t1 = current_time();
-    f.realize(imf);
-    t2 = current_time();
-    double parallelTime = t2 - t1;
+    double parallelTime = benchmark("parallel_performance/parallel", [&]() {
+        f.realize(imf);
+    }).p50;
 
     printf("Realizing g\n");
     Image<float> img = g.realize(W, H);
     printf("Done realizing g\n");
 
-    t1 = current_time();
-    g.realize(img);
-    t2 = current_time();
-    double serialTime = t2 - t1;
+    double serialTime = benchmark("parallel_performance/serial", [&]() {
+        g.realize(img);
+    }).p50;
 
     for (int y = 0; y < H; y++) {
         for (int x = 0; x < W; x++) {
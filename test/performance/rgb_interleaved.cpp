@@ -1,6 +1,6 @@
 #include "Halide.h"
 #include <stdio.h>
-#include "clock.h"
+#include "benchmark.h"
 #include <memory>
 
 using namespace Halide;
@@ -23,9 +23,6 @@ void test_deinterleave() {
     dst.reorder(c, x, y).unroll(c);
     dst.vectorize(x, 16);
 
-    // Run test many times to avoid timing jitter
-    const int iterations = 20;
-
     // Allocate two 16 megapixel, 3 channel, 8-bit images -- input and output
     const int32_t buffer_side_length = (1 << 12);
     const int32_t buffer_size = buffer_side_length * buffer_side_length;
@@ -74,17 +71,11 @@ void test_deinterleave() {
 
     dst.compile_jit();
 
-    // Warm up caches, etc.
-    dst.realize(dst_image);
-
-    double t1 = current_time();
-
-    for (int i = 0; i < iterations; i++)
+    double t = benchmark("rgb_interleaved/deinterleave", [&]() {
         dst.realize(dst_image);
+    }).p50;
 
-    double t2 = current_time();
-
-    printf("Interleaved to planar bandwidth %.3e byte/s.\n", (buffer_size / (t2 - t1)) * 1000 * iterations);
+    printf("Interleaved to planar bandwidth %.3e byte/s.\n", buffer_size / t);
 
     for (int32_t x = 0; x < buffer_side_length; x++) {
         for (int32_t y = 0; y < buffer_side_length; y++) {
@@ -107,12 +98,9 @@ void test_deinterleave() {
 
     memset(dst_storage, 0, buffer_size);
 
-    double t3 = current_time();
-
-    for (int i = 0; i < iterations; i++)
+    t = benchmark("rgb_interleaved/deinterleave_semi_planar", [&]() {
         dst.realize(dst_image);
-
-    double t4 = current_time();
+    }).p50;
 
     for (int32_t x = 0; x < buffer_side_length; x++) {
         for (int32_t y = 0; y < buffer_side_length; y++) {
@@ -122,7 +110,7 @@ void test_deinterleave() {
         }
     }
 
-    printf("Interleaved to semi-planar bandwidth %.3e byte/s.\n", (buffer_size / (t4 - t3)) * 1000 * iterations);
+    printf("Interleaved to semi-planar bandwidth %.3e byte/s.\n", buffer_size / t);
 
     delete[] src_storage;
     delete[] dst_storage;
@@ -151,9 +139,6 @@ void test_interleave(bool fast) {
         dst.reorder(c, x, y).vectorize(x, 16);
     }
 
-    // Run test many times to avoid timing jitter
-    const int iterations = 20;
-
     // Allocate two 16 megapixel, 3 channel, 8-bit images -- input and output
     const int32_t buffer_side_length = (1 << 12);
     const int32_t buffer_size = buffer_side_length * buffer_side_length;
@@ -207,17 +192,11 @@ void test_interleave(bool fast) {
     }
     dst.compile_jit();
 
-    // Warm up caches, etc.
-    dst.realize(dst_image);
-
-    double t1 = current_time();
-
-    for (int i = 0; i < iterations; i++)
+    double t = benchmark(fast ? "rgb_interleaved/interleave_fast" : "rgb_interleaved/interleave", [&]() {
         dst.realize(dst_image);
+    }).p50;
 
-    double t2 = current_time();
-
-    printf("Planar to interleaved bandwidth %.3e byte/s.\n", (buffer_size / (t2 - t1)) * 1000 * iterations);
+    printf("Planar to interleaved bandwidth %.3e byte/s.\n", buffer_size / t);
 
     for (int32_t x = 0; x < buffer_side_length; x++) {
         for (int32_t y = 0; y < buffer_side_length; y++) {
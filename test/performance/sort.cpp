@@ -1,7 +1,7 @@
 #include "Halide.h"
 #include <stdio.h>
 #include <algorithm>
-#include "clock.h"
+#include "benchmark.h"
 
 using namespace Halide;
 
@@ -155,12 +155,9 @@ int main(int argc, char **argv) {
     f.compile_jit();
     printf("Running...\n");
     Image<int> bitonic_sorted(N);
-    f.realize(bitonic_sorted);
-    double t1 = current_time();
-    for (int i = 0; i < 10; i++) {
+    double t_bitonic = benchmark("sort/bitonic", [&]() {
         f.realize(bitonic_sorted);
-    }
-    double t2 = current_time();
+    }).p50;
 
     printf("Merge sort...\n");
     f = merge_sort(input, N);
@@ -168,27 +165,29 @@ int main(int argc, char **argv) {
     f.compile_jit();
     printf("Running...\n");
     Image<int> merge_sorted(N);
-    f.realize(merge_sorted);
-    double t3 = current_time();
-    for (int i = 0; i < 10; i++) {
+    double t_merge = benchmark("sort/merge", [&]() {
         f.realize(merge_sorted);
-    }
-    double t4 = current_time();
+    }).p50;
 
     Image<int> correct(N);
     for (int i = 0; i < N; i++) {
         correct(i) = data(i);
     }
     printf("std::sort...\n");
-    double t5 = current_time();
+    // Each iteration has to start from the unsorted data, so this
+    // includes the time to copy it.
+    std::vector<int> scratch(N);
+    double t_std = benchmark("sort/std_sort", [&]() {
+        std::copy(&data(0), &data(0) + N, scratch.begin());
+        std::sort(scratch.begin(), scratch.end());
+    }).p50;
     std::sort(&correct(0), &correct(N));
-    double t6 = current_time();
 
     printf("Times:\n"
            "bitonic sort: %f \n"
            "merge sort: %f \n"
            "std::sort %f\n",
-           (t2-t1)/10, (t4-t3)/10, t6-t5);
+           t_bitonic * 1000, t_merge * 1000, t_std * 1000);
 
     if (N <= 100) {
         for (int i = 0; i < N; i++) {
@@ -0,0 +1,126 @@
+// Compares two files of benchmark results written by
+// apps/support/benchmark.h (one JSON object per line), and reports the
+// change in the median time of each benchmark found in both. Exits
+// with a nonzero status if any benchmark got slower by more than the
+// given percentage (default 10).
+//
+//     compare_benchmarks baseline.jsonl results.jsonl [threshold_percent]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fstream>
+#include <map>
+#include <string>
+#include <utility>
+
+// Find the value of the given key in a line written by benchmark_report.
+static bool find_value(const std::string &line, const std::string &key, size_t *pos) {
+    std::string pattern = "\"" + key + "\": ";
+    size_t p = line.find(pattern);
+    if (p == std::string::npos) return false;
+    *pos = p + pattern.size();
+    return true;
+}
+
+static bool get_string(const std::string &line, const std::string &key, std::string *value) {
+    size_t p;
+    if (!find_value(line, key, &p) || p >= line.size() || line[p] != '"') return false;
+    value->clear();
+    for (p++; p < line.size() && line[p] != '"'; p++) {
+        if (line[p] == '\\' && p + 1 < line.size()) {
+            p++;
+            if (line[p] == 'u') {
+                // benchmark_report only escapes control characters this way.
+                *value += (char)strtol(line.substr(p + 1, 4).c_str(), NULL, 16);
+                p += 4;
+                continue;
+            }
+        }
+        *value += line[p];
+    }
+    return p < line.size();
+}
+
+static bool get_number(const std::string &line, const std::string &key, double *value) {
+    size_t p;
+    if (!find_value(line, key, &p)) return false;
+    char *end;
+    *value = strtod(line.c_str() + p, &end);
+    return end != line.c_str() + p;
+}
+
+typedef std::pair<std::string, int> Key;
+
+// The median times from a file of results. If a benchmark appears more
+// than once, the last result wins.
+static bool load(const char *filename, std::map<Key, double> *results) {
+    std::ifstream f(filename);
+    if (!f) {
+        fprintf(stderr, "Could not open %s\n", filename);
+        return false;
+    }
+    std::string line;
+    int line_number = 0;
+    while (std::getline(f, line)) {
+        line_number++;
+        if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+        std::string name;
+        double threads = 0, p50;
+        if (!get_string(line, "name", &name) || !get_number(line, "p50_ms", &p50)) {
+            fprintf(stderr, "%s:%d: not a benchmark result\n", filename, line_number);
+            return false;
+        }
+        get_number(line, "threads", &threads);
+        (*results)[Key(name, (int)threads)] = p50;
+    }
+    return true;
+}
+
+static std::string describe(const Key &k) {
+    std::string s = k.first;
+    if (k.second > 0) {
+        s += " (" + std::to_string(k.second) + " threads)";
+    }
+    return s;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3 || argc > 4) {
+        fprintf(stderr, "Usage: %s baseline.jsonl results.jsonl [threshold_percent]\n", argv[0]);
+        return 1;
+    }
+    double threshold = argc == 4 ? atof(argv[3]) : 10.0;
+
+    std::map<Key, double> baseline, results;
+    if (!load(argv[1], &baseline) || !load(argv[2], &results)) {
+        return 1;
+    }
+
+    int regressions = 0;
+    printf("%-60s %12s %12s %9s\n", "benchmark", "baseline ms", "current ms", "change");
+    for (const auto &r : results) {
+        auto b = baseline.find(r.first);
+        if (b == baseline.end()) {
+            printf("%-60s %12s %12.4f %9s\n", describe(r.first).c_str(), "-", r.second, "new");
+            continue;
+        }
+        double change = b->second > 0 ? 100.0 * (r.second - b->second) / b->second : 0.0;
+        bool regressed = change > threshold;
+        printf("%-60s %12.4f %12.4f %+8.1f%%%s\n", describe(r.first).c_str(),
+               b->second, r.second, change, regressed ? "  REGRESSION" : "");
+        if (regressed) regressions++;
+    }
+    for (const auto &b : baseline) {
+        if (results.find(b.first) == results.end()) {
+            printf("%-60s %12.4f %12s %9s\n", describe(b.first).c_str(), b.second, "-", "missing");
+        }
+    }
+
+    if (regressions) {
+        printf("%d benchmark%s got more than %g%% slower\n",
+               regressions, regressions == 1 ? "" : "s", threshold);
+        return 1;
+    }
+    return 0;
+}